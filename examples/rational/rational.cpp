@@ -79,6 +79,76 @@ EXPORTED_FUNCTION const vector<AggregatePtr>& GetAggregates()
     return _aggregates;
 }
 
+/**
+ * Typed kernels for sum() and prod() over rationals. Without them these
+ * aggregates fall back to the generic implementations that evaluate the
+ * "+" and "*" functions above through an expression for every value.
+ */
+struct RationalSum: AggregateKernel<RationalSum, SciDB_Rational, SciDB_Rational>
+{
+    static void init(SciDB_Rational& state)
+    {
+        state = SciDB_Rational(0);
+    }
+
+    static void aggregate(SciDB_Rational& state, SciDB_Rational const& value)
+    {
+        state += value;
+    }
+
+    static void multAggregate(SciDB_Rational& state, SciDB_Rational const& value, uint64_t count)
+    {
+        state += value * count;
+    }
+
+    static void merge(SciDB_Rational& state, SciDB_Rational const& other)
+    {
+        state += other;
+    }
+
+    static bool final(SciDB_Rational const& state, SciDB_Rational& result)
+    {
+        result = state;
+        return true;
+    }
+
+    static bool final(Value::reason, SciDB_Rational& result)
+    {
+        result = SciDB_Rational(0);
+        return true;
+    }
+};
+
+struct RationalProd: AggregateKernel<RationalProd, SciDB_Rational, SciDB_Rational>
+{
+    static void init(SciDB_Rational& state)
+    {
+        state = SciDB_Rational(1);
+    }
+
+    static void aggregate(SciDB_Rational& state, SciDB_Rational const& value)
+    {
+        state = state * value;
+    }
+
+    static void merge(SciDB_Rational& state, SciDB_Rational const& other)
+    {
+        state = state * other;
+    }
+
+    static bool final(SciDB_Rational const& state, SciDB_Rational& result)
+    {
+        result = state;
+        return true;
+    }
+
+    static bool final(Value::reason, SciDB_Rational& result)
+    {
+        result = SciDB_Rational(1);
+        return true;
+    }
+};
+
 /**
  * Class for registering/unregistering user defined objects
  */
@@ -139,7 +209,8 @@ public:
         _functionDescs.push_back(FunctionDescription(">", list_of("rational")("rational"), TID_BOOL, &rationalGT));
 
         // Aggregates
-//        _aggregates.push_back(AggregatePtr(new BaseAggregate<AggSum, SciDB_Rational, SciDB_Rational>("sum", rationalType, rationalType)));
+        _aggregates.push_back(AggregatePtr(new KernelAggregate<RationalSum>("sum", rationalType, rationalType)));
+        _aggregates.push_back(AggregatePtr(new KernelAggregate<RationalProd>("prod", rationalType, rationalType)));
         _aggregates.push_back(AggregatePtr(new BaseAggregate<AggAvg, SciDB_Rational, SciDB_Rational>("avg", rationalType, rationalType)));
         _aggregates.push_back(AggregatePtr(new BaseAggregateInitByFirst<AggMin, SciDB_Rational, SciDB_Rational>("min", rationalType, rationalType)));
         _aggregates.push_back(AggregatePtr(new BaseAggregateInitByFirst<AggMax, SciDB_Rational, SciDB_Rational>("max", rationalType, rationalType)));
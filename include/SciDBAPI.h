@@ -41,6 +41,7 @@
 #define SCIDBAPI_H_
 
 #include <stdint.h>
+#include <map>
 #include <queue>
 
 #include <array/Array.h>
@@ -53,6 +54,12 @@ namespace scidb
 
 typedef std::queue<Warning> WarningsQueue;
 
+/**
+ * Values of the $name bind parameters of a query, keyed by name (without the '$').
+ * Each value is the text of an AFL literal: a number, a quoted string, true, false or null.
+ */
+typedef std::map<std::string, std::string> QueryParameters;
+
 /**
  * Query execution statistic
  */
@@ -137,6 +144,19 @@ public:
      */
     virtual void prepareQuery(const std::string& queryString, bool afl, const std::string& programOptions, QueryResult& queryResult, void* connection = NULL) const = 0;
 
+    /**
+     * Prepare a query string with bind parameters. Throws exception if an error occurred.
+     * Every $name reference in the query which names one of the parameters is replaced
+     * with its value. Queries that differ only in the parameter values can reuse
+     * the physical plan cached by the server.
+     * @param queryString a string with query on scidb language.
+     * @param parameters the values of the bind parameters.
+     * @param queryResult a reference to QueryResult structure with description of query execution result.
+     * @param connection is handle to connection returned by connect method.
+     */
+    virtual void prepareQuery(const std::string& queryString, bool afl, const std::string& programOptions,
+                              const QueryParameters& parameters, QueryResult& queryResult, void* connection = NULL) const = 0;
+
     /**
      * Execute a query string. Throws exception if an error occurred.
      * @param queryString a string with query on scidb language.
@@ -82,13 +82,65 @@ namespace scidb
  * @param nInstancesOriginal number of instances at the time the Array was created
  *        (which is not always the current number of instances, even though it often
  *         is, so be careful: use the value that was persisted with the Array).
+ * @param psDimension for psRangePartitioned and psCoPartitioned, the number of the
+ *        dimension chunks are placed by
+ * @param psBlock for psRangePartitioned and psCoPartitioned, the number of consecutive
+ *        chunks along psDimension placed on the same instance
  * @return if positive, the InstanceID where the primary copy of the chunk belongs
  *         if negative, a special value like ALL_INSTANCES_MASK which is not associated
  *         with a single instance, so it is often incorrect to directly compare the result
  *         to another InstanceID directly.  A matching predicate should be used.
  */
 InstanceID getPrimaryInstanceForChunk(PartitioningSchema ps, Coordinates const& chunkPosition,
-                                      Dimensions const& dims, size_t nInstancesOriginal);
+                                      Dimensions const& dims, size_t nInstancesOriginal,
+                                      size_t psDimension = 0, uint64_t psBlock = 1);
+
+/**
+ * The optional data for psRangePartitioned and psCoPartitioned: the dimension
+ * the chunks are placed by and the number of its consecutive chunks on each instance.
+ * Redistributing to these partitioning schemas requires it, because the array being
+ * redistributed need not be partitioned the same way.
+ */
+class PartitioningSchemaDataForDimension : public PartitioningSchemaData
+{
+public:
+    /**
+     * @param desc an array descriptor with psRangePartitioned or psCoPartitioned
+     */
+    explicit PartitioningSchemaDataForDimension(ArrayDesc const& desc)
+    :   _ps(desc.getPartitioningSchema()),
+        _dimension(desc.getPartitioningDimension()),
+        _block(desc.getPartitioningBlock())
+    {
+        assert(_ps == psRangePartitioned || _ps == psCoPartitioned);
+    }
+
+    virtual PartitioningSchema getID()
+    {
+        return _ps;
+    }
+
+    size_t getDimension() const
+    {
+        return _dimension;
+    }
+
+    uint64_t getBlock() const
+    {
+        return _block;
+    }
+
+private:
+    PartitioningSchema _ps;
+    size_t _dimension;
+    uint64_t _block;
+};
+
+/**
+ * @return the optional data needed to redistribute an array into the partitioning of desc,
+ *         or null if its partitioning schema needs none
+ */
+std::shared_ptr<PartitioningSchemaData> getPartitioningSchemaData(ArrayDesc const& desc);
 
 } // namespace scidb
 
@@ -0,0 +1,105 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file ExchangeArray.h
+ *
+ * @brief An array evaluating several chunks of its input concurrently.
+ */
+
+#ifndef EXCHANGE_ARRAY_H_
+#define EXCHANGE_ARRAY_H_
+
+#include <memory>
+
+#include <array/Array.h>
+
+namespace scidb
+{
+
+class Query;
+
+/**
+ * An exchange on top of a pipeline of delegate arrays, such as apply() over filter() over scan().
+ * Each attribute iterator keeps up to nWorkers chunk positions of the input in flight: every
+ * position is pulled through the pipeline by a job on the operator thread pool, using its own
+ * input iterator, and copied into a MemChunk. The consumer gets the chunks either in the order
+ * of the input iterator or, if it does not need the attributes to move in lockstep, in the order
+ * they complete.
+ *
+ * A consumer never blocks on a position no thread has started: it evaluates such a position
+ * itself. So an exchange can safely sit below another one, although both use the same pool.
+ *
+ * The input must support RANDOM access, and its iterators must be usable from
+ * different threads at the same time (as the iterators of delegate arrays are).
+ */
+class ExchangeArray : public Array
+{
+public:
+    /**
+     * @param input the pipeline to evaluate
+     * @param nWorkers the number of chunks of each attribute to evaluate concurrently
+     * @param ordered true to return the chunks in the order of the input iterators,
+     *        false to return each one as soon as it is ready
+     * @param query the current query
+     */
+    ExchangeArray(std::shared_ptr<Array> const& input,
+                  size_t nWorkers,
+                  bool ordered,
+                  std::shared_ptr<Query> const& query);
+
+    virtual ArrayDesc const& getArrayDesc() const
+    {
+        return _input->getArrayDesc();
+    }
+
+    virtual Access getSupportedAccess() const
+    {
+        return _input->getSupportedAccess();
+    }
+
+    virtual std::shared_ptr<ConstArrayIterator> getConstIterator(AttributeID attId) const;
+
+    std::shared_ptr<Array> const& getInputArray() const
+    {
+        return _input;
+    }
+
+    bool isOrdered() const
+    {
+        return _ordered;
+    }
+
+private:
+    class ChunkSlot;
+    class ChunkJob;
+    class ExchangeArrayIterator;
+
+    std::shared_ptr<Array> _input;
+    size_t _nWorkers;
+    bool _ordered;
+    std::weak_ptr<Query> _query;
+};
+
+} // namespace
+#endif
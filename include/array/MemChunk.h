@@ -274,6 +274,13 @@ namespace scidb
         void decompress(const CompressedBuffer& buf);
         void setData(SharedBuffer const* buf);
 
+        /**
+         * Exchange the data of this chunk with the data of another chunk,
+         * which must have the same layout. The chunk descriptions are not exchanged.
+         * @param other the chunk to exchange the data with
+         */
+        void swapData(MemChunk& other);
+
         static size_t getFootprint(size_t ndims)
         { return sizeof(MemChunk) + (4 * (ndims * sizeof(Coordinate))); }
 
@@ -421,6 +428,7 @@ namespace scidb
         ConstRLEEmptyBitmap::iterator emptyBitmapIterator;
 
         Coordinates currPos;
+        position_t currPosLPos;   // the logical position of currPos, -1 before the first getPosition()
         TypeId typeId;
         Type   type;
         Value const& defaultValue;
@@ -544,6 +552,7 @@ namespace scidb
         std::shared_ptr<ConstRLEEmptyBitmap> _emptyBitmap;
         ConstRLEEmptyBitmap::iterator _emptyBitmapIterator;
         Coordinates _currPos;
+        position_t _currPosLPos;  // the logical position of _currPos, -1 before the first getPosition()
         std::weak_ptr<Query> _query;
 
         BaseTileChunkIterator(ArrayDesc const& desc,
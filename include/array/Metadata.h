@@ -144,6 +144,9 @@ enum PartitioningSchema
                         // TODO: replace with psWildcard and others as required
     psGroupby,
     psScaLAPACK,
+    psRangePartitioned, // blocks of consecutive chunks along one dimension, in turn on
+                        // each instance (one block per instance by default)
+    psCoPartitioned,    // like psRangePartitioned, one chunk per block by default
     // A newly introduced partitioning schema should be added before this line.
     psEND
 };
@@ -195,7 +198,8 @@ inline PartitioningSchema defaultPartitioning()
  */
 inline bool doesPartitioningSchemaHaveData(PartitioningSchema ps)
 {
-    return ps==psGroupby || ps==psScaLAPACK; // TODO: || ps==psLocalInstance ?
+    return ps==psGroupby || ps==psScaLAPACK ||
+           ps==psRangePartitioned || ps==psCoPartitioned; // TODO: || ps==psLocalInstance ?
 }
 
 /**
@@ -832,6 +836,41 @@ public:
     {
         assert(isPermitted(ps)); // prevent psUninitialized from leaking
        _ps = ps;
+       if (ps != psRangePartitioned && ps != psCoPartitioned) {
+           _psDimension = 0;
+           _psBlock = 1;
+       }
+    }
+
+    /**
+     * Get the number of the dimension that psRangePartitioned and psCoPartitioned
+     * place chunks by. Meaningless for other partitioning schemas.
+     */
+    size_t getPartitioningDimension() const
+    {
+        return _psDimension;
+    }
+
+    /**
+     * Get the number of consecutive chunks along the partitioning dimension that
+     * psRangePartitioned and psCoPartitioned place on the same instance.
+     */
+    uint64_t getPartitioningBlock() const
+    {
+        return _psBlock;
+    }
+
+    /**
+     * Set the dimension that psRangePartitioned and psCoPartitioned place chunks by,
+     * and the number of its consecutive chunks placed on the same instance.
+     * Setting any other partitioning schema resets them.
+     */
+    void setPartitioningDimension(size_t dimension, uint64_t block)
+    {
+        assert(dimension < _dimensions.size() || _dimensions.empty());
+        assert(block > 0);
+        _psDimension = dimension;
+        _psBlock = block;
     }
 
     /**
@@ -858,6 +897,8 @@ public:
         ar & _dimensions;
         ar & _flags;
         ar & _ps;
+        ar & _psDimension;
+        ar & _psBlock;
 
         if (Archive::is_loading::value)
         {
@@ -1043,6 +1084,8 @@ private:
     AttributeDesc* _bitmapAttr;
     int32_t _flags;
     PartitioningSchema _ps;
+    size_t _psDimension;
+    uint64_t _psBlock;
 };
 
 /**
@@ -1830,7 +1873,9 @@ inline ArrayDesc addEmptyTagAttribute(ArrayDesc const& desc)
 {
     //XXX: This does not check to see if some other attribute does not already have the same name
     //     and it would be faster to mutate the structure, not copy. See also ArrayDesc::addAttribute
-    return ArrayDesc(desc.getName(), addEmptyTagAttribute(desc.getAttributes()), desc.getDimensions(), desc.getPartitioningSchema());
+    ArrayDesc result(desc.getName(), addEmptyTagAttribute(desc.getAttributes()), desc.getDimensions(), desc.getPartitioningSchema());
+    result.setPartitioningDimension(desc.getPartitioningDimension(), desc.getPartitioningBlock());
+    return result;
 }
 
 /**
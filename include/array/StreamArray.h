@@ -226,6 +226,17 @@ class MultiStreamArray : public StreamArray
          */
         virtual std::shared_ptr<MemChunk> getMergedChunk(AttributeID attId,
                                                        std::shared_ptr<Query> const& query) = 0;
+        /**
+         * Get a new merger for a group of the partial chunks of a position, so that the groups
+         * can be merged concurrently and their results merged by this merger in turn.
+         * The chunk returned by getMergedChunk() of the group merger must be a partial chunk
+         * acceptable to mergePartialChunk() of this merger.
+         * @return a new merger or NULL if all the partial chunks must be merged by this merger
+         */
+        virtual std::shared_ptr<PartialChunkMerger> getGroupMerger() const
+        {
+            return std::shared_ptr<PartialChunkMerger>();
+        }
     protected:
         PartialChunkMerger() {}
     private: // disallow
@@ -271,6 +282,9 @@ class MultiStreamArray : public StreamArray
         /// @see MultiStreamArray::PartialChunkMerger::getMergedChunk
         virtual std::shared_ptr<MemChunk> getMergedChunk(AttributeID attId,
                                                            const std::shared_ptr<Query>& query);
+
+        /// @see MultiStreamArray::PartialChunkMerger::getGroupMerger
+        virtual std::shared_ptr<PartialChunkMerger> getGroupMerger() const;
     };
 
     /**
@@ -353,6 +367,14 @@ private:
                                 const AttributeID attId);
     void logReadyPositions(PositionMap& readyPos,
                            const AttributeID attId);
+    bool isTreeMerge(std::list<size_t> const& currPartialStreams,
+                     const AttributeID attId) const;
+    std::shared_ptr<MemChunk> mergeTree(const AttributeID attId,
+                                        std::shared_ptr<Query> const& query);
+
+    class GroupMergeJob;
+    /// A partial chunk and its source stream
+    typedef std::pair<size_t, std::shared_ptr<MemChunk> > PartialChunk;
 
     const size_t _nStreams;
     const size_t _localStream;
@@ -362,6 +384,12 @@ private:
     std::vector<PositionMap> _readyPositions;
     std::vector<std::list<size_t> > _notReadyPositions;
     std::vector<std::list<size_t> > _currPartialStreams;
+    /// The partial chunks of the current position received so far, when they are merged as a tree
+    std::vector<std::vector<PartialChunk> > _partialChunks;
+    /// The minimum number of partial chunks of a position merged as a tree, 0 for never
+    const size_t _treeMergeFanIn;
+    /// The maximum number of groups of partial chunks merged concurrently
+    const size_t _nMergeWorkers;
 
     /// true if a data integrity issue has been found
     bool _hasDataIntegrityIssue;
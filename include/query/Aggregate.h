@@ -193,6 +193,15 @@ public:
         return false;
     }
 
+    /**
+     * Set the numeric constants following the input attribute of the
+     * aggregate call, e.g. the 0.95 of approx_quantile(x, 0.95).
+     * @param parameters the constants, possibly none
+     * @throws UserException if the aggregate does not accept them
+     * @note clone() must preserve the parameters.
+     */
+    virtual void setParameters(std::vector<double> const& parameters);
+
     virtual void initializeState(Value& state) = 0;
 
     /**
@@ -526,6 +535,165 @@ public:
     }
 };
 
+/**
+ * Base of the kernels plugged into @c KernelAggregate.
+ *
+ * A kernel is a class with no data members that describes one typed
+ * aggregate. It derives from AggregateKernel<Kernel, Input, State, Result>
+ * and must define:
+ * @code
+ *   static void init(State& state);
+ *   static void aggregate(State& state, Input const& value);
+ *   static void merge(State& state, State const& other);
+ *   static bool final(State const& state, Result& result);   // false means null
+ * @endcode
+ * It may also redefine multAggregate(), called for a run of @c count equal
+ * values of an RLE tile, and final(Value::reason, Result&), which produces
+ * the result of a group that saw no values (null by default).
+ *
+ * @c Input and @c Result are the in-memory representations of the input
+ * and result SciDB types. @c State is stored as a TID_BINARY value and
+ * shipped between instances as raw bytes, so it must be trivially copyable.
+ */
+template<typename Kernel, typename I, typename S, typename R = I>
+struct AggregateKernel
+{
+    typedef I Input;
+    typedef S State;
+    typedef R Result;
+
+    static void multAggregate(State& state, Input const& value, uint64_t count)
+    {
+        for (uint64_t i = 0; i < count; ++i) {
+            Kernel::aggregate(state, value);
+        }
+    }
+
+    static bool final(Value::reason, Result&)
+    {
+        return false;
+    }
+};
+
+/**
+ * Aggregate driven by a typed kernel (see @c AggregateKernel).
+ *
+ * This is the authoring API for aggregates over user-defined types: a plugin
+ * registers, e.g.,
+ * @code
+ *   std::make_shared<KernelAggregate<RationalSum> >("sum", rationalType, rationalType)
+ * @endcode
+ * from GetAggregates(), and AggregateLibrary picks it over the generic
+ * expression-based fallback registered for TID_VOID. Accumulation calls the
+ * kernel directly, and tile mode walks the RLE segments handing runs of equal
+ * values to multAggregate(), without building a Value per cell.
+ */
+template<typename K, bool asterisk = false>
+class KernelAggregate: public Aggregate
+{
+protected:
+    typedef typename K::Input  Input;
+    typedef typename K::State  State;
+    typedef typename K::Result Result;
+
+    void accumulate(Value& dstState, Value const& srcValue)
+    {
+        assert(isStateInitialized(dstState));
+        assert(isAccumulatable(srcValue));
+
+        K::aggregate(dstState.get<State>(), srcValue.get<Input>());
+    }
+
+    void merge(Value& dstState, Value const& srcState)
+    {
+        assert(isStateInitialized(dstState));
+        assert(isMergeable(srcState));
+
+        K::merge(dstState.get<State>(), srcState.get<State>());
+    }
+
+public:
+    KernelAggregate(const std::string& name, Type const& aggregateType, Type const& resultType): Aggregate(name, aggregateType, resultType)
+    {}
+
+    AggregatePtr clone() const
+    {
+        return std::make_shared<KernelAggregate>(getName(), getAggregateType(), getResultType());
+    }
+
+    AggregatePtr clone(Type const& aggregateType) const
+    {
+        return std::make_shared<KernelAggregate>(getName(), aggregateType, _resultType.typeId() == TID_VOID ? aggregateType : _resultType);
+    }
+
+    bool ignoreNulls() const
+    {
+        return true;
+    }
+
+    Type getStateType() const
+    {
+        return Type(TID_BINARY, sizeof(State) * CHAR_BIT);
+    }
+
+    bool supportAsterisk() const
+    {
+        return asterisk;
+    }
+
+    void initializeState(Value& state)
+    {
+        state.setSize(sizeof(State));
+        K::init(state.get<State>());
+    }
+
+    virtual void accumulateIfNeeded(Value& state, ConstRLEPayload const* tile)
+    {
+        if (! isStateInitialized(state)) {
+            initializeState(state);
+            assert(isStateInitialized(state));
+        }
+
+        State& s = state.get<State>();
+
+        for (size_t i=0,n=tile->nSegments(); i < n; i++)
+        {
+            size_t vLen;
+            const RLEPayload::Segment& v = tile->getSegment(i, vLen);
+            if (v.null())
+                continue;
+            if (v.same()) {
+                K::multAggregate(s, getPayloadValue<Input>(tile, v.valueIndex()), vLen);
+            } else {
+                const size_t end = v.valueIndex() + vLen;
+                for (size_t j = v.valueIndex(); j < end; j++) {
+                    K::aggregate(s, getPayloadValue<Input>(tile, j));
+                }
+            }
+        }
+    }
+
+    void finalResult(Value& dstValue, Value const& srcState)
+    {
+        dstValue.setSize(sizeof(Result));
+        bool valid;
+
+        if (srcState.isNull())
+        {
+            valid = K::final(srcState.getMissingReason(), dstValue.get<Result>());
+        }
+        else
+        {
+            valid = K::final(srcState.get<State>(), dstValue.get<Result>());
+        }
+
+        if (!valid)
+        {
+            dstValue.setNull();
+        }
+    }
+};
+
 class CountingAggregate : public Aggregate
 {
 protected:
@@ -573,6 +741,7 @@ private:
 
     // Map of aggregate factories.
     // '*' for aggregate type means universal aggregate operator which operates by expressions (slow universal implementation).
+    // It is only used when no aggregate was registered for the exact input type, see KernelAggregate.
     typedef std::map<TypeId, AggregateElement> AggregateTypeIdToElementMap;
     typedef std::map < std::string, AggregateTypeIdToElementMap, __lesscasecmp > FactoriesMap;
     FactoriesMap _registeredFactories;
@@ -697,6 +866,9 @@ public:
     /// @see MultiStreamArray::PartialChunkMerger::getMergedChunk
     virtual std::shared_ptr<MemChunk> getMergedChunk(AttributeID attId,
                                                        const std::shared_ptr<Query>& query);
+
+    /// @see MultiStreamArray::PartialChunkMerger::getGroupMerger
+    virtual std::shared_ptr<MultiStreamArray::PartialChunkMerger> getGroupMerger() const;
 };
 #endif
 
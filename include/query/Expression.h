@@ -33,6 +33,9 @@
 #ifndef EXPRESSION_H_
 #define EXPRESSION_H_
 
+#include <map>
+#include <string>
+#include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/shared_array.hpp>
 
@@ -212,6 +215,15 @@ public:
         return _bindings;
     }
 
+    /**
+     * Replace the values of the bind parameter constants of a compiled expression.
+     * Each value must have the type of the literal the expression was compiled with;
+     * it goes through the same conversion the compiler applied to that literal.
+     * Parameters missing from bindings keep their current values.
+     * @param bindings values keyed by parameter name
+     */
+    void bindParameters(const std::map<std::string, Value>& bindings);
+
     void addVariableInfo(const std::string& name, const TypeId& type);
 
 private:
@@ -265,7 +277,9 @@ private:
         TypeId type;
         bool isConst;  /**< true if value presents and is constant */
         bool isConstantFunction;
-        ArgProp(): type( TID_VOID), isConst(false), isConstantFunction(false)
+        std::string parameter; /**< name of the bind parameter the constant came from, if any */
+        TypeId parameterType;  /**< type of the parameter literal before any conversion to type */
+        ArgProp(): type( TID_VOID), isConst(false), isConstantFunction(false), parameterType(TID_VOID)
         {
         }
         ArgProp& operator=(const ArgProp& val)
@@ -273,6 +287,8 @@ private:
             type = val.type;
             isConst = val.isConst;
             isConstantFunction = val.isConstantFunction;
+            parameter = val.parameter;
+            parameterType = val.parameterType;
             return *this;
         }
 
@@ -282,6 +298,8 @@ private:
             ar & type;
             ar & isConst;
             ar & isConstantFunction;
+            ar & parameter;
+            ar & parameterType;
         }
     };
 
@@ -103,7 +103,8 @@ class Constant : public LogicalExpression
 {
 public:
 	Constant(const std::shared_ptr<ParsingContext>& parsingContext, const  Value& value,
-		const  TypeId& type): LogicalExpression(parsingContext), _value(value), _type(type)
+		const  TypeId& type, const std::string& parameter = std::string()):
+		LogicalExpression(parsingContext), _value(value), _type(type), _parameter(parameter)
 	{
 	}
 
@@ -115,6 +116,14 @@ public:
         return _type;
     }
 
+    /**
+     * @return the name of the bind parameter this constant was substituted for,
+     * or an empty string for a literal written in the query text
+     */
+    const std::string& getParameter() const {
+        return _parameter;
+    }
+
     /**
      * Retrieve a human-readable description.
      * Append a human-readable description of this onto str. Description takes up
@@ -128,6 +137,7 @@ public:
 private:
 	 Value _value;
 	 TypeId _type;
+	 std::string _parameter;
 };
 
 class Function : public LogicalExpression
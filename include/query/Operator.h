@@ -45,6 +45,7 @@
 #include <memory>
 #include <boost/format.hpp>
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
 #include <unordered_map>
 
 #include <array/Array.h>
@@ -750,11 +751,13 @@ public:
             const std::shared_ptr<ParsingContext>& parsingContext,
             const std::string& aggregateName,
             std::shared_ptr <OperatorParam> const& inputAttribute,
-            const std::string& alias):
+            const std::string& alias,
+            std::vector<double> const& parameters = std::vector<double>()):
         OperatorParam(PARAM_AGGREGATE_CALL, parsingContext),
         _aggregateName(aggregateName),
         _inputAttribute(inputAttribute),
-        _alias(alias)
+        _alias(alias),
+        _parameters(parameters)
     {}
 
     std::string const& getAggregateName() const
@@ -777,10 +780,20 @@ public:
         return _alias;
     }
 
+    /**
+     * @return the numeric constants following the input attribute in the
+     * call, e.g. the 0.95 of approx_quantile(x, 0.95)
+     */
+    std::vector<double> const& getParameters() const
+    {
+        return _parameters;
+    }
+
 private:
     std::string _aggregateName;
     std::shared_ptr <OperatorParam> _inputAttribute;
     std::string _alias;
+    std::vector<double> _parameters;
 
 public:
     template<class Archive>
@@ -802,6 +815,7 @@ public:
         }
 
         ar & _alias;
+        ar & _parameters;
     }
 
     /**
@@ -1108,12 +1122,15 @@ private:
     PartitioningSchema _partitioningSchema;
     std::shared_ptr <CoordinateTranslator> _distMapper;
     int64_t _instanceId;
+    size_t _psDimension;
+    uint64_t _psBlock;
 
 public:
     RedistributeContext(PartitioningSchema ps = psHashPartitioned,
                       std::shared_ptr <CoordinateTranslator> distMapper = std::shared_ptr<CoordinateTranslator>(),
                       int64_t instanceId = 0):
-        _partitioningSchema(ps), _distMapper(distMapper), _instanceId(instanceId)
+        _partitioningSchema(ps), _distMapper(distMapper), _instanceId(instanceId),
+        _psDimension(0), _psBlock(1)
     {
         if(!isValidPartitioningSchema(ps, true)) {
              ASSERT_EXCEPTION_FALSE("RedistributeContext: invalid PartitioningSchema")
@@ -1123,10 +1140,25 @@ public:
             throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_UNDEFINED_DISTRIBUTION_CANT_HAVE_MAPPER);
     }
 
+    /**
+     * The distribution of an array partitioned as schema says, including the partitioning
+     * dimension of psRangePartitioned and psCoPartitioned.
+     */
+    explicit RedistributeContext(ArrayDesc const& schema,
+                                 std::shared_ptr <CoordinateTranslator> distMapper = std::shared_ptr<CoordinateTranslator>()):
+        _partitioningSchema(schema.getPartitioningSchema()), _distMapper(distMapper), _instanceId(0),
+        _psDimension(schema.getPartitioningDimension()), _psBlock(schema.getPartitioningBlock())
+    {
+        if(_distMapper.get() != NULL && _partitioningSchema == psUndefined)
+            throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_UNDEFINED_DISTRIBUTION_CANT_HAVE_MAPPER);
+    }
+
     RedistributeContext(const RedistributeContext& other):
         _partitioningSchema(other._partitioningSchema),
         _distMapper(other._distMapper),
-        _instanceId(other._instanceId)
+        _instanceId(other._instanceId),
+        _psDimension(other._psDimension),
+        _psBlock(other._psBlock)
     {
         if (_distMapper.get() != NULL && _partitioningSchema == psUndefined)
             throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_UNDEFINED_DISTRIBUTION_CANT_HAVE_MAPPER);
@@ -1142,6 +1174,8 @@ public:
             _partitioningSchema = rhs._partitioningSchema;
             _distMapper = rhs._distMapper;
             _instanceId = rhs._instanceId;
+            _psDimension = rhs._psDimension;
+            _psBlock = rhs._psBlock;
         }
         return *this;
     }
@@ -1176,6 +1210,24 @@ public:
         return _instanceId;
     }
 
+    /**
+     * @return true if chunks are placed by one dimension, as with psRangePartitioned and psCoPartitioned
+     */
+    bool hasPartitioningDimension() const
+    {
+        return _partitioningSchema == psRangePartitioned || _partitioningSchema == psCoPartitioned;
+    }
+
+    size_t getPartitioningDimension() const
+    {
+        return _psDimension;
+    }
+
+    uint64_t getPartitioningBlock() const
+    {
+        return _psBlock;
+    }
+
     friend bool operator== (RedistributeContext const& lhs, RedistributeContext const& rhs);
     friend bool operator!= (RedistributeContext const& lhs, RedistributeContext const& rhs)
     {
@@ -1422,15 +1474,49 @@ public:
     friend std::ostream& operator<<(std::ostream& stream, const PhysicalBoundaries& bounds);
 };
 
+/**
+ * The chunk positions of an input array, handed out in morsels of consecutive
+ * positions to the jobs storing them.
+ */
+class ChunkMorsels
+{
+private:
+    Mutex _mutex;
+    std::shared_ptr<ConstArrayIterator> _iterator;
+    size_t const _morselSize;
+
+public:
+    /**
+     * @param input an array supporting RANDOM access
+     * @param morselSize the number of positions in a morsel
+     */
+    ChunkMorsels(std::shared_ptr<Array> const& input, size_t morselSize);
+
+    /**
+     * Get the next morsel.
+     * @param[out] positions the positions of the morsel
+     * @return false if no positions are left
+     */
+    bool next(std::vector<Coordinates>& positions);
+
+    /**
+     * @return the number of jobs that should store an input in morsels,
+     *         or 1 if it must be stored by a single job in one pass
+     */
+    static size_t getNumberOfJobs(Array const& input);
+};
+
 /**
  * A thread that reads chunks from an input array and stores them into an output array.
- * Currently used by operators store() and redimension_store() - the latter to be cleaned up.
+ * Several jobs sharing ChunkMorsels store the input in parallel, each one pulling, copying,
+ * compressing and writing all the attributes of the positions of the morsels it takes;
+ * without morsels a single job stores the whole input in one pass.
+ * Currently used by operator store().
  */
 class StoreJob : public Job, protected SelfStatistics
 {
 private:
-    size_t _shift;
-    size_t _step;
+    std::shared_ptr<ChunkMorsels> _morsels;
     std::shared_ptr<Array> _dstArray;
     std::shared_ptr<Array> _srcArray;
     std::vector<std::shared_ptr<ArrayIterator> > _dstArrayIterators;
@@ -1438,6 +1524,9 @@ private:
 
     /// @return true if srcChunk has values anywhere in its body or overlap
     bool hasValues(ConstChunk const& srcChunk);
+
+    /// Store all the attributes at the current position of the source iterators
+    void storeChunks();
 public:
 
     /**
@@ -1450,10 +1539,10 @@ public:
      */
     std::set<Coordinates, CoordinatesLess> createdChunks;
 
-    StoreJob(size_t id, size_t nJobs, std::shared_ptr<Array> dst,
+    StoreJob(std::shared_ptr<ChunkMorsels> const& morsels, std::shared_ptr<Array> dst,
             std::shared_ptr<Array> src, size_t nDims, size_t nAttrs,
             std::shared_ptr<Query> query) :
-            Job(query), _shift(id), _step(nJobs), _dstArray(dst), _srcArray(src), _dstArrayIterators(
+            Job(query), _morsels(morsels), _dstArray(dst), _srcArray(src), _dstArrayIterators(
                     nAttrs), _srcArrayIterators(nAttrs), bounds(
                     PhysicalBoundaries::createEmpty(nDims))
     {
@@ -2131,6 +2220,47 @@ public:
         return true;
     }
 
+    /**
+     *  [Optimizer API] Determine if each output chunk is computed from the chunks of the
+     *  first input at the same position only, by array iterators that different threads
+     *  may use at the same time. The optimizer may then evaluate several chunks of a chain
+     *  of such operators concurrently.
+     *  @param sourceSchemas shapes of all arrays that will given as inputs.
+     *  @return true if the output chunks may be computed concurrently, false otherwise
+     */
+    virtual bool computesChunksIndependently(
+            std::vector<ArrayDesc> const& sourceSchemas) const
+    {
+        return false;
+    }
+
+    /**
+     *  [Optimizer API] Determine if the operator reads each attribute of its first input
+     *  on its own, so that the chunks of different attributes may come in different orders.
+     *  @param sourceSchemas shapes of all arrays that will given as inputs.
+     *  @return true if the input chunks may come unordered, false otherwise
+     */
+    virtual bool acceptsUnorderedChunks(
+            std::vector<ArrayDesc> const& sourceSchemas) const
+    {
+        return false;
+    }
+
+    /**
+     *  [Optimizer API] Determine if the operator, requiring collocated inputs, computes the same
+     *  result when one of its two inputs is replicated on every instance (psReplication) and the
+     *  other one has any distribution with full chunks. The optimizer may then replicate a small
+     *  input instead of redistributing a large one. The operator must then return the distribution
+     *  of the input which is not replicated from getOutputDistribution().
+     *  @param sourceSchemas shapes of all arrays that will given as inputs.
+     *  @return true if an input may be replicated, false otherwise
+     */
+    virtual bool acceptsReplicatedInput(
+            std::vector<ArrayDesc> const& sourceSchemas) const
+    {
+        return false;
+    }
+
     /**
      *  [Optimizer API] Determine the distribution of operator output.
      *  @param sourceDistributions distributions of inputs that will be provided in order same as inputSchemas
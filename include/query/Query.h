@@ -472,6 +472,11 @@ public:
      */
     std::string programOptions;
 
+    /**
+     * Values of the $name bind parameters supplied with the query
+     */
+    QueryParameters parameters;
+
     /**
      * Handle a change in the local instance liveness. If the new livenes is different
      * from this query's coordinator liveness, the query is marked to be aborted.
@@ -837,6 +842,12 @@ public:
      */
     ArrayID getCatalogVersion(const std::string& arrayName, bool allowMissing=false) const ;
 
+    /**
+     * @return a copy of the array locks requested by this query so far;
+     * once the locks are acquired they carry the catalog array ids they were granted at
+     */
+    SystemCatalog::QueryLocks getRequestedLocks();
+
     /**
      * Return current queryID for thread.
      */
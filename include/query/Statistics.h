@@ -55,6 +55,12 @@ public:
     volatile uint64_t receivedSize; /**< A number of received bytes */
     volatile uint64_t receivedMessages; /**< A number of received messages */
 
+    // redistribution
+    volatile uint64_t localChunkSize;  /**< A number of bytes of chunks redistributed to the local instance */
+    volatile uint64_t localChunks; /**< A number of chunks redistributed to the local instance */
+    volatile uint64_t remoteChunkSize;  /**< A number of bytes of chunks redistributed to other instances */
+    volatile uint64_t remoteChunks; /**< A number of chunks redistributed to other instances */
+
     // disk
     volatile uint64_t writtenSize;  /**< A number of written bytes to disk */
     volatile uint64_t writtenChunks; /**< A number of written chunks to disk */
@@ -71,6 +77,7 @@ public:
 
     Statistics(): executionTime(0),
         sentSize(0), sentMessages(0), receivedSize(0), receivedMessages(0),
+        localChunkSize(0), localChunks(0), remoteChunkSize(0), remoteChunks(0),
         writtenSize(0), writtenChunks(0), readSize(0), readChunks(0),
         pinnedSize(0), pinnedChunks(0),
         allocatedSize(0), allocatedChunks(0)
@@ -125,6 +132,9 @@ const size_t smLogger = 1;
 /// Output into postgres database. String in create is connection string.
 const size_t smPostgres = 2;
 
+/// Output into log as one line of exact counters per query. String in create is logger name.
+const size_t smCounters = 3;
+
 class StatisticsMonitor
 {
 public:
@@ -138,7 +138,28 @@ enum
     CONFIG_INPUT_DOUBLE_BUFFERING,
     CONFIG_SECURITY,
     CONFIG_ENABLE_CHUNKMAP_RECOVERY,
-    CONFIG_SKIP_CHUNKMAP_INTEGRITY_CHECK
+    CONFIG_SKIP_CHUNKMAP_INTEGRITY_CHECK,
+    CONFIG_DELTA_CHAIN_LIMIT,
+    CONFIG_CHUNKMAP_CHECKPOINT_INTERVAL,
+    CONFIG_CHUNKMAP_LOADED_LIMIT,
+    CONFIG_REPLICATION_BATCH_SIZE,
+    CONFIG_REPLICATION_COMPRESSION,
+    CONFIG_STORAGE_TIERS,
+    CONFIG_STORAGE_TIER_INTERVAL,
+    CONFIG_STORAGE_TIER_COLD_SECONDS,
+    CONFIG_STORAGE_TIER_HOT_ACCESSES,
+    CONFIG_MMAP_MIN_CHUNK_SIZE,
+    CONFIG_MMAP_CACHE_SIZE,
+    CONFIG_MMAP_ADVICE,
+    CONFIG_SCRUB_RATE,
+    CONFIG_SCRUB_INTERVAL,
+    CONFIG_WRITE_BATCH_SIZE,
+    CONFIG_PLAN_CACHE_SIZE,
+    CONFIG_EXCHANGE_WORKERS,
+    CONFIG_STORE_MORSEL_SIZE,
+    CONFIG_MERGE_FAN_IN,
+    CONFIG_SG_LOCAL_BYPASS,
+    CONFIG_BROADCAST_JOIN_THRESHOLD
 };
 
 enum RepartAlgorithm
@@ -81,7 +81,7 @@ const int    DEFAULT_STRING_SIZE_ESTIMATION = 10;
  * the moment.
  * @see SystemCatalog::connect(const string&, bool)
  */
-const int    METADATA_VERSION               = 3;
+const int    METADATA_VERSION               = 5;
 
 /****************************************************************************/
 }
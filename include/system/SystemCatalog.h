@@ -659,6 +659,46 @@ public:
      */
     void removeLibrary(const std::string& libraryName);
 
+    /**
+     * Register a materialized view.
+     *
+     * @param[in] viewId the unversioned id of the array holding the view states
+     * @param[in] sourceId the unversioned id of the array the view aggregates
+     * @param[in] sourceVersionId the id of the source array version the view is computed from
+     * @param[in] definition the aggregate calls and grouping dimensions of the view
+     */
+    void addView(ArrayID viewId, ArrayID sourceId, ArrayID sourceVersionId,
+                 const std::string& definition);
+
+    /**
+     * Get info about a materialized view.
+     *
+     * @param[in] viewId the unversioned id of the array holding the view states
+     * @param[out] sourceId the unversioned id of the array the view aggregates
+     * @param[out] sourceVersionId the id of the source array version the view was last refreshed to
+     * @param[out] definition the aggregate calls and grouping dimensions of the view
+     * @return false if the array is not a registered view
+     */
+    bool getView(ArrayID viewId, ArrayID& sourceId, ArrayID& sourceVersionId,
+                 std::string& definition);
+
+    /**
+     * Record the source array version a materialized view was refreshed to.
+     *
+     * @param[in] viewId the unversioned id of the array holding the view states
+     * @param[in] sourceVersionId the id of the source array version
+     */
+    void updateView(ArrayID viewId, ArrayID sourceVersionId);
+
+    /**
+     * Find a materialized view aggregating an array.
+     *
+     * @param[in] sourceId the unversioned id of the source array
+     * @param[out] viewName the name of one of the views of the array
+     * @return false if no view aggregates the array
+     */
+    bool findView(ArrayID sourceId, std::string& viewName);
+
     /**
      * Returns version of loaded catalog metadata
      *
@@ -802,6 +842,8 @@ private:  // Methods
                       std::string& arrName,
                       int& arrPs,
                       int& arrFlags,
+                      int& arrPsDimension,
+                      int64_t& arrPsBlock,
                       pqxx::basic_transaction* tr);
     std::shared_ptr<ArrayDesc> _getArrayDesc(const ArrayID id);
     bool _deleteArrayByName(const std::string &array_name);
@@ -828,6 +870,12 @@ private:  // Methods
     void _addLibrary(const std::string& libraryName);
     void _getLibraries(std::vector< std::string >& libraries);
     void _removeLibrary(const std::string& libraryName);
+    void _addView(ArrayID viewId, ArrayID sourceId, ArrayID sourceVersionId,
+                  const std::string& definition);
+    bool _getView(ArrayID viewId, ArrayID& sourceId, ArrayID& sourceVersionId,
+                  std::string& definition);
+    void _updateView(ArrayID viewId, ArrayID sourceVersionId);
+    bool _findView(ArrayID sourceId, std::string& viewName);
     void _getCurrentVersion(QueryLocks& locks);
 
 private:  // Variables
@@ -0,0 +1,49 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/*
+ * CRC32C.h
+ *
+ * CRC-32C (Castagnoli) checksum of memory buffers
+ */
+
+#ifndef CRC32C_H_
+#define CRC32C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace scidb
+{
+    /**
+     * Compute the CRC-32C (Castagnoli) checksum of a buffer, using the SSE4.2
+     * crc32 instruction when the processor has it.
+     * @param content data to checksum
+     * @param length number of bytes
+     * @param crc checksum of the preceding data when checksumming a buffer in
+     *        pieces, 0 for the first piece
+     * @return the checksum of the data seen so far
+     */
+    uint32_t calculateCRC32C(void const* content, size_t length, uint32_t crc = 0);
+}
+
+#endif /* CRC32C_H_ */
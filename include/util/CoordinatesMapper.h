@@ -25,7 +25,9 @@
 
 /****************************************************************************/
 
+#include <vector>
 #include <array/Coordinate.h>
+#include <util/FastDivisor.h>
 
 /****************************************************************************/
 namespace scidb {
@@ -35,6 +37,10 @@ class ConstChunk;
 
 /**
  *  Map coordinates to offset within chunk.
+ *
+ *  The conversions of chunks of up to four dimensions are compiled for their number of
+ *  dimensions, and picked once, when the mapper is constructed. They divide by the chunk
+ *  intervals with FastDivisors rather than with integer divisions.
  */
 class CoordinatesMapper
 {
@@ -43,10 +49,18 @@ protected:
     uint64_t    _logicalChunkSize;
     Coordinates _origin;
     Coordinates _chunkIntervals;
+    std::vector<FastDivisor> _divisors;           // Of _chunkIntervals
+
+    void       (CoordinatesMapper::*_pos2coord)(position_t,Coordinate*) const;
+    position_t (CoordinatesMapper::*_coord2pos)(Coordinate const*) const;
 
     // Internal init function that is shared by the constructors.
     void init(CoordinateCRange,CoordinateCRange);
 
+    // The conversions for a number of dimensions known at compile time, or any number if 0.
+    template<size_t N> void       pos2coordFixed(position_t,Coordinate*) const;
+    template<size_t N> position_t coord2posFixed(Coordinate const*) const;
+
 public:
     /**
      *  Construct a mapper from the first and last positions within a chunk.
@@ -85,22 +99,9 @@ public:
     {
         assert(pos >= 0);
         assert(coord.size() == _nDims);
+        assert(static_cast<uint64_t>(pos) < _logicalChunkSize);
 
-        if (_nDims == 1) {
-            coord[0] = _origin[0] + pos;
-            assert(pos < _chunkIntervals[0]);
-        } else if (_nDims == 2) {
-            coord[1] = _origin[1] + (pos % _chunkIntervals[1]);
-            pos /= _chunkIntervals[1];
-            coord[0] = _origin[0] + pos;
-            assert(pos < _chunkIntervals[0]);
-        } else {
-            for (int i=_nDims; --i>=0;) {
-                coord[i] = _origin[i] + (pos % _chunkIntervals[i]);
-                pos /= _chunkIntervals[i];
-            }
-            assert(pos == 0);
-        }
+        (this->*_pos2coord)(pos,coord.begin());
     }
 
     /**
@@ -109,24 +110,30 @@ public:
     position_t coord2pos(CoordinateCRange coord) const
     {
         assert(coord.size() == _nDims);
-        position_t pos(-1);
-
-        if (_nDims == 1) {
-            pos = coord[0] - _origin[0];
-            assert(pos < _chunkIntervals[0]);
-        } else if (_nDims == 2) {
-            pos = (coord[0] - _origin[0])*_chunkIntervals[1] + (coord[1] - _origin[1]);
-        } else {
-            pos = 0;
-            for (size_t i = 0, n = _nDims; i < n; i++) {
-                pos *= _chunkIntervals[i];
-                pos += coord[i] - _origin[i];
-            }
-        }
+
+        position_t pos = (this->*_coord2pos)(coord.begin());
         assert(pos >= 0 && static_cast<uint64_t>(pos)<_logicalChunkSize);
         return pos;
     }
 
+    /**
+     *  Move array coordinates to the next cell in row-major order, without any division:
+     *  the same as pos2coord(coord2pos(coord) + 1, coord), for iterators stepping through
+     *  the cells of a chunk.
+     */
+    void advance(CoordinateRange coord) const
+    {
+        assert(coord.size() == _nDims);
+
+        for (size_t i = _nDims; --i > 0; ) {
+            if (++coord[i] < _origin[i] + _chunkIntervals[i]) {
+                return;
+            }
+            coord[i] = _origin[i];
+        }
+        ++coord[0];
+    }
+
     /**
      *  Return the number of dimensions used by the mapper.
      *
@@ -148,6 +155,30 @@ public:
     }
 };
 
+template<size_t N>
+inline void CoordinatesMapper::pos2coordFixed(position_t pos,Coordinate* coord) const
+{
+    uint64_t p = pos;
+
+    for (size_t i = (N == 0 ? _nDims : N); --i > 0; ) {
+        uint64_t const q = _divisors[i].divide(p);
+        coord[i] = _origin[i] + static_cast<Coordinate>(p - q * _chunkIntervals[i]);
+        p = q;
+    }
+    coord[0] = _origin[0] + static_cast<Coordinate>(p);
+}
+
+template<size_t N>
+inline position_t CoordinatesMapper::coord2posFixed(Coordinate const* coord) const
+{
+    position_t pos = coord[0] - _origin[0];
+
+    for (size_t i = 1, n = (N == 0 ? _nDims : N); i < n; ++i) {
+        pos = pos * _chunkIntervals[i] + (coord[i] - _origin[i]);
+    }
+    return pos;
+}
+
 /****************************************************************************/
 }
 /****************************************************************************/
@@ -57,6 +57,8 @@ namespace scidb
             MemArrayChunkWrite = 0,
             MemArrayChunkRead,
             MemArrayCleanSwap,
+            SGLocalChunkBytes,
+            SGRemoteChunkBytes,
             LastCounter             // This entry must be last!
         };
 
@@ -86,6 +88,16 @@ namespace scidb
                 _entries.insert(_entries.begin(), LastCounter, e);
             }
 
+        /**
+         * Add an amount (e.g. of bytes) to a counter which is not a timer,
+         * in any build mode
+         */
+        void add(const CounterId id, uint64_t n)
+            {
+                ScopedMutexLock sm(_stateMutex);
+                _entries[id]._num += n;
+            }
+
         /**
          * List all stats to the builder
          */
@@ -111,6 +123,8 @@ namespace scidb
                 _names[MemArrayChunkWrite] = "MemArrayChunkWrite";
                 _names[MemArrayChunkRead] = "MemArrayChunkRead";
                 _names[MemArrayCleanSwap] = "MemArrayCleanSwap";
+                _names[SGLocalChunkBytes] = "SGLocalChunkBytes";
+                _names[SGRemoteChunkBytes] = "SGRemoteChunkBytes";
             }
 
     private:
@@ -34,6 +34,7 @@
 #include <dirent.h>
 #include <map>
 #include <set>
+#include <vector>
 #include <util/FileIO.h>
 #include <util/Mutex.h>
 #include <boost/function.hpp>
@@ -44,6 +45,7 @@ namespace scidb
 
 class DataStores;
 class DataStoreFlusher;
+class DataStoreMigrator;
 class ListDataStoresArrayBuilder;
 
 /**
@@ -72,6 +74,19 @@ public:
      */
     off_t allocateSpace(size_t requestedSize, size_t& allocatedSize);
 
+    /**
+     * Find space for several chunks written together by one writer.
+     * The chunks are laid out one after the other, in the order of
+     * the request, within a single extent of the file.
+     * @param requestedSizes minimum required size of each chunk
+     * @param offsets Out param location of each chunk
+     * @param allocatedSizes Out param actual allocated size of each chunk
+     * @throws SystemException on error
+     */
+    void allocateSpace(std::vector<size_t> const& requestedSizes,
+                       std::vector<off_t>& offsets,
+                       std::vector<size_t>& allocatedSizes);
+
     /**
      * Write bytes to the DataStore, to a location that is already
      * allocated
@@ -86,14 +101,43 @@ public:
                    size_t len,
                    size_t allocatedSize);
 
+    /**
+     * Write several chunks to the DataStore, to locations that are
+     * already allocated.  Chunks allocated back to back (see the bulk
+     * allocateSpace()) are written with a single gather write.
+     * @param offsets Locations to write, in increasing order
+     * @param buffers Data to write
+     * @param lens Number of bytes to write for each chunk
+     * @param allocatedSizes Size of allocated region of each chunk
+     * @throws SystemException on error
+     */
+    void writeData(std::vector<off_t> const& offsets,
+                   std::vector<void const*> const& buffers,
+                   std::vector<size_t> const& lens,
+                   std::vector<size_t> const& allocatedSizes);
+
     /**
      * Read a chunk from the DataStore
      * @param off Location of chunk to read
      * @param buffer Place to put data read
      * @param len Size of chunk to read
+     * @param countAccess false for maintenance reads (e.g. scrubbing), which
+     *        must not count towards the tier placement of the datastore
      * @throws SystemException on error
      */
-    void readData(off_t off, void* buffer, size_t len);
+    void readData(off_t off, void* buffer, size_t len, bool countAccess = true);
+
+    /**
+     * Map a chunk of the DataStore into memory instead of reading it
+     * @param off Location of chunk to map
+     * @param len Size of chunk to map
+     * @param advice madvise() hint for the access pattern
+     * @param mapping Out param start of the mapping, to release with ::munmap()
+     * @param mappedLen Out param length of the mapping
+     * @return address of the chunk data within the mapping
+     * @throws SystemException on error
+     */
+    void* mapData(off_t off, size_t len, int advice, void*& mapping, size_t& mappedLen);
 
     /**
      * Flush dirty data and metadata for the DataStore
@@ -126,6 +170,12 @@ public:
     Guid getGuid() const
         { return _guid; }
 
+    /**
+     * Return the storage tier holding the data store, 0 being the fastest
+     */
+    size_t getTier() const
+        { ScopedMutexLock sm(_dslock); return _tier; }
+
     /**
      * Destroy a DataStore object
      */
@@ -133,8 +183,9 @@ public:
 
     /**
      * Construct a new DataStore object
+     * @param tier index of the storage root holding filename
      */
-    DataStore(char const* filename, Guid guid, DataStores& parent);
+    DataStore(char const* filename, Guid guid, DataStores& parent, size_t tier = 0);
 
     /**
      * Accsessor: return the guid
@@ -155,6 +206,17 @@ public:
      */
     void verifyFreelist();
 
+    /**
+     * Copy the data store to the storage root of another tier and switch to the
+     * copy.  The copy is made without blocking readers and writers and is
+     * discarded if the data store changes or is removed meanwhile.
+     * @param tier index of the target storage root
+     * @param filename path of the data file in the target storage root
+     * @returns true if the data store has moved
+     * @throws SystemException on error
+     */
+    bool migrate(size_t tier, std::string const& filename);
+
 private:
     friend class DataStores;
 
@@ -184,14 +246,23 @@ private:
     void invalidateFreelistFile();
 
     /* Remove the free-list file from disk
-       @pre caller has locked the DataStore
      */
     void removeFreelistFile();
 
-    /* Set the data store to be removed from disk on close
+    /* Set the data store to be removed from disk on close.  A migration
+       in progress discards its copy instead of publishing it.
      */
-    void removeOnClose()
-        { _file->removeOnClose(); }
+    void removeOnClose();
+
+    /* Count a read or write for the tier placement policy
+       @pre caller has locked the DataStore
+     */
+    void noteAccess();
+
+    /* Return the number of accesses since the previous call and the
+       number of seconds since the last access
+     */
+    void takeAccessStats(uint64_t& accesses, time_t& idleSeconds);
 
     /* Iterate the free lists and find a free chunk of the requested size
        @pre caller has locked the DataStore
@@ -202,6 +273,12 @@ private:
      */
     void addToFreelist(size_t bucket, off_t off);
 
+    /* Add the unused range [from, to) of the file to the free lists,
+       split into aligned power-of-two blocks
+       @pre caller has locked the DataStore
+     */
+    void addRangeToFreelist(off_t from, off_t to);
+
     /* Verify the freelist, but with lock already held
      */
     void verifyFreelistInternal();
@@ -291,6 +368,11 @@ private:
     size_t                     _allocatedSize;    // size of the store including free blks
     bool                       _dirty;            // unflushed data is present
     bool                       _fldirty;          // fl data differs from fl data on-disk
+    size_t                     _tier;             // storage tier holding the data file
+    uint64_t                   _changes;          // counter of data and free list updates
+    bool                       _removed;          // removed from disk on close
+    uint64_t                   _accesses;         // reads and writes since the last placement pass
+    time_t                     _lastAccess;       // time of the last read or write
 };
 
 
@@ -348,6 +430,63 @@ public:
 };
 
 
+/**
+ * @brief   Periodically moves datastores between storage tiers
+ *
+ * @details Runs a separate thread that wakes up at a configured interval
+ *          and applies the tier placement policy of DataStores: datastores
+ *          idle for storage-tier-cold-seconds move one tier down, those
+ *          accessed storage-tier-hot-accesses times during an interval
+ *          move back to the fastest tier.
+ */
+class DataStoreMigrator
+{
+private:
+    DataStores&_dsm;
+    std::shared_ptr<JobQueue> _queue;
+    std::shared_ptr<ThreadPool> _threadPool;
+    bool _running;
+    Mutex _lock;
+
+    class MigrateJob : public Job
+    {
+    private:
+        int _timeIntervalSecs;
+        DataStoreMigrator *_migrator;
+
+    public:
+        MigrateJob(int timeIntervalSecs,
+                   DataStoreMigrator* migrator):
+            Job(std::shared_ptr<Query>()),
+            _timeIntervalSecs(timeIntervalSecs),
+            _migrator(migrator)
+            {}
+
+        virtual void run();
+    };
+
+    std::shared_ptr<MigrateJob> _myJob;
+
+    bool isRunning()
+        { ScopedMutexLock cs(_lock); return _running; }
+
+public:
+    DataStoreMigrator(DataStores& dsm):
+        _dsm(dsm),
+        _queue(std::shared_ptr<JobQueue>(new JobQueue())),
+        _threadPool(std::shared_ptr<ThreadPool>(new ThreadPool(1, _queue))),
+        _running(false),
+        _lock(),
+        _myJob()
+        {}
+
+    void start(int timeIntervalSecs);
+    void stop();
+
+    ~DataStoreMigrator();
+};
+
+
 /**
  * @brief   Class which manages group of datastores
  *
@@ -356,6 +495,12 @@ public:
  *          located at a common root in the file system.
  *          Callers obtain/close a DataStore by going through
  *          the DataStores interface.
+ *
+ *          Additional storage roots may be configured with
+ *          storage-tiers, from the fastest to the slowest device.
+ *          New datastores are created on the fastest tier (the
+ *          common root) and DataStoreMigrator moves them between
+ *          tiers according to their access frequency.
  */
 class DataStores
 {
@@ -367,8 +512,9 @@ public:
     /**
      * Initialize the global DataStore state
      * @param basepath path to the root of the storage heirarchy
+     * @param tiers comma separated storage roots of the slower tiers
      */
-    void initDataStores(char const* basepath);
+    void initDataStores(char const* basepath, std::string const& tiers = std::string());
 
     /**
      * Get a reference to a specific DataStore
@@ -398,6 +544,21 @@ public:
      */
     void visitDataStores(const Visitor&) const;
 
+    /**
+     * Move the datastores between storage tiers according to their use
+     * since the previous call.  Datastores not opened since startup
+     * move down when their files have not been modified for
+     * storage-tier-cold-seconds.
+     * @throws SystemException on error
+     */
+    void migrateDataStores();
+
+    /**
+     * Return the number of storage tiers
+     */
+    size_t getTierCount() const
+        { return _tierPaths.size(); }
+
     /**
      * Accessor, return the min allocation size
      */
@@ -423,7 +584,9 @@ public:
         _theDataStores(NULL),
         _basePath(""),
         _minAllocSize(0),
-        _dsflusher(*this)
+        _initTime(0),
+        _dsflusher(*this),
+        _dsmigrator(*this)
         {}
 
     /**
@@ -435,6 +598,21 @@ private:
 
     typedef std::map< DataStore::Guid, std::shared_ptr<DataStore> > DataStoreMap;
 
+    /* Return the path of the data file of a data store and the tier holding
+       it.  If copies were left in several tiers by an interrupted migration
+       the most recently modified one is kept and the others are removed.
+       A new data store is placed in tier 0.
+     */
+    std::string findDataStoreFile(DataStore::Guid guid, size_t& tier);
+
+    /* Return the path of the data file of a data store in the given tier
+     */
+    std::string getDataStorePath(DataStore::Guid guid, size_t tier) const;
+
+    /* Clear all datastore files from one storage root
+     */
+    void clearDataStoreDir(std::string const& basePath);
+
     /* Global map of all DataStores
      */
     DataStoreMap*   _theDataStores;
@@ -442,6 +620,8 @@ private:
 
     std::string _basePath;        // base path of data directory
     size_t      _minAllocSize;    // smallest allowed allocation
+    std::vector<std::string> _tierPaths; // storage roots from fastest to slowest, [0] is _basePath
+    time_t      _initTime;        // when initDataStores() ran
 
     /* Error listener for invalidate path
      */
@@ -450,6 +630,10 @@ private:
     /* Optional data store flusher
      */
     DataStoreFlusher _dsflusher;
+
+    /* Tier placement, running when several tiers are configured
+     */
+    DataStoreMigrator _dsmigrator;
 };
 
 inline static uint32_t calculateCRC32(void const* content, size_t content_length, uint32_t crc = ~0)
@@ -0,0 +1,103 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file FastDivisor.h
+ *
+ * @brief Division of unsigned 64-bit integers by a divisor known ahead of time.
+ */
+
+#ifndef FAST_DIVISOR_H_
+#define FAST_DIVISOR_H_
+
+#include <assert.h>
+#include <stdint.h>
+
+namespace scidb
+{
+
+/**
+ * An unsigned 64-bit divisor, with the multiplier and shift that replace a division by
+ * it with a multiplication and shifts (T. Granlund, P. Montgomery, "Division by Invariant
+ * Integers using Multiplication", 1994). Worth it where one divisor divides many numbers,
+ * as the chunk intervals do the positions of the cells of a chunk.
+ */
+class FastDivisor
+{
+public:
+    FastDivisor() : _divisor(1), _magic(0), _shift(0), _add(false) {}
+
+    explicit FastDivisor(uint64_t divisor) : _divisor(divisor), _magic(0), _shift(0), _add(false)
+    {
+        assert(divisor > 0);
+        uint32_t const log2 = 63 - __builtin_clzll(divisor);
+        _shift = log2;
+        if ((divisor & (divisor - 1)) == 0) {
+            return;                                       // a power of 2: shift alone
+        }
+
+        // m = floor(2^(64 + log2) / divisor), which does not fit in 64 bits for the rounding below
+        __uint128_t const numerator = static_cast<__uint128_t>(1) << (64 + log2);
+        uint64_t m = static_cast<uint64_t>(numerator / divisor);
+        uint64_t const rem = static_cast<uint64_t>(numerator % divisor);
+        if (divisor - rem < (static_cast<uint64_t>(1) << log2)) {
+            _magic = m + 1;                               // m + 1 is exact to 64 bits
+        } else {
+            // one more bit of precision, the top one of which divide() adds back
+            m += m;
+            uint64_t const twiceRem = rem + rem;
+            if (twiceRem >= divisor || twiceRem < rem) {
+                m += 1;
+            }
+            _magic = m + 1;
+            _add = true;
+        }
+    }
+
+    uint64_t getDivisor() const
+    {
+        return _divisor;
+    }
+
+    /// @return n / getDivisor()
+    uint64_t divide(uint64_t n) const
+    {
+        if (_magic == 0) {
+            return n >> _shift;
+        }
+        uint64_t const q = static_cast<uint64_t>((static_cast<__uint128_t>(_magic) * n) >> 64);
+        if (_add) {
+            return (((n - q) >> 1) + q) >> _shift;
+        }
+        return q >> _shift;
+    }
+
+private:
+    uint64_t _divisor;
+    uint64_t _magic;
+    uint32_t _shift;
+    bool     _add;
+};
+
+} // namespace scidb
+
+#endif /* FAST_DIVISOR_H_ */
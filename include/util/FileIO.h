@@ -145,6 +145,13 @@ namespace scidb
          */
         static int closeFd(int fd);
 
+        /**
+         * Fsync a directory so that the entries created or renamed in it are durable
+         * @return 0 on success, or -1 otherwise
+         * @param dirPath directory path
+         */
+        static int syncDir(const std::string& dirPath);
+
         /**
          * Open a file (restarting after signal interrupt if necessary)
          * @return fd or -1
@@ -229,6 +236,16 @@ namespace scidb
          */
         int fdatasync();
 
+        /**
+         * Map a region of the file into memory.  The mapping is private
+         * (copy-on-write) and stays valid after the file is closed.
+         * @param size bytes to map
+         * @param offs page aligned file offset of the region
+         * @return address of the mapping, to be released with ::munmap()
+         * @throws SystemException if the underlying system call fails
+         */
+        void* mmap(size_t size, uint64_t offs);
+
         /**
          * ftruncate a file (restarting after signal interrupt in necessary)
          * @param len requested len of file
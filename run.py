@@ -832,6 +832,18 @@ def runTests(scidbEnv, testsPath, srcTestsPath, commands=[]):
     for cmd in commands:
        cmdList.extend([cmd,";"])
     #.........................................................................
+    # Set run-time options of the cluster before running the tests; they stay
+    # in effect until the instances are restarted.
+    #.........................................................................
+    for opt in (getattr(scidbEnv.args, 'setopt', None) or []):
+        if '=' not in opt:
+            raise RuntimeError('Bad --setopt option, expected NAME=VALUE: ' + opt)
+        optName,optValue = opt.split('=',1)
+        cmdList.extend([os.path.join(binPath,"iquery"),
+                        "--host", "${IQUERY_HOST}",
+                        "--port", "${IQUERY_PORT}",
+                        "-naq", "\"setopt('%s','%s')\""%(optName,optValue), ";"])
+    #.........................................................................
     # Determine test root directory:
     testRootDir = srcTestsPath
     scratchDir = os.path.join(testsPath,'testcases')
@@ -1203,6 +1215,8 @@ SCIDB_NAME - the name of the SciDB database to be tested, default = mydb"""+
     subParser.add_argument('--disabled-tests', default='', help="path to the custom disable.tests file (will be used in place of the default one).")
     subParser.add_argument('--user-name', default='', help="specify the user-name (should also specify passowrd)")
     subParser.add_argument('--user-password', default='', help="specify the user password")
+    subParser.add_argument('--setopt', action='append', metavar='NAME=VALUE', help=
+                           "set a run-time option of the cluster (see setopt()) before running the tests, e.g. --setopt exchange-workers=4; may be repeated")
     subParser.set_defaults(func=tests)
 
 
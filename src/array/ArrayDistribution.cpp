@@ -75,6 +75,23 @@ static uint64_t getHashedChunkNumber(scidb::Dimensions const& dims, scidb::Coord
     return no;
 }
 
+/**
+ * The number of the block of consecutive chunks a chunk falls into along one dimension.
+ * Chunks are numbered from coordinate 0 rather than from the start of the dimension,
+ * so that arrays with different origins or extents place their matching chunks alike.
+ *
+ * @param dim the dimension chunks are placed by
+ * @param pos the coordinate of the chunk along dim
+ * @param block the number of consecutive chunks in a block
+ */
+static int64_t getChunkBlockNumber(scidb::DimensionDesc const& dim, scidb::Coordinate pos, uint64_t block)
+{
+    const int64_t interval = dim.getChunkInterval();
+    const int64_t chunkNo = pos >= 0 ? pos / interval : -((interval - 1 - pos) / interval);
+    const int64_t blockSize = static_cast<int64_t>(block);
+    return chunkNo >= 0 ? chunkNo / blockSize : -((blockSize - 1 - chunkNo) / blockSize);
+}
+
 namespace scidb {
 
  /**
@@ -85,7 +102,8 @@ namespace scidb {
  */
 
 InstanceID getPrimaryInstanceForChunk(PartitioningSchema ps, Coordinates const& chunkPosition,
-                                      Dimensions const& dims, size_t nInstancesOriginal)
+                                      Dimensions const& dims, size_t nInstancesOriginal,
+                                      size_t psDimension, uint64_t psBlock)
 {
     const size_t instanceCount = nInstancesOriginal;   // to make meld diff well. remove after first check-in
 
@@ -127,6 +145,17 @@ InstanceID getPrimaryInstanceForChunk(PartitioningSchema ps, Coordinates const&
         }
         break;
     }
+    case psRangePartitioned:
+    case psCoPartitioned:
+    {
+        // blocks of consecutive chunks along one dimension go round the instances:
+        // one block per instance for psRangePartitioned, one chunk per block for psCoPartitioned
+        ASSERT_EXCEPTION(psDimension < dims.size(), "getPrimaryInstanceForChunk: bad partitioning dimension");
+        const int64_t blockNo = getChunkBlockNumber(dims[psDimension], chunkPosition[psDimension], psBlock);
+        const int64_t nInstances = static_cast<int64_t>(instanceCount);
+        destInstanceId = ((blockNo % nInstances) + nInstances) % nInstances;
+        break;
+    }
     //
     // Non-persistable cases.
     // These are not mappable to instanceIds given the currently persisted array information.
@@ -165,4 +194,13 @@ InstanceID getPrimaryInstanceForChunk(PartitioningSchema ps, Coordinates const&
 
     return destInstanceId;
 }
+
+std::shared_ptr<PartitioningSchemaData> getPartitioningSchemaData(ArrayDesc const& desc)
+{
+    const PartitioningSchema ps = desc.getPartitioningSchema();
+    if (ps == psRangePartitioned || ps == psCoPartitioned) {
+        return std::make_shared<PartitioningSchemaDataForDimension>(desc);
+    }
+    return std::shared_ptr<PartitioningSchemaData>();
+}
 } // namespace scidb
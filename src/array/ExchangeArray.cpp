@@ -0,0 +1,406 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file ExchangeArray.cpp
+ */
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <log4cxx/logger.h>
+
+#include "array/ExchangeArray.h"
+#include "array/MemChunk.h"
+#include "query/Operator.h"
+#include "query/Statistics.h"
+#include "system/Exceptions.h"
+#include "util/Atomic.h"
+#include "util/Job.h"
+#include "util/Semaphore.h"
+
+namespace scidb
+{
+    using namespace std;
+
+    static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("scidb.array.exchange"));
+
+    /**
+     * One chunk position in flight: the input iterator used to evaluate it and the result.
+     * The consumer dispatches a slot and takes it back; in between, the first thread to
+     * claim the slot (a pool thread or the consumer itself) evaluates the position.
+     */
+    class ExchangeArray::ChunkSlot : public SelfStatistics
+    {
+    public:
+        enum State
+        {
+            IDLE,
+            QUEUED,
+            RUNNING,
+            DONE
+        };
+
+        ChunkSlot(ExchangeArray const& array, AttributeID attId)
+        : _array(array),
+          _iterator(array._input->getConstIterator(attId)),
+          _attId(attId),
+          _result(NULL),
+          _state(IDLE)
+        {}
+
+        void dispatch(Coordinates const& pos)
+        {
+            _pos = pos;
+            _result = NULL;
+            _error.reset();
+            _state = QUEUED;
+        }
+
+        /// @return true if the caller is the one to evaluate the dispatched position
+        bool claim()
+        {
+            return _state.testAndSet(QUEUED, RUNNING);
+        }
+
+        bool isDone() const
+        {
+            return _state == DONE;
+        }
+
+        void release()
+        {
+            _state = IDLE;
+        }
+
+        Coordinates const& getPosition() const
+        {
+            return _pos;
+        }
+
+        ConstChunk const& getResult() const
+        {
+            if (_error) {
+                _error->raise();
+            }
+            if (!_result) {
+                throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_CURRENT_CHUNK);
+            }
+            return *_result;
+        }
+
+        /// Drop the input iterator before the input array goes away
+        void cleanup()
+        {
+            _result = NULL;
+            _iterator.reset();
+        }
+
+        /// Pull the claimed position through the input pipeline
+        void evaluate()
+        {
+            StatisticsScope sScope(_statistics);
+            try {
+                std::shared_ptr<Query> query(Query::getValidQueryPtr(_array._query));
+                if (!_iterator->setPosition(_pos)) {
+                    throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+                }
+                ConstChunk const& inputChunk = _iterator->getChunk();
+                if (inputChunk.isMaterialized()) {
+                    _result = &inputChunk;
+                } else {
+                    ArrayDesc const& desc = _array.getArrayDesc();
+                    Address addr(_attId, inputChunk.getFirstPosition(false));
+                    _chunk.initialize(&_array, &desc, addr, inputChunk.getCompressionMethod());
+                    _chunk.setBitmapChunk((Chunk*)&inputChunk);
+                    std::shared_ptr<ConstChunkIterator> src =
+                        inputChunk.getConstIterator(ChunkIterator::INTENDED_TILE_MODE |
+                                                    ChunkIterator::IGNORE_EMPTY_CELLS);
+                    std::shared_ptr<ChunkIterator> dst =
+                        _chunk.getIterator(query,
+                                           (src->getMode() & ChunkIterator::TILE_MODE) |
+                                           ChunkIterator::NO_EMPTY_CHECK |
+                                           ChunkIterator::SEQUENTIAL_WRITE);
+                    size_t count = 0;
+                    while (!src->end()) {
+                        if (dst->setPosition(src->getPosition())) {
+                            dst->writeItem(src->getItem());
+                            count += 1;
+                        }
+                        ++(*src);
+                    }
+                    if (!desc.hasOverlap()) {
+                        _chunk.setCount(count);
+                    }
+                    dst->flush();
+                    _result = &_chunk;
+                }
+            } catch (Exception const& x) {
+                _error = x.copy();
+            } catch (std::exception const& e) {
+                _error = SYSTEM_EXCEPTION_SPTR(SCIDB_SE_EXECUTION, SCIDB_LE_UNKNOWN_ERROR) << e.what();
+            }
+            _state = DONE;
+        }
+
+    private:
+        ExchangeArray const& _array;
+        std::shared_ptr<ConstArrayIterator> _iterator;
+        AttributeID _attId;
+        Coordinates _pos;
+        MemChunk _chunk;
+        ConstChunk const* _result;
+        std::shared_ptr<Exception> _error;
+        Atomic<int> _state;
+    };
+
+    /**
+     * A request to a pool thread to evaluate a slot. It does nothing if the slot
+     * has been claimed meanwhile, so that a job is never reused.
+     */
+    class ExchangeArray::ChunkJob : public Job
+    {
+    public:
+        ChunkJob(std::shared_ptr<ChunkSlot> const& slot,
+                 std::shared_ptr<Semaphore> const& progress,
+                 std::shared_ptr<Query> const& query)
+        : Job(query),
+          _slot(slot),
+          _progress(progress)
+        {}
+
+    protected:
+        virtual void run()
+        {
+            if (_slot->claim()) {
+                _slot->evaluate();
+                _progress->release();
+            }
+        }
+
+    private:
+        std::shared_ptr<ChunkSlot> _slot;
+        std::shared_ptr<Semaphore> _progress;
+    };
+
+    class ExchangeArray::ExchangeArrayIterator : public ConstArrayIterator
+    {
+    public:
+        ExchangeArrayIterator(ExchangeArray const& array, AttributeID attId)
+        : _array(array),
+          _positions(array._input->getConstIterator(attId)),
+          _progress(std::make_shared<Semaphore>())
+        {
+            _idle.reserve(array._nWorkers);
+            for (size_t i = 0; i < array._nWorkers; ++i) {
+                _idle.push_back(std::make_shared<ChunkSlot>(array, attId));
+            }
+            fill();
+            next();
+        }
+
+        ~ExchangeArrayIterator()
+        {
+            try {
+                drain();
+            } catch (std::exception const& e) {
+                LOG4CXX_ERROR(logger, "ExchangeArrayIterator::~ExchangeArrayIterator: " << e.what());
+            }
+            // The jobs still queued find their slots idle and do nothing
+            for (size_t i = 0; i < _idle.size(); ++i) {
+                _idle[i]->cleanup();
+            }
+        }
+
+        virtual bool end()
+        {
+            return !_current;
+        }
+
+        virtual void operator ++()
+        {
+            if (!_current) {
+                throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_CURRENT_ELEMENT);
+            }
+            next();
+        }
+
+        virtual Coordinates const& getPosition()
+        {
+            if (!_current) {
+                throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_CURRENT_ELEMENT);
+            }
+            return _current->getPosition();
+        }
+
+        virtual ConstChunk const& getChunk()
+        {
+            if (!_current) {
+                throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_CURRENT_CHUNK);
+            }
+            return _current->getResult();
+        }
+
+        virtual bool setPosition(Coordinates const& pos)
+        {
+            drain();
+            if (!_positions->setPosition(pos)) {
+                return false;
+            }
+            // Evaluate the requested chunk and prefetch the ones following it
+            std::shared_ptr<ChunkSlot> slot = dispatch();
+            fill();
+            wait(slot);
+            _current = slot;
+            return true;
+        }
+
+        virtual void reset()
+        {
+            drain();
+            _positions->reset();
+            fill();
+            next();
+        }
+
+    private:
+        /// Dispatch the next position of the input to an idle slot
+        std::shared_ptr<ChunkSlot> dispatch()
+        {
+            SCIDB_ASSERT(!_idle.empty() && !_positions->end());
+            std::shared_ptr<ChunkSlot> slot = _idle.back();
+            _idle.pop_back();
+            slot->dispatch(_positions->getPosition());
+            ++(*_positions);
+
+            std::shared_ptr<Query> query(Query::getValidQueryPtr(_array._query));
+            std::shared_ptr<Job> job(std::make_shared<ChunkJob>(slot, _progress, query));
+            PhysicalOperator::getGlobalQueueForOperators()->pushJob(job);
+            _active.push_back(slot);
+            return slot;
+        }
+
+        void fill()
+        {
+            while (!_idle.empty() && !_positions->end()) {
+                dispatch();
+            }
+        }
+
+        /// Wait for a slot, evaluating it here if no pool thread has started it
+        void wait(std::shared_ptr<ChunkSlot> const& slot)
+        {
+            if (slot->claim()) {
+                slot->evaluate();
+            }
+            while (!slot->isDone()) {
+                _progress->enter();
+            }
+            std::deque<std::shared_ptr<ChunkSlot> >::iterator i = std::find(_active.begin(), _active.end(), slot);
+            SCIDB_ASSERT(i != _active.end());
+            _active.erase(i);
+        }
+
+        /// Make the next chunk current
+        void next()
+        {
+            if (_current) {
+                _current->release();
+                _idle.push_back(_current);
+                _current.reset();
+            }
+            fill();
+            if (_active.empty()) {
+                return;
+            }
+            std::shared_ptr<ChunkSlot> slot;
+            if (_array._ordered) {
+                slot = _active.front();
+            } else {
+                while (!slot) {
+                    for (size_t i = 0; i < _active.size() && !slot; ++i) {
+                        if (_active[i]->isDone()) {
+                            slot = _active[i];
+                        }
+                    }
+                    for (size_t i = 0; i < _active.size() && !slot; ++i) {
+                        if (_active[i]->claim()) {
+                            _active[i]->evaluate();
+                            slot = _active[i];
+                        }
+                    }
+                    if (!slot) {
+                        _progress->enter();
+                    }
+                }
+            }
+            wait(slot);
+            _current = slot;
+        }
+
+        /// Take back all the slots
+        void drain()
+        {
+            if (_current) {
+                _current->release();
+                _idle.push_back(_current);
+                _current.reset();
+            }
+            while (!_active.empty()) {
+                std::shared_ptr<ChunkSlot> slot = _active.front();
+                _active.pop_front();
+                if (!slot->claim()) {
+                    while (!slot->isDone()) {
+                        _progress->enter();
+                    }
+                }
+                slot->release();
+                _idle.push_back(slot);
+            }
+        }
+
+        ExchangeArray const& _array;
+        std::shared_ptr<ConstArrayIterator> _positions;
+        std::shared_ptr<Semaphore> _progress;
+        std::vector<std::shared_ptr<ChunkSlot> > _idle;
+        std::deque<std::shared_ptr<ChunkSlot> > _active;
+        std::shared_ptr<ChunkSlot> _current;
+    };
+
+    ExchangeArray::ExchangeArray(std::shared_ptr<Array> const& input,
+                                 size_t nWorkers,
+                                 bool ordered,
+                                 std::shared_ptr<Query> const& query)
+    : _input(input),
+      _nWorkers(std::max<size_t>(nWorkers, 1)),
+      _ordered(ordered),
+      _query(query)
+    {
+        SCIDB_ASSERT(input->getSupportedAccess() == Array::RANDOM);
+    }
+
+    std::shared_ptr<ConstArrayIterator> ExchangeArray::getConstIterator(AttributeID attId) const
+    {
+        return std::make_shared<ExchangeArrayIterator>(*this, attId);
+    }
+}
@@ -350,6 +350,14 @@ namespace scidb
         reallocate(buf->getSize());
         memcpy(getData(), buf->getConstData(), buf->getSize());
     }
+    void MemChunk::swapData(MemChunk& other)
+    {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        dirty = true;
+        other.dirty = true;
+    }
+
     void MemChunk::decompress(CompressedBuffer const& buf)
     {
         allocate(buf.getDecompressedSize());
@@ -474,7 +482,16 @@ namespace scidb
         if (!hasCurrent) {
             throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_CURRENT_ELEMENT);
         }
-        pos2coord((mode & TILE_MODE) ? tilePos : emptyBitmapIterator.getLPos(), currPos);
+        position_t const pos = (mode & TILE_MODE) ? tilePos : emptyBitmapIterator.getLPos();
+        if (pos != currPosLPos) {
+            // iterating over consecutive cells, step to the next one without any division
+            if (currPosLPos >= 0 && pos == currPosLPos + 1) {
+                advance(currPos);
+            } else {
+                pos2coord(pos, currPos);
+            }
+            currPosLPos = pos;
+        }
         return currPos;
     }
 
@@ -543,6 +560,7 @@ namespace scidb
       hasCurrent(false),
       mode(iterationMode),
       currPos(array.getDimensions().size()),
+      currPosLPos(-1),
       typeId(attr.getType()),
       type(TypeLibrary::getType(typeId)),
       defaultValue(attr.getDefaultValue()),
@@ -1148,7 +1166,15 @@ void addToPayload(const position_t curPos,
         if (!_hasCurrent) {
             throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_CURRENT_ELEMENT);
         }
-        pos2coord(_emptyBitmapIterator.getLPos(), _currPos);
+        position_t const pos = _emptyBitmapIterator.getLPos();
+        if (pos != _currPosLPos) {
+            if (_currPosLPos >= 0 && pos == _currPosLPos + 1) {
+                advance(_currPos);
+            } else {
+                pos2coord(pos, _currPos);
+            }
+            _currPosLPos = pos;
+        }
         return _currPos;
     }
 
@@ -1222,6 +1248,7 @@ BaseTileChunkIterator::BaseTileChunkIterator(ArrayDesc const& desc,
   _hasCurrent(false),
   _mode(iterationMode),
   _currPos(_array.getDimensions().size()),
+  _currPosLPos(-1),
   _query(query)
 {
     if (_sDebug) {
@@ -238,7 +238,9 @@ ArrayDesc::ArrayDesc() :
     _versionId(0),
     _bitmapAttr(NULL),
     _flags(0),
-    _ps(psUninitialized)
+    _ps(psUninitialized),
+    _psDimension(0),
+    _psBlock(1)
 {}
 
 
@@ -254,7 +256,9 @@ ArrayDesc::ArrayDesc(const std::string &name,
     _attributes(attributes),
     _dimensions(dimensions),
     _flags(flags),
-    _ps(ps)
+    _ps(ps),
+    _psDimension(0),
+    _psBlock(1)
 {
     assert(isPermitted(ps)); // temporary restriction while scaffolding erected for #4546
 
@@ -276,7 +280,9 @@ ArrayDesc::ArrayDesc(ArrayID arrId, ArrayUAID uAId, VersionID vId,
     _attributes(attributes),
     _dimensions(dimensions),
     _flags(flags),
-    _ps(ps)
+    _ps(ps),
+    _psDimension(0),
+    _psBlock(1)
 {
     assert(isPermitted(ps)); // temporary restriction while scaffolding erected for #4546
 
@@ -297,7 +303,9 @@ ArrayDesc::ArrayDesc(ArrayDesc const& other) :
     _dimensions(other._dimensions),
     _bitmapAttr(other._bitmapAttr != NULL ? &_attributes[other._bitmapAttr->getId()] : NULL),
     _flags(other._flags),
-    _ps(other._ps) // TODO: this my be invoked with other._ps = psUninitialized
+    _ps(other._ps), // TODO: this my be invoked with other._ps = psUninitialized
+    _psDimension(other._psDimension),
+    _psBlock(other._psBlock)
 {
     initializeDimensions();
 }
@@ -307,6 +315,8 @@ bool ArrayDesc::operator==(ArrayDesc const& other) const
     return
         _name == other._name &&
         _ps == other._ps &&
+        _psDimension == other._psDimension &&
+        _psBlock == other._psBlock &&
         _attributes == other._attributes &&
         _dimensions == other._dimensions &&
         _flags == other._flags;
@@ -325,6 +335,8 @@ ArrayDesc& ArrayDesc::operator=(ArrayDesc const& other)
     _flags = other._flags;
     initializeDimensions();
     _ps = other._ps; // TODO: this does get invoked with other._ps = psUninitialized
+    _psDimension = other._psDimension;
+    _psBlock = other._psBlock;
     return *this;
 }
 
@@ -445,7 +457,8 @@ InstanceID ArrayDesc::getPrimaryInstanceId(Coordinates const& chunkPosition,
     // getDimensions() const, not getDimensions() [which has unacceptable malloc overhead]
     // next line it is getDimensions() const" that is called, otherwise this call would
     //
-    return getPrimaryInstanceForChunk(_ps, chunkPosition, getDimensions(), nInstances);
+    return getPrimaryInstanceForChunk(_ps, chunkPosition, getDimensions(), nInstances,
+                                      _psDimension, _psBlock);
 }
 
 ssize_t ArrayDesc::findDimension(const std::string& name, const std::string& alias) const
@@ -701,6 +714,8 @@ bool ArrayDesc::isPermitted(PartitioningSchema ps) const
     return (ps == psHashPartitioned ||
             ps == psByRow ||
             ps == psByCol ||
+            ps == psRangePartitioned ||
+            ps == psCoPartitioned ||
             ps == psReplication ||
             ps == psUndefined ||
             ps == psLocalInstance);
@@ -731,7 +746,9 @@ size_t getChunkNumberOfElements(Coordinates const& low, Coordinates const& high)
 void ArrayDesc::checkConformity(ArrayDesc const& srcDesc, ArrayDesc const& dstDesc, unsigned options)
 {
     if (!(options & IGNORE_PSCHEME) &&
-        srcDesc.getPartitioningSchema() != dstDesc.getPartitioningSchema())
+        (srcDesc.getPartitioningSchema() != dstDesc.getPartitioningSchema() ||
+         srcDesc.getPartitioningDimension() != dstDesc.getPartitioningDimension() ||
+         srcDesc.getPartitioningBlock() != dstDesc.getPartitioningBlock()))
     {
         throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_ARRAYS_NOT_CONFORMANT)
             << "Target of INSERT/STORE must have same distribution as the source";
@@ -922,6 +939,11 @@ std::ostream& operator<<(std::ostream& stream,const ArrayDesc& ob)
     stream << " Version: " << ob.getVersionId();
     stream << " Flags: " << ob.getFlags();
     stream << " PartitioningSchema: " << ob.getPartitioningSchema();
+    if (ob.getPartitioningSchema() == psRangePartitioned ||
+        ob.getPartitioningSchema() == psCoPartitioned) {
+        stream << " PartitioningDimension: " << ob.getPartitioningDimension();
+        stream << " PartitioningBlock: " << ob.getPartitioningBlock();
+    }
     stream << " <" << ob.getAttributes(false) << ">" ;
 #endif
 
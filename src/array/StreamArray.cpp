@@ -33,8 +33,11 @@
 #include <array/Metadata.h>
 #include <array/StreamArray.h>
 #ifndef SCIDB_CLIENT
+#include <query/Operator.h>
 #include <query/RemoteArray.h>
 #include <query/PullSGArray.h>
+#include <util/Atomic.h>
+#include <util/Job.h>
 #endif
 #include <system/Config.h>
 #include <system/Exceptions.h>
@@ -336,6 +339,71 @@ MultiStreamArray::DefaultChunkMerger::getMergedChunk(AttributeID attId,
     return result;
 }
 
+std::shared_ptr<MultiStreamArray::PartialChunkMerger>
+MultiStreamArray::DefaultChunkMerger::getGroupMerger() const
+{
+    return std::make_shared<DefaultChunkMerger>(_isEnforceDataIntegrity);
+}
+
+/**
+ * A job merging a group of the partial chunks of a position with its own merger.
+ * The group is merged by whichever claims it first: a pool thread or the thread consuming the array.
+ */
+class MultiStreamArray::GroupMergeJob : public Job
+{
+public:
+    GroupMergeJob(std::shared_ptr<PartialChunkMerger> const& merger,
+                  AttributeID attId,
+                  std::vector<PartialChunk>::iterator begin,
+                  std::vector<PartialChunk>::iterator end,
+                  std::shared_ptr<Query> const& query)
+    : Job(query),
+      _merger(merger),
+      _attId(attId),
+      _partials(begin, end),
+      _claimed(false)
+    {
+        assert(!_partials.empty());
+    }
+
+    /// @return true if the caller is the one to merge the group
+    bool claim()
+    {
+        return _claimed.testAndSet(false, true);
+    }
+
+    /// Merge the partial chunks of the group into one
+    void merge(std::shared_ptr<Query> const& query)
+    {
+        for (size_t i = 0; i < _partials.size(); ++i) {
+            std::shared_ptr<MemChunk> chunk;
+            chunk.swap(_partials[i].second);
+            _merger->mergePartialChunk(_partials[i].first, _attId, chunk, query);
+        }
+        _partials.front().second = _merger->getMergedChunk(_attId, query);
+    }
+
+    /// @return the merged chunk and the stream of the first partial chunk of the group
+    PartialChunk& getResult()
+    {
+        return _partials.front();
+    }
+
+protected:
+    virtual void run()
+    {
+        if (claim()) {
+            merge(_query);
+        }
+    }
+
+private:
+    std::shared_ptr<PartialChunkMerger> _merger;
+    const AttributeID _attId;
+    std::vector<PartialChunk> _partials;
+    Atomic<bool> _claimed;
+};
+
 /**
  * Multistream array constructor
  * @param n number of chunk streams
@@ -357,6 +425,9 @@ MultiStreamArray::MultiStreamArray(size_t n,
   _readyPositions(arr.getAttributes().size()),
   _notReadyPositions(arr.getAttributes().size()),
   _currPartialStreams(arr.getAttributes().size()),
+  _partialChunks(arr.getAttributes().size()),
+  _treeMergeFanIn(Config::getInstance()->getOption<int>(CONFIG_MERGE_FAN_IN)),
+  _nMergeWorkers(Config::getInstance()->getOption<int>(CONFIG_RESULT_PREFETCH_THREADS)),
   _hasDataIntegrityIssue(false),
   _currMinPos(arr.getAttributes().size())
 {
@@ -541,6 +612,7 @@ MultiStreamArray::mergePartialStreams(PositionMap& readyPos,
     std::shared_ptr<MemChunk> mergeChunk = std::make_shared<MemChunk>();
     std::shared_ptr<Query> query(Query::getValidQueryPtr(_query));
     assert(_chunkMergers[attId]);
+    const bool treeMerge = isTreeMerge(currPartialStreams, attId);
 
     // get all partial chunks
     for (list<size_t>::iterator it=currPartialStreams.begin();
@@ -599,7 +671,11 @@ MultiStreamArray::mergePartialStreams(PositionMap& readyPos,
                      <<", size=" << next->getSize());
 
         assert(_currMinPos[attId] == next->getFirstPosition(false));
-        if (!_chunkMergers[attId]->mergePartialChunk(stream, attId,mergeChunk,query)) {
+        if (treeMerge) {
+            // keep the partial chunk until all of them are in
+            _partialChunks[attId].push_back(PartialChunk(stream, mergeChunk));
+            mergeChunk = std::make_shared<MemChunk>();
+        } else if (!_chunkMergers[attId]->mergePartialChunk(stream, attId,mergeChunk,query)) {
             assert(!mergeChunk);
             mergeChunk = std::make_shared<MemChunk>();
         }
@@ -607,7 +683,86 @@ MultiStreamArray::mergePartialStreams(PositionMap& readyPos,
     }
     if (err) { throw *err; }
 
-    _resultChunks[attId] = _chunkMergers[attId]->getMergedChunk(attId, query);
+    if (treeMerge) {
+        _resultChunks[attId] = mergeTree(attId, query);
+    } else {
+        _resultChunks[attId] = _chunkMergers[attId]->getMergedChunk(attId, query);
+    }
+}
+
+bool
+MultiStreamArray::isTreeMerge(list<size_t> const& currPartialStreams,
+                              const AttributeID attId) const
+{
+    // the partial chunks already kept and the ones still to come add up to the same number
+    // on every call for the same position, so the choice does not change across retries
+    const size_t nPartials = _partialChunks[attId].size() + currPartialStreams.size();
+    return (_treeMergeFanIn > 0 && _nMergeWorkers > 1 &&
+            nPartials >= std::max<size_t>(_treeMergeFanIn, 4));
+}
+
+std::shared_ptr<MemChunk>
+MultiStreamArray::mergeTree(const AttributeID attId,
+                            std::shared_ptr<Query> const& query)
+{
+    static const char *funcName = "MultiStreamArray::mergeTree: ";
+    vector<PartialChunk>& partials = _partialChunks[attId];
+    PartialChunkMerger& merger = *_chunkMergers[attId];
+    const size_t nPartials = partials.size();
+    const size_t nGroups = std::min(_nMergeWorkers, nPartials / 2);
+    assert(nGroups > 1);
+
+    // merge groups of at least two partial chunks concurrently
+    vector<std::shared_ptr<GroupMergeJob> > jobs;
+    for (size_t g = 0; g < nGroups; ++g) {
+        std::shared_ptr<PartialChunkMerger> groupMerger = merger.getGroupMerger();
+        if (!groupMerger) {
+            jobs.clear();
+            break;
+        }
+        jobs.push_back(std::make_shared<GroupMergeJob>(groupMerger, attId,
+                                                       partials.begin() + (g * nPartials / nGroups),
+                                                       partials.begin() + ((g + 1) * nPartials / nGroups),
+                                                       query));
+    }
+    if (!jobs.empty()) {
+        partials.clear();
+        LOG4CXX_TRACE(logger, funcName << "merging " << nPartials << " partial chunks in "
+                      << jobs.size() << " groups attId= " << attId);
+
+        std::shared_ptr<JobQueue> queue = PhysicalOperator::getGlobalQueueForOperators();
+        for (size_t g = 1; g < jobs.size(); ++g) {
+            queue->pushJob(jobs[g]);
+        }
+        // merge the groups no pool thread has taken yet, wait for the others
+        std::shared_ptr<Exception> err;
+        std::shared_ptr<GroupMergeJob> failedJob;
+        for (size_t g = 0; g < jobs.size(); ++g) {
+            if (jobs[g]->claim()) {
+                try {
+                    jobs[g]->merge(query);
+                } catch (Exception const& e) {
+                    if (!err) { err = e.copy(); }
+                }
+            } else if (!jobs[g]->wait() && !failedJob) {
+                failedJob = jobs[g];
+            }
+        }
+        if (err) { err->raise(); }
+        if (failedJob) { failedJob->rethrow(); }
+
+        for (size_t g = 0; g < jobs.size(); ++g) {
+            partials.push_back(jobs[g]->getResult());
+        }
+    }
+
+    for (size_t i = 0; i < partials.size(); ++i) {
+        std::shared_ptr<MemChunk> chunk;
+        chunk.swap(partials[i].second);
+        merger.mergePartialChunk(partials[i].first, attId, chunk, query);
+    }
+    partials.clear();
+    return merger.getMergedChunk(attId, query);
 }
 
 void
@@ -306,12 +306,23 @@ public:
         }
     }
 
-    void prepareQuery(const std::string& queryString, bool afl, const std::string&, QueryResult& queryResult, void* connection) const
+    void prepareQuery(const std::string& queryString, bool afl, const std::string& programOptions, QueryResult& queryResult, void* connection) const
+    {
+        prepareQuery(queryString, afl, programOptions, QueryParameters(), queryResult, connection);
+    }
+
+    void prepareQuery(const std::string& queryString, bool afl, const std::string&,
+                      const QueryParameters& parameters, QueryResult& queryResult, void* connection) const
     {
         StatisticsScope sScope;
         std::shared_ptr<MessageDesc> queryMessage = std::make_shared<MessageDesc>(mtPrepareQuery);
         queryMessage->getRecord<scidb_msg::Query>()->set_query(queryString);
         queryMessage->getRecord<scidb_msg::Query>()->set_afl(afl);
+        for (QueryParameters::const_iterator i = parameters.begin(); i != parameters.end(); ++i) {
+            scidb_msg::Query_Parameter* parameter = queryMessage->getRecord<scidb_msg::Query>()->add_parameters();
+            parameter->set_name(i->first);
+            parameter->set_value(i->second);
+        }
 
         std::string programOptions;
         fillProgramOptions(programOptions);
@@ -112,6 +112,15 @@ string ClientMessageHandleJob::getProgramOptions(std::string const& programOptio
     return ip.str();
 }
 
+QueryParameters ClientMessageHandleJob::getQueryParameters(const scidb_msg::Query& record) const
+{
+    QueryParameters parameters;
+    for (int i = 0; i < record.parameters_size(); ++i) {
+        parameters[record.parameters(i).name()] = record.parameters(i).value();
+    }
+    return parameters;
+}
+
 void
 ClientMessageHandleJob::executeSerially(std::shared_ptr<WorkQueue>& serialQueue,
                                         std::weak_ptr<WorkQueue>& initialQueue,
@@ -441,6 +450,7 @@ void ClientMessageHandleJob::prepareClientQuery()
                 queryString,
                 afl,
                 getProgramOptions(programOptions),
+                getQueryParameters(*record),
                 queryResult,
                 &_connection);
         }
@@ -606,6 +616,7 @@ void ClientMessageHandleJob::executeClientQuery()
                     queryString,
                     afl,
                     getProgramOptions(programOptions),
+                    getQueryParameters(*record),
                     queryResult,
                     &_connection);
 
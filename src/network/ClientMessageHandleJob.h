@@ -81,6 +81,9 @@ class ClientMessageHandleJob : public MessageHandleJob
 
     std::string getProgramOptions(const std::string &programOptions) const;
 
+    /// @return the bind parameters carried by a query message
+    QueryParameters getQueryParameters(const scidb_msg::Query& record) const;
+
     /**
      * Retrieve the combined user-name stored in the
      * session as a string.
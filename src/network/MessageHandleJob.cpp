@@ -38,6 +38,7 @@
 #include <query/Query.h>
 #include <query/QueryProcessor.h>
 #include <smgr/io/Storage.h>
+#include <smgr/io/ReplicationManager.h>
 #include <system/Cluster.h>
 #include <system/Exceptions.h>
 #include <system/Resources.h>
@@ -734,19 +735,37 @@ void ServerMessageHandleJob::handleReplicaChunk()
         return;
     }
 
-    const int compMethod = chunkRecord->compression_method();
-    const size_t decompressedSize = chunkRecord->decompressed_size();
-    const AttributeID attributeID = chunkRecord->attribute_id();
-    const size_t count = chunkRecord->count();
-    Coordinates coordinates;
-    for (int i = 0; i < chunkRecord->coordinates_size(); i++) {
-        coordinates.push_back(chunkRecord->coordinates(i));
-    }
-
     std::shared_ptr<Array> dbArr = replicationCtx->getPersistentArray(arrId);
     assert(dbArr);
 
-    if(chunkRecord->tombstone())
+    if (chunkRecord->replicas_size() > 0) {
+        // a batch of chunks for the same array
+        vector<std::shared_ptr<CompressedBuffer> > payloads;
+        ReplicationManager::unpackBatch(_messageDesc, payloads);
+        for (int i = 0; i < chunkRecord->replicas_size(); ++i) {
+            storeReplicaChunk(dbArr, chunkRecord->replicas(i), payloads[i]);
+        }
+        LOG4CXX_TRACE(logger, funcName << "stored batch of " << chunkRecord->replicas_size() << " chunks");
+        return;
+    }
+    storeReplicaChunk(dbArr, *chunkRecord,
+                      dynamic_pointer_cast<CompressedBuffer>(_messageDesc->getBinary()));
+}
+
+void ServerMessageHandleJob::storeReplicaChunk(const std::shared_ptr<Array>& dbArr,
+                                               const scidb_msg::Chunk& chunkRecord,
+                                               const std::shared_ptr<CompressedBuffer>& compressedBuffer)
+{
+    const int compMethod = chunkRecord.compression_method();
+    const size_t decompressedSize = chunkRecord.decompressed_size();
+    const AttributeID attributeID = chunkRecord.attribute_id();
+    const size_t count = chunkRecord.count();
+    Coordinates coordinates;
+    for (int i = 0; i < chunkRecord.coordinates_size(); i++) {
+        coordinates.push_back(chunkRecord.coordinates(i));
+    }
+
+    if(chunkRecord.tombstone())
     { // tombstone record
         StorageManager::getInstance().removeLocalChunkVersion(dbArr->getArrayDesc(), coordinates, _query);
     }
@@ -762,8 +781,7 @@ void ServerMessageHandleJob::handleReplicaChunk()
     else
     { // regular chunk
         std::shared_ptr<ArrayIterator> outputIter = dbArr->getIterator(attributeID);
-        std::shared_ptr<CompressedBuffer> compressedBuffer =
-            dynamic_pointer_cast<CompressedBuffer>(_messageDesc->getBinary());
+        assert(compressedBuffer);
         compressedBuffer->setCompressionMethod(compMethod);
         compressedBuffer->setDecompressedSize(decompressedSize);
         Chunk& outChunk = outputIter->newChunk(coordinates);
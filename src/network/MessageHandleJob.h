@@ -147,6 +147,10 @@ namespace scidb
         void handleBufferSend();
         void handleReplicaSyncResponse();
         void handleReplicaChunk();
+        /// Store one replica chunk or tombstone received alone or in a batch
+        void storeReplicaChunk(const std::shared_ptr<Array>& dbArr,
+                               const scidb_msg::Chunk& chunkRecord,
+                               const std::shared_ptr<CompressedBuffer>& compressedBuffer);
         void handleInstanceStatus();
         void handleResourcesFileExists();
         void handleInvalidMessage();
@@ -106,8 +106,23 @@ AggregateChunkMerger::getMergedChunk(AttributeID attId,
     return result;
 }
 
+std::shared_ptr<MultiStreamArray::PartialChunkMerger>
+AggregateChunkMerger::getGroupMerger() const
+{
+    // a group leaves the aggregate states unfinalized and merges them with its own copy of the aggregate
+    return std::make_shared<AggregateChunkMerger>(_aggregate->clone(), _isEmptyable);
+}
+
 #endif //SCIDB_CLIENT
 
+void Aggregate::setParameters(std::vector<double> const& parameters)
+{
+    if (!parameters.empty())
+    {
+        throw USER_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_WRONG_AGGREGATE_PARAMETERS) << getName();
+    }
+}
+
 void AggregateLibrary::addAggregate(
         AggregatePtr const& aggregate,
         string const & libraryName /* = "scidb" */ )
@@ -46,8 +46,36 @@ class AggregateTests: public CppUnit::TestFixture
     CPPUNIT_TEST(testFloatSum);
     CPPUNIT_TEST(testIntegerAvg);
     CPPUNIT_TEST(testDoubleAvg);
+    CPPUNIT_TEST(testApproxQuantile);
+    CPPUNIT_TEST(testApproxQuantileBounded);
+    CPPUNIT_TEST(testApproxTopK);
+    CPPUNIT_TEST(testKernelAggregate);
     CPPUNIT_TEST_SUITE_END();
 
+    struct SumOfSquares: AggregateKernel<SumOfSquares, int32_t, int64_t, int64_t>
+    {
+        static void init(int64_t& state)
+        {
+            state = 0;
+        }
+
+        static void aggregate(int64_t& state, int32_t const& value)
+        {
+            state += int64_t(value) * value;
+        }
+
+        static void merge(int64_t& state, int64_t const& other)
+        {
+            state += other;
+        }
+
+        static bool final(int64_t const& state, int64_t& result)
+        {
+            result = state;
+            return true;
+        }
+    };
+
     void testIntegerSum()
     {
         AggregateLibrary* al = AggregateLibrary::getInstance();
@@ -205,6 +233,143 @@ class AggregateTests: public CppUnit::TestFixture
         avg->finalResult(final, state);
         CPPUNIT_ASSERT( std::fabs(final.getDouble() - (8.0 / 3.0)) < 4*std::numeric_limits<float>::epsilon() );
     }
+
+    void testApproxQuantile()
+    {
+        AggregateLibrary* al = AggregateLibrary::getInstance();
+        Type tInt64 = TypeLibrary::getType(TID_INT64);
+
+        AggregatePtr q = al->createAggregate("approx_quantile", tInt64);
+        CPPUNIT_ASSERT(q.get() != 0);
+        CPPUNIT_ASSERT(q->getResultType() == TypeLibrary::getType(TID_DOUBLE));
+        q->setParameters(std::vector<double>(1, 0.9));
+        q = q->clone();
+
+        Value input(q->getAggregateType());
+        Value state(q->getStateType());
+        Value state2(q->getStateType());
+        Value final(q->getResultType());
+
+        q->initializeState(state);
+        q->finalResult(final, state);
+        CPPUNIT_ASSERT(final.isNull());
+
+        // Two partial states over interleaved halves of 0..N-1, then merged
+        const int64_t N = 200000;
+        q->initializeState(state2);
+        for (int64_t i = 0; i < N; i++)
+        {
+            input.setInt64((i * 7919) % N);
+            q->accumulateIfNeeded(i % 2 ? state : state2, input);
+        }
+        input.setNull();
+        q->accumulateIfNeeded(state, input);
+        q->mergeIfNeeded(state, state2);
+
+        q->finalResult(final, state);
+        CPPUNIT_ASSERT(std::fabs(final.getDouble() - 0.9 * N) < 0.02 * N);
+
+        // The state stays bounded: a few levels of at most 256 values
+        CPPUNIT_ASSERT(state.size() < 20 * 256 * sizeof(double));
+
+        std::vector<double> bad(1, 1.5);
+        CPPUNIT_ASSERT_THROW(q->setParameters(bad), UserException);
+    }
+
+    void testApproxQuantileBounded()
+    {
+        AggregateLibrary* al = AggregateLibrary::getInstance();
+        AggregatePtr q = al->createAggregate("approx_quantile", TypeLibrary::getType(TID_DOUBLE));
+        q->setParameters(std::vector<double>(1, 0.25));
+        q = q->clone();
+
+        Value input(q->getAggregateType());
+        Value state(q->getStateType());
+        Value final(q->getResultType());
+
+        // The levels shrink geometrically below the top one: 10^7 values
+        // are summarized in less than 4K doubles, 3K plus the header
+        const int64_t N = 10000000;
+        size_t maxSize = 0;
+        q->initializeState(state);
+        for (int64_t i = 0; i < N; i++)
+        {
+            input.setDouble(double((i * 7919) % N));
+            q->accumulateIfNeeded(state, input);
+            maxSize = std::max(maxSize, state.size());
+        }
+        CPPUNIT_ASSERT(maxSize < 4 * 256 * sizeof(double));
+
+        q->finalResult(final, state);
+        CPPUNIT_ASSERT(std::fabs(final.getDouble() - 0.25 * N) < 0.01 * N);
+    }
+
+    void testApproxTopK()
+    {
+        AggregateLibrary* al = AggregateLibrary::getInstance();
+        Type tString = TypeLibrary::getType(TID_STRING);
+
+        AggregatePtr topk = al->createAggregate("approx_topk", tString);
+        CPPUNIT_ASSERT(topk.get() != 0);
+        CPPUNIT_ASSERT(topk->getResultType() == TypeLibrary::getType(TID_STRING));
+        topk->setParameters(std::vector<double>(1, 2));
+
+        Value input(topk->getAggregateType());
+        Value state(topk->getStateType());
+        Value state2(topk->getStateType());
+        Value final(topk->getResultType());
+
+        // "a" and "b" stand out of a long tail of distinct values
+        topk->initializeState(state);
+        topk->initializeState(state2);
+        for (int i = 0; i < 10000; i++)
+        {
+            Value& s = i % 2 ? state : state2;
+            input.setString(i % 3 == 0 ? "a" : i % 5 == 0 ? "b" : std::to_string(i).c_str());
+            topk->accumulateIfNeeded(s, input);
+        }
+        topk->mergeIfNeeded(state, state2);
+
+        topk->finalResult(final, state);
+        std::string result(final.getString());
+        CPPUNIT_ASSERT(result.compare(0, 2, "a:") == 0);
+        CPPUNIT_ASSERT(result.find(", b:") != std::string::npos);
+
+        std::vector<double> bad(1, 0);
+        CPPUNIT_ASSERT_THROW(topk->setParameters(bad), UserException);
+    }
+
+    void testKernelAggregate()
+    {
+        Type tInt32 = TypeLibrary::getType(TID_INT32);
+        Type tInt64 = TypeLibrary::getType(TID_INT64);
+        AggregatePtr agg = std::make_shared<KernelAggregate<SumOfSquares> >("sum_sq", tInt32, tInt64);
+
+        CPPUNIT_ASSERT(agg->getStateType().byteSize() == sizeof(int64_t));
+        AggregatePtr copy = agg->clone(tInt32);
+        CPPUNIT_ASSERT(copy->getResultType() == tInt64);
+
+        Value input(tInt32);
+        Value state(agg->getStateType());
+        Value state2(agg->getStateType());
+        Value final(tInt64);
+
+        // A group that saw no values yields null by default.
+        agg->finalResult(final, state);
+        CPPUNIT_ASSERT(final.isNull());
+
+        input.setInt32(3);
+        agg->accumulateIfNeeded(state, input);
+        input.setNull();
+        agg->accumulateIfNeeded(state, input);
+        input.setInt32(-2);
+        copy->accumulateIfNeeded(state2, input);
+        agg->mergeIfNeeded(state, state2);
+
+        agg->finalResult(final, state);
+        CPPUNIT_ASSERT(!final.isNull());
+        CPPUNIT_ASSERT(final.getInt64() == 13);
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(AggregateTests);
@@ -28,6 +28,9 @@
 
 
 #include <math.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
 #include <log4cxx/logger.h>
 
 #include <query/Aggregate.h>
@@ -444,6 +447,690 @@ public:
     }
 };
 
+/**
+ * This class implements approx_quantile(x, q), the q-quantile (0 <= q <= 1, by
+ * default 0.5, the median) of the values of a numeric attribute estimated
+ * with a mergeable quantile sketch.
+ *
+ * The state is a stack of compactors as in the KLL sketch (Karnin, Lang and
+ * Liberty, "Optimal Quantile Approximation in Streams").  Values are appended
+ * to level 0; once the levels hold as many values as their capacities add up
+ * to, the lowest full level is sorted and every other value of it, starting
+ * at a random one, moves up a level where it stands for twice as many values.
+ * The top level holds up to K values and each level below it 2/3 of the one
+ * above, so the state is bounded by about 3K values however many levels n
+ * calls for, while the rank error stays a small multiple of n/K.  The levels
+ * are packed from the top one down, level 0 last, so that values are
+ * appended at the end.
+ */
+template<typename T>
+class ApproxQuantileAggregate : public Aggregate
+{
+private:
+    static const uint32_t K            = 256;
+    static const uint32_t MIN_CAPACITY = 2;
+    static const uint32_t MAX_LEVELS   = 64 - 8; // a level above it would stand for more than 2^64 values
+
+    struct Header
+    {
+        uint64_t n;                    // number of values accumulated
+        uint64_t random;               // state of the generator choosing the values to promote
+        uint32_t nLevels;              // number of levels following the header
+        uint32_t nValues;              // number of values held in all the levels
+        uint32_t capacity;             // sum of the capacities of the levels
+        uint32_t sizes[MAX_LEVELS];    // number of values held in each level
+    };
+
+    double _q;
+
+    static Header& header(Value& state)
+    {
+        return *state.getData<Header>();
+    }
+
+    static Header const& header(Value const& state)
+    {
+        return *state.getData<Header>();
+    }
+
+    static double* values(Value& state)
+    {
+        return reinterpret_cast<double*>(state.getData<char>() + sizeof(Header));
+    }
+
+    static double const* values(Value const& state)
+    {
+        return reinterpret_cast<double const*>(state.getData<char>() + sizeof(Header));
+    }
+
+    /**
+     * @return the position of level l in the values, after the levels above it
+     */
+    static uint32_t offset(Header const& hdr, uint32_t l)
+    {
+        uint32_t off = 0;
+        for (uint32_t i = l + 1; i < hdr.nLevels; i++)
+        {
+            off += hdr.sizes[i];
+        }
+        return off;
+    }
+
+    /**
+     * @return the capacity of level l of nLevels, 2/3 of the one above it
+     */
+    static uint32_t levelCapacity(uint32_t nLevels, uint32_t l)
+    {
+        uint32_t capacity = K;
+        for (uint32_t i = l + 1; i < nLevels && capacity > MIN_CAPACITY; i++)
+        {
+            capacity = capacity * 2 / 3;
+        }
+        return std::max(capacity, MIN_CAPACITY);
+    }
+
+    static uint32_t totalCapacity(uint32_t nLevels)
+    {
+        uint32_t capacity = 0;
+        for (uint32_t l = 0; l < nLevels; l++)
+        {
+            capacity += levelCapacity(nLevels, l);
+        }
+        return capacity;
+    }
+
+    static bool randomBit(Header& hdr)
+    {
+        hdr.random ^= hdr.random << 13;
+        hdr.random ^= hdr.random >> 7;
+        hdr.random ^= hdr.random << 17;
+        return hdr.random & 1;
+    }
+
+    /**
+     * Halve level l, promoting every other of its sorted values to level l+1.
+     */
+    static void compact(Value& state, uint32_t l)
+    {
+        assert(l + 1 < MAX_LEVELS);
+        if (l + 1 == header(state).nLevels)
+        {
+            // The new top level goes in front of the others, empty
+            Header& hdr = header(state);
+            hdr.sizes[hdr.nLevels++] = 0;
+            hdr.capacity = totalCapacity(hdr.nLevels);
+            if (state.size() < sizeof(Header) + size_t(hdr.capacity) * sizeof(double))
+            {
+                state.setSize(sizeof(Header) + size_t(hdr.capacity) * sizeof(double));
+            }
+        }
+
+        Header& hdr = header(state);
+        const uint32_t size = hdr.sizes[l];
+        double* src = values(state) + offset(hdr, l);
+        double* end = values(state) + hdr.nValues;
+        std::sort(src, src + size);
+
+        // With an odd number of values the smallest or largest one stays
+        uint32_t from = 0;
+        uint32_t to = size;
+        double left = 0;
+        if (size & 1)
+        {
+            if (randomBit(hdr))
+            {
+                left = src[from++];
+            }
+            else
+            {
+                left = src[--to];
+            }
+        }
+
+        // The promoted values end level l+1, which is right in front of level l
+        double* dst = src;
+        for (uint32_t i = from + (randomBit(hdr) ? 1 : 0); i < to; i += 2)
+        {
+            *dst++ = src[i];
+        }
+        if (size & 1)
+        {
+            *dst++ = left;
+        }
+        memmove(dst, src + size, (end - src - size) * sizeof(double));
+
+        const uint32_t promoted = (to - from) / 2;
+        hdr.sizes[l + 1] += promoted;
+        hdr.sizes[l] = size & 1;
+        hdr.nValues -= size - promoted - hdr.sizes[l];
+    }
+
+    /**
+     * Compact the lowest full levels until the values fit the capacity again.
+     */
+    static void compress(Value& state)
+    {
+        while (header(state).nValues >= header(state).capacity)
+        {
+            Header const& hdr = header(state);
+            uint32_t l = 0;
+            while (hdr.sizes[l] < levelCapacity(hdr.nLevels, l))
+            {
+                l++;
+            }
+            compact(state, l);
+        }
+    }
+
+protected:
+    virtual void accumulate(Value& dstState, Value const& srcValue)
+    {
+        assert(isStateInitialized(dstState));
+        assert(isAccumulatable(srcValue));
+
+        Header& hdr = header(dstState);
+        values(dstState)[hdr.nValues++] = static_cast<double>(srcValue.get<T>());
+        hdr.sizes[0] += 1;
+        hdr.n += 1;
+        compress(dstState);
+    }
+
+    virtual void merge(Value& dstState, Value const& srcState)
+    {
+        assert(isStateInitialized(dstState));
+        assert(isMergeable(srcState));
+
+        // Concatenate the levels of both states, then compact them to fit
+        Header const& src = header(srcState);
+        Header hdr = header(dstState);
+        const uint32_t nLevels = std::max(hdr.nLevels, src.nLevels);
+        std::vector<double> merged;
+        merged.reserve(hdr.nValues + src.nValues);
+        uint32_t sizes[MAX_LEVELS];
+        for (uint32_t l = nLevels; l-- > 0; )
+        {
+            sizes[l] = 0;
+            if (l < hdr.nLevels)
+            {
+                double const* v = values(dstState) + offset(hdr, l);
+                merged.insert(merged.end(), v, v + hdr.sizes[l]);
+                sizes[l] += hdr.sizes[l];
+            }
+            if (l < src.nLevels)
+            {
+                double const* v = values(srcState) + offset(src, l);
+                merged.insert(merged.end(), v, v + src.sizes[l]);
+                sizes[l] += src.sizes[l];
+            }
+        }
+        hdr.n += src.n;
+        hdr.nLevels = nLevels;
+        hdr.nValues = static_cast<uint32_t>(merged.size());
+        hdr.capacity = totalCapacity(nLevels);
+        memcpy(hdr.sizes, sizes, nLevels * sizeof(uint32_t));
+
+        dstState.setSize(sizeof(Header) + std::max(merged.size(), size_t(hdr.capacity)) * sizeof(double));
+        header(dstState) = hdr;
+        if (!merged.empty())
+        {
+            memcpy(values(dstState), &merged[0], merged.size() * sizeof(double));
+        }
+        compress(dstState);
+        dstState.setSize(sizeof(Header) + size_t(header(dstState).capacity) * sizeof(double));
+    }
+
+public:
+    ApproxQuantileAggregate(const std::string& name, Type const& aggregateType, double q = 0.5)
+    : Aggregate(name, aggregateType, TypeLibrary::getType(TID_DOUBLE)),
+      _q(q)
+    {}
+
+    virtual void setParameters(std::vector<double> const& parameters)
+    {
+        if (parameters.size() > 1 || (parameters.size() == 1 && !(parameters[0] >= 0 && parameters[0] <= 1)))
+        {
+            throw USER_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_WRONG_AGGREGATE_PARAMETERS) << getName();
+        }
+        _q = parameters.empty() ? 0.5 : parameters[0];
+    }
+
+    virtual bool ignoreNulls() const
+    {
+        return true;
+    }
+
+    virtual Type getStateType() const
+    {
+        return TypeLibrary::getType(TID_BINARY);
+    }
+
+    virtual AggregatePtr clone() const
+    {
+        return AggregatePtr(new ApproxQuantileAggregate(getName(), getAggregateType(), _q));
+    }
+
+    virtual AggregatePtr clone(Type const& aggregateType) const
+    {
+        return AggregatePtr(new ApproxQuantileAggregate(getName(), aggregateType, _q));
+    }
+
+    virtual void initializeState(Value& state)
+    {
+        memset(state.setSize(sizeof(Header) + K * sizeof(double)), 0, sizeof(Header));
+        header(state).random = 0x5C1DB;
+        header(state).nLevels = 1;
+        header(state).capacity = totalCapacity(1);
+    }
+
+    virtual void finalResult(Value& dstValue, Value const& srcState)
+    {
+        if (!isMergeable(srcState) || header(srcState).n == 0)
+        {
+            dstValue.setNull();
+            return;
+        }
+
+        // Sort the retained values with their weights, 2^level, and find the
+        // first one at which the cumulative weight reaches q of the total
+        Header const& hdr = header(srcState);
+        std::vector<std::pair<double, uint64_t> > retained;
+        for (uint32_t l = 0; l < hdr.nLevels; l++)
+        {
+            double const* v = values(srcState) + offset(hdr, l);
+            for (uint32_t i = 0; i < hdr.sizes[l]; i++)
+            {
+                retained.push_back(std::make_pair(v[i], uint64_t(1) << l));
+            }
+        }
+        std::sort(retained.begin(), retained.end());
+
+        const double rank = _q * hdr.n;
+        uint64_t weight = 0;
+        size_t i = 0;
+        while (i + 1 < retained.size() && double(weight + retained[i].second) < rank)
+        {
+            weight += retained[i++].second;
+        }
+        dstValue.setDouble(retained[i].first);
+    }
+};
+
+/**
+ * This class implements approx_topk(x, k), the k (by default 10) most
+ * frequent values of an attribute of any type, estimated with the
+ * Space-Saving algorithm (Metwally, Agrawal and El Abbadi, "Efficient
+ * Computation of Frequent and Top-k Elements in Data Streams").
+ *
+ * The state keeps a bounded number of counters; a value without a counter
+ * takes over the smallest one, inheriting its count as the error bound.
+ * States are merged as in Agarwal et al., "Mergeable Summaries".  The result
+ * is a string listing the values with their estimated counts by decreasing
+ * count: "value:count, value:count, ...".
+ */
+class ApproxTopKAggregate : public Aggregate
+{
+private:
+    static const uint32_t DEFAULT_K   = 10;
+    static const uint32_t MAX_K       = 1000;
+    static const uint32_t COUNTERS_PER_VALUE = 8;    // counters kept for each of the k values
+    static const uint32_t MIN_COUNTERS = 64;
+
+    struct Header
+    {
+        uint32_t capacity;    // maximal number of counters
+        uint32_t nCounters;   // counters in use
+        uint32_t heapSize;    // bytes of the key heap in use
+        uint32_t liveSize;    // bytes of the key heap referenced by counters
+    };
+
+    struct Counter
+    {
+        uint64_t count;       // estimated number of occurrences, an upper bound
+        uint64_t error;       // maximal overestimation of count
+        uint32_t hash;
+        uint32_t keySize;
+        uint32_t keyOffset;   // offset of the key in the heap
+        uint32_t reserved;
+    };
+
+    struct Entry
+    {
+        std::string key;
+        uint64_t count;
+        uint64_t error;
+
+        bool operator < (Entry const& other) const
+        {
+            return count > other.count || (count == other.count && key < other.key);
+        }
+    };
+
+    uint32_t _k;
+
+    uint32_t capacity() const
+    {
+        return _k * COUNTERS_PER_VALUE > MIN_COUNTERS ? _k * COUNTERS_PER_VALUE : MIN_COUNTERS;
+    }
+
+    static Header& header(Value& state)
+    {
+        return *state.getData<Header>();
+    }
+
+    static Header const& header(Value const& state)
+    {
+        return *state.getData<Header>();
+    }
+
+    static Counter* counters(Value& state)
+    {
+        return reinterpret_cast<Counter*>(state.getData<char>() + sizeof(Header));
+    }
+
+    static Counter const* counters(Value const& state)
+    {
+        return reinterpret_cast<Counter const*>(state.getData<char>() + sizeof(Header));
+    }
+
+    static char* heap(Value& state)
+    {
+        return state.getData<char>() + sizeof(Header) + header(state).capacity * sizeof(Counter);
+    }
+
+    static char const* heap(Value const& state)
+    {
+        return state.getData<char>() + sizeof(Header) + header(state).capacity * sizeof(Counter);
+    }
+
+    static uint32_t hashKey(void const* key, size_t size)
+    {
+        uint32_t h;
+        MurmurHash3_x86_32(key, static_cast<int>(size), 0x5C1DB, &h);
+        return h;
+    }
+
+    /**
+     * Point counter c at a copy of key, appending it to the heap unless it
+     * fits in place of the current key of c.  The heap is compacted when
+     * more than half of it is garbage.
+     */
+    static void setKey(Value& state, uint32_t c, void const* key, uint32_t size)
+    {
+        Header* hdr = &header(state);
+        Counter* counter = &counters(state)[c];
+        hdr->liveSize -= counter->keySize;
+        if (size > counter->keySize)
+        {
+            if (hdr->heapSize + size > 2 * (hdr->liveSize + size) && hdr->heapSize > 4 * KiB)
+            {
+                counter->keySize = 0;
+                packHeap(state);
+                hdr = &header(state);
+                counter = &counters(state)[c];
+            }
+            const size_t base = sizeof(Header) + hdr->capacity * sizeof(Counter);
+            if (base + hdr->heapSize + size > state.size())
+            {
+                state.setSize(std::max(base + hdr->heapSize + size, base + 2 * hdr->heapSize));
+                hdr = &header(state);
+                counter = &counters(state)[c];
+            }
+            counter->keyOffset = hdr->heapSize;
+            hdr->heapSize += size;
+        }
+        memcpy(heap(state) + counter->keyOffset, key, size);
+        counter->keySize = size;
+        hdr->liveSize += size;
+    }
+
+    static void packHeap(Value& state)
+    {
+        Header& hdr = header(state);
+        Counter* c = counters(state);
+        std::vector<char> keys(hdr.liveSize);
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < hdr.nCounters; i++)
+        {
+            memcpy(&keys[offset], heap(state) + c[i].keyOffset, c[i].keySize);
+            c[i].keyOffset = offset;
+            offset += c[i].keySize;
+        }
+        hdr.heapSize = offset;
+        if (offset != 0)
+        {
+            memcpy(heap(state), &keys[0], offset);
+        }
+    }
+
+    void decode(Value const& state, std::vector<Entry>& entries) const
+    {
+        Header const& hdr = header(state);
+        Counter const* c = counters(state);
+        entries.resize(hdr.nCounters);
+        for (uint32_t i = 0; i < hdr.nCounters; i++)
+        {
+            entries[i].key.assign(heap(state) + c[i].keyOffset, c[i].keySize);
+            entries[i].count = c[i].count;
+            entries[i].error = c[i].error;
+        }
+    }
+
+    /**
+     * Smallest count of a full state, bounding the count of any value
+     * without a counter; 0 if the state is not full.
+     */
+    static uint64_t minCount(Value const& state)
+    {
+        Header const& hdr = header(state);
+        if (hdr.nCounters < hdr.capacity)
+        {
+            return 0;
+        }
+        Counter const* c = counters(state);
+        uint64_t m = c[0].count;
+        for (uint32_t i = 1; i < hdr.nCounters; i++)
+        {
+            m = std::min(m, c[i].count);
+        }
+        return m;
+    }
+
+protected:
+    virtual void accumulate(Value& dstState, Value const& srcValue)
+    {
+        assert(isStateInitialized(dstState));
+        assert(isAccumulatable(srcValue));
+
+        void const* key = srcValue.data();
+        const uint32_t size = static_cast<uint32_t>(srcValue.size());
+        const uint32_t hash = hashKey(key, size);
+
+        Header& hdr = header(dstState);
+        Counter* c = counters(dstState);
+        uint32_t smallest = 0;
+        for (uint32_t i = 0; i < hdr.nCounters; i++)
+        {
+            if (c[i].hash == hash && c[i].keySize == size &&
+                memcmp(heap(dstState) + c[i].keyOffset, key, size) == 0)
+            {
+                c[i].count += 1;
+                return;
+            }
+            if (c[i].count < c[smallest].count)
+            {
+                smallest = i;
+            }
+        }
+
+        uint32_t victim;
+        uint64_t base = 0;
+        if (hdr.nCounters < hdr.capacity)
+        {
+            victim = hdr.nCounters++;
+            c[victim].keySize = 0;
+        }
+        else
+        {
+            victim = smallest;
+            base = c[victim].count;
+        }
+        c[victim].count = base + 1;
+        c[victim].error = base;
+        c[victim].hash = hash;
+        setKey(dstState, victim, key, size);
+    }
+
+    virtual void merge(Value& dstState, Value const& srcState)
+    {
+        assert(isStateInitialized(dstState));
+        assert(isMergeable(srcState));
+
+        std::vector<Entry> dst, src;
+        decode(dstState, dst);
+        decode(srcState, src);
+        const uint64_t dstMin = minCount(dstState);
+        const uint64_t srcMin = minCount(srcState);
+
+        // A value missing from one of the states may have occurred there
+        // as often as its smallest counter
+        std::map<std::string, Entry> merged;
+        for (size_t i = 0; i < dst.size(); i++)
+        {
+            Entry& e = merged[dst[i].key];
+            e = dst[i];
+            e.count += srcMin;
+            e.error += srcMin;
+        }
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            std::map<std::string, Entry>::iterator m = merged.find(src[i].key);
+            if (m == merged.end())
+            {
+                Entry& e = merged[src[i].key];
+                e = src[i];
+                e.count += dstMin;
+                e.error += dstMin;
+            }
+            else
+            {
+                m->second.count += src[i].count - srcMin;
+                m->second.error += src[i].error - srcMin;
+            }
+        }
+
+        std::vector<Entry> entries;
+        entries.reserve(merged.size());
+        for (std::map<std::string, Entry>::iterator m = merged.begin(); m != merged.end(); ++m)
+        {
+            entries.push_back(m->second);
+        }
+        std::sort(entries.begin(), entries.end());
+        const uint32_t cap = header(dstState).capacity;
+        if (entries.size() > cap)
+        {
+            entries.resize(cap);
+        }
+
+        // Rebuild the state from the counters kept
+        Header& hdr = header(dstState);
+        hdr.nCounters = 0;
+        hdr.heapSize = 0;
+        hdr.liveSize = 0;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            const uint32_t c = header(dstState).nCounters++;
+            Counter& counter = counters(dstState)[c];
+            counter.count = entries[i].count;
+            counter.error = entries[i].error;
+            counter.hash = hashKey(entries[i].key.data(), entries[i].key.size());
+            counter.keySize = 0;
+            setKey(dstState, c, entries[i].key.data(), static_cast<uint32_t>(entries[i].key.size()));
+        }
+    }
+
+public:
+    ApproxTopKAggregate(const std::string& name, Type const& aggregateType, uint32_t k = DEFAULT_K)
+    : Aggregate(name, aggregateType, TypeLibrary::getType(TID_STRING)),
+      _k(k)
+    {}
+
+    virtual void setParameters(std::vector<double> const& parameters)
+    {
+        if (parameters.size() > 1 ||
+            (parameters.size() == 1 &&
+             !(parameters[0] >= 1 && parameters[0] <= MAX_K && parameters[0] == floor(parameters[0]))))
+        {
+            throw USER_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_WRONG_AGGREGATE_PARAMETERS) << getName();
+        }
+        _k = parameters.empty() ? DEFAULT_K : static_cast<uint32_t>(parameters[0]);
+    }
+
+    virtual bool ignoreNulls() const
+    {
+        return true;
+    }
+
+    virtual Type getStateType() const
+    {
+        return TypeLibrary::getType(TID_BINARY);
+    }
+
+    virtual AggregatePtr clone() const
+    {
+        return AggregatePtr(new ApproxTopKAggregate(getName(), getAggregateType(), _k));
+    }
+
+    virtual AggregatePtr clone(Type const& aggregateType) const
+    {
+        return AggregatePtr(new ApproxTopKAggregate(getName(), aggregateType, _k));
+    }
+
+    virtual void initializeState(Value& state)
+    {
+        const size_t size = sizeof(Header) + capacity() * sizeof(Counter);
+        memset(state.setSize(size), 0, size);
+        header(state).capacity = capacity();
+    }
+
+    virtual void finalResult(Value& dstValue, Value const& srcState)
+    {
+        if (!isMergeable(srcState))
+        {
+            dstValue.setString("");
+            return;
+        }
+
+        std::vector<Entry> entries;
+        decode(srcState, entries);
+        std::sort(entries.begin(), entries.end());
+
+        FunctionPointer converter = NULL;
+        if (getAggregateType().typeId() != TID_STRING)
+        {
+            converter = FunctionLibrary::getInstance()->findConverter(getAggregateType().typeId(), TID_STRING, false);
+        }
+
+        std::stringstream ss;
+        Value key(getAggregateType());
+        Value str(TypeLibrary::getType(TID_STRING));
+        for (size_t i = 0; i < entries.size() && i < _k; i++)
+        {
+            key.setData(entries[i].key.data(), entries[i].key.size());
+            if (converter)
+            {
+                const Value* v = &key;
+                converter(&v, &str, NULL);
+            }
+            else
+            {
+                str = key;
+            }
+            ss << (i ? ", " : "") << str.getString() << ':' << entries[i].count;
+        }
+        dstValue.setString(ss.str());
+    }
+};
+
 AggregateLibrary::AggregateLibrary()
 {
     /** SUM **/
@@ -543,6 +1230,21 @@ AggregateLibrary::AggregateLibrary()
 
     /** ApproxDC **/
     addAggregate(make_shared<ApproxDCAggregate>());
+
+    /** APPROX_QUANTILE **/
+    addAggregate(make_shared<ApproxQuantileAggregate<int8_t> >("approx_quantile", TypeLibrary::getType(TID_INT8)));
+    addAggregate(make_shared<ApproxQuantileAggregate<int16_t> >("approx_quantile", TypeLibrary::getType(TID_INT16)));
+    addAggregate(make_shared<ApproxQuantileAggregate<int32_t> >("approx_quantile", TypeLibrary::getType(TID_INT32)));
+    addAggregate(make_shared<ApproxQuantileAggregate<int64_t> >("approx_quantile", TypeLibrary::getType(TID_INT64)));
+    addAggregate(make_shared<ApproxQuantileAggregate<uint8_t> >("approx_quantile", TypeLibrary::getType(TID_UINT8)));
+    addAggregate(make_shared<ApproxQuantileAggregate<uint16_t> >("approx_quantile", TypeLibrary::getType(TID_UINT16)));
+    addAggregate(make_shared<ApproxQuantileAggregate<uint32_t> >("approx_quantile", TypeLibrary::getType(TID_UINT32)));
+    addAggregate(make_shared<ApproxQuantileAggregate<uint64_t> >("approx_quantile", TypeLibrary::getType(TID_UINT64)));
+    addAggregate(make_shared<ApproxQuantileAggregate<float> >("approx_quantile", TypeLibrary::getType(TID_FLOAT)));
+    addAggregate(make_shared<ApproxQuantileAggregate<double> >("approx_quantile", TypeLibrary::getType(TID_DOUBLE)));
+
+    /** APPROX_TOPK **/
+    addAggregate(make_shared<ApproxTopKAggregate>("approx_topk", TypeLibrary::getType(TID_VOID)));
 }
 
 } // namespace scidb
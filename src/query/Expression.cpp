@@ -467,6 +467,8 @@ Expression::internalCompile(std::shared_ptr<LogicalExpression> expr,
         _eargs.resize(_props.size());
         _eargs[resultIndex] = tile ? makeTileConstant(e->getType(),e->getValue()) : e->getValue();
         _props[resultIndex].isConst = true;
+        _props[resultIndex].parameter = e->getParameter();
+        _props[resultIndex].parameterType = e->getType();
         assert(_props[resultIndex].type != TID_VOID || e->getValue().isNull());
         _nullable |= e->getValue().isNull();
     }
@@ -643,6 +645,34 @@ void Expression::insertConverter(TypeId newType, FunctionPointer converter,
     _eargs[resultIndex] = val;
 }
 
+void Expression::bindParameters(const std::map<std::string, Value>& bindings)
+{
+    assert(_compiled);
+    for (size_t i = 0; i < _props.size(); i++)
+    {
+        const ArgProp& prop = _props[i];
+        if (prop.parameter.empty()) {
+            continue;
+        }
+        std::map<std::string, Value>::const_iterator binding = bindings.find(prop.parameter);
+        if (binding == bindings.end()) {
+            continue;
+        }
+        assert(prop.isConst);
+        Value value = binding->second;
+        if (prop.type != prop.parameterType) {
+            // the compiler converted the literal in place, do the same with the new value
+            FunctionPointer converter =
+                FunctionLibrary::getInstance()->findConverter(prop.parameterType, prop.type, false);
+            Value converted(TypeLibrary::getType(prop.type));
+            const Value* v = &value;
+            converter(&v, &converted, NULL);
+            value = converted;
+        }
+        _eargs[i] = _tileMode ? makeTileConstant(prop.type, value) : value;
+    }
+}
+
 void Expression::toString (std::ostream &out, int indent) const
 {
     Indent prefix(indent);
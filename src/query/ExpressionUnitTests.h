@@ -81,6 +81,7 @@ CPPUNIT_TEST(evlAPlusB);
 CPPUNIT_TEST(evlIsNull);
 CPPUNIT_TEST(evlMissingReason);
 CPPUNIT_TEST(evlStrPlusNull);
+CPPUNIT_TEST(evlBindParameters);
 CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -697,6 +698,46 @@ public:
         CPPUNIT_ASSERT(e.getType() == TID_STRING);
         CPPUNIT_ASSERT(e.evaluate().isNull());
     }
+
+    void evlBindParameters()
+    {
+        // $p + 0.5, with $p bound to an integer which gets converted to double at compile time
+        std::shared_ptr<ParsingContext> context;
+        Value p(TypeLibrary::getType(TID_INT64));
+        p.setInt64(5);
+        Value half(TypeLibrary::getType(TID_DOUBLE));
+        half.setDouble(0.5);
+        std::vector<std::shared_ptr<LogicalExpression> > args;
+        args.push_back(std::make_shared<Constant>(context, p, TID_INT64, "p"));
+        args.push_back(std::make_shared<Constant>(context, half, TID_DOUBLE));
+        std::shared_ptr<LogicalExpression> le = std::make_shared<Function>(context, "+", args);
+
+        Expression e;
+        std::shared_ptr<scidb::Query> emptyQuery;
+        e.compile(le, emptyQuery, false);
+        CPPUNIT_ASSERT(e.getType() == TID_DOUBLE);
+        CPPUNIT_ASSERT(e.evaluate().getDouble() == 5.5);
+
+        // the parameter slot survives serialization
+        std::stringstream ss;
+        boost::archive::text_oarchive oa(ss);
+        oa & e;
+        Expression r;
+        boost::archive::text_iarchive ia(ss);
+        ia & r;
+
+        std::map<std::string, Value> bindings;
+        Value q(TypeLibrary::getType(TID_INT64));
+        q.setInt64(-2);
+        bindings["q"] = q;
+        r.bindParameters(bindings);
+        CPPUNIT_ASSERT(r.evaluate().getDouble() == 5.5);
+
+        p.setInt64(7);
+        bindings["p"] = p;
+        r.bindParameters(bindings);
+        CPPUNIT_ASSERT(r.evaluate().getDouble() == 7.5);
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ExpressionTests);
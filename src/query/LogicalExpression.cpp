@@ -62,7 +62,11 @@ void Constant::toString(std::ostream &out, int indent) const
     Indent prefix(indent);
     out << prefix(' ', false);
     out << "[constant] type " << _type;
-    out <<" value "<< _value.toString(_type) << "\n";
+    out <<" value "<< _value.toString(_type);
+    if (!_parameter.empty()) {
+        out << " parameter $" << _parameter;
+    }
+    out << "\n";
 }
 
 void Function::toString(std::ostream &out, int indent) const
@@ -182,6 +182,17 @@ void OperatorParamAggregateCall::toString(std::ostream &out, int indent) const
     out <<"input: ";
     _inputAttribute->toString(out);
 
+    if (_parameters.size())
+    {
+        out << prefix(' ');
+        out << "parameters";
+        for (size_t i = 0; i < _parameters.size(); ++i)
+        {
+            out << " " << _parameters[i];
+        }
+        out << "\n";
+    }
+
     if (_alias.size() )
     {
         out << prefix(' ');
@@ -845,6 +856,8 @@ bool operator== (RedistributeContext const& lhs, RedistributeContext const& rhs)
 {
     return lhs._partitioningSchema == rhs._partitioningSchema &&
            (lhs._partitioningSchema != psLocalInstance || lhs._instanceId == rhs._instanceId) &&
+           (!lhs.hasPartitioningDimension() ||
+            (lhs._psDimension == rhs._psDimension && lhs._psBlock == rhs._psBlock)) &&
            ((!lhs.hasMapper() && !rhs.hasMapper()) || ( lhs.hasMapper() && rhs.hasMapper() && *lhs._distMapper.get() == *rhs._distMapper.get()));
 }
 
@@ -868,6 +881,10 @@ std::ostream& operator<<(std::ostream& stream, const RedistributeContext& dist)
                                 break;
         case psScaLAPACK:       stream<<"ScaLAPACK";
                                 break;
+        case psRangePartitioned: stream<<"rnge";
+                                break;
+        case psCoPartitioned:   stream<<"copa";
+                                break;
     default:
             assert(0);
             throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_UNREACHABLE_CODE) << "operator<<(std::ostream& stream, const RedistributeContext& dist)";
@@ -877,6 +894,10 @@ std::ostream& operator<<(std::ostream& stream, const RedistributeContext& dist)
     {
         stream<<" instance "<<dist._instanceId;
     }
+    if (dist.hasPartitioningDimension())
+    {
+        stream<<" dimension "<<dist._psDimension<<" block "<<dist._psBlock;
+    }
     if (dist._distMapper.get() != NULL)
     {
         stream<<" "<<*dist._distMapper;
@@ -1061,6 +1082,19 @@ InstanceID getInstanceForChunk(std::shared_ptr<Query> const& query,
         }
         break;
     }
+    case psRangePartitioned:
+    case psCoPartitioned:
+    {
+        // persistable, but the placement is parameterized by the target array,
+        // which need not be partitioned the same way as desc
+        PartitioningSchemaDataForDimension* dimData = dynamic_cast<PartitioningSchemaDataForDimension*>(psData);
+        if (dimData == NULL || dimData->getID() != ps) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_REDISTRIBUTE_ERROR);
+        }
+        destInstanceId = getPrimaryInstanceForChunk(ps, *chunkPosition, dims, instanceCount,
+                                                    dimData->getDimension(), dimData->getBlock());
+        break;
+    }
     case psReplication:
         ASSERT_EXCEPTION(false, "getInstanceForChunk: internal error: psReplication should not reach this switch statement");
     case psUndefined:
@@ -1185,6 +1219,7 @@ AggregatePtr resolveAggregate(std::shared_ptr <OperatorParamAggregateCall>const&
         if (PARAM_ASTERISK == acParam->getParamType())
         {
             AggregatePtr agg = AggregateLibrary::getInstance()->createAggregate( aggregateCall->getAggregateName(), TypeLibrary::getType(TID_VOID));
+            agg->setParameters(aggregateCall->getParameters());
 
             if (inputAttributeID)
             {
@@ -1203,6 +1238,7 @@ AggregatePtr resolveAggregate(std::shared_ptr <OperatorParamAggregateCall>const&
             AttributeDesc const& inputAttr = inputAttributes[ref->getObjectNo()];
             Type const& inputType = TypeLibrary::getType(inputAttr.getType());
             AggregatePtr agg = AggregateLibrary::getInstance()->createAggregate( aggregateCall->getAggregateName(), inputType);
+            agg->setParameters(aggregateCall->getParameters());
 
             if (inputAttributeID)
             {
@@ -1222,7 +1258,8 @@ AggregatePtr resolveAggregate(std::shared_ptr <OperatorParamAggregateCall>const&
     }
     catch(const UserException &e)
     {
-        if (SCIDB_LE_AGGREGATE_NOT_FOUND == e.getLongErrorCode())
+        if (SCIDB_LE_AGGREGATE_NOT_FOUND == e.getLongErrorCode() ||
+            SCIDB_LE_WRONG_AGGREGATE_PARAMETERS == e.getLongErrorCode())
         {
             throw CONV_TO_USER_QUERY_EXCEPTION(e, acParam->getParsingContext());
         }
@@ -1571,50 +1608,97 @@ PhysicalOperator::assertLastVersion(std::string const& arrayName,
     }
 }
 
+ChunkMorsels::ChunkMorsels(std::shared_ptr<Array> const& input, size_t morselSize)
+: _iterator(input->getConstIterator(0)),
+  _morselSize(morselSize)
+{
+    assert(input->getSupportedAccess() == Array::RANDOM);
+    assert(morselSize > 0);
+}
+
+bool ChunkMorsels::next(std::vector<Coordinates>& positions)
+{
+    positions.clear();
+    ScopedMutexLock cs(_mutex);
+    for (; positions.size() < _morselSize && !_iterator->end(); ++(*_iterator))
+    {
+        positions.push_back(_iterator->getPosition());
+    }
+    return !positions.empty();
+}
+
+size_t ChunkMorsels::getNumberOfJobs(Array const& input)
+{
+    if (input.getSupportedAccess() != Array::RANDOM ||
+        Config::getInstance()->getOption<int>(CONFIG_STORE_MORSEL_SIZE) <= 0) {
+        return 1;
+    }
+    int nThreads = Config::getInstance()->getOption<int>(CONFIG_RESULT_PREFETCH_THREADS);
+    return nThreads > 1 ? nThreads : 1;
+}
+
 void StoreJob::run()
 {
-    ArrayDesc const& dstArrayDesc = _dstArray->getArrayDesc();
-    size_t nAttrs = dstArrayDesc.getAttributes().size();
     Query::setCurrentQueryID(_query->getQueryID());
 
-    for (size_t i = _shift; i != 0 && !_srcArrayIterators[0]->end(); --i)
+    if (!_morsels)
     {
-        for (size_t j = 0; j < nAttrs; j++)
+        while (!_srcArrayIterators[0]->end())
         {
-            ++(*_srcArrayIterators[j]);
+            storeChunks();
+            for (size_t i = 0; i < _srcArrayIterators.size(); i++)
+            {
+                ++(*_srcArrayIterators[i]);
+            }
         }
+        return;
     }
 
-    while (!_srcArrayIterators[0]->end())
+    std::vector<Coordinates> positions;
+    while (_morsels->next(positions))
     {
-        bool chunkHasElems(true);
-        for (size_t i = 0; i < nAttrs; i++)
+        for (size_t p = 0; p < positions.size(); p++)
         {
-            ConstChunk const& srcChunk = _srcArrayIterators[i]->getChunk();
-            Coordinates srcPos = _srcArrayIterators[i]->getPosition();
-            if (!dstArrayDesc.contains(srcPos)) {
-                throw USER_EXCEPTION(SCIDB_SE_OPERATOR, SCIDB_LE_CHUNK_OUT_OF_BOUNDARIES)
-                    << CoordsToStr(srcPos) << dstArrayDesc.getDimensions();
-            }
-            if (i==0) {
-                chunkHasElems = hasValues(srcChunk);
-                if (chunkHasElems) {
-                    createdChunks.insert(_srcArrayIterators[0]->getPosition());
+            for (size_t i = 0; i < _srcArrayIterators.size(); i++)
+            {
+                if (!_srcArrayIterators[i]->setPosition(positions[p])) {
+                    throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
                 }
-            } else {
-                assert(chunkHasElems == hasValues(srcChunk));
             }
+            storeChunks();
+        }
+    }
+}
+
+void StoreJob::storeChunks()
+{
+    ArrayDesc const& dstArrayDesc = _dstArray->getArrayDesc();
+    size_t nAttrs = dstArrayDesc.getAttributes().size();
+    bool chunkHasElems(true);
+    for (size_t i = 0; i < nAttrs; i++)
+    {
+        ConstChunk const& srcChunk = _srcArrayIterators[i]->getChunk();
+        Coordinates srcPos = _srcArrayIterators[i]->getPosition();
+        if (!dstArrayDesc.contains(srcPos)) {
+            throw USER_EXCEPTION(SCIDB_SE_OPERATOR, SCIDB_LE_CHUNK_OUT_OF_BOUNDARIES)
+                << CoordsToStr(srcPos) << dstArrayDesc.getDimensions();
+        }
+        if (i==0) {
+            chunkHasElems = hasValues(srcChunk);
             if (chunkHasElems) {
-                if (i == nAttrs - 1)
-                {
-                    bounds.updateFromChunk(&srcChunk, dstArrayDesc.getEmptyBitmapAttribute() == NULL);
-                }
-                _dstArrayIterators[i]->copyChunk(srcChunk);
+                createdChunks.insert(srcPos);
+            }
+        } else {
+            assert(chunkHasElems == hasValues(srcChunk));
+        }
+        if (chunkHasElems) {
+            if (i == nAttrs - 1)
+            {
+                bounds.updateFromChunk(&srcChunk, dstArrayDesc.getEmptyBitmapAttribute() == NULL);
             }
-            Query::validateQueryPtr(_query);
-            for (size_t j = _step; j != 0 && !_srcArrayIterators[i]->end(); ++(*_srcArrayIterators[i]), --j)
-                ;
+            _dstArrayIterators[i]->copyChunk(srcChunk);
         }
+        Query::validateQueryPtr(_query);
     }
 }
 
@@ -1748,13 +1832,18 @@ void PhysicalUpdate::preSingleExecute(std::shared_ptr<Query> query)
                         _unversionedSchema.getAttributes(),
                         _unversionedSchema.getDimensions(),
                         _unversionedSchema.getPartitioningSchema());
+    _schema.setPartitioningDimension(_unversionedSchema.getPartitioningDimension(),
+                                     _unversionedSchema.getPartitioningBlock());
 
     BOOST_FOREACH (DimensionDesc& d, _schema.getDimensions())
     {
         d.setCurrStart(CoordinateBounds::getMax());
         d.setCurrEnd(CoordinateBounds::getMin());
     }
-    SCIDB_ASSERT(_schema.getPartitioningSchema() == defaultPartitioning());
+    SCIDB_ASSERT(_schema.getPartitioningSchema() == defaultPartitioning() ||
+                 _schema.getPartitioningSchema() == psReplication ||
+                 _schema.getPartitioningSchema() == psRangePartitioned ||
+                 _schema.getPartitioningSchema() == psCoPartitioned);
 
     _arrayID = catalog->getNextArrayId();
 
@@ -0,0 +1,241 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file PlanCache.cpp
+ *
+ * @brief Bind parameters of prepared queries and the cache of their physical plans.
+ */
+
+#include <algorithm>
+#include <errno.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <ctype.h>
+#include <sstream>
+#include <log4cxx/logger.h>
+
+#include <query/PlanCache.h>
+#include <system/Config.h>
+#include <system/SciDBConfigOptions.h>
+#include <system/Exceptions.h>
+
+using namespace std;
+
+namespace scidb
+{
+
+static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("scidb.qproc.plancache"));
+
+Value parseQueryParameter(const string& name, const string& text, TypeId& type)
+{
+    if (!strcasecmp(text.c_str(), "null")) {
+        type = TID_VOID;
+        Value value;
+        value.setNull();
+        return value;
+    }
+
+    if (!strcasecmp(text.c_str(), "true") || !strcasecmp(text.c_str(), "false")) {
+        type = TID_BOOL;
+        Value value(TypeLibrary::getType(TID_BOOL));
+        value.setBool(!strcasecmp(text.c_str(), "true"));
+        return value;
+    }
+
+    if (text.size() >= 2 && text[0] == '\'' && text[text.size() - 1] == '\'') {
+        string s;
+        bool escaped = false;
+        for (size_t i = 1; i + 1 < text.size(); ++i) {
+            const char c = text[i];
+            if (escaped) {
+                s += c;
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '\'') {
+                throw USER_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_WRONG_QUERY_PARAMETER) << name << text;
+            } else {
+                s += c;
+            }
+        }
+        if (escaped) {
+            throw USER_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_WRONG_QUERY_PARAMETER) << name << text;
+        }
+        type = TID_STRING;
+        Value value(TypeLibrary::getType(TID_STRING));
+        value.setString(s);
+        return value;
+    }
+
+    if (!text.empty() && !isspace(text[0])) {
+        char* end = NULL;
+        errno = 0;
+        const long long i = strtoll(text.c_str(), &end, 10);
+        if (*end == '\0' && errno == 0) {
+            type = TID_INT64;
+            Value value(TypeLibrary::getType(TID_INT64));
+            value.setInt64(i);
+            return value;
+        }
+        errno = 0;
+        const double d = strtod(text.c_str(), &end);
+        if (*end == '\0' && errno == 0) {
+            type = TID_DOUBLE;
+            Value value(TypeLibrary::getType(TID_DOUBLE));
+            value.setDouble(d);
+            return value;
+        }
+    }
+
+    throw USER_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_WRONG_QUERY_PARAMETER) << name << text;
+}
+
+/// Append the query text with every run of white space outside of string literals replaced by one blank
+static void appendNormalizedText(ostream& out, const string& text)
+{
+    bool quoted = false;
+    bool escaped = false;
+    bool blank = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (quoted) {
+            out << c;
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '\'') {
+                quoted = false;
+            }
+        } else if (isspace(c)) {
+            blank = true;
+        } else {
+            if (blank) {
+                out << ' ';
+                blank = false;
+            }
+            out << c;
+            quoted = (c == '\'');
+        }
+    }
+}
+
+static void appendSchemas(ostream& out, const std::shared_ptr<LogicalQueryPlanNode>& node)
+{
+    vector<std::shared_ptr<LogicalQueryPlanNode> >& children = node->getChildren();
+    for (size_t i = 0; i < children.size(); ++i) {
+        appendSchemas(out, children[i]);
+    }
+    const std::shared_ptr<LogicalOperator>& op = node->getLogicalOperator();
+    out << op->getLogicalName() << ' ' << op->getSchema() << '\n';
+}
+
+string PlanCache::makeKey(const std::shared_ptr<Query>& query, bool afl)
+{
+    if (Config::getInstance()->getOption<int>(CONFIG_PLAN_CACHE_SIZE) <= 0) {
+        return string();
+    }
+    std::shared_ptr<LogicalQueryPlanNode> root = query->logicalPlan->getRoot();
+    if (!root || root->isDdl()) {
+        return string();
+    }
+
+    stringstream key;
+    key << (afl ? "AFL " : "AQL ");
+    appendNormalizedText(key, query->queryString);
+    key << '\n';
+
+    for (QueryParameters::const_iterator i = query->parameters.begin(); i != query->parameters.end(); ++i) {
+        TypeId type;
+        parseQueryParameter(i->first, i->second, type);
+        key << '$' << i->first << ' ' << type << '\n';
+    }
+
+    // arrays are only ever read, and at the latest versions known to the catalog
+    const SystemCatalog::QueryLocks locks = query->getRequestedLocks();
+    for (SystemCatalog::QueryLocks::const_iterator i = locks.begin(); i != locks.end(); ++i) {
+        if ((*i)->getLockMode() != SystemCatalog::LockDesc::RD) {
+            return string();
+        }
+        key << (*i)->getArrayName() << ' ' << (*i)->getArrayCatalogId() << '\n';
+    }
+
+    appendSchemas(key, root);
+
+    key << "view " << query->getCoordinatorLiveness()->getViewId()
+        << " instances " << query->getInstancesCount();
+    return key.str();
+}
+
+bool PlanCache::lookup(const string& key, string& plan, string& distributions)
+{
+    ScopedMutexLock cs(_mutex);
+    unordered_map<string, Entry>::const_iterator i = _entries.find(key);
+    if (i == _entries.end()) {
+        return false;
+    }
+    _lru.touch(key);
+    plan = i->second.plan;
+    distributions = i->second.distributions;
+    return true;
+}
+
+void PlanCache::insert(const string& key, const string& plan, const string& distributions)
+{
+    assert(!key.empty());
+    const int capacity = Config::getInstance()->getOption<int>(CONFIG_PLAN_CACHE_SIZE);
+
+    ScopedMutexLock cs(_mutex);
+    Entry& entry = _entries[key];
+    entry.plan = plan;
+    entry.distributions = distributions;
+    _lru.touch(key);
+
+    string victim;
+    while (_lru.size() > static_cast<size_t>(std::max(capacity, 0)) && _lru.pop(victim)) {
+        _entries.erase(victim);
+    }
+    LOG4CXX_TRACE(logger, "PlanCache::insert: " << _entries.size() << " plans cached");
+}
+
+static void appendDistributions(ostream& out,
+                                const std::shared_ptr<PhysicalQueryPlanNode>& node,
+                                const std::shared_ptr<Query>& query)
+{
+    vector<std::shared_ptr<PhysicalQueryPlanNode> >& children = node->getChildren();
+    for (size_t i = 0; i < children.size(); ++i) {
+        appendDistributions(out, children[i], query);
+    }
+    node->getPhysicalOperator()->setQuery(query);
+    out << node->getPhysicalOperator()->getPhysicalName() << ' ' << node->inferDistribution() << '\n';
+}
+
+string PlanCache::getDistributions(const std::shared_ptr<PhysicalQueryPlanNode>& root,
+                                   const std::shared_ptr<Query>& query)
+{
+    stringstream out;
+    appendDistributions(out, root, query);
+    return out.str();
+}
+
+} // namespace scidb
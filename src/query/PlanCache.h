@@ -0,0 +1,124 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file PlanCache.h
+ *
+ * @brief Bind parameters of prepared queries and the cache of their physical plans.
+ *
+ * A query may refer to values supplied with it as $name (see SciDB::prepareQuery()).
+ * The translator turns such references into constants tagged with the parameter name,
+ * and the compiled expressions remember where the tagged constants went, so a physical
+ * plan built for one set of values can be rebound to another one (Expression::bindParameters()).
+ *
+ * The coordinator keeps the serialized physical plans of read-only queries in an LRU cache
+ * keyed by the normalized query text, the parameter types, the catalog versions of
+ * the locked arrays, the inferred logical schemas and the cluster membership.
+ * A query with a matching key skips the optimizer and executes the cached plan with its own
+ * parameter values.
+ */
+
+#ifndef PLAN_CACHE_H_
+#define PLAN_CACHE_H_
+
+#include <string>
+#include <unordered_map>
+
+#include <query/QueryProcessor.h>
+#include <util/Lru.h>
+#include <util/Mutex.h>
+#include <util/Singleton.h>
+
+namespace scidb
+{
+
+/**
+ * Parse the value of a bind parameter.
+ * @param name the parameter name, for error reporting
+ * @param text an AFL literal: null, true, false, a single-quoted string, an integer or a real number
+ * @param[out] type the type of the literal; TID_VOID for null
+ * @return the value of the literal
+ * @throw USER_EXCEPTION SCIDB_LE_WRONG_QUERY_PARAMETER if the text is not a literal
+ */
+Value parseQueryParameter(const std::string& name, const std::string& text, TypeId& type);
+
+/**
+ * The cache of the physical plans of prepared queries.
+ * All the methods are thread-safe.
+ */
+class PlanCache : public Singleton<PlanCache>
+{
+public:
+    /**
+     * Compute the key under which the physical plan of a query is cached.
+     * Must be called on the coordinator once the types of the logical plan are inferred
+     * under the acquired array locks.
+     * @param query the prepared query
+     * @param afl true for an AFL query, false for AQL
+     * @return the key, or an empty string if the plan of the query may not be cached:
+     * the cache is disabled, or the query is DDL or updates some array
+     */
+    std::string makeKey(const std::shared_ptr<Query>& query, bool afl);
+
+    /**
+     * @param key a key produced by makeKey()
+     * @param[out] plan the serialized physical plan
+     * @param[out] distributions the distributions of the plan nodes, see getDistributions()
+     * @return true if the plan was found
+     */
+    bool lookup(const std::string& key, std::string& plan, std::string& distributions);
+
+    /**
+     * Remember a physical plan, evicting the least recently used one if the cache is full.
+     * @param key a key produced by makeKey()
+     * @param plan the serialized physical plan
+     * @param distributions the distributions of the plan nodes, see getDistributions()
+     */
+    void insert(const std::string& key, const std::string& plan, const std::string& distributions);
+
+    /**
+     * Infer the distributions of the nodes of a physical plan bottom-up and describe them.
+     * Some operators derive their output distribution from parameter values (e.g. the offset
+     * of subarray()), so a rebound plan is only valid if its description matches the one
+     * of the plan the optimizer built.
+     * @param root the root of the physical plan
+     * @param query the query executing the plan
+     * @return the description
+     */
+    static std::string getDistributions(const std::shared_ptr<PhysicalQueryPlanNode>& root,
+                                        const std::shared_ptr<Query>& query);
+
+private:
+    struct Entry
+    {
+        std::string plan;
+        std::string distributions;
+    };
+
+    Mutex _mutex;
+    LRU<std::string> _lru;
+    std::unordered_map<std::string, Entry> _entries;
+};
+
+} // namespace scidb
+
+#endif /* PLAN_CACHE_H_ */
@@ -382,7 +382,7 @@ PullSGArray::getChunk(size_t stream, AttributeID attId, const Coordinates& posit
     assert(chunk);
 
     std::shared_ptr<MessageDesc> chunkDesc;
-    std::shared_ptr<CompressedBuffer> compressedBuffer;
+    std::shared_ptr<SharedBuffer> chunkBuffer;
     {
         ScopedMutexLock lock(_sMutexes[stream % _sMutexes.size()]);
 
@@ -397,8 +397,8 @@ PullSGArray::getChunk(size_t stream, AttributeID attId, const Coordinates& posit
             assert(chunkDesc);
             assert(!chunkDesc->getRecord<scidb_msg::Chunk>()->eof());
 
-            compressedBuffer = dynamic_pointer_cast<CompressedBuffer>(chunkDesc->getBinary());
-            assert(compressedBuffer);
+            chunkBuffer = chunkDesc->getBinary();
+            assert(chunkBuffer);
             {
                 ScopedMutexLock cLock(_aMutexes[attId % _aMutexes.size()]);
                 if (isDebug()) { --_cachedChunks[attId]; }
@@ -440,7 +440,7 @@ PullSGArray::getChunk(size_t stream, AttributeID attId, const Coordinates& posit
     {
         LOG4CXX_TRACE(_logger, funcName << "found next chunk message stream="<<stream<<", attId="<<attId);
         assert(chunk != NULL);
-        ASSERT_EXCEPTION(compressedBuffer.get()!=nullptr, funcName);
+        ASSERT_EXCEPTION(chunkBuffer.get()!=nullptr, funcName);
 
         const int compMethod = chunkMsg->compression_method();
         const size_t decompressedSize = chunkMsg->decompressed_size();
@@ -454,9 +454,19 @@ PullSGArray::getChunk(size_t stream, AttributeID attId, const Coordinates& posit
         chunk->initialize(this, &desc, firstElem, compMethod);
         chunk->setCount(chunkMsg->count());
 
-        compressedBuffer->setCompressionMethod(compMethod);
-        compressedBuffer->setDecompressedSize(decompressedSize);
-        chunk->decompress(*compressedBuffer); //XXX TODO: avoid data copy
+        std::shared_ptr<LocalChunkBuffer> localBuffer = dynamic_pointer_cast<LocalChunkBuffer>(chunkBuffer);
+        if (localBuffer) {
+            // scattered by this instance: take the uncompressed data over
+            assert(localBuffer->getSize() == decompressedSize);
+            chunk->swapData(localBuffer->getChunk());
+        } else {
+            std::shared_ptr<CompressedBuffer> compressedBuffer =
+                dynamic_pointer_cast<CompressedBuffer>(chunkBuffer);
+            ASSERT_EXCEPTION(compressedBuffer.get()!=nullptr, funcName);
+            compressedBuffer->setCompressionMethod(compMethod);
+            compressedBuffer->setDecompressedSize(decompressedSize);
+            chunk->decompress(*compressedBuffer); //XXX TODO: avoid data copy
+        }
         assert(chunkMsg->dest_instance() == getLocalStream());
         if (!isSerialized()) {
             // When the input array is "serialized",
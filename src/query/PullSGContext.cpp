@@ -33,7 +33,10 @@
 #include <log4cxx/logger.h>
 
 #include <system/Config.h>
+#include <system/SciDBConfigOptions.h>
 #include <query/PullSGContext.h>
+#include <query/Statistics.h>
+#include <util/Counter.h>
 
 using namespace std;
 using namespace boost;
@@ -57,7 +60,12 @@ PullSGContext::PullSGContext(const std::shared_ptr<Array>& source,
     _attributeIterators(result->getArrayDesc().getAttributes().size()),
     _attributeStates(result->getArrayDesc().getAttributes().size()),
     _perAttributeMaxSize(64),
-    _hasDataIntegrityIssue(false)
+    _hasDataIntegrityIssue(false),
+    _isLocalBypass(Config::getInstance()->getOption<bool>(CONFIG_SG_LOCAL_BYPASS)),
+    _localSize(0),
+    _localChunks(0),
+    _remoteSize(0),
+    _remoteChunks(0)
 {
     assert(source);
     assert(result);
@@ -72,6 +80,16 @@ PullSGContext::PullSGContext(const std::shared_ptr<Array>& source,
     if (cacheSizePerAttribute>0) { _perAttributeMaxSize = cacheSizePerAttribute; }
 }
 
+PullSGContext::~PullSGContext()
+{
+    LOG4CXX_DEBUG(logger, "PullSGContext::~PullSGContext: "
+                  << "local chunks=" << _localChunks << ", local bytes=" << _localSize
+                  << ", remote chunks=" << _remoteChunks << ", remote bytes=" << _remoteSize);
+    // reported by list('counters')
+    CounterState::getInstance()->add(CounterState::SGLocalChunkBytes, _localSize);
+    CounterState::getInstance()->add(CounterState::SGRemoteChunkBytes, _remoteSize);
+}
+
 bool
 PullSGContext::hasValues(ConstChunk const& chunk)
 {
@@ -305,12 +323,17 @@ PullSGContext::drainInputArray(std::shared_ptr<ConstArrayIterator>& inputArrIter
         std::shared_ptr<CompressedBuffer> buffer;
         for (; destInstance < maxDest; ++destInstance) {
             // Cache the next chunk
-            std::shared_ptr<MessageDesc> chunkMsg = getChunkMesg(query->getQueryID(),
-                                                            attrId, destInstance,
-                                                            chunk, chunkPosition,
-                                                            buffer);
-            assert(buffer);
-            assert(buffer->getData());
+            std::shared_ptr<MessageDesc> chunkMsg;
+            if (_isLocalBypass && destInstance == query->getInstanceID()) {
+                chunkMsg = getLocalChunkMesg(query->getQueryID(), attrId, destInstance, chunk);
+            } else {
+                chunkMsg = getChunkMesg(query->getQueryID(),
+                                        attrId, destInstance,
+                                        chunk, chunkPosition,
+                                        buffer);
+                assert(buffer);
+                assert(buffer->getData());
+            }
             InstanceState& destState = _instanceStates[attrId][destInstance];
             destState._chunks.push_back(chunkMsg);
         }
@@ -594,22 +617,80 @@ PullSGContext::getChunkMesg(const QueryID queryId,
 {
     if (!buffer) {
         buffer = std::make_shared<CompressedBuffer>();
-        std::shared_ptr<ConstRLEEmptyBitmap> emptyBitmap;
-
-        if (_inputSGArray->getArrayDesc().getEmptyBitmapAttribute() != NULL &&
-            !chunk.getAttributeDesc().isEmptyIndicator()) {
-            emptyBitmap = chunk.getEmptyBitmap();
-            if (isDebug() && _isEmptyable) {
-                verifyPositions(chunk, emptyBitmap);
-            }
-        }
+        std::shared_ptr<ConstRLEEmptyBitmap> emptyBitmap = getClosureBitmap(chunk);
         chunk.compress(*buffer, emptyBitmap); //XXX TODO: avoid data copy
         emptyBitmap.reset(); // the bitmask must be cleared before the iterator is advanced (bug?)
     }
+    _remoteSize += buffer->getSize();
+    ++_remoteChunks;
+    currentStatistics->remoteChunkSize += buffer->getSize();
+    currentStatistics->remoteChunks++;
+    return makeChunkMesg(queryId, attributeId, destSGInstance, chunk, buffer,
+                         buffer->getCompressionMethod(), buffer->getDecompressedSize());
+}
+
+std::shared_ptr<MessageDesc>
+PullSGContext::getLocalChunkMesg(const QueryID queryId,
+                                 const AttributeID attributeId,
+                                 const InstanceID destSGInstance,
+                                 const ConstChunk& chunk)
+{
+    // The input iterator moves on once the chunk is cached, so the chunk data is copied once,
+    // in the form the receiving side would have decompressed it to
+    std::shared_ptr<MemChunk> localChunk = std::make_shared<MemChunk>();
+    std::shared_ptr<ConstRLEEmptyBitmap> emptyBitmap = getClosureBitmap(chunk);
+    ConstChunk const* src = chunk.materialize();
+    localChunk->initialize(chunk);
+    if (emptyBitmap && src->getBitmapSize() == 0) {
+        src->makeClosure(*localChunk, emptyBitmap);
+    } else {
+        PinBuffer scope(*src);
+        size_t size = src->getSize();
+        if (!emptyBitmap) {
+            size -= src->getBitmapSize();
+        }
+        localChunk->allocate(size);
+        memcpy(localChunk->getData(), src->getData(), size);
+    }
+    emptyBitmap.reset();
+
+    const size_t size = localChunk->getSize();
+    _localSize += size;
+    ++_localChunks;
+    currentStatistics->localChunkSize += size;
+    currentStatistics->localChunks++;
+    return makeChunkMesg(queryId, attributeId, destSGInstance, chunk,
+                         std::make_shared<LocalChunkBuffer>(localChunk),
+                         chunk.getCompressionMethod(), size);
+}
+
+std::shared_ptr<ConstRLEEmptyBitmap>
+PullSGContext::getClosureBitmap(ConstChunk const& chunk)
+{
+    std::shared_ptr<ConstRLEEmptyBitmap> emptyBitmap;
+    if (_inputSGArray->getArrayDesc().getEmptyBitmapAttribute() != NULL &&
+        !chunk.getAttributeDesc().isEmptyIndicator()) {
+        emptyBitmap = chunk.getEmptyBitmap();
+        if (isDebug() && _isEmptyable) {
+            verifyPositions(chunk, emptyBitmap);
+        }
+    }
+    return emptyBitmap;
+}
+
+std::shared_ptr<MessageDesc>
+PullSGContext::makeChunkMesg(const QueryID queryId,
+                             const AttributeID attributeId,
+                             const InstanceID destSGInstance,
+                             const ConstChunk& chunk,
+                             const std::shared_ptr<SharedBuffer>& buffer,
+                             const int compressionMethod,
+                             const size_t decompressedSize)
+{
     std::shared_ptr<MessageDesc> chunkMsg = std::make_shared<MessageDesc>(mtRemoteChunk, buffer);
     std::shared_ptr<scidb_msg::Chunk> chunkRecord = chunkMsg->getRecord<scidb_msg::Chunk>();
-    chunkRecord->set_compression_method(buffer->getCompressionMethod());
-    chunkRecord->set_decompressed_size(buffer->getDecompressedSize());
+    chunkRecord->set_compression_method(compressionMethod);
+    chunkRecord->set_decompressed_size(decompressedSize);
     chunkRecord->set_count(chunk.isCountKnown() ? chunk.count() : 0);
     const Coordinates& coordinates = chunk.getFirstPosition(false);
     for (size_t i = 0, n = coordinates.size(); i< n; ++i) {
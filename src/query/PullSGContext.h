@@ -54,6 +54,49 @@ namespace scidb
  * the pull-based redistribute() (i.e. the Scatter side)
  * @see scidb::PullSGArray for the data consumer side (i.e. the Gather side)
  */
+/**
+ * The payload of a chunk message the SG sends to its own instance:
+ * the uncompressed chunk, which the receiving PullSGArray takes over by pointer
+ * instead of decompressing a copy of it.
+ */
+class LocalChunkBuffer : public SharedBuffer
+{
+private:
+    std::shared_ptr<MemChunk> _chunk;
+
+public:
+    explicit LocalChunkBuffer(std::shared_ptr<MemChunk> const& chunk)
+    : _chunk(chunk)
+    {
+        assert(_chunk);
+    }
+
+    virtual void* getData() const
+    {
+        return _chunk->getData();
+    }
+
+    virtual size_t getSize() const
+    {
+        return _chunk->getSize();
+    }
+
+    virtual bool pin() const
+    {
+        return false;
+    }
+
+    virtual void unPin() const
+    {
+    }
+
+    /// @return the chunk carried by this buffer
+    MemChunk& getChunk()
+    {
+        return *_chunk;
+    }
+};
+
 class PullSGContext : virtual public Query::OperatorContext
 {
 private:
@@ -97,6 +140,15 @@ private:
     /// true if a data integrity issue has been found
     bool _hasDataIntegrityIssue;
 
+    /// true if the chunks for this instance are handed over uncompressed
+    bool _isLocalBypass;
+
+    // The bytes and numbers of chunks scattered to this instance and to the other instances
+    uint64_t _localSize;
+    uint64_t _localChunks;
+    uint64_t _remoteSize;
+    uint64_t _remoteChunks;
+
 public:
 
     static InstanceID instanceForChunk(const std::shared_ptr<Query>& query,
@@ -140,7 +192,7 @@ public:
                   const SGInstanceLocator& instLocator,
                   size_t cacheSizePerAttribute=0);
 
-    virtual ~PullSGContext() {}
+    virtual ~PullSGContext();
 
     std::shared_ptr<PullSGArray> getResultArray()
     {
@@ -207,6 +259,28 @@ private:
                  const ConstChunk& chunk,
                  const Coordinates& chunkPosition,
                  std::shared_ptr<CompressedBuffer>& buffer);
+
+    /**
+     * Get a message handing an uncompressed copy of the chunk over to this instance
+     */
+    std::shared_ptr<MessageDesc>
+    getLocalChunkMesg(const QueryID queryId,
+                      const AttributeID attributeId,
+                      const InstanceID destSGInstance,
+                      const ConstChunk& chunk);
+
+    std::shared_ptr<MessageDesc>
+    makeChunkMesg(const QueryID queryId,
+                  const AttributeID attributeId,
+                  const InstanceID destSGInstance,
+                  const ConstChunk& chunk,
+                  const std::shared_ptr<SharedBuffer>& buffer,
+                  const int compressionMethod,
+                  const size_t decompressedSize);
+
+    /// @return the empty bitmap to append to the chunk data sent out, if any
+    std::shared_ptr<ConstRLEEmptyBitmap> getClosureBitmap(ConstChunk const& chunk);
+
     void verifyPositions(ConstChunk const& chunk,
                          std::shared_ptr<ConstRLEEmptyBitmap>& emptyBitmap);
 
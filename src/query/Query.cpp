@@ -820,6 +820,7 @@ void dumpMemoryUsage(const QueryID queryId)
         LOG4CXX_DEBUG(Query::_logger,
                       "Stats after query ID ("<<queryId<<"): "
                       <<"Allocated size for PersistentChunks: " << StorageManager::getInstance().getUsedMemSize()
+                      <<", mapped size for PersistentChunks: " << StorageManager::getInstance().getMappedMemSize()
                       <<", allocated size for network messages: " << NetworkManager::getInstance()->getUsedMemSize()
                       <<", MAX size for MemChunks: "<< SharedMemCache::getInstance().getMemThreshold()
                       <<", allocated size for MemChunks: " << SharedMemCache::getInstance().getUsedMemSize()
@@ -1360,6 +1361,12 @@ Query::getCatalogVersion(const std::string& arrayName, bool allowMissing) const
     return lock->getArrayCatalogId();
 }
 
+SystemCatalog::QueryLocks Query::getRequestedLocks()
+{
+    ScopedMutexLock cs(errorMutex);
+    return _requestedLocks;
+}
+
 uint64_t Query::getLockTimeoutNanoSec()
 {
     static const uint64_t WAIT_LOCK_TIMEOUT_MSEC = 2000;
@@ -1502,18 +1509,25 @@ void generateReplicationItems(std::shared_ptr<MessageDesc>& msg,
 void ReplicationContext::replicationSync(ArrayID arrId)
 {
     assert(arrId > 0);
+
+    // the chunks deferred in write batches must be stored (and replicated) first
+    StorageManager::getInstance().flushWriteBatches(arrId);
+
     if (Config::getInstance()->getOption<size_t>(CONFIG_REDUNDANCY) <= 0) {
         return;
     }
 
+    assert(_replicationMngr);
+    std::shared_ptr<Query> query(Query::getValidQueryPtr(_query));
+
+    // the chunks replicated asynchronously must have left before the eof
+    _replicationMngr->waitForQuery(query->getQueryID());
+
     std::shared_ptr<MessageDesc> msg = std::make_shared<MessageDesc>(mtChunkReplica);
     std::shared_ptr<scidb_msg::Chunk> chunkRecord = msg->getRecord<scidb_msg::Chunk> ();
     chunkRecord->set_array_id(arrId);
     // tell remote instances that we are done replicating
     chunkRecord->set_eof(true);
-
-    assert(_replicationMngr);
-    std::shared_ptr<Query> query(Query::getValidQueryPtr(_query));
     msg->setQueryID(query->getQueryID());
 
     vector<std::shared_ptr<ReplicationManager::Item> > replicasVec;
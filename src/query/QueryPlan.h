@@ -359,6 +359,30 @@ class PhysicalQueryPlanNode
         return _physicalOperator->outputFullChunks(getChildSchemas());
     }
 
+    /**
+     * Delegator to physicalOperator.
+     */
+    bool computesChunksIndependently() const
+    {
+        return _physicalOperator->computesChunksIndependently(getChildSchemas());
+    }
+
+    /**
+     * Delegator to physicalOperator.
+     */
+    bool acceptsUnorderedChunks() const
+    {
+        return _physicalOperator->acceptsUnorderedChunks(getChildSchemas());
+    }
+
+    /**
+     * Delegator to physicalOperator.
+     */
+    bool acceptsReplicatedInput() const
+    {
+        return _physicalOperator->acceptsReplicatedInput(getChildSchemas());
+    }
+
     /**
       * [Optimizer API] Determine if the output chunks
       * of this subtree will be completely filled.
@@ -480,6 +504,12 @@ public:
         SerializedPtrConverter<PhysicalQueryPlanNode> _nodes;
         SerializedPtrConverter<OperatorParam> _params;
 
+        /// values for the bind parameters of the plan expressions, NULL to keep the serialized ones
+        const std::map<std::string, Value>* _bindings;
+
+        SerializationHelper(): _bindings(NULL)
+        {}
+
         void clear()
         {
             _nodes.clear();
@@ -544,6 +574,10 @@ void PhysicalQueryPlanNode::serialize(Archive& ar, const unsigned int version)
             OperatorParam* op;
             ar & op;
             parameters[i] = helper._params.getSharedPtr(op);
+            if (helper._bindings && parameters[i]->getParamType() == PARAM_PHYSICAL_EXPRESSION) {
+                // operators may evaluate their parameters as early as in the constructor
+                ((std::shared_ptr<OperatorParamPhysicalExpression>&)parameters[i])->getExpression()->bindParameters(*helper._bindings);
+            }
         }
         ar & schema;
 
@@ -90,8 +90,8 @@ public:
 
     void parseLogical(std::shared_ptr<Query> query, bool afl);
     void parsePhysical(const string& plan, std::shared_ptr<Query> query);
+    void parsePhysical(const string& plan, std::shared_ptr<Query> query, const QueryParamMap& queryParams);
     const ArrayDesc& inferTypes(std::shared_ptr<Query> query);
-    void setParameters(std::shared_ptr<Query> query, QueryParamMap queryParams);
     bool optimize(std::shared_ptr<Optimizer> optimizer, std::shared_ptr<Query> query);
     void preSingleExecute(std::shared_ptr<Query> query);
     void execute(std::shared_ptr<Query> query);
@@ -144,6 +144,24 @@ void QueryProcessorImpl::parsePhysical(const std::string& plan, std::shared_ptr<
     query->addPhysicalPlan(std::make_shared<PhysicalPlan>(node));
 }
 
+void QueryProcessorImpl::parsePhysical(const std::string& plan, std::shared_ptr<Query> query,
+                                       const QueryParamMap& queryParams)
+{
+    assert(!plan.empty());
+
+    stringstream ss;
+    ss << plan;
+    TextIArchiveQueryPlan ia(ss);
+    registerLeafDerivedOperatorParams<TextIArchiveQueryPlan>(ia);
+    ia._helper._bindings = &queryParams;
+
+    PhysicalQueryPlanNode* n;
+    ia & n;
+
+    std::shared_ptr<PhysicalQueryPlanNode> node = ia._helper._nodes.getSharedPtr(n);
+    query->addPhysicalPlan(std::make_shared<PhysicalPlan>(node));
+}
+
 
 const ArrayDesc& QueryProcessorImpl::inferTypes(std::shared_ptr<Query> query)
 {
@@ -164,10 +182,6 @@ bool QueryProcessorImpl::optimize(std::shared_ptr<Optimizer> optimizer, std::sha
 }
 
 
-void QueryProcessorImpl::setParameters(std::shared_ptr<Query> query, QueryParamMap queryParams)
-{
-}
-
 
 // Recursive method for single executing physical plan
 void QueryProcessorImpl::preSingleExecute(std::shared_ptr<PhysicalQueryPlanNode> node, std::shared_ptr<Query> query)
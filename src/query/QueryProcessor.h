@@ -36,6 +36,7 @@
 #ifndef QUERY_PROCESSOR_H_
 #define QUERY_PROCESSOR_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <queue>
@@ -58,12 +59,9 @@ namespace scidb
   class Session;
 
 /**
- * The stub for data type
+ * Values of the bind parameters of a query keyed by parameter name
  */
-struct QueryParamMap
-{
-
-};
+typedef std::map<std::string, Value> QueryParamMap;
 
 /**
  * The query processor is the interface to all major query processing tasks in SciDB.
@@ -95,6 +93,12 @@ public:
      */
     virtual void parsePhysical(const std::string& plan, std::shared_ptr<Query> query) = 0;
 
+    /**
+     * Parse the physical plan string binding new values to the parameters of its expressions
+     */
+    virtual void parsePhysical(const std::string& plan, std::shared_ptr<Query> query,
+                               const QueryParamMap& queryParams) = 0;
+
     /**
      * Infers types through logical tree
      */
@@ -112,11 +116,6 @@ public:
      */
     virtual bool optimize(std::shared_ptr< Optimizer> optimizer, std::shared_ptr<Query> query) = 0;
 
-    /**
-     * Set parameters of query before execution
-     */
-    virtual void setParameters(std::shared_ptr<Query> query, QueryParamMap queryParams) = 0;
-
     /**
      * Execute the physical plan in query only for coordinator instance.
      * It's useful for some preparations before execution.
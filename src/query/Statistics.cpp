@@ -81,6 +81,8 @@ std::ostream& writeStatistics(std::ostream& os, const Statistics& s, size_t tab)
     os <<
         tabStr << "Sent " << printSize(s.sentSize) << printSizeUnit(s.sentSize) << " (" << s.sentMessages << " messages)" << endl <<
         tabStr << "Recieved " << printSize(s.receivedSize) << printSizeUnit(s.receivedSize) << " (" << s.receivedMessages << " messages)" << endl <<
+        tabStr << "Redistributed locally " << printSize(s.localChunkSize) << printSizeUnit(s.localChunkSize) << " (" << s.localChunks << " chunks)" << endl <<
+        tabStr << "Redistributed remotely " << printSize(s.remoteChunkSize) << printSizeUnit(s.remoteChunkSize) << " (" << s.remoteChunks << " chunks)" << endl <<
         tabStr << "Written " << printSize(s.writtenSize) << printSizeUnit(s.writtenSize) << " (" << s.writtenChunks << " chunks)" << endl <<
         tabStr << "Read " << printSize(s.readSize) << printSizeUnit(s.readSize) << " (" << s.readChunks << " chunks)" << endl <<
         tabStr << "Pinned " << printSize(s.pinnedSize) << printSizeUnit(s.pinnedSize) << " (" << s.pinnedChunks << " chunks)" << endl <<
@@ -208,12 +210,56 @@ private:
     log4cxx::LoggerPtr _logger;
 };
 
+/**
+ * Writes the counters of every query as a single line of name=value pairs, in bytes and
+ * chunks rather than the rounded sizes of writeStatistics(), for tools to collect.
+ */
+class CountersStatisticsMonitor: public StatisticsMonitor
+{
+public:
+    virtual ~CountersStatisticsMonitor() {}
+    CountersStatisticsMonitor(const string& loggerName):
+        _logger(log4cxx::Logger::getLogger(loggerName == "" ? "scidb.statistics" : loggerName))
+    {
+    }
+
+    void pushStatistics(const Query& query)
+    {
+        if (query.isFake()) {
+            return;
+        }
+        const Statistics& s = query.statistics;
+        LOG4CXX_INFO(_logger, "Counters of query " << query.getQueryID() << ":"
+                     << " sent_bytes=" << s.sentSize
+                     << " sent_messages=" << s.sentMessages
+                     << " received_bytes=" << s.receivedSize
+                     << " received_messages=" << s.receivedMessages
+                     << " local_chunk_bytes=" << s.localChunkSize
+                     << " local_chunks=" << s.localChunks
+                     << " remote_chunk_bytes=" << s.remoteChunkSize
+                     << " remote_chunks=" << s.remoteChunks
+                     << " written_bytes=" << s.writtenSize
+                     << " written_chunks=" << s.writtenChunks
+                     << " read_bytes=" << s.readSize
+                     << " read_chunks=" << s.readChunks
+                     << " pinned_bytes=" << s.pinnedSize
+                     << " pinned_chunks=" << s.pinnedChunks
+                     << " allocated_bytes=" << s.allocatedSize
+                     << " allocated_chunks=" << s.allocatedChunks);
+    }
+
+private:
+    log4cxx::LoggerPtr _logger;
+};
+
 std::shared_ptr<StatisticsMonitor> StatisticsMonitor::create(size_t type, const string& params)
 {
     switch (type)
     {
     case smPostgres:
         return std::shared_ptr<StatisticsMonitor>(new PostgresStatisticsMonitor(params));
+    case smCounters:
+        return std::shared_ptr<StatisticsMonitor>(new CountersStatisticsMonitor(params));
     case smLogger:
     default:
         return std::shared_ptr<StatisticsMonitor>(new LoggerStatisticsMonitor(params));
@@ -41,6 +41,7 @@
 #include <network/Connection.h>
 #include <array/StreamArray.h>
 #include <system/Exceptions.h>
+#include <query/PlanCache.h>
 #include <query/QueryProcessor.h>
 #include <query/Serialize.h>
 #include <network/NetworkManager.h>
@@ -111,6 +112,16 @@ class SciDBExecutor: public scidb::SciDB
                       const std::string& programOptions,
                       QueryResult& queryResult,
                       void* connection) const
+    {
+        prepareQuery(queryString, afl, programOptions, QueryParameters(), queryResult, connection);
+    }
+
+    void prepareQuery(const std::string& queryString,
+                      bool afl,
+                      const std::string& programOptions,
+                      const QueryParameters& parameters,
+                      QueryResult& queryResult,
+                      void* connection) const
     {
         ASSERT_EXCEPTION(connection, "NULL connection");
 
@@ -145,6 +156,7 @@ class SciDBExecutor: public scidb::SciDB
 
 
         try {
+            query->parameters = parameters;
             prepareQueryBeforeLocking(query, queryProcessor, afl, programOptions);
             query->acquireLocks(); //can throw "try-again", i.e. SystemCatalog::LockBusyException
             prepareQueryAfterLocking(query, queryProcessor, afl, queryResult);
@@ -250,9 +262,16 @@ class SciDBExecutor: public scidb::SciDB
         try {
             query->start();
 
-            while (queryProcessor->optimize(optimizer, query))
+            // A read-only query may reuse the physical plan of an earlier one
+            // differing only in the values of its bind parameters
+            PlanCache* planCache = PlanCache::getInstance();
+            const string planKey = planCache->makeKey(query, afl);
+            bool cached = !planKey.empty() && getCachedPlan(planCache, planKey, query, queryProcessor);
+            string optimizedPlan;
+
+            while (cached || queryProcessor->optimize(optimizer, query))
             {
-                LOG4CXX_DEBUG(logger, "Query is optimized");
+                LOG4CXX_DEBUG(logger, "Query is " << (cached ? "bound to a cached plan" : "optimized"));
 
                 isDdl = query->getCurrentPhysicalPlan()->isDdl();
                 query->isDDL = isDdl;
@@ -276,6 +295,9 @@ class SciDBExecutor: public scidb::SciDB
 
                     // Serialize physical plan and sending it out
                     const string physicalPlan = serializePhysicalPlan(query->getCurrentPhysicalPlan());
+                    if (!cached) {
+                        optimizedPlan = physicalPlan;
+                    }
                     LOG4CXX_DEBUG(logger, "The query plan is: " << planString.str());
                     LOG4CXX_DEBUG(logger, "The serialized form of the physical plan: queryID="
                                   << queryResult.queryID << ", physicalPlan='" << physicalPlan << "'");
@@ -321,6 +343,13 @@ class SciDBExecutor: public scidb::SciDB
                 query->validate();
 
                 queryProcessor->postSingleExecute(query);
+
+                if (!planKey.empty() && !cached && !query->logicalPlan->getRoot()) {
+                    // the optimizer produced the whole plan at once
+                    planCache->insert(planKey, optimizedPlan,
+                                      PlanCache::getDistributions(query->getCurrentPhysicalPlan()->getRoot(), query));
+                }
+                cached = false;
             }
             query->done();
         } catch (const Exception& e) {
@@ -341,6 +370,37 @@ class SciDBExecutor: public scidb::SciDB
         LOG4CXX_DEBUG(logger, "The result of query is returned")
     }
 
+    /**
+     * Make the cached physical plan with the given key the current plan of the query,
+     * binding the values of the query parameters to its expressions.
+     * @return false if the plan is not cached, or does not fit the parameter values
+     */
+    bool getCachedPlan(PlanCache* planCache,
+                       const string& planKey,
+                       const std::shared_ptr<Query>& query,
+                       const std::shared_ptr<QueryProcessor>& queryProcessor) const
+    {
+        string plan;
+        string distributions;
+        if (!planCache->lookup(planKey, plan, distributions)) {
+            return false;
+        }
+
+        QueryParamMap bindings;
+        for (QueryParameters::const_iterator i = query->parameters.begin(); i != query->parameters.end(); ++i) {
+            TypeId type;
+            bindings[i->first] = parseQueryParameter(i->first, i->second, type);
+        }
+        queryProcessor->parsePhysical(plan, query, bindings);
+
+        if (PlanCache::getDistributions(query->getCurrentPhysicalPlan()->getRoot(), query) != distributions) {
+            LOG4CXX_DEBUG(logger, "The cached plan does not fit the parameters of query " << query->getQueryID());
+            return false;
+        }
+        query->logicalPlan->setRoot(std::shared_ptr<LogicalQueryPlanNode>());
+        return true;
+    }
+
     void cancelQuery(QueryID queryID, void* connection) const
     {
         LOG4CXX_TRACE(logger, "Cancelling query " << queryID)
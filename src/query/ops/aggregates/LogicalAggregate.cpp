@@ -44,8 +44,8 @@ using namespace boost;
  *
  * @par Synopsis:
  *   aggregate( srcArray {, AGGREGATE_CALL}+ {, groupbyDim}* {, chunkSize}* )
- *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr) [as resultName]
- *   <br> AGGREGATE_FUNC := approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
+ *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr {, constant}*) [as resultName]
+ *   <br> AGGREGATE_FUNC := approx_quantile | approx_topk | approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
  *
  * @par Summary:
  *   Calculates aggregates over groups of values in an array, given the aggregate types and attributes to aggregate on. <br>
@@ -58,6 +58,9 @@ using namespace boost;
  *     For instance, the default resultName for sum(sales) is 'sales_sum'.
  *     The count aggregate may take * as the input attribute, meaning to count all the items in the group including null items.
  *     The default resultName for count(*) is 'count'.
+ *     Numeric constants after inputAttr are parameters of the aggregate: approx_quantile(x, q) estimates the
+ *     q-quantile of x (0.5 if omitted), approx_topk(x, k) lists the k most frequent values of x (10 if omitted)
+ *     with their estimated counts.
  *   - 0 or more dimensions that together determines the grouping criteria.
  *   - 0 or numGroupbyDims chunk sizes.
  *     If no chunk size is given, the groupby dims will inherit chunk sizes from the input array.
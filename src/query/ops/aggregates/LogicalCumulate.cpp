@@ -42,7 +42,7 @@ namespace scidb
  * @par Synopsis:
  *  cumulate ( inputArray {, AGGREGATE_ALL}+ [, aggrDim] )
  *  <br> AGGREGATE_CALL := AGGREGATE_FUNC ( inputAttribute ) [ AS aliasName ]
- *  <br> AGGREGATE_FUNC := approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
+ *  <br> AGGREGATE_FUNC := approx_quantile | approx_topk | approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
  *
  * @par Summary:
  *
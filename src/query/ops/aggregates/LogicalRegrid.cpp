@@ -43,7 +43,7 @@ using namespace std;
  * @par Synopsis:
  *   regrid( srcArray {, blockSize}+ {, AGGREGATE_CALL}+ {, chunkSize}* )
  *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr) [as resultName]
- *   <br> AGGREGATE_FUNC := approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
+ *   <br> AGGREGATE_FUNC := approx_quantile | approx_topk | approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
  *
  * @par Summary:
  *   Partitions the cells in the source array into blocks (with the given blockSize in each dimension), and for each block,
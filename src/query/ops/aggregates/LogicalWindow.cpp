@@ -47,7 +47,7 @@ using namespace std;
  * @par Synopsis:
  *   window( srcArray {, leftEdge, rightEdge}+ {, AGGREGATE_CALL}+ [, METHOD ] )
  *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr) [as resultName]
- *   <br> AGGREGATE_FUNC := approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
+ *   <br> AGGREGATE_FUNC := approx_quantile | approx_topk | approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
  *   <br> METHOD := 'materialize' | 'probe'
  *
  * @par Summary:
@@ -52,6 +52,11 @@ class PhysicalApply: public  PhysicalOperator
         return inputBoundaries[0];
     }
 
+    virtual bool computesChunksIndependently(std::vector<ArrayDesc> const&) const
+    {
+        return true;
+    }
+
     std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
     {
         assert(inputArrays.size() == 1);
@@ -90,6 +90,11 @@ public:
        return inputBoundaries[0].intersectWith(window);
     }
 
+   virtual bool computesChunksIndependently(std::vector<ArrayDesc> const&) const
+   {
+       return true;
+   }
+
    /***
     * Between is a pipelined operator, hence it executes by returning an iterator-based array to the consumer.
     */
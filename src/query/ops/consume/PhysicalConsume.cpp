@@ -48,18 +48,20 @@ public:
     {
     }
 
+    /**
+     * Attributes scanned one at a time do not need their chunks to come in the same order.
+     */
+    virtual bool acceptsUnorderedChunks(std::vector<ArrayDesc> const&) const
+    {
+        return getStrideSize() <= 1;
+    }
+
     std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
     {
         assert(inputArrays.size() == 1);
         assert(_parameters.size() <= 1);
 
-        /* This parameter determines the width of the vertical slice that we use to scan
-           Default is 1.
-        */
-        uint64_t attrStrideSize =
-            (_parameters.size() == 1)
-            ? ((std::shared_ptr<OperatorParamPhysicalExpression>&)_parameters[0])->getExpression()->evaluate().getUint64()
-            : 1;
+        uint64_t attrStrideSize = getStrideSize();
 
         std::shared_ptr<Array>& array = inputArrays[0];
 
@@ -178,6 +180,17 @@ public:
             }
         }
     }
+
+private:
+    /* This parameter determines the width of the vertical slice that we use to scan
+       Default is 1.
+    */
+    uint64_t getStrideSize() const
+    {
+        return (_parameters.size() == 1)
+            ? ((std::shared_ptr<OperatorParamPhysicalExpression>&)_parameters[0])->getExpression()->evaluate().getUint64()
+            : 1;
+    }
 };
 
 DECLARE_PHYSICAL_OPERATOR_FACTORY(PhysicalConsume, "consume", "PhysicalConsume")
@@ -0,0 +1,153 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file CreateArrayDistribution.h
+ *
+ * @brief The distribution argument of create_array().
+ *
+ * The argument is one of:
+ *   - 'hashed': the default distribution;
+ *   - 'replicated': psReplication, a copy of every chunk on every instance, for small arrays
+ *     joined with large ones where the large ones are;
+ *   - 'range:<dim>[:<block>]': psRangePartitioned by the dimension named <dim>, placing
+ *     <block> consecutive chunks along it on each instance. By default the chunks of a
+ *     bounded dimension are split evenly over the instances, so that every instance holds
+ *     one contiguous range of the dimension;
+ *   - 'copartitioned:<dim>[:<block>]': psCoPartitioned by the dimension named <dim>, placing
+ *     <block> (by default one) consecutive chunks along it on each instance in turn.
+ *
+ * Both place a chunk by its coordinate along <dim> alone, so the matching chunks of any two
+ * arrays partitioned the same way are on the same instance, whatever their other dimensions.
+ */
+
+#ifndef CREATE_ARRAY_DISTRIBUTION_H_
+#define CREATE_ARRAY_DISTRIBUTION_H_
+
+#include <string>
+#include <boost/lexical_cast.hpp>
+
+#include <array/Metadata.h>
+#include <system/Exceptions.h>
+
+namespace scidb
+{
+
+/**
+ * Parse the distribution argument of create_array().
+ * @param distribution the argument
+ * @param schema the schema of the array to be created
+ * @param[out] ps the partitioning schema
+ * @param[out] dimension the partitioning dimension, if any
+ * @param[out] block the number of consecutive chunks per instance, 0 if it is to be computed
+ * @throw USER_EXCEPTION SCIDB_LE_BAD_ARRAY_DISTRIBUTION if the argument is malformed
+ */
+inline void parseArrayDistribution(std::string const& distribution,
+                                   ArrayDesc const& schema,
+                                   PartitioningSchema& ps,
+                                   size_t& dimension,
+                                   uint64_t& block)
+{
+    dimension = 0;
+    block = 1;
+
+    std::string::size_type const colon = distribution.find(':');
+    std::string const kind = distribution.substr(0, colon);
+    if (kind == "hashed" && colon == std::string::npos) {
+        ps = psHashPartitioned;
+        return;
+    } else if (kind == "replicated" && colon == std::string::npos) {
+        ps = psReplication;
+        return;
+    } else if (kind == "range") {
+        ps = psRangePartitioned;
+        block = 0;
+    } else if (kind == "copartitioned") {
+        ps = psCoPartitioned;
+    } else {
+        throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_BAD_ARRAY_DISTRIBUTION)
+            << distribution << "expected 'hashed', 'replicated', 'range:<dim>' or 'copartitioned:<dim>'";
+    }
+    if (colon == std::string::npos) {
+        throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_BAD_ARRAY_DISTRIBUTION)
+            << distribution << "the partitioning dimension is missing";
+    }
+
+    std::string::size_type const blockColon = distribution.find(':', colon + 1);
+    std::string const dimName = distribution.substr(colon + 1, blockColon - colon - 1);
+    ssize_t const dimNo = schema.findDimension(dimName, "");
+    if (dimNo < 0) {
+        throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_BAD_ARRAY_DISTRIBUTION)
+            << distribution << "no such dimension";
+    }
+    dimension = dimNo;
+
+    if (blockColon != std::string::npos) {
+        try {
+            std::string const blockStr = distribution.substr(blockColon + 1);
+            if (blockStr.empty() || blockStr[0] == '-') {
+                throw boost::bad_lexical_cast();
+            }
+            block = boost::lexical_cast<uint64_t>(blockStr);
+        } catch (boost::bad_lexical_cast const&) {
+            block = 0;
+        }
+        if (block == 0) {
+            throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_BAD_ARRAY_DISTRIBUTION)
+                << distribution << "the number of chunks per instance must be a positive integer";
+        }
+    }
+}
+
+/**
+ * Set the distribution named by the argument of create_array() on the schema of the new array.
+ * @param schema the schema of the array to be created, with all its dimensions known
+ * @param distribution the argument
+ * @param nInstances the number of instances the array is created on
+ */
+inline void setArrayDistribution(ArrayDesc& schema, std::string const& distribution, size_t nInstances)
+{
+    PartitioningSchema ps;
+    size_t dimension;
+    uint64_t block;
+    parseArrayDistribution(distribution, schema, ps, dimension, block);
+
+    if (block == 0) {
+        // one contiguous range of the bounded dimension per instance
+        DimensionDesc const& dim = schema.getDimensions()[dimension];
+        if (dim.isMaxStar()) {
+            throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_BAD_ARRAY_DISTRIBUTION)
+                << distribution << "an unbounded dimension needs the number of chunks per instance";
+        }
+        uint64_t const nChunks = (dim.getLength() + dim.getChunkInterval() - 1) / dim.getChunkInterval();
+        block = std::max<uint64_t>((nChunks + nInstances - 1) / nInstances, 1);
+    }
+
+    schema.setPartitioningSchema(ps);
+    if (ps == psRangePartitioned || ps == psCoPartitioned) {
+        schema.setPartitioningDimension(dimension, block);
+    }
+}
+
+}  // namespace scidb
+
+#endif /* CREATE_ARRAY_DISTRIBUTION_H_ */
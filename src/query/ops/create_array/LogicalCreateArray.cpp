@@ -29,6 +29,7 @@
  */
 
 #include "query/Operator.h"
+#include "CreateArrayDistribution.h"
 
 #define fail(e) throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA,e)
 
@@ -46,6 +47,10 @@ using std::shared_ptr;
  *  @endcode
  *  or
  *  @code
+ *      create_array ( array_name, array_schema , temp , distribution )
+ *  @endcode
+ *  or
+ *  @code
  *      CREATE ['TEMP'] ARRAY array_name  array_schema [ [ [cells] ] USING load_array ]
  *  @endcode
  *
@@ -62,6 +67,15 @@ using std::shared_ptr;
  *                         sensible choices for those details of the target dimensions that
  *                         were elided.
  *      - cells            the desired number of logical cells per chunk (default is 1M)
+ *      - distribution     how the chunks of the array are placed on the instances:
+ *                         'hashed' (the default), 'replicated' for a copy of the whole array on
+ *                         every instance, 'range:<dim>[:<block>]' for contiguous ranges
+ *                         of the dimension <dim> on each instance, or 'copartitioned:<dim>[:<block>]'
+ *                         for consecutive chunks along <dim> going round the instances.
+ *                         Arrays partitioned the same way by a dimension keep their matching chunks
+ *                         on the same instance, so operators combining them need not redistribute them.
+ *                         A replicated array is joined where the other input of join() is.
+ *                         @see CreateArrayDistribution.h
  *
  *  An array schema has the following form:
  *
@@ -163,6 +177,18 @@ struct LogicalCreateArray : LogicalOperator
         ADD_PARAM_OUT_ARRAY_NAME()                       // The array name
         ADD_PARAM_SCHEMA()                               // The array schema
         ADD_PARAM_CONSTANT(TID_BOOL);                    // The temporary flag
+        ADD_PARAM_VARIES()                               // The distribution
+    }
+
+    std::vector<std::shared_ptr<OperatorParamPlaceholder> > nextVaryParamPlaceholder(const std::vector<ArrayDesc>&)
+    {
+        std::vector<std::shared_ptr<OperatorParamPlaceholder> > res;
+        res.push_back(END_OF_VARIES_PARAMS());
+        if (_parameters.size() == 3)
+        {
+            res.push_back(PARAM_CONSTANT(TID_STRING));
+        }
+        return res;
     }
 
     ArrayDesc inferSchema(vector<ArrayDesc>,std::shared_ptr<Query> query)
@@ -179,6 +205,16 @@ struct LogicalCreateArray : LogicalOperator
                                        _parameters[0]->getParsingContext()) << arrayName;
         }
 
+        if (_parameters.size() > 3)                      // Distribution given?
+        {
+            string const distribution(
+                evaluate(param<OperatorParamLogicalExpression>(3)->getExpression(),query,TID_STRING).getString());
+            PartitioningSchema ps;
+            size_t             dimension;
+            uint64_t           block;
+            parseArrayDistribution(distribution,param<OperatorParamSchema>(1)->getSchema(),ps,dimension,block);
+        }
+
         ArrayDesc arrDesc;
         arrDesc.setPartitioningSchema(defaultPartitioning());
         return arrDesc;
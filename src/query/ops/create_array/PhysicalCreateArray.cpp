@@ -26,6 +26,7 @@
 #include <query/Operator.h>
 #include <array/TransientCache.h>
 #include <util/session/Session.h>
+#include "CreateArrayDistribution.h"
 
 using namespace std;
 
@@ -64,6 +65,13 @@ struct PhysicalCreateArray : PhysicalOperator
 
             this->fixDimensions(in,arrSchema.getDimensions());
             arrSchema.setPartitioningSchema(defaultPartitioning());
+
+            if (_parameters.size() > 3)                  // Distribution given?
+            {
+                setArrayDistribution(arrSchema,
+                    param<OperatorParamPhysicalExpression>(3)->getExpression()->evaluate().getString(),
+                    query->getInstancesCount());
+            }
             ArrayID uAId = SystemCatalog::getInstance()->getNextArrayId();
             arrSchema.setIds(uAId, uAId, VersionID(0));
             SystemCatalog::getInstance()->addArray(
@@ -55,6 +55,8 @@ namespace scidb {
  *   <br>   clusterSize: uint64
  *   <br>   nFreeClusters: uint64
  *   <br>   nSegments: uint64
+ *   <br>   cacheUsed: uint64, bytes of chunk cache held in heap buffers
+ *   <br>   cacheMapped: uint64, bytes of chunk cache mapped from datastores
  *   <br> >
  *   <br> [
  *   <br>   Instance: start=0, end=#instances less 1, chunk interval=1.
@@ -83,12 +85,14 @@ public:
         assert(schemas.size() == 0);
         assert(_parameters.size() == 0);
 
-        vector<AttributeDesc> attributes(5);
+        vector<AttributeDesc> attributes(7);
         attributes[0] = AttributeDesc((AttributeID)0, "used",  TID_UINT64, 0, 0);
         attributes[1] = AttributeDesc((AttributeID)1, "available",  TID_UINT64, 0, 0);
         attributes[2] = AttributeDesc((AttributeID)2, "clusterSize",  TID_UINT64, 0, 0);
         attributes[3] = AttributeDesc((AttributeID)3, "nFreeClusters",  TID_UINT64, 0, 0);
         attributes[4] = AttributeDesc((AttributeID)4, "nSegments",  TID_UINT64, 0, 0);
+        attributes[5] = AttributeDesc((AttributeID)5, "cacheUsed",  TID_UINT64, 0, 0);
+        attributes[6] = AttributeDesc((AttributeID)6, "cacheMapped",  TID_UINT64, 0, 0);
         vector<DimensionDesc> dimensions(1);
         const size_t nInstances = query->getInstancesCount();
         size_t end        = nInstances>0 ? nInstances-1 : 0;
@@ -52,7 +52,7 @@ class PhysicalDiskInfo: public PhysicalOperator
     std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
     {
         std::shared_ptr<TupleArray> tuples(std::make_shared<TupleArray>(_schema, _arena));
-        Value tuple[5];
+        Value tuple[7];
         Storage::DiskInfo info;
         StorageManager::getInstance().getDiskInfo(info);
         tuple[0].setUint64(info.used);
@@ -60,6 +60,8 @@ class PhysicalDiskInfo: public PhysicalOperator
         tuple[2].setUint64(info.clusterSize);
         tuple[3].setUint64(info.nFreeClusters);
         tuple[4].setUint64(info.nSegments);
+        tuple[5].setUint64(info.cacheUsed);
+        tuple[6].setUint64(info.cacheMapped);
         tuples->appendTuple(tuple);
         return tuples;
     }
@@ -0,0 +1,91 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file LogicalExchange.cpp
+ *
+ * @brief The logical operator _exchange(), inserted by the optimizer.
+ */
+
+#include "query/Operator.h"
+
+namespace scidb
+{
+
+/**
+ * @brief The operator: _exchange().
+ *
+ * @par Synopsis:
+ *   _exchange( srcArray, workers, ordered )
+ *
+ * @par Summary:
+ *   Evaluates up to 'workers' chunks of each attribute of srcArray concurrently.
+ *   The optimizer puts it on top of chains of operators computing their chunks
+ *   independently, such as apply() and filter(), if exchange-workers is not 0.
+ *
+ * @par Input:
+ *   - srcArray: the source array with srcDims and srcAttrs.
+ *   - workers: uint32, the number of chunks of each attribute to evaluate concurrently.
+ *   - ordered: bool, false if the chunks of each attribute may come in any order.
+ *
+ * @par Output array:
+ *        <
+ *   <br>   srcAttrs
+ *   <br> >
+ *   <br> [
+ *   <br>   srcDims
+ *   <br> ]
+ *
+ * @par Examples:
+ *   n/a
+ *
+ * @par Errors:
+ *   n/a
+ *
+ * @par Notes:
+ *   n/a
+ *
+ */
+class LogicalExchange: public LogicalOperator
+{
+public:
+    LogicalExchange(const std::string& logicalName, const std::string& alias):
+        LogicalOperator(logicalName, alias)
+    {
+        ADD_PARAM_INPUT();
+        ADD_PARAM_CONSTANT("uint32");
+        ADD_PARAM_CONSTANT("bool");
+    }
+
+    /**
+     * The schema of output array is the same as input
+     */
+    ArrayDesc inferSchema(std::vector< ArrayDesc> inputSchemas, std::shared_ptr< Query> query)
+    {
+        assert(inputSchemas.size() == 1);
+        return inputSchemas[0];
+    }
+};
+
+DECLARE_LOGICAL_OPERATOR_FACTORY(LogicalExchange, "_exchange")
+
+} //namespace
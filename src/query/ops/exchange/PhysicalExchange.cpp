@@ -0,0 +1,68 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file PhysicalExchange.cpp
+ *
+ * @brief The physical operator _exchange().
+ */
+
+#include "query/Operator.h"
+#include "array/ExchangeArray.h"
+
+using namespace std;
+
+namespace scidb
+{
+
+class PhysicalExchange: public PhysicalOperator
+{
+public:
+    PhysicalExchange(const string& logicalName, const string& physicalName, const Parameters& parameters, const ArrayDesc& schema):
+        PhysicalOperator(logicalName, physicalName, parameters, schema)
+    {
+    }
+
+    virtual PhysicalBoundaries getOutputBoundaries(const std::vector<PhysicalBoundaries> & inputBoundaries,
+                                                   const std::vector< ArrayDesc> & inputSchemas) const
+    {
+        return inputBoundaries[0];
+    }
+
+    /**
+     * An input that cannot be iterated by several threads is returned as is.
+     */
+    std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
+    {
+        assert(inputArrays.size() == 1);
+        uint32_t nWorkers = ((std::shared_ptr<OperatorParamPhysicalExpression>&)_parameters[0])->getExpression()->evaluate().getUint32();
+        bool ordered = ((std::shared_ptr<OperatorParamPhysicalExpression>&)_parameters[1])->getExpression()->evaluate().getBool();
+        if (nWorkers < 2 || inputArrays[0]->getSupportedAccess() != Array::RANDOM) {
+            return inputArrays[0];
+        }
+        return std::shared_ptr<Array>(new ExchangeArray(inputArrays[0], nWorkers, ordered, query));
+    }
+};
+
+DECLARE_PHYSICAL_OPERATOR_FACTORY(PhysicalExchange, "_exchange", "impl_exchange")
+
+} //namespace
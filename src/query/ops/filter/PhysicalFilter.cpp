@@ -54,6 +54,11 @@ public:
         return inputBoundaries[0];
     }
 
+    virtual bool computesChunksIndependently(std::vector<ArrayDesc> const&) const
+    {
+        return true;
+    }
+
         /***
          * Filter is a pipelined operator, hence it executes by returning an iterator-based array to the consumer
          * that overrides the chunkiterator method.
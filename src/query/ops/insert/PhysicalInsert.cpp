@@ -186,12 +186,12 @@ public:
 
     /**
      * Get the distribution requirement.
-     * @return a DistributionRquirement requiring defaultPartitioning()
+     * @return a DistributionRquirement requiring the distribution of the target array
      */
     virtual DistributionRequirement getDistributionRequirement (const std::vector< ArrayDesc> & inputSchemas) const
     {
         vector<RedistributeContext> requiredDistribution;
-        requiredDistribution.push_back(RedistributeContext(defaultPartitioning()));
+        requiredDistribution.push_back(RedistributeContext(_schema));
         return DistributionRequirement(DistributionRequirement::SpecificAnyOrder, requiredDistribution);
     }
 
@@ -278,6 +278,134 @@ public:
         outputCIter->flush();
     }
 
+    /**
+     * A job merging the chunks of the input with the chunks of the previous version.
+     * Several jobs sharing ChunkMorsels insert the input in parallel, each one reading and
+     * writing all the attributes of its positions through its own iterators; without
+     * morsels a single job inserts the whole input in one pass.
+     */
+    class InsertJob : public Job
+    {
+    private:
+        PhysicalInsert& _insert;
+        std::shared_ptr<ChunkMorsels> _morsels;
+        vector<std::shared_ptr<ConstArrayIterator> > _inputIters;    //iterators over the input array
+        vector<std::shared_ptr<ConstArrayIterator> > _existingIters; //iterators over the data already in the
+                                                                     // output array
+        vector<std::shared_ptr<ArrayIterator> > _outputIters;        //write-iterators into the output array
+        size_t const _nDims;
+
+    public:
+        /**
+         * The boundaries of the chunks this job has inserted.
+         */
+        PhysicalBoundaries bounds;
+
+        InsertJob(PhysicalInsert& insert,
+                  std::shared_ptr<ChunkMorsels> const& morsels,
+                  std::shared_ptr<Array> const& inputArray,
+                  std::shared_ptr<Array> const& dstArray,
+                  size_t nDims,
+                  std::shared_ptr<Query> const& query)
+        : Job(query),
+          _insert(insert),
+          _morsels(morsels),
+          _inputIters(insert._schema.getAttributes().size()),
+          _existingIters(_inputIters.size()),
+          _outputIters(_inputIters.size()),
+          _nDims(nDims),
+          bounds(PhysicalBoundaries::createEmpty(nDims))
+        {
+            for (AttributeID i = 0; i < _inputIters.size(); i++)
+            {
+                _inputIters[i] = inputArray->getConstIterator(i);
+                _existingIters[i] = dstArray->getConstIterator(i);
+                _outputIters[i] = dstArray->getIterator(i);
+            }
+        }
+
+        virtual void run()
+        {
+            std::shared_ptr<Query> query(_query);
+            Query::setCurrentQueryID(query->getQueryID());
+
+            if (!_morsels)
+            {
+                while (!_inputIters[0]->end())
+                {
+                    insertChunks(_inputIters[0]->getPosition(), query);
+                    for (AttributeID i = 0; i < _inputIters.size(); i++)
+                    {
+                        ++(*_inputIters[i]);
+                    }
+                }
+                return;
+            }
+
+            vector<Coordinates> positions;
+            while (_morsels->next(positions))
+            {
+                for (size_t p = 0; p < positions.size(); p++)
+                {
+                    for (AttributeID i = 0; i < _inputIters.size(); i++)
+                    {
+                        if (!_inputIters[i]->setPosition(positions[p]))
+                        {
+                            throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+                        }
+                    }
+                    insertChunks(positions[p], query);
+                }
+            }
+        }
+
+    private:
+        /// Insert all the attributes at the current position of the input iterators
+        void insertChunks(Coordinates const& pos, std::shared_ptr<Query>& query)
+        {
+            ArrayDesc const& schema = _insert._schema;
+            const size_t nAttrs = _inputIters.size();
+            if (!schema.contains(pos))
+            {
+                throw USER_EXCEPTION(SCIDB_SE_OPERATOR, SCIDB_LE_CHUNK_OUT_OF_BOUNDARIES)
+                    << CoordsToStr(pos) << schema.getDimensions();
+            }
+
+            bool haveExistingChunk = _existingIters[0]->setPosition(pos);
+            for(AttributeID i = 0; i < nAttrs; i++)
+            {
+                if ( haveExistingChunk && i != 0 )
+                {
+                    _existingIters[i]->setPosition(pos);
+                }
+
+                ConstChunk const& inputChunk = _inputIters[i]->getChunk();
+                ConstChunk* matChunk = inputChunk.materialize();
+                if(matChunk->count() == 0)
+                {
+                    break;
+                }
+
+                if(haveExistingChunk)
+                {
+                    _insert.insertMergeChunk(query, matChunk, _existingIters[i]->getChunk(),
+                                             _insert.getNewChunk(pos,_outputIters[i]),
+                                             _nDims);
+                }
+                else
+                {
+                    _outputIters[i]->copyChunk(*matChunk);
+                }
+
+                if (i == nAttrs-1)
+                {
+                    bounds.updateFromChunk(matChunk, schema.getEmptyBitmapAttribute() == NULL);
+                }
+            }
+            Query::validateQueryPtr(query);
+        }
+    };
+
     /**
      * Insert inputArray into a new version based on _schema, update catalog boundaries.
      * @param inputArray the input to insert
@@ -291,7 +419,6 @@ public:
                                        Coordinates const& currentHiBound,
                                        size_t const nDims)
     {
-        const size_t nAttrs = _schema.getAttributes().size();
         std::shared_ptr<Array> dstArray;
 
         if (_schema.isTransient())
@@ -321,64 +448,45 @@ public:
             inputArray = make_shared<NonEmptyableArray>(inputArray);
         }
 
-        vector<std::shared_ptr<ConstArrayIterator> > inputIters(nAttrs);    //iterators over the input array
-        vector<std::shared_ptr<ConstArrayIterator> > existingIters(nAttrs); //iterators over the data already in the
-                                                                       // output array
-        vector<std::shared_ptr<ArrayIterator> > outputIters(nAttrs);        //write-iterators into the output array
-
-        for(AttributeID i = 0; i < nAttrs; i++)
+        // Insert the chunks in parallel morsels of positions if the input can be read at random;
+        // a transient target is merged in place and is always written by a single job
+        const size_t nJobs = _schema.isTransient() ? 1 : ChunkMorsels::getNumberOfJobs(*inputArray);
+        std::shared_ptr<ChunkMorsels> morsels;
+        if (nJobs > 1)
         {
-            inputIters[i] = inputArray->getConstIterator(i);
-            existingIters[i] = dstArray->getConstIterator(i);
-            outputIters[i] = dstArray->getIterator(i);
+            morsels = std::make_shared<ChunkMorsels>(inputArray,
+                                                     Config::getInstance()->getOption<int>(CONFIG_STORE_MORSEL_SIZE));
         }
 
-        while(!inputIters[0]->end())
+        std::shared_ptr<JobQueue> queue = PhysicalOperator::getGlobalQueueForOperators();
+        vector<std::shared_ptr<InsertJob> > jobs(nJobs);
+        for (size_t i = 0; i < nJobs; i++)
         {
-            Coordinates const& pos = inputIters[0]->getPosition();
-            if (!_schema.contains(pos))
-            {
-                throw USER_EXCEPTION(SCIDB_SE_OPERATOR, SCIDB_LE_CHUNK_OUT_OF_BOUNDARIES)
-                    << CoordsToStr(pos) << _schema.getDimensions();
-            }
-
-            bool haveExistingChunk = existingIters[0]->setPosition(pos);
-            for(AttributeID i = 0; i < nAttrs; i++)
-            {
-                if ( haveExistingChunk && i != 0 )
-                {
-                    existingIters[i]->setPosition(pos);
-                }
-
-                ConstChunk const& inputChunk = inputIters[i]->getChunk();
-                ConstChunk* matChunk = inputChunk.materialize();
-                if(matChunk->count() == 0)
-                {
-                    break;
-                }
+            jobs[i] = std::make_shared<InsertJob>(*this, morsels, inputArray, dstArray, nDims, query);
+        }
+        for (size_t i = 1; i < nJobs; i++)
+        {
+            queue->pushJob(jobs[i]);
+        }
 
-                if(haveExistingChunk)
-                {
-                    insertMergeChunk(query, matChunk, existingIters[i]->getChunk(),
-                                     getNewChunk(pos,outputIters[i]),
-                                     nDims);
-                }
-                else
-                {
-                    outputIters[i]->copyChunk(*matChunk);
-                }
+        jobs[0]->execute();
 
-                if (i == nAttrs-1)
-                {
-                    bounds.updateFromChunk(matChunk, _schema.getEmptyBitmapAttribute() == NULL);
-                }
+        int errorJob = -1;
+        for (size_t i = 0; i < nJobs; i++)
+        {
+            if (!jobs[i]->wait())
+            {
+                errorJob = i;
             }
-
-            for(AttributeID i = 0; i < nAttrs; i++)
+            else
             {
-                ++(*inputIters[i]);
+                bounds = bounds.unionWith(jobs[i]->bounds);
             }
         }
+        if (errorJob >= 0)
+        {
+            jobs[errorJob]->rethrow();
+        }
 
         // Update boundaries
         updateSchemaBoundaries(_schema, bounds, query);
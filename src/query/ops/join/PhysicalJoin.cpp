@@ -133,6 +133,25 @@ public:
         return DistributionRequirement(DistributionRequirement::Collocated);
     }
 
+    /**
+     * Every chunk of one input is joined with the chunk of the other input at the same position
+     * where it is, so the chunks of a replicated input are found wherever the other input has them.
+     */
+    virtual bool acceptsReplicatedInput(const std::vector< ArrayDesc> & inputSchemas) const
+    {
+        return true;
+    }
+
+    virtual RedistributeContext getOutputDistribution(const std::vector<RedistributeContext> & inputDistributions,
+                                                      const std::vector< ArrayDesc> & inputSchemas) const
+    {
+        assert(inputDistributions.size() == 2);
+        if (inputDistributions[0].getPartitioningSchema() == psReplication) {
+            return inputDistributions[1];
+        }
+        return inputDistributions[0];
+    }
+
     virtual PhysicalBoundaries getOutputBoundaries(const std::vector<PhysicalBoundaries> & inputBoundaries,
                                                    const std::vector< ArrayDesc> & inputSchemas) const
     {
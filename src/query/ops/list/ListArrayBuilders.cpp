@@ -118,6 +118,7 @@ Attributes ListChunkMapArrayBuilder::getAttributes() const
 
 void ListChunkMapArrayBuilder::list(const ArrayUAID& uaid,
                                     const StorageAddress& addr,
+                                    const ChunkHeader* hdr,
                                     const PersistentChunk* chunk,
                                     uint64_t tombstonePos,
                                     bool valid)
@@ -125,27 +126,27 @@ void ListChunkMapArrayBuilder::list(const ArrayUAID& uaid,
     std::ostringstream s;
 
     beginElement();
-    write(STORAGE_VERSION,  chunk==NULL ? -1 : chunk->_hdr.storageVersion);
-    write(INSTANCE_ID,      chunk==NULL ? -1 : chunk->_hdr.instanceId);
-    write(DATASTORE_GUID,   chunk==NULL ? -1 : chunk->_hdr.pos.dsGuid);
-    write(DISK_HEADER_POS,  chunk==NULL ? tombstonePos : chunk->_hdr.pos.hdrPos);
-    write(DISK_OFFSET,      chunk==NULL ? -1 : chunk->_hdr.pos.offs);
+    write(STORAGE_VERSION,  hdr==NULL ? -1 : hdr->storageVersion);
+    write(INSTANCE_ID,      hdr==NULL ? -1 : hdr->instanceId);
+    write(DATASTORE_GUID,   hdr==NULL ? -1 : hdr->pos.dsGuid);
+    write(DISK_HEADER_POS,  hdr==NULL ? tombstonePos : hdr->pos.hdrPos);
+    write(DISK_OFFSET,      hdr==NULL ? -1 : hdr->pos.offs);
     write(U_ARRAY_ID,       uaid);
     write(V_ARRAY_ID,       addr.arrId);
     write(ATTRIBUTE_ID,     addr.attId);
     s << addr.coords;
     write(COORDINATES,      s.str());
-    write(COMPRESSION,      chunk==NULL ?  int8_t(-1) : chunk->_hdr.compressionMethod);
+    write(COMPRESSION,      hdr==NULL ?  int8_t(-1) : hdr->compressionMethod);
     write(FLAGS,
-          chunk==NULL ?
+          hdr==NULL ?
           (valid ?
            uint8_t(ChunkHeader::TOMBSTONE) :
            uint8_t(ChunkHeader::INVALID)) :
-          chunk->_hdr.flags);
-    write(NUM_ELEMENTS,     chunk==NULL ? -1 : chunk->_hdr.nElems);
-    write(COMPRESSED_SIZE,  chunk==NULL ? -1 : chunk->_hdr.compressedSize);
-    write(UNCOMPRESSED_SIZE,chunk==NULL ? -1 : chunk->_hdr.size);
-    write(ALLOCATED_SIZE,   chunk==NULL ? -1 : chunk->_hdr.allocatedSize);
+          hdr->flags);
+    write(NUM_ELEMENTS,     hdr==NULL ? -1 : hdr->nElems);
+    write(COMPRESSED_SIZE,  hdr==NULL ? -1 : hdr->compressedSize);
+    write(UNCOMPRESSED_SIZE,hdr==NULL ? -1 : hdr->size);
+    write(ALLOCATED_SIZE,   hdr==NULL ? -1 : hdr->allocatedSize);
     write(ADDRESS,          uint64_t(chunk));
     write(CLONE_OF,         -1);    //XXX TODO: remove this field (used to be _cloneOf)
     write(CLONES,           "[]");  //XXX TODO: remove this field (used to be _clones)
@@ -181,6 +182,41 @@ void ListChunkMapArrayBuilder::list(const ArrayUAID& uaid,
 
 /****************************************************************************/
 
+Attributes ListCorruptChunksArrayBuilder::getAttributes() const
+{
+    return list_of
+    (AttributeDesc(U_ARRAY_ID,   "uaid",        TID_UINT64,0,0))
+    (AttributeDesc(V_ARRAY_ID,   "arrid",       TID_UINT64,0,0))
+    (AttributeDesc(ATTRIBUTE_ID, "attid",       TID_UINT64,0,0))
+    (AttributeDesc(COORDINATES,  "coord",       TID_STRING,0,0))
+    (AttributeDesc(DISK_OFFSET,  "doffs",       TID_UINT64,0,0))
+    (AttributeDesc(EXPECTED_CRC, "expected_crc",TID_UINT32,0,0))
+    (AttributeDesc(ACTUAL_CRC,   "actual_crc",  TID_UINT32,0,0))
+    (AttributeDesc(DETECTED,     "detected",    TID_DATETIME,0,0))
+    (AttributeDesc(SOURCE,       "source",      TID_STRING,0,0))
+    (emptyBitmapAttribute(EMPTY_INDICATOR));
+}
+
+void ListCorruptChunksArrayBuilder::list(const CorruptChunk& item)
+{
+    std::ostringstream s;
+
+    beginElement();
+    write(U_ARRAY_ID,   item.uaid);
+    write(V_ARRAY_ID,   item.arrId);
+    write(ATTRIBUTE_ID, uint64_t(item.attId));
+    s << item.coords;
+    write(COORDINATES,  s.str());
+    write(DISK_OFFSET,  item.offs);
+    write(EXPECTED_CRC, item.expectedCrc);
+    write(ACTUAL_CRC,   item.actualCrc);
+    write(DETECTED,     item.detected);
+    write(SOURCE,       item.byScrub ? "scrub" : "read");
+    endElement();
+}
+
+/****************************************************************************/
+
 Attributes ListLibrariesArrayBuilder::getAttributes() const
 {
     return list_of
@@ -248,6 +284,7 @@ Attributes ListDataStoresArrayBuilder::getAttributes() const
     (AttributeDesc(FILE_BYTES,     "file_bytes",     TID_UINT64,0,0))
     (AttributeDesc(FILE_BLOCKS_512,"file_blocks_512",TID_UINT64,0,0))
     (AttributeDesc(FILE_FREE,      "file_free_bytes",TID_UINT64,0,0))
+    (AttributeDesc(TIER,           "tier",           TID_UINT32,0,0))
     (emptyBitmapAttribute(EMPTY_INDICATOR));
 }
 
@@ -264,6 +301,7 @@ void ListDataStoresArrayBuilder::list(DataStore const& item)
     write(FILE_BYTES,     filesize);
     write(FILE_BLOCKS_512,fileblks);
     write(FILE_FREE ,     filefree);
+    write(TIER,           static_cast<uint32_t>(item.getTier()));
     endElement();
 }
 
@@ -109,12 +109,37 @@ struct ListChunkMapArrayBuilder : ListArrayBuilder
 
     void       list(const ArrayUAID&,
                     const StorageAddress&,
+                    const ChunkHeader*,
                     const PersistentChunk*,
                     uint64_t,
                     bool);
     Attributes getAttributes() const;
 };
 
+/**
+ *  A ListArrayBuilder for listing chunks which failed checksum verification.
+ */
+struct ListCorruptChunksArrayBuilder : ListArrayBuilder
+{
+    enum
+    {
+        U_ARRAY_ID,
+        V_ARRAY_ID,
+        ATTRIBUTE_ID,
+        COORDINATES,
+        DISK_OFFSET,
+        EXPECTED_CRC,
+        ACTUAL_CRC,
+        DETECTED,
+        SOURCE,
+        EMPTY_INDICATOR,
+        NUM_ATTRIBUTES
+    };
+
+    void       list(const CorruptChunk&);
+    Attributes getAttributes() const;
+};
+
 /**
  *  A ListArrayBuilder for listing loaded library information.
  */
@@ -172,6 +197,7 @@ struct ListDataStoresArrayBuilder : ListArrayBuilder
         FILE_BYTES,
         FILE_BLOCKS_512,
         FILE_FREE,
+        TIER,
         EMPTY_INDICATOR,
         NUM_ATTRIBUTES
     };
@@ -53,6 +53,7 @@ using namespace boost;
  *   - arrays: show all the arrays.
  *   - chunk descriptors: show all the chunk descriptors.
  *   - chunk map: show the chunk map.
+ *   - corrupt chunks: show the chunks found not to match their checksum.
  *   - functions: show all the functions.
  *   - instances: show all SciDB instances.
  *   - libraries: show all the libraries that are loaded in the current SciDB session.
@@ -183,6 +184,8 @@ struct LogicalList : LogicalOperator
             return ListChunkDescriptorsArrayBuilder().getSchema(query);
         } else if (what == "chunk map") {
             return ListChunkMapArrayBuilder().getSchema(query);
+        } else if (what == "corrupt chunks") {
+            return ListCorruptChunksArrayBuilder().getSchema(query);
         } else if (what == "libraries") {
             return ListLibrariesArrayBuilder().getSchema(query);
         } else if (what == "datastores") {
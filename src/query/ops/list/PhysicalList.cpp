@@ -92,6 +92,7 @@ struct PhysicalList : PhysicalOperator
         {
             "chunk descriptors",
             "chunk map",
+            "corrupt chunks",
             "datastores",
             "libraries",
             "meminfo",
@@ -223,7 +224,15 @@ struct PhysicalList : PhysicalOperator
             StorageManager::getInstance().visitChunkMap(
                 Storage::ChunkMapVisitor(
                     boost::bind(
-                        &ListChunkMapArrayBuilder::list,&builder,_1,_2,_3,_4,_5)));
+                        &ListChunkMapArrayBuilder::list,&builder,_1,_2,_3,_4,_5,_6)));
+            return builder.getArray();
+        } else if (what == "corrupt chunks") {
+            ListCorruptChunksArrayBuilder builder;
+            builder.initialize(query);
+            StorageManager::getInstance().visitCorruptChunks(
+                Storage::CorruptChunkVisitor(
+                    boost::bind(
+                        &ListCorruptChunksArrayBuilder::list,&builder,_1)));
             return builder.getArray();
         } else if (what == "libraries") {
             ListLibrariesArrayBuilder builder;
@@ -45,7 +45,7 @@ namespace scidb {
  * @par Synopsis:
  *   redimension( srcArray, schemaArray | schema , isStrict=true | {, AGGREGATE_CALL}* )
  *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr) [as resultName]
- *   <br> AGGREGATE_FUNC := approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
+ *   <br> AGGREGATE_FUNC := approx_quantile | approx_topk | approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
  *
  * @par Summary:
  *   Produces a array using some or all of the variables of a source array, potentially changing some or all of those variables from dimensions
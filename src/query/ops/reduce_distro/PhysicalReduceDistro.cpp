@@ -47,8 +47,9 @@ public:
                              DelegateArray const& delegate,
                              AttributeID attrID,
                              std::shared_ptr<ConstArrayIterator> inputIterator,
-                             PartitioningSchema ps):
-   DelegateArrayIterator(delegate, attrID, inputIterator), _ps(ps), _myInstance(query->getInstanceID()), _nextChunk(0), _query(query)
+                             PartitioningSchema ps,
+                             std::shared_ptr<PartitioningSchemaData> const& psData):
+   DelegateArrayIterator(delegate, attrID, inputIterator), _ps(ps), _psData(psData), _myInstance(query->getInstanceID()), _nextChunk(0), _query(query)
     {
         findNext();
     }
@@ -65,7 +66,7 @@ public:
             std::shared_ptr<CoordinateTranslator> distMapper;
             if (getInstanceForChunk(Query::getValidQueryPtr(_query), pos,
                                     array.getArrayDesc(), _ps,
-                                    distMapper, 0, 0) == _myInstance)
+                                    distMapper, 0, 0, _psData.get()) == _myInstance)
             {
                 _nextChunk = &inputIterator->getChunk();
                 _hasNext = true;
@@ -101,7 +102,7 @@ public:
         chunkInitialized = false;
         std::shared_ptr<CoordinateTranslator> distMapper;
         if (getInstanceForChunk(Query::getValidQueryPtr(_query), pos, array.getArrayDesc(),
-                                _ps, distMapper, 0, 0) == _myInstance &&
+                                _ps, distMapper, 0, 0, _psData.get()) == _myInstance &&
             inputIterator->setPosition(pos))
         {
             _nextChunk = &inputIterator->getChunk();
@@ -124,6 +125,7 @@ public:
 private:
     bool _hasNext;
     PartitioningSchema _ps;
+    std::shared_ptr<PartitioningSchemaData> _psData;
     InstanceID _myInstance;
     ConstChunk const* _nextChunk;
     std::weak_ptr<Query> _query;
@@ -135,7 +137,7 @@ class ReduceDistroArray: public DelegateArray
 {
 public:
     ReduceDistroArray(const std::shared_ptr<Query>& query, ArrayDesc const& desc, std::shared_ptr<Array> const& array, PartitioningSchema ps):
-    DelegateArray(desc, array, true), _ps(ps)
+    DelegateArray(desc, array, true), _ps(ps), _psData(getPartitioningSchemaData(desc))
     {
         assert(query);
         _query = query;
@@ -144,11 +146,12 @@ public:
     virtual DelegateArrayIterator* createArrayIterator(AttributeID id) const
     {
         return new ReduceDistroArrayIterator(Query::getValidQueryPtr(_query),
-                                             *this, id, inputArray->getConstIterator(id), _ps);
+                                             *this, id, inputArray->getConstIterator(id), _ps, _psData);
     }
 
 private:
    PartitioningSchema _ps;
+   std::shared_ptr<PartitioningSchemaData> _psData;
 };
 
 class PhysicalReduceDistro: public  PhysicalOperator
@@ -175,6 +178,9 @@ public:
             std::vector<ArrayDesc> const&) const
     {
         PartitioningSchema ps = (PartitioningSchema)((std::shared_ptr<OperatorParamPhysicalExpression>&)_parameters[0])->getExpression()->evaluate().getInt32();
+        if (ps == _schema.getPartitioningSchema()) {
+            return RedistributeContext(_schema);
+        }
         return RedistributeContext(ps);
     }
 
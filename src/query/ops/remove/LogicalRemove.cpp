@@ -55,7 +55,7 @@ namespace scidb {
  *   n/a
  *
  * @par Errors:
- *   n/a
+ *   - SCIDB_SE_EXECUTION::SCIDB_LE_ARRAY_HAS_VIEWS: a materialized view aggregates arrayToRemove.
  *
  * @par Notes:
  *   n/a
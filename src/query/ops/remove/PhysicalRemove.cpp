@@ -59,6 +59,20 @@ public:
            throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NO_QUORUM2);
        }
        const string &arrayName = ((std::shared_ptr<OperatorParamReference>&)_parameters[0])->getObjectName();
+       bool arrayExists = SystemCatalog::getInstance()->getArrayDesc(arrayName,
+                                                                     query->getCatalogVersion(arrayName),
+                                                                     _schema, true);
+       SCIDB_ASSERT(arrayExists);
+       assert(_schema.getName() == arrayName);
+
+       /* A materialized view cannot outlive its source: refuse before the
+          error handler below would roll the removal forward
+        */
+       string viewName;
+       if (SystemCatalog::getInstance()->findView(_schema.getUAId(), viewName)) {
+           throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_ARRAY_HAS_VIEWS) << arrayName << viewName;
+       }
+
        _lock = std::shared_ptr<SystemCatalog::LockDesc>(new SystemCatalog::LockDesc(arrayName,
                                                                                       query->getQueryID(),
                                                                                       Cluster::getInstance()->getLocalInstanceId(),
@@ -66,12 +80,6 @@ public:
                                                                                       SystemCatalog::LockDesc::RM));
        std::shared_ptr<Query::ErrorHandler> ptr(new RemoveErrorHandler(_lock));
        query->pushErrorHandler(ptr);
-
-       bool arrayExists = SystemCatalog::getInstance()->getArrayDesc(arrayName,
-                                                                     query->getCatalogVersion(arrayName),
-                                                                     _schema, true);
-       SCIDB_ASSERT(arrayExists);
-       assert(_schema.getName() == arrayName);
    }
 
     std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
@@ -0,0 +1,413 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file DenseRepart.cpp
+ *
+ * @brief Repartitioning of arrays of fixed size attributes by runs of cells.
+ */
+
+#include <string.h>
+#include <log4cxx/logger.h>
+
+#include <array/RLE.h>
+#include <query/TypeSystem.h>
+#include <system/Config.h>
+#include <system/Exceptions.h>
+#include <util/CoordinatesMapper.h>
+#include "DenseRepart.h"
+
+using namespace std;
+
+namespace scidb
+{
+
+static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("scidb.query.ops.repart"));
+
+namespace
+{
+
+/// Get the box of the chunk at pos, clipped to the dimensions
+void getChunkBox(Dimensions const& dims, Coordinates const& pos, bool withOverlap,
+                 Coordinates& low, Coordinates& high)
+{
+    const size_t nDims = dims.size();
+    low.resize(nDims);
+    high.resize(nDims);
+    for (size_t i = 0; i < nDims; i++) {
+        const Coordinate overlap = withOverlap ? dims[i].getChunkOverlap() : 0;
+        low[i] = max(pos[i] - overlap, dims[i].getStartMin());
+        high[i] = min(pos[i] + dims[i].getChunkInterval() - 1 + overlap, dims[i].getEndMax());
+    }
+}
+
+/// @return the position of the chunk holding coordinate x in its body
+Coordinate getChunkStart(DimensionDesc const& dim, Coordinate x)
+{
+    return x - (x - dim.getStartMin()) % dim.getChunkInterval();
+}
+
+/**
+ * Advance the coordinates of the first cell of a row to the next row of a box,
+ * all the dimensions but the last being iterated in row-major order.
+ * @return false if there are no rows left
+ */
+bool nextRow(Coordinates& row, Coordinates const& low, Coordinates const& high)
+{
+    for (size_t i = row.size() - 1; i-- > 0; ) {
+        if (++row[i] <= high[i]) {
+            return true;
+        }
+        row[i] = low[i];
+    }
+    return false;
+}
+
+bool hasNulls(ConstRLEPayload const& payload)
+{
+    for (size_t i = 0, n = payload.nSegments(); i < n; i++) {
+        if (payload.getSegment(i).null()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Copy the values of a run of positions of a payload without nulls
+void copyRun(ConstRLEPayload const& payload, position_t pos, size_t length, char* dst, size_t elemSize)
+{
+    size_t segLength = 0;
+    for (size_t s = payload.findSegment(pos); length != 0; s++) {
+        ConstRLEPayload::Segment const& segment = payload.getSegment(s, segLength);
+        const size_t offset = pos - segment.pPosition();
+        const size_t n = min(length, segLength - offset);
+        if (segment.same()) {
+            char const* value = payload.getRawValue(segment.valueIndex());
+            for (size_t i = 0; i < n; i++) {
+                memcpy(dst + i * elemSize, value, elemSize);
+            }
+        } else {
+            memcpy(dst, payload.getRawValue(segment.valueIndex() + offset), n * elemSize);
+        }
+        dst += n * elemSize;
+        pos += n;
+        length -= n;
+    }
+}
+
+}
+
+DenseRepart::DenseRepart(ArrayDesc const& schema, std::shared_ptr<Query> const& query)
+: _schema(schema),
+  _query(query)
+{
+    Attributes const& attrs = _schema.getAttributes(true);
+    _elemSizes.resize(attrs.size());
+    for (size_t i = 0; i < attrs.size(); i++) {
+        _elemSizes[i] = TypeLibrary::getType(attrs[i].getType()).byteSize();
+    }
+}
+
+bool DenseRepart::isApplicable(ArrayDesc const& inputSchema, ArrayDesc const& schema)
+{
+    Attributes const& attrs = schema.getAttributes(true);
+    if (inputSchema.getAttributes(true).size() != attrs.size() ||
+        inputSchema.getDimensions().size() != schema.getDimensions().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < attrs.size(); i++) {
+        Type const& type = TypeLibrary::getType(attrs[i].getType());
+        if (type.variableSize() || type.bitSize() == 1 || attrs[i].isNullable()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<Array> DenseRepart::execute(std::shared_ptr<Array>& input)
+{
+    _input = PhysicalOperator::ensureRandomAccess(input, _query);
+    _output = std::make_shared<MemArray>(ArrayDesc(_schema.getName(),
+                                                   addEmptyTagAttribute(_schema.getAttributes(true)),
+                                                   _schema.getDimensions(),
+                                                   defaultPartitioning()),
+                                         _query);
+    findTargets();
+    _nextTarget = _targets.begin();
+
+    const int nThreads = Config::getInstance()->getOption<int>(CONFIG_RESULT_PREFETCH_THREADS);
+    const size_t nJobs = max<size_t>(1, min<size_t>(nThreads, _targets.size()));
+    LOG4CXX_DEBUG(logger, "DenseRepart: building " << _targets.size() << " chunks with " << nJobs << " jobs");
+
+    std::shared_ptr<JobQueue> queue = PhysicalOperator::getGlobalQueueForOperators();
+    vector< std::shared_ptr<BuildJob> > jobs(nJobs);
+    for (size_t i = 0; i < nJobs; i++) {
+        jobs[i] = std::make_shared<BuildJob>(*this, _query);
+    }
+    for (size_t i = 1; i < nJobs; i++) {
+        queue->pushJob(jobs[i]);
+    }
+
+    jobs[0]->execute();
+
+    int errorJob = -1;
+    for (size_t i = 0; i < nJobs; i++) {
+        if (!jobs[i]->wait()) {
+            errorJob = i;
+        }
+    }
+    if (errorJob >= 0) {
+        jobs[errorJob]->rethrow();
+    }
+    _targets.clear();
+    _input.reset();
+    return _output;
+}
+
+void DenseRepart::findTargets()
+{
+    Dimensions const& inputDims = _input->getArrayDesc().getDimensions();
+    Dimensions const& dims = _schema.getDimensions();
+    const size_t nDims = dims.size();
+    Coordinates low, high, first(nDims), last(nDims), target;
+
+    for (std::shared_ptr<ConstArrayIterator> it = _input->getConstIterator(0); !it->end(); ++(*it)) {
+        Coordinates const& sourcePos = it->getPosition();
+        getChunkBox(inputDims, sourcePos, false, low, high);
+
+        // the output chunks whose boxes, with their overlaps, intersect the body of the input chunk
+        for (size_t i = 0; i < nDims; i++) {
+            first[i] = getChunkStart(dims[i], max(low[i] - dims[i].getChunkOverlap(), dims[i].getStartMin()));
+            last[i] = getChunkStart(dims[i], min(high[i] + dims[i].getChunkOverlap(), dims[i].getEndMax()));
+        }
+        target = first;
+        while (true) {
+            _targets[target].push_back(sourcePos);
+
+            size_t i = nDims;
+            while (i-- > 0) {
+                target[i] += dims[i].getChunkInterval();
+                if (target[i] <= last[i]) {
+                    break;
+                }
+                target[i] = first[i];
+            }
+            if (i == size_t(-1)) {
+                break;
+            }
+        }
+    }
+}
+
+bool DenseRepart::getNextTarget(Coordinates& pos, vector<Coordinates>& sources)
+{
+    ScopedMutexLock cs(_mutex);
+    if (_nextTarget == _targets.end()) {
+        return false;
+    }
+    pos = _nextTarget->first;
+    sources = _nextTarget->second;
+    ++_nextTarget;
+    return true;
+}
+
+DenseRepart::BuildJob::BuildJob(DenseRepart& repart, std::shared_ptr<Query> const& query)
+: Job(query),
+  _repart(repart),
+  _inputIterators(repart._input->getArrayDesc().getAttributes().size()),
+  _outputIterators(repart._output->getArrayDesc().getAttributes().size()),
+  _values(repart._elemSizes.size())
+{
+    for (size_t i = 0; i < _inputIterators.size(); i++) {
+        _inputIterators[i] = repart._input->getConstIterator(i);
+    }
+    for (size_t i = 0; i < _outputIterators.size(); i++) {
+        _outputIterators[i] = repart._output->getIterator(i);
+    }
+}
+
+void DenseRepart::BuildJob::run()
+{
+    Query::setCurrentQueryID(_query->getQueryID());
+
+    Coordinates pos;
+    vector<Coordinates> sources;
+    while (_repart.getNextTarget(pos, sources)) {
+        buildChunk(pos, sources);
+    }
+}
+
+void DenseRepart::BuildJob::buildChunk(Coordinates const& pos, vector<Coordinates> const& sources)
+{
+    Coordinates low, high;
+    getChunkBox(_repart._schema.getDimensions(), pos, true, low, high);
+    CoordinatesMapper target(low, high);
+
+    size_t nCells = 1;
+    for (size_t i = 0; i < low.size(); i++) {
+        nCells *= high[i] - low[i] + 1;
+    }
+    for (size_t i = 0; i < _values.size(); i++) {
+        _values[i].resize(nCells * _repart._elemSizes[i]);
+    }
+    _present.assign(nCells, 0);
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        copyChunk(sources[i], target, low, high);
+    }
+    writeChunks(pos, nCells);
+}
+
+void DenseRepart::BuildJob::copyChunk(Coordinates const& sourcePos, CoordinatesMapper const& target,
+                                      Coordinates const& targetLow, Coordinates const& targetHigh)
+{
+    ArrayDesc const& inputDesc = _repart._input->getArrayDesc();
+    const size_t nDims = targetLow.size();
+
+    // the intersection of the body of the input chunk with the box of the output chunk
+    Coordinates low, high;
+    getChunkBox(inputDesc.getDimensions(), sourcePos, false, low, high);
+    for (size_t i = 0; i < nDims; i++) {
+        low[i] = max(low[i], targetLow[i]);
+        high[i] = min(high[i], targetHigh[i]);
+        if (low[i] > high[i]) {
+            return;
+        }
+    }
+    const size_t rowLength = high[nDims - 1] - low[nDims - 1] + 1;
+
+    for (size_t i = 0; i < _inputIterators.size(); i++) {
+        if (!_inputIterators[i]->setPosition(sourcePos)) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+        }
+    }
+
+    // the input chunk is full if its empty bitmap, if any, has all the cells of its box set
+    AttributeDesc const* emptyTag = inputDesc.getEmptyBitmapAttribute();
+    ConstChunk const& firstChunk = _inputIterators[0]->getChunk();
+    CoordinatesMapper source(firstChunk);
+    size_t nSourceCells = 1;
+    for (size_t i = 0; i < nDims; i++) {
+        nSourceCells *= firstChunk.getLastPosition(true)[i] - firstChunk.getFirstPosition(true)[i] + 1;
+    }
+    bool isFull = true;
+    if (emptyTag != NULL) {
+        ConstChunk const& bitmapChunk = _inputIterators[emptyTag->getId()]->getChunk();
+        PinBuffer scope(bitmapChunk);
+        ConstRLEEmptyBitmap bitmap(static_cast<char const*>(bitmapChunk.getConstData()));
+        isFull = bitmap.count() == nSourceCells;
+    }
+
+    Coordinates row(low);
+    for (AttributeID attr = 0; attr < _values.size(); attr++) {
+        const AttributeID inputAttr = emptyTag != NULL && emptyTag->getId() <= attr ? attr + 1 : attr;
+        ConstChunk const& chunk = _inputIterators[inputAttr]->getChunk();
+        const size_t elemSize = _repart._elemSizes[attr];
+        char* values = &_values[attr][0];
+
+        if (isFull && chunk.isMaterialized()) {
+            PinBuffer scope(chunk);
+            ConstRLEPayload payload(static_cast<char const*>(chunk.getConstData()));
+            if (payload.count() == nSourceCells && !hasNulls(payload)) {
+                row = low;
+                do {
+                    const position_t dstPos = target.coord2pos(row);
+                    copyRun(payload, source.coord2pos(row), rowLength, values + dstPos * elemSize, elemSize);
+                    memset(&_present[dstPos], 1, rowLength);
+                } while (nextRow(row, low, high));
+                continue;
+            }
+        }
+
+        // not full, or with nulls: go through the cells of the body one at a time
+        std::shared_ptr<ConstChunkIterator> it =
+            chunk.getConstIterator(ConstChunkIterator::IGNORE_OVERLAPS | ConstChunkIterator::IGNORE_EMPTY_CELLS);
+        for (; !it->end(); ++(*it)) {
+            Coordinates const& cell = it->getPosition();
+            bool isInside = true;
+            for (size_t i = 0; i < nDims && isInside; i++) {
+                isInside = cell[i] >= low[i] && cell[i] <= high[i];
+            }
+            if (!isInside) {
+                continue;
+            }
+            Value const& value = it->getItem();
+            if (value.isNull()) {
+                continue;
+            }
+            const position_t dstPos = target.coord2pos(cell);
+            memcpy(values + dstPos * elemSize, value.data(), elemSize);
+            _present[dstPos] = 1;
+        }
+    }
+}
+
+void DenseRepart::BuildJob::writeChunks(Coordinates const& pos, size_t nCells)
+{
+    // the runs of present cells, which become the segments of the empty bitmap
+    RLEEmptyBitmap bitmap;
+    RLEEmptyBitmap::Segment segment;
+    segment._pPosition = 0;
+    for (size_t i = 0; i < nCells; ) {
+        if (!_present[i]) {
+            i++;
+            continue;
+        }
+        segment._lPosition = i;
+        while (++i < nCells && _present[i]);
+        segment._length = i - segment._lPosition;
+        bitmap.addSegment(segment);
+        segment._pPosition += segment._length;
+    }
+    const size_t nPresent = bitmap.count();
+    if (nPresent == 0) {
+        return;
+    }
+
+    for (size_t attr = 0; attr < _values.size(); attr++) {
+        const size_t elemSize = _repart._elemSizes[attr];
+        char* values = &_values[attr][0];
+
+        // compact the values to the cells present, which only ever moves them backwards
+        if (nPresent != nCells) {
+            for (size_t s = 0; s < bitmap.nSegments(); s++) {
+                RLEEmptyBitmap::Segment const& run = bitmap.getSegment(s);
+                memmove(values + run._pPosition * elemSize,
+                        values + run._lPosition * elemSize,
+                        run._length * elemSize);
+            }
+        }
+        RLEPayload payload(values, nPresent * elemSize, nPresent * elemSize, elemSize, nPresent, false);
+
+        Chunk& chunk = _outputIterators[attr]->newChunk(pos);
+        chunk.allocate(payload.packedSize());
+        payload.pack(static_cast<char*>(chunk.getData()));
+        chunk.write(_query);
+    }
+
+    Chunk& bitmapChunk = _outputIterators.back()->newChunk(pos);
+    bitmapChunk.allocate(bitmap.packedSize());
+    bitmap.pack(static_cast<char*>(bitmapChunk.getData()));
+    bitmapChunk.write(_query);
+}
+
+}  // namespace scidb
@@ -0,0 +1,127 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file DenseRepart.h
+ *
+ * @brief Repartitioning of arrays of fixed size attributes by runs of cells.
+ *
+ * Every cell of the output belongs to the body of exactly one input chunk, so an
+ * output chunk (with its overlap) is assembled from the intersections of its box with
+ * the bodies of the input chunks it overlaps. The values of each intersection are moved
+ * one row (a run of cells along the last dimension) at a time: with memcpy from the
+ * literal segments of the input payloads, or by repeating the value of a run segment.
+ * Input chunks which are not full, or whose payloads hold nulls, are read cell by cell.
+ * The output chunks are built in parallel, each one into a dense buffer per attribute
+ * which is then compacted to the cells present and packed as a single literal segment.
+ */
+
+#ifndef DENSE_REPART_H_
+#define DENSE_REPART_H_
+
+#include <map>
+#include <vector>
+
+#include <array/Metadata.h>
+#include <array/MemArray.h>
+#include <query/Operator.h>
+#include <util/Job.h>
+#include <util/Mutex.h>
+
+namespace scidb
+{
+
+class DenseRepart
+{
+public:
+    /**
+     * @param schema the schema of the output of repart()
+     * @param query the query context
+     */
+    DenseRepart(ArrayDesc const& schema, std::shared_ptr<Query> const& query);
+
+    /**
+     * @return true if every attribute of schema is of a fixed size type other than bool
+     *         and is not nullable, so that its values can be moved as runs of bytes
+     */
+    static bool isApplicable(ArrayDesc const& inputSchema, ArrayDesc const& schema);
+
+    /**
+     * Repartition the local chunks of an input array.
+     * @return the partial output chunks built from the local input chunks, with an empty tag
+     *         and the undefined partitioning, to be merged by a redistribution
+     */
+    std::shared_ptr<Array> execute(std::shared_ptr<Array>& input);
+
+private:
+    typedef std::map<Coordinates, std::vector<Coordinates>, CoordinatesLess> TargetMap;
+
+    /// A job building output chunks until none are left
+    class BuildJob : public Job
+    {
+    public:
+        BuildJob(DenseRepart& repart, std::shared_ptr<Query> const& query);
+
+    protected:
+        virtual void run();
+
+    private:
+        DenseRepart& _repart;
+        std::vector<std::shared_ptr<ConstArrayIterator> > _inputIterators;
+        std::vector<std::shared_ptr<ArrayIterator> > _outputIterators;
+        std::vector<std::vector<char> > _values;
+        std::vector<char> _present;
+
+        /// Build the output chunk at a position from the input chunks whose bodies it overlaps
+        void buildChunk(Coordinates const& pos, std::vector<Coordinates> const& sources);
+
+        /// Copy the cells of the body of an input chunk that fall into the box of an output chunk
+        void copyChunk(Coordinates const& sourcePos, CoordinatesMapper const& target,
+                       Coordinates const& targetLow, Coordinates const& targetHigh);
+
+        /// Write the cells present in the buffers as the output chunks at a position
+        void writeChunks(Coordinates const& pos, size_t nCells);
+    };
+
+    ArrayDesc const& _schema;
+    std::shared_ptr<Query> _query;
+    std::shared_ptr<Array> _input;
+    std::shared_ptr<MemArray> _output;
+    std::vector<size_t> _elemSizes;
+
+    Mutex _mutex;
+    TargetMap _targets;
+    TargetMap::const_iterator _nextTarget;
+
+    /// Map every output chunk to the local input chunks whose bodies it overlaps
+    void findTargets();
+
+    /**
+     * Get the next output chunk to build.
+     * @return false if no output chunks are left
+     */
+    bool getNextTarget(Coordinates& pos, std::vector<Coordinates>& sources);
+};
+
+}  // namespace scidb
+
+#endif /* DENSE_REPART_H_ */
@@ -31,7 +31,9 @@
 #include <array/Metadata.h>
 #include <network/NetworkManager.h>
 #include <array/DelegateArray.h>
+#include <system/Config.h>
 #include "../redimension/RedimensionCommon.h"
+#include "DenseRepart.h"
 
 using namespace std;
 using namespace boost;
@@ -88,6 +90,14 @@ public:
             return std::shared_ptr<Array> (new DelegateArray(_schema, input, true) );
         }
 
+        // Move runs of cells between the chunk layouts when the values have a fixed size
+        if (!Config::getInstance()->getOption<bool>(CONFIG_REPART_DISABLE_TILE_MODE) &&
+            DenseRepart::isApplicable(input->getArrayDesc(), _schema))
+        {
+            DenseRepart repart(_schema, query);
+            return repart.execute(input);
+        }
+
         Attributes const& destAttrs = _schema.getAttributes(true); // true = exclude empty tag.
         Dimensions const& destDims  = _schema.getDimensions();
 
@@ -62,7 +62,7 @@ class PhysicalScan: public  PhysicalOperator
             // make sure PhysicalScan informs the optimizer that the distribution is unknown
             return RedistributeContext(psUndefined);
         }
-        return RedistributeContext(_schema.getPartitioningSchema());
+        return RedistributeContext(_schema);
     }
 
     virtual PhysicalBoundaries getOutputBoundaries(const std::vector<PhysicalBoundaries> & inputBoundaries,
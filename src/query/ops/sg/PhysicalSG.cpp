@@ -140,7 +140,8 @@ class PhysicalSG: public PhysicalUpdate
             distMapper = CoordinateTranslator::createOffsetMapper(offset);
         }
 
-        return RedistributeContext(ps,distMapper);
+        SCIDB_ASSERT(ps == _schema.getPartitioningSchema());
+        return RedistributeContext(_schema, distMapper);
     }
 
     DimensionVector getOffsetVector(const vector<ArrayDesc> & inputSchemas) const
@@ -196,7 +197,7 @@ class PhysicalSG: public PhysicalUpdate
             // XXX TODO: the incorrect PartitioningSchema (that of the input)
             return redistributeToRandomAccess(srcArray, query, ps,
                                               instanceID, distMapper, 0,
-                                              std::shared_ptr<PartitioningSchemaData>(),
+                                              getPartitioningSchemaData(_schema),
                                               enforceDataIntegrity);
         }
 
@@ -265,7 +266,7 @@ class PhysicalSG: public PhysicalUpdate
             set<Coordinates, CoordinatesLess> newChunkCoordinates;
             redistributeToArray(srcArray, outputArray,  &newChunkCoordinates,
                                 query, ps, instanceID, distMapper, 0,
-                                std::shared_ptr<PartitioningSchemaData>(),
+                                getPartitioningSchemaData(_schema),
                                 enforceDataIntegrity);
 
             if (!_schema.isTransient()) {
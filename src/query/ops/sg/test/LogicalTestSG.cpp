@@ -55,6 +55,9 @@ namespace scidb
  *     3 = psByRow,<br>
  *     4 = psByCol,<br>
  *     5 = psUndefined.<br>
+ *     (8 = psRangePartitioned and 9 = psCoPartitioned are not accepted, because they also need
+ *     the partitioning dimension of the target; the optimizer inserts SGs to them for store() and insert()
+ *     into arrays created with those distributions.)<br>
  *   - instanceId:<br>
  *     -2 = to coordinator (same with 0),<br>
  *     -1 = all instances participate,<br>
@@ -125,6 +125,7 @@ public:
         //XXX TODO: so we are forcing it.
         //XXX TODO: Another complication is that SGs are inserted before the physical execution,
         //XXX TODO: Here, we dont know the true distribution coming into the store()
+        //XXX TODO: An existing target keeps the distribution it was created with.
         ps = defaultPartitioning();
 
         //Ensure attributes names uniqueness.
@@ -236,7 +237,10 @@ public:
         dstDesc.setDimensions(newDims);
         SCIDB_ASSERT(dstDesc.getId() == dstDesc.getUAId() && dstDesc.getName() == arrayName);
         SCIDB_ASSERT(dstDesc.getUAId() > 0);
-        SCIDB_ASSERT(ps==dstDesc.getPartitioningSchema());
+        SCIDB_ASSERT(ps==dstDesc.getPartitioningSchema() ||
+                     dstDesc.getPartitioningSchema()==psReplication ||
+                     dstDesc.getPartitioningSchema()==psRangePartitioned ||
+                     dstDesc.getPartitioningSchema()==psCoPartitioned);
         return dstDesc;
     }
 
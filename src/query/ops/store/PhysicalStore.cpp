@@ -110,7 +110,7 @@ class PhysicalStore: public PhysicalUpdate
     virtual DistributionRequirement getDistributionRequirement(const std::vector< ArrayDesc> & inputSchemas) const
     {
         return DistributionRequirement(DistributionRequirement::SpecificAnyOrder,
-                                       vector<RedistributeContext>(1,RedistributeContext(defaultPartitioning())));
+                                       vector<RedistributeContext>(1,RedistributeContext(_schema)));
     }
 
     std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
@@ -197,18 +197,21 @@ class PhysicalStore: public PhysicalUpdate
             srcArray = std::shared_ptr<Array>(make_shared<NonEmptyableArray>(srcArray));
         }
 
-        // Perform parallel evaluation of aggregate
+        // Store the chunks in parallel morsels of positions if the input can be read at random,
+        // each job writing through its own iterators, in a single pass otherwise
         std::shared_ptr<JobQueue> queue = PhysicalOperator::getGlobalQueueForOperators();
-        size_t nJobs = false // until we have a trully multi-threaded storage manager and
-                             // StoreJob that yields its thread, store() is single-threaded
-            ? Config::getInstance()->getOption<int>(CONFIG_RESULT_PREFETCH_QUEUE_SIZE)
-            : 1;
+        const size_t nJobs = ChunkMorsels::getNumberOfJobs(*srcArray);
+        std::shared_ptr<ChunkMorsels> morsels;
+        if (nJobs > 1) {
+            morsels = std::make_shared<ChunkMorsels>(srcArray,
+                                                     Config::getInstance()->getOption<int>(CONFIG_STORE_MORSEL_SIZE));
+        }
 
         vector< std::shared_ptr<StoreJob> > jobs(nJobs);
         Dimensions const& dims = dstArrayDesc.getDimensions();
         const size_t nDims = dims.size();
         for (size_t i = 0; i < nJobs; i++) {
-            jobs[i] = make_shared<StoreJob>(i, nJobs, dstArray, srcArray, nDims, nAttrs, query);
+            jobs[i] = std::make_shared<StoreJob>(morsels, dstArray, srcArray, nDims, nAttrs, query);
         }
         for (size_t i = 1; i < nJobs; i++) {
             queue->pushJob(jobs[i]);
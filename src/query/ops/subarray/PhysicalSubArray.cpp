@@ -158,7 +158,8 @@ public:
         RedistributeContext inputDistro = inputDistributions[0];
         if (inputDistro.isUndefined() ||
             inputDistro.getPartitioningSchema() == psScaLAPACK ||
-            inputDistro.getPartitioningSchema() == psGroupby)
+            inputDistro.getPartitioningSchema() == psGroupby ||
+            inputDistro.hasPartitioningDimension())
         {
             return RedistributeContext(psUndefined);
         }
@@ -37,7 +37,7 @@ namespace scidb
  * @par Synopsis:
  *   variable_window( srcArray, dim, leftEdge, rightEdge {, AGGREGATE_CALL}+ )
  *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr) [as resultName]
- *   <br> AGGREGATE_FUNC := approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
+ *   <br> AGGREGATE_FUNC := approx_quantile | approx_topk | approxdc | avg | count | max | min | sum | stdev | var | some_use_defined_aggregate_function
  *
  * @par Summary:
  *   Produces a result array with the same dimensions as the source array, where each cell stores some aggregates calculated over
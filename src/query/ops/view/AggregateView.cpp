@@ -0,0 +1,640 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file AggregateView.cpp
+ *
+ * @brief Materialized aggregate views maintained incrementally.
+ */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <log4cxx/logger.h>
+
+#include <array/DBArray.h>
+#include <array/MemArray.h>
+#include <smgr/io/Storage.h>
+#include <system/Exceptions.h>
+#include <system/SystemCatalog.h>
+#include <util/Network.h>
+
+#include "AggregateView.h"
+
+using namespace std;
+
+namespace scidb
+{
+
+static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("scidb.query.ops.view"));
+
+AggregateViewDesc::AggregateViewDesc(string const& viewName, string const& text)
+{
+    istringstream lines(text);
+    string line;
+    while (getline(lines, line)) {
+        istringstream words(line);
+        string word;
+        if (!(words >> word)) {
+            continue;
+        }
+        if (word == "by") {
+            while (words >> word) {
+                _groupBy.push_back(word);
+            }
+            continue;
+        }
+        Call call;
+        call.aggregateName = word;
+        if (!(words >> call.inputName >> call.inputType >> call.outputName)) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_METADATA, SCIDB_LE_NOT_A_VIEW) << viewName;
+        }
+        double parameter;
+        while (words >> parameter) {
+            call.parameters.push_back(parameter);
+        }
+        if (!words.eof()) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_METADATA, SCIDB_LE_NOT_A_VIEW) << viewName;
+        }
+        _calls.push_back(call);
+    }
+    if (_calls.empty()) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_METADATA, SCIDB_LE_NOT_A_VIEW) << viewName;
+    }
+}
+
+void AggregateViewDesc::addCall(std::shared_ptr<OperatorParamAggregateCall> const& aggregateCall,
+                                ArrayDesc const& source)
+{
+    AttributeID inputId = INVALID_ATTRIBUTE_ID;
+    Call call;
+    AggregatePtr agg = resolveAggregate(aggregateCall, source.getAttributes(), &inputId, &call.outputName);
+
+    // the states of a view are merged in no particular order
+    if (agg->isOrderSensitive()) {
+        throw USER_EXCEPTION(SCIDB_SE_OPERATOR, SCIDB_LE_AGGREGATION_ORDER_MISMATCH) << agg->getName();
+    }
+
+    call.aggregateName = aggregateCall->getAggregateName();
+    if (inputId == INVALID_ATTRIBUTE_ID) {
+        call.inputName = "*";
+        call.inputType = TID_VOID;
+    } else {
+        call.inputName = source.getAttributes()[inputId].getName();
+        call.inputType = source.getAttributes()[inputId].getType();
+    }
+    call.parameters = aggregateCall->getParameters();
+    _calls.push_back(call);
+}
+
+void AggregateViewDesc::addGroupBy(std::shared_ptr<OperatorParamDimensionReference> const& dimension,
+                                   ArrayDesc const& source)
+{
+    Dimensions const& dims = source.getDimensions();
+    for (size_t i = 0; i < dims.size(); ++i) {
+        if (dims[i].hasNameAndAlias(dimension->getObjectName(), dimension->getArrayName())) {
+            if (find(_groupBy.begin(), _groupBy.end(), dims[i].getBaseName()) == _groupBy.end()) {
+                _groupBy.push_back(dims[i].getBaseName());
+            }
+            return;
+        }
+    }
+    throw SYSTEM_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_DIMENSION_NOT_EXIST)
+        << dimension->getObjectName() << "create_view input" << dims;
+}
+
+vector<AggregatePtr> AggregateViewDesc::createAggregates() const
+{
+    vector<AggregatePtr> aggs(_calls.size());
+    for (size_t i = 0; i < _calls.size(); ++i) {
+        aggs[i] = AggregateLibrary::getInstance()->createAggregate(_calls[i].aggregateName,
+                                                                   TypeLibrary::getType(_calls[i].inputType));
+        aggs[i]->setParameters(_calls[i].parameters);
+    }
+    return aggs;
+}
+
+string AggregateViewDesc::toString() const
+{
+    ostringstream out;
+    out.precision(17);
+    for (size_t i = 0; i < _calls.size(); ++i) {
+        Call const& call = _calls[i];
+        out << call.aggregateName << ' ' << call.inputName << ' ' << call.inputType << ' ' << call.outputName;
+        for (size_t j = 0; j < call.parameters.size(); ++j) {
+            out << ' ' << call.parameters[j];
+        }
+        out << '\n';
+    }
+    if (!_groupBy.empty()) {
+        out << "by";
+        for (size_t i = 0; i < _groupBy.size(); ++i) {
+            out << ' ' << _groupBy[i];
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+size_t AggregateViewDesc::mapDimensions(ArrayDesc const& source, vector<size_t>& positions) const
+{
+    Dimensions const& dims = source.getDimensions();
+    const size_t nChunkDims = std::max<size_t>(dims.size() - _groupBy.size(), 1);
+
+    positions.assign(dims.size(), 0);
+    size_t nextChunkDim = 0;
+    for (size_t i = 0; i < dims.size(); ++i) {
+        vector<string>::const_iterator g = find(_groupBy.begin(), _groupBy.end(), dims[i].getBaseName());
+        positions[i] = (g == _groupBy.end()) ? nextChunkDim++ : nChunkDims + (g - _groupBy.begin());
+    }
+    if (nextChunkDim + _groupBy.size() != dims.size()) {
+        for (size_t g = 0; g < _groupBy.size(); ++g) {
+            if (source.findDimension(_groupBy[g], "") < 0) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_QPROC, SCIDB_LE_DIMENSION_NOT_EXIST)
+                    << _groupBy[g] << "view source" << dims;
+            }
+        }
+    }
+    return nChunkDims;
+}
+
+/// Make a dimension name distinct from the ones already taken
+static string uniqueName(string const& name, set<string>& taken)
+{
+    string result = name;
+    for (size_t i = 2; taken.count(result); ++i) {
+        stringstream ss;
+        ss << name << "_" << i;
+        result = ss.str();
+    }
+    taken.insert(result);
+    return result;
+}
+
+ArrayDesc AggregateViewDesc::createStateDesc(string const& viewName, ArrayDesc const& source) const
+{
+    vector<size_t> positions;
+    const size_t nChunkDims = mapDimensions(source, positions);
+    Dimensions const& srcDims = source.getDimensions();
+    Dimensions dims(nChunkDims + (_groupBy.empty() ? 1 : _groupBy.size()));
+
+    set<string> taken;
+    for (size_t i = 0; i < srcDims.size(); ++i) {
+        if (positions[i] >= nChunkDims) {
+            DimensionDesc const& d = srcDims[i];
+            dims[positions[i]] = DimensionDesc(uniqueName(d.getBaseName(), taken),
+                                               d.getStartMin(),
+                                               d.getCurrStart(),
+                                               d.getCurrEnd(),
+                                               d.getEndMax(),
+                                               d.getChunkInterval(),
+                                               0);
+        }
+    }
+    if (_groupBy.empty()) {
+        dims[nChunkDims] = DimensionDesc(uniqueName("i", taken), 0, 0, 0, 0, 1, 0);
+    }
+    if (nChunkDims + _groupBy.size() > srcDims.size()) {
+        dims[0] = DimensionDesc(uniqueName("chunk", taken), -1, CoordinateBounds::getMax(), 1, 0);
+    }
+    for (size_t i = 0; i < srcDims.size(); ++i) {
+        if (positions[i] < nChunkDims) {
+            dims[positions[i]] = DimensionDesc(uniqueName(srcDims[i].getBaseName() + "_chunk", taken),
+                                               -1, CoordinateBounds::getMax(), 1, 0);
+        }
+    }
+
+    vector<AggregatePtr> aggs = createAggregates();
+    Attributes attrs;
+    for (size_t i = 0; i < aggs.size(); ++i) {
+        Value defaultNull;
+        defaultNull.setNull(0);
+        attrs.push_back(AttributeDesc(i,
+                                      _calls[i].outputName,
+                                      aggs[i]->getStateType().typeId(),
+                                      AttributeDesc::IS_NULLABLE,
+                                      0, std::set<std::string>(), &defaultNull, ""));
+    }
+    return ArrayDesc(viewName, attrs, dims, defaultPartitioning());
+}
+
+ArrayDesc AggregateViewDesc::createResultDesc(ArrayDesc const& stateDesc) const
+{
+    Dimensions const& stateDims = stateDesc.getDimensions();
+    Dimensions dims(stateDims.begin() + getNumberOfChunkDims(stateDesc), stateDims.end());
+
+    ArrayDesc result(stateDesc.getName(), Attributes(), dims, defaultPartitioning());
+    vector<AggregatePtr> aggs = createAggregates();
+    for (size_t i = 0; i < aggs.size(); ++i) {
+        result.addAttribute(AttributeDesc(i,
+                                          _calls[i].outputName,
+                                          aggs[i]->getResultType().typeId(),
+                                          AttributeDesc::IS_NULLABLE,
+                                          0));
+    }
+    if (!_groupBy.empty()) {
+        result.addAttribute(AttributeDesc(aggs.size(),
+                                          DEFAULT_EMPTY_TAG_ATTRIBUTE_NAME,
+                                          TID_INDICATOR,
+                                          AttributeDesc::IS_EMPTY_INDICATOR,
+                                          0));
+    }
+    return result;
+}
+
+AggregateViewUpdate::AggregateViewUpdate(const string& logicalName,
+                                         const string& physicalName,
+                                         const Parameters& parameters,
+                                         const ArrayDesc& schema,
+                                         const string& viewName):
+PhysicalUpdate(logicalName, physicalName, parameters, schema, viewName),
+_sourceId(0),
+_sourceVersionId(0)
+{}
+
+void AggregateViewUpdate::lockView(std::shared_ptr<Query>& query)
+{
+    if (_lock) {
+        return;
+    }
+    SCIDB_ASSERT(!query->isCoordinator());
+    SCIDB_ASSERT(!_schema.isTransient());
+
+    _lock = std::make_shared<SystemCatalog::LockDesc>(_unversionedArrayName,
+                                                      query->getQueryID(),
+                                                      Cluster::getInstance()->getLocalInstanceId(),
+                                                      SystemCatalog::LockDesc::WORKER,
+                                                      SystemCatalog::LockDesc::WR);
+    _lock->setArrayVersion(_schema.getVersionId());
+    std::shared_ptr<Query::ErrorHandler> ptr(std::make_shared<UpdateErrorHandler>(_lock));
+    query->pushErrorHandler(ptr);
+
+    Query::Finalizer f = boost::bind(&UpdateErrorHandler::releaseLock, _lock, _1);
+    query->pushFinalizer(f);
+    SystemCatalog::ErrorChecker errorChecker(boost::bind(&Query::validate, query));
+    if (!SystemCatalog::getInstance()->lockArray(_lock, errorChecker)) {
+        throw USER_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_CANT_INCREMENT_LOCK) << _lock->toString();
+    }
+}
+
+void AggregateViewUpdate::getPreviousBoundaries(Coordinates& lo, Coordinates& hi)
+{
+    const size_t nDims = _schema.getDimensions().size();
+    lo.assign(nDims, CoordinateBounds::getMax());
+    hi.assign(nDims, CoordinateBounds::getMin());
+
+    const VersionID version = _schema.getVersionId() - 1;
+    if (version == 0) {
+        return;
+    }
+    ArrayDesc previous;
+    SystemCatalog::getInstance()->getArrayDesc(_unversionedArrayName, SystemCatalog::ANY_VERSION,
+                                               version, previous, true);
+    lo = previous.getLowBoundary();
+    hi = previous.getHighBoundary();
+}
+
+namespace
+{
+    typedef map<Coordinates, Value, CoordinatesLess> CellStates;
+
+    /// The states of all the cells of a view, by chunk
+    typedef map<Coordinates, CellStates, CoordinatesLess> ChunkStates;
+
+    bool isInitialized(Value const& state)
+    {
+        return !(state.isNull() && state.getMissingReason() == 0);
+    }
+
+    /// The group chunk of a view chunk
+    Coordinates getGroupChunk(Coordinates const& pos, size_t nChunkDims)
+    {
+        return Coordinates(pos.begin() + nChunkDims, pos.end());
+    }
+
+    /// The chunk of a view holding the states merged over all the source chunks
+    Coordinates getMergedChunk(Coordinates const& groupChunk, size_t nChunkDims)
+    {
+        Coordinates pos(nChunkDims, -1);
+        pos.insert(pos.end(), groupChunk.begin(), groupChunk.end());
+        return pos;
+    }
+
+    void writeStates(ArrayIterator& arrayIterator,
+                     Coordinates const& chunkPos,
+                     CellStates const& states,
+                     std::shared_ptr<Query> const& query)
+    {
+        Chunk& chunk = arrayIterator.newChunk(chunkPos);
+        std::shared_ptr<ChunkIterator> it = chunk.getIterator(query);
+        for (CellStates::const_iterator i = states.begin(); i != states.end(); ++i) {
+            if (!it->setPosition(i->first)) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+            }
+            it->writeItem(i->second);
+        }
+        it->flush();
+    }
+
+    /// Copy all the chunks of an array into the new version of a view
+    void copyChunks(Array& from,
+                    vector<std::shared_ptr<ArrayIterator> >& to,
+                    PhysicalBoundaries& bounds,
+                    CoordinateSet* positions)
+    {
+        for (AttributeID i = 0; i < to.size(); ++i) {
+            for (std::shared_ptr<ConstArrayIterator> it = from.getConstIterator(i); !it->end(); ++(*it)) {
+                ConstChunk const& chunk = it->getChunk();
+                to[i]->copyChunk(chunk);
+                if (i == 0) {
+                    bounds.updateFromChunk(&chunk, true);
+                    if (positions) {
+                        positions->insert(it->getPosition());
+                    }
+                }
+            }
+        }
+    }
+
+    void marshall(vector<Coordinate>& out, vector<Coordinates> const& positions)
+    {
+        out.push_back(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            out.insert(out.end(), positions[i].begin(), positions[i].end());
+        }
+    }
+
+    Coordinate const* unMarshall(Coordinate const* in, size_t nDims, vector<Coordinates>& positions)
+    {
+        const size_t n = *in++;
+        for (size_t i = 0; i < n; ++i, in += nDims) {
+            positions.push_back(Coordinates(in, in + nDims));
+        }
+        return in;
+    }
+
+    /**
+     * Let every instance know the view chunks dropped and the group chunks touched by the others.
+     * @param[in,out] removed the positions of the view chunks of the removed source chunks
+     * @param[in,out] touched the group chunks of the written and removed source chunks
+     */
+    void exchangeChanges(vector<Coordinates>& removed,
+                         vector<Coordinates>& touched,
+                         size_t nDims,
+                         size_t nGroupDims,
+                         std::shared_ptr<Query>& query)
+    {
+        vector<Coordinate> data;
+        marshall(data, removed);
+        marshall(data, touched);
+        std::shared_ptr<SharedBuffer> buf(new MemoryBuffer(&data[0], data.size() * sizeof(Coordinate)));
+
+        const InstanceID myInstanceId = query->getInstanceID();
+        for (InstanceID i = 0; i < query->getInstancesCount(); ++i) {
+            if (i != myInstanceId) {
+                BufSend(i, buf, query);
+            }
+        }
+        for (InstanceID i = 0; i < query->getInstancesCount(); ++i) {
+            if (i != myInstanceId) {
+                std::shared_ptr<SharedBuffer> in = BufReceive(i, query);
+                Coordinate const* p = static_cast<Coordinate const*>(in->getData());
+                p = unMarshall(p, nDims, removed);
+                unMarshall(p, nGroupDims, touched);
+            }
+        }
+    }
+}
+
+std::shared_ptr<Array> AggregateViewUpdate::refresh(AggregateViewDesc const& view,
+                                                    ArrayDesc const& source,
+                                                    ArrayID fromVersionId,
+                                                    std::shared_ptr<Query>& query)
+{
+    Storage& storage = StorageManager::getInstance();
+    SCIDB_ASSERT(fromVersionId >= source.getUAId() && fromVersionId <= source.getId());
+
+    vector<size_t> positions;
+    const size_t nChunkDims = view.mapDimensions(source, positions);
+    const size_t nDims = _schema.getDimensions().size();
+    Dimensions const& srcDims = source.getDimensions();
+    vector<AggregatePtr> aggs = view.createAggregates();
+    vector<AggregateViewDesc::Call> const& calls = view.getCalls();
+
+    std::shared_ptr<Array> dstArray(DBArray::newDBArray(_schema, query));
+    query->getReplicationContext()->enableInboundQueue(_schema.getId(), dstArray);
+    vector<std::shared_ptr<ArrayIterator> > dstIters(aggs.size());
+    for (AttributeID i = 0; i < aggs.size(); ++i) {
+        dstIters[i] = dstArray->getIterator(i);
+    }
+    Coordinates lo, hi;
+    getPreviousBoundaries(lo, hi);
+    PhysicalBoundaries bounds(lo, hi);
+
+    // The local source chunks written after fromVersionId, and those removed since then.
+    // Only the chunk map is consulted.
+    vector<Coordinates> written;
+    StorageAddress addr(source.getId(), 0, Coordinates());
+    while (storage.findNextChunk(source, query, addr)) {
+        if (addr.arrId > fromVersionId) {
+            written.push_back(addr.coords);
+        }
+    }
+    vector<Coordinates> removed;
+    if (fromVersionId != source.getUAId()) {
+        ArrayDesc fromDesc(source);
+        fromDesc.setIds(fromVersionId, source.getUAId(), 0);
+        StorageAddress fromAddr(fromVersionId, 0, Coordinates());
+        while (storage.findNextChunk(fromDesc, query, fromAddr)) {
+            StorageAddress toAddr(source.getId(), 0, fromAddr.coords);
+            if (!storage.findChunk(source, query, toAddr)) {
+                removed.push_back(fromAddr.coords);
+            }
+        }
+    }
+    LOG4CXX_DEBUG(logger, "AggregateViewUpdate::refresh: " << written.size() << " source chunks written, "
+                  << removed.size() << " removed since array " << fromVersionId);
+
+    // Aggregate the written source chunks, each into its own view chunk
+    std::shared_ptr<Array> srcArray(DBArray::newDBArray(source, query));
+    std::shared_ptr<MemArray> delta(std::make_shared<MemArray>(_schema, query));
+    CoordinateSet touchedSet;
+    Coordinates chunkPos(nDims), cellPos(nDims);
+    for (size_t c = 0; c < calls.size(); ++c) {
+        AttributeID inputId = 0;
+        if (calls[c].inputName == "*") {
+            if (source.getEmptyBitmapAttribute()) {
+                inputId = source.getEmptyBitmapAttribute()->getId();
+            }
+        } else {
+            Attributes const& attrs = source.getAttributes(true);
+            size_t a = 0;
+            while (a < attrs.size() && attrs[a].getName() != calls[c].inputName) {
+                ++a;
+            }
+            if (a == attrs.size()) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_METADATA, SCIDB_LE_NOT_A_VIEW) << _unversionedArrayName;
+            }
+            inputId = attrs[a].getId();
+        }
+        std::shared_ptr<ConstArrayIterator> srcIter = srcArray->getConstIterator(inputId);
+        std::shared_ptr<ArrayIterator> deltaIter = delta->getIterator(c);
+        const int mode = ChunkIterator::IGNORE_EMPTY_CELLS | ChunkIterator::IGNORE_OVERLAPS |
+            (aggs[c]->ignoreNulls() ? ChunkIterator::IGNORE_NULL_VALUES : 0);
+
+        for (size_t w = 0; w < written.size(); ++w) {
+            Coordinates const& srcPos = written[w];
+            chunkPos.assign(nDims, 0);
+            for (size_t d = 0; d < srcDims.size(); ++d) {
+                chunkPos[positions[d]] = (positions[d] < nChunkDims)
+                    ? (srcPos[d] - srcDims[d].getStartMin()) / srcDims[d].getChunkInterval()
+                    : srcPos[d];
+            }
+            touchedSet.insert(getGroupChunk(chunkPos, nChunkDims));
+
+            if (!srcIter->setPosition(srcPos)) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+            }
+            CellStates states;
+            cellPos = chunkPos;
+            for (std::shared_ptr<ConstChunkIterator> it = srcIter->getChunk().getConstIterator(mode);
+                 !it->end(); ++(*it)) {
+                Coordinates const& pos = it->getPosition();
+                for (size_t d = 0; d < srcDims.size(); ++d) {
+                    if (positions[d] >= nChunkDims) {
+                        cellPos[positions[d]] = pos[d];
+                    }
+                }
+                aggs[c]->accumulateIfNeeded(states[cellPos], it->getItem());
+            }
+            // an empty chunk still replaces the states of the previous one
+            writeStates(*deltaIter, chunkPos, states, query);
+        }
+    }
+    vector<Coordinates> removedStates;
+    for (size_t r = 0; r < removed.size(); ++r) {
+        chunkPos.assign(nDims, 0);
+        for (size_t d = 0; d < srcDims.size(); ++d) {
+            chunkPos[positions[d]] = (positions[d] < nChunkDims)
+                ? (removed[r][d] - srcDims[d].getStartMin()) / srcDims[d].getChunkInterval()
+                : removed[r][d];
+        }
+        removedStates.push_back(chunkPos);
+        touchedSet.insert(getGroupChunk(chunkPos, nChunkDims));
+    }
+
+    // Store the states of the written source chunks on the instances responsible for them
+    std::shared_ptr<Array> deltaArray(delta);
+    delta.reset();
+    std::shared_ptr<Array> redistributed = redistributeToRandomAccess(deltaArray,
+                                                                      query,
+                                                                      defaultPartitioning(),
+                                                                      ALL_INSTANCE_MASK,
+                                                                      std::shared_ptr<CoordinateTranslator>(),
+                                                                      0,
+                                                                      std::shared_ptr<PartitioningSchemaData>());
+    deltaArray.reset();
+    copyChunks(*redistributed, dstIters, bounds, NULL);
+    redistributed.reset();
+
+    // Drop the states of the removed source chunks
+    vector<Coordinates> touched(touchedSet.begin(), touchedSet.end());
+    exchangeChanges(removedStates, touched, nDims, nDims - nChunkDims, query);
+    touchedSet.insert(touched.begin(), touched.end());
+    for (size_t r = 0; r < removedStates.size(); ++r) {
+        StorageAddress viewAddr(_schema.getId(), 0, removedStates[r]);
+        if (storage.findChunk(_schema, query, viewAddr)) {
+            storage.removeChunkVersion(_schema, removedStates[r], query);
+        }
+    }
+
+    // Re-merge the local states of the touched group chunks
+    vector<Coordinates> toMerge;
+    StorageAddress viewAddr(_schema.getId(), 0, Coordinates());
+    while (storage.findNextChunk(_schema, query, viewAddr)) {
+        if (viewAddr.coords[0] != -1 && touchedSet.count(getGroupChunk(viewAddr.coords, nChunkDims))) {
+            toMerge.push_back(viewAddr.coords);
+        }
+    }
+    std::shared_ptr<MemArray> partial(std::make_shared<MemArray>(_schema, query));
+    for (AttributeID i = 0; i < aggs.size(); ++i) {
+        ChunkStates merged;
+        std::shared_ptr<ConstArrayIterator> viewIter = dstArray->getConstIterator(i);
+        for (size_t m = 0; m < toMerge.size(); ++m) {
+            if (!viewIter->setPosition(toMerge[m])) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+            }
+            for (std::shared_ptr<ConstChunkIterator> it = viewIter->getChunk().getConstIterator();
+                 !it->end(); ++(*it)) {
+                Value const& state = it->getItem();
+                if (!isInitialized(state)) {
+                    continue;
+                }
+                cellPos = it->getPosition();
+                std::fill(cellPos.begin(), cellPos.begin() + nChunkDims, -1);
+                CellStates& states = merged[getMergedChunk(getGroupChunk(toMerge[m], nChunkDims), nChunkDims)];
+                aggs[i]->mergeIfNeeded(states[cellPos], state);
+            }
+        }
+        std::shared_ptr<ArrayIterator> partialIter = partial->getIterator(i);
+        for (ChunkStates::const_iterator c = merged.begin(); c != merged.end(); ++c) {
+            writeStates(*partialIter, c->first, c->second, query);
+        }
+    }
+
+    // Merge the partial states across the instances
+    std::shared_ptr<Array> partialArray(partial);
+    partial.reset();
+    std::shared_ptr<Array> mergedArray = redistributeToRandomAccess(partialArray,
+                                                                    query,
+                                                                    aggs,
+                                                                    defaultPartitioning(),
+                                                                    ALL_INSTANCE_MASK,
+                                                                    std::shared_ptr<CoordinateTranslator>(),
+                                                                    0,
+                                                                    std::shared_ptr<PartitioningSchemaData>());
+    partialArray.reset();
+    CoordinateSet mergedChunks;
+    copyChunks(*mergedArray, dstIters, bounds, &mergedChunks);
+    mergedArray.reset();
+
+    // Drop the merged states of the group chunks left without data
+    for (CoordinateSet::const_iterator g = touchedSet.begin(); g != touchedSet.end(); ++g) {
+        Coordinates const pos = getMergedChunk(*g, nChunkDims);
+        StorageAddress mergedAddr(_schema.getId(), 0, pos);
+        if (!mergedChunks.count(pos) && storage.findChunk(_schema, query, mergedAddr)) {
+            storage.removeChunkVersion(_schema, pos, query);
+        }
+    }
+
+    updateSchemaBoundaries(_schema, bounds, query);
+
+    query->getReplicationContext()->replicationSync(_schema.getId());
+    query->getReplicationContext()->removeInboundQueue(_schema.getId());
+
+    storage.flush();
+    getInjectedErrorListener().check();
+    return std::shared_ptr<Array>(std::make_shared<MemArray>(_schema, query));
+}
+
+} // namespace scidb
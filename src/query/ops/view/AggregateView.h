@@ -0,0 +1,209 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file AggregateView.h
+ *
+ * @brief Materialized aggregate views maintained incrementally.
+ *
+ * A view is a persistent array V holding the aggregate states (not the final results)
+ * of an aggregate() over a stored source array. Its dimensions are
+ * <ul>
+ * <li> one dimension [-1:*,1,0] per source dimension that is not grouped by,
+ *      holding the number of the source chunk along that dimension
+ *      (a single dimension 'chunk' if all the source dimensions are grouped by), followed by
+ * <li> the group-by dimensions with the chunk intervals of the source, or 'i' [0:0,1,0]
+ *      for a grand aggregate.
+ * </ul>
+ * Every source chunk thus maps to exactly one chunk of V, which holds the states
+ * of that source chunk alone. The chunk at -1 along all the chunk number dimensions
+ * holds the states of the whole group chunk, merged over all the source chunks.
+ *
+ * A refresh looks up in the storage chunk map the source chunks written or removed since
+ * the source version the view was computed from, re-aggregates only the written ones,
+ * and re-merges the states of the group chunks they touch. The catalog records the
+ * definition of the view and the source version it is current with.
+ */
+
+#ifndef AGGREGATE_VIEW_H_
+#define AGGREGATE_VIEW_H_
+
+#include <string>
+#include <vector>
+
+#include <array/Metadata.h>
+#include <query/Aggregate.h>
+#include <query/Operator.h>
+
+namespace scidb
+{
+
+/**
+ * The definition of a materialized aggregate view: the aggregate calls and the group-by dimensions.
+ * It is recorded in the catalog as text, one aggregate call per line:
+ *   aggregateName inputAttribute inputType outputName {parameter}*
+ * with '*' and 'void' as the input of count(*), optionally followed by a line
+ *   by {dimensionName}+
+ */
+class AggregateViewDesc
+{
+public:
+    struct Call
+    {
+        std::string aggregateName;
+        std::string inputName;
+        TypeId inputType;
+        std::string outputName;
+        std::vector<double> parameters;
+    };
+
+    AggregateViewDesc() {}
+
+    /**
+     * Parse the definition recorded in the catalog.
+     * @param viewName the name of the view, for error reporting
+     * @param text the definition produced by toString()
+     * @throw SYSTEM_EXCEPTION SCIDB_LE_NOT_A_VIEW if the text is malformed
+     */
+    AggregateViewDesc(std::string const& viewName, std::string const& text);
+
+    /**
+     * Append an aggregate call of create_view().
+     * @param aggregateCall the call
+     * @param source the schema of the source array
+     * @throw USER_EXCEPTION SCIDB_LE_AGGREGATION_ORDER_MISMATCH if the aggregate is order sensitive
+     */
+    void addCall(std::shared_ptr<OperatorParamAggregateCall> const& aggregateCall, ArrayDesc const& source);
+
+    /**
+     * Append a group-by dimension of create_view(), ignoring duplicates.
+     * @param dimension the reference to the dimension
+     * @param source the schema of the source array
+     * @throw SYSTEM_EXCEPTION SCIDB_LE_DIMENSION_NOT_EXIST if the source has no such dimension
+     */
+    void addGroupBy(std::shared_ptr<OperatorParamDimensionReference> const& dimension, ArrayDesc const& source);
+
+    std::vector<Call> const& getCalls() const
+    {
+        return _calls;
+    }
+
+    std::vector<std::string> const& getGroupBy() const
+    {
+        return _groupBy;
+    }
+
+    /**
+     * @return the aggregates of the calls, in order
+     */
+    std::vector<AggregatePtr> createAggregates() const;
+
+    /**
+     * @return the text to record in the catalog
+     */
+    std::string toString() const;
+
+    /**
+     * Map the dimensions of the source array to the dimensions of the view.
+     * @param source the schema of the source array
+     * @param[out] positions for every source dimension the position of the view dimension
+     *        holding its chunk number if it is not grouped by, or its coordinate if it is
+     * @return the number of the dimensions of the view the group-by dimensions are preceded by
+     * @throw SYSTEM_EXCEPTION SCIDB_LE_DIMENSION_NOT_EXIST if the source lacks a group-by dimension
+     */
+    size_t mapDimensions(ArrayDesc const& source, std::vector<size_t>& positions) const;
+
+    /**
+     * Build the schema of the array holding the states of the view.
+     * @param viewName the name of the view
+     * @param source the schema of the source array
+     */
+    ArrayDesc createStateDesc(std::string const& viewName, ArrayDesc const& source) const;
+
+    /**
+     * Build the schema of scan_view(), the one aggregate() would produce.
+     * @param stateDesc the schema of the array holding the states of the view
+     */
+    ArrayDesc createResultDesc(ArrayDesc const& stateDesc) const;
+
+    /**
+     * @return the number of the dimensions of a view array the group-by dimensions are preceded by
+     */
+    size_t getNumberOfChunkDims(ArrayDesc const& stateDesc) const
+    {
+        return stateDesc.getDimensions().size() - (_groupBy.empty() ? 1 : _groupBy.size());
+    }
+
+private:
+    std::vector<Call> _calls;
+    std::vector<std::string> _groupBy;
+};
+
+/**
+ * The base of the physical operators writing a new version of a view.
+ */
+class AggregateViewUpdate: public PhysicalUpdate
+{
+protected:
+    ArrayID _sourceId;
+    ArrayID _sourceVersionId;
+    std::string _definition;
+
+public:
+    /// @see scidb::PhysicalUpdate::PhysicalUpdate
+    AggregateViewUpdate(const std::string& logicalName,
+                        const std::string& physicalName,
+                        const Parameters& parameters,
+                        const ArrayDesc& schema,
+                        const std::string& viewName);
+
+protected:
+    /**
+     * On a worker, lock the view for writing the new version.
+     * The coordinator holds the lock since preSingleExecute().
+     */
+    void lockView(std::shared_ptr<Query>& query);
+
+    /**
+     * Bring the view up to date with a version of the source array:
+     * re-aggregate the source chunks written after fromVersionId,
+     * drop the states of the ones removed since then, and re-merge the group chunks they touch.
+     * Must be called on every instance.
+     * @param view the definition of the view
+     * @param source the schema of the source version to refresh to
+     * @param fromVersionId the id of the source version the view is current with,
+     *        the unversioned id of the source if the view is empty
+     * @param query the query context
+     * @return an empty array with the schema of the new version of the view
+     */
+    std::shared_ptr<Array> refresh(AggregateViewDesc const& view,
+                                   ArrayDesc const& source,
+                                   ArrayID fromVersionId,
+                                   std::shared_ptr<Query>& query);
+
+private:
+    void getPreviousBoundaries(Coordinates& lo, Coordinates& hi);
+};
+
+} // namespace scidb
+
+#endif /* AGGREGATE_VIEW_H_ */
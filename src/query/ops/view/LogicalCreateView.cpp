@@ -0,0 +1,163 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file LogicalCreateView.cpp
+ *
+ * @brief The logical operator create_view().
+ */
+
+#include "query/Operator.h"
+#include "system/SystemCatalog.h"
+#include "system/Exceptions.h"
+#include "AggregateView.h"
+
+using namespace std;
+
+namespace scidb {
+
+/**
+ * @brief The operator: create_view().
+ *
+ * @par Synopsis:
+ *   create_view( srcArray, viewName {, AGGREGATE_CALL}+ {, groupbyDim}* )
+ *   <br> AGGREGATE_CALL := AGGREGATE_FUNC(inputAttr {, constant}*) [as resultName]
+ *
+ * @par Summary:
+ *   Creates a materialized view of aggregate(srcArray, AGGREGATE_CALL..., groupbyDim...),
+ *   which refresh_view() keeps up to date with the new versions of srcArray at a cost
+ *   proportional to the chunks they change. <br>
+ *
+ * @par Input:
+ *   - srcArray: a stored array with srcAttrs and srcDims.
+ *   - viewName: the name of the view to create; it must not exist.
+ *   - 1 or more aggregate calls, as in aggregate(). Order-sensitive aggregates are not allowed.
+ *   - 0 or more dimensions of srcArray to group by.
+ *
+ * @par Output array:
+ *   No cells. The view is an array holding the aggregate states of every chunk of srcArray,
+ *   with one dimension [-1:*,1,0] per srcDim not grouped by followed by the groupbyDims;
+ *   scan_view() returns its contents in the form aggregate() would.
+ *
+ * @par Examples:
+ *   - create_view(A, V, count(*), sum(sales), year)
+ *   - insert(B, A)
+ *   - refresh_view(V)
+ *   - scan_view(V)
+ *
+ * @par Errors:
+ *   - SCIDB_SE_INFER_SCHEMA::SCIDB_LE_ARRAY_ALREADY_EXIST, if viewName exists.
+ *   - SCIDB_SE_INFER_SCHEMA::SCIDB_LE_VIEW_SOURCE_NOT_STORED, if srcArray is not a stored array.
+ *
+ * @par Notes:
+ *   - The view is removed with remove(). srcArray cannot be removed while it has views.
+ *
+ */
+class LogicalCreateView: public LogicalOperator
+{
+public:
+    LogicalCreateView(const string& logicalName, const std::string& alias):
+        LogicalOperator(logicalName, alias)
+    {
+        ADD_PARAM_INPUT()
+        ADD_PARAM_OUT_ARRAY_NAME()
+        ADD_PARAM_VARIES()
+    }
+
+    std::vector<std::shared_ptr<OperatorParamPlaceholder> >
+    nextVaryParamPlaceholder(const std::vector< ArrayDesc> &schemas)
+    {
+        std::vector<std::shared_ptr<OperatorParamPlaceholder> > res;
+        if (_parameters.size() == 1)
+        {
+            // At least one aggregate call.
+            res.push_back(PARAM_AGGREGATE_CALL());
+        }
+        else
+        {
+            res.push_back(END_OF_VARIES_PARAMS());
+            if (_parameters.back()->getParamType() == PARAM_AGGREGATE_CALL)
+            {
+                res.push_back(PARAM_AGGREGATE_CALL());
+            }
+            res.push_back(PARAM_IN_DIMENSION_NAME());
+        }
+        return res;
+    }
+
+    void inferArrayAccess(std::shared_ptr<Query>& query)
+    {
+        LogicalOperator::inferArrayAccess(query);
+        SCIDB_ASSERT(_parameters.size() > 0);
+        SCIDB_ASSERT(_parameters[0]->getParamType() == PARAM_ARRAY_REF);
+        const string& viewName = ((std::shared_ptr<OperatorParamReference>&)_parameters[0])->getObjectName();
+
+        SCIDB_ASSERT(viewName.find('@') == std::string::npos);
+
+        std::shared_ptr<SystemCatalog::LockDesc> lock(make_shared<SystemCatalog::LockDesc>(viewName,
+                                                                                          query->getQueryID(),
+                                                                                          Cluster::getInstance()->getLocalInstanceId(),
+                                                                                          SystemCatalog::LockDesc::COORD,
+                                                                                          SystemCatalog::LockDesc::WR));
+        std::shared_ptr<SystemCatalog::LockDesc> resLock = query->requestLock(lock);
+        SCIDB_ASSERT(resLock);
+        SCIDB_ASSERT(resLock->getLockMode() >= SystemCatalog::LockDesc::WR);
+    }
+
+    ArrayDesc inferSchema(std::vector< ArrayDesc> schemas, std::shared_ptr< Query> query)
+    {
+        SCIDB_ASSERT(schemas.size() == 1);
+        ArrayDesc const& source = schemas[0];
+
+        const string& viewName = ((std::shared_ptr<OperatorParamReference>&)_parameters[0])->getObjectName();
+        SCIDB_ASSERT(ArrayDesc::isNameUnversioned(viewName));
+
+        if (source.getUAId() == 0 || source.isTransient()) {
+            throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_VIEW_SOURCE_NOT_STORED) << viewName;
+        }
+
+        ArrayDesc existing;
+        if (SystemCatalog::getInstance()->getArrayDesc(viewName,
+                                                       query->getCatalogVersion(viewName),
+                                                       existing, false)) {
+            throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_ARRAY_ALREADY_EXIST) << viewName;
+        }
+
+        AggregateViewDesc view;
+        for (size_t i = 1; i < _parameters.size(); ++i)
+        {
+            if (_parameters[i]->getParamType() == PARAM_AGGREGATE_CALL)
+            {
+                view.addCall((std::shared_ptr<OperatorParamAggregateCall>&)_parameters[i], source);
+            }
+            else
+            {
+                view.addGroupBy((std::shared_ptr<OperatorParamDimensionReference>&)_parameters[i], source);
+            }
+        }
+        return view.createStateDesc(viewName, source);
+    }
+};
+
+DECLARE_LOGICAL_OPERATOR_FACTORY(LogicalCreateView, "create_view")
+
+}  // namespace scidb
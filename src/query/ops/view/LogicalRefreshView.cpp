@@ -0,0 +1,125 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file LogicalRefreshView.cpp
+ *
+ * @brief The logical operator refresh_view().
+ */
+
+#include "query/Operator.h"
+#include "system/SystemCatalog.h"
+#include "system/Exceptions.h"
+
+using namespace std;
+
+namespace scidb {
+
+/**
+ * @brief The operator: refresh_view().
+ *
+ * @par Synopsis:
+ *   refresh_view( viewName )
+ *
+ * @par Summary:
+ *   Brings a view made by create_view() up to date with the latest version of its source array.
+ *   Only the source chunks written or removed since the last refresh are read, and only the
+ *   groups they belong to are re-merged. Each refresh creates a new version of the view. <br>
+ *
+ * @par Input:
+ *   - viewName: the name of the view.
+ *
+ * @par Output array:
+ *   No cells, with the schema of the view.
+ *
+ * @par Examples:
+ *   n/a
+ *
+ * @par Errors:
+ *   - SCIDB_SE_INFER_SCHEMA::SCIDB_LE_NOT_A_VIEW, if viewName is not a view.
+ *
+ * @par Notes:
+ *   n/a
+ *
+ */
+class LogicalRefreshView: public LogicalOperator
+{
+public:
+    LogicalRefreshView(const string& logicalName, const std::string& alias):
+        LogicalOperator(logicalName, alias)
+    {
+        ADD_PARAM_IN_ARRAY_NAME()
+    }
+
+    void inferArrayAccess(std::shared_ptr<Query>& query)
+    {
+        LogicalOperator::inferArrayAccess(query);
+        SCIDB_ASSERT(_parameters.size() == 1);
+        SCIDB_ASSERT(_parameters[0]->getParamType() == PARAM_ARRAY_REF);
+        const string& viewName = ((std::shared_ptr<OperatorParamReference>&)_parameters[0])->getObjectName();
+
+        SCIDB_ASSERT(viewName.find('@') == std::string::npos);
+
+        std::shared_ptr<SystemCatalog::LockDesc> lock(make_shared<SystemCatalog::LockDesc>(viewName,
+                                                                                          query->getQueryID(),
+                                                                                          Cluster::getInstance()->getLocalInstanceId(),
+                                                                                          SystemCatalog::LockDesc::COORD,
+                                                                                          SystemCatalog::LockDesc::WR));
+        std::shared_ptr<SystemCatalog::LockDesc> resLock = query->requestLock(lock);
+        SCIDB_ASSERT(resLock);
+        SCIDB_ASSERT(resLock->getLockMode() >= SystemCatalog::LockDesc::WR);
+
+        // the source is read at the version current when the lock is acquired
+        SystemCatalog* catalog = SystemCatalog::getInstance();
+        ArrayDesc viewDesc;
+        ArrayID sourceId = 0;
+        ArrayID sourceVersionId = 0;
+        string definition;
+        catalog->getArrayDesc(viewName, SystemCatalog::ANY_VERSION, viewDesc);
+        if (!catalog->getView(viewDesc.getUAId(), sourceId, sourceVersionId, definition)) {
+            throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_NOT_A_VIEW) << viewName;
+        }
+        ArrayDesc sourceDesc;
+        catalog->getArrayDesc(sourceId, sourceDesc);
+
+        lock = make_shared<SystemCatalog::LockDesc>(sourceDesc.getName(),
+                                                    query->getQueryID(),
+                                                    Cluster::getInstance()->getLocalInstanceId(),
+                                                    SystemCatalog::LockDesc::COORD,
+                                                    SystemCatalog::LockDesc::RD);
+        query->requestLock(lock);
+    }
+
+    ArrayDesc inferSchema(std::vector< ArrayDesc> schemas, std::shared_ptr< Query> query)
+    {
+        SCIDB_ASSERT(schemas.size() == 0);
+        const string& viewName = ((std::shared_ptr<OperatorParamReference>&)_parameters[0])->getObjectName();
+
+        ArrayDesc viewDesc;
+        SystemCatalog::getInstance()->getArrayDesc(viewName, query->getCatalogVersion(viewName), viewDesc);
+        return viewDesc;
+    }
+};
+
+DECLARE_LOGICAL_OPERATOR_FACTORY(LogicalRefreshView, "refresh_view")
+
+}  // namespace scidb
@@ -0,0 +1,99 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file LogicalScanView.cpp
+ *
+ * @brief The logical operator scan_view().
+ */
+
+#include "query/Operator.h"
+#include "system/SystemCatalog.h"
+#include "system/Exceptions.h"
+#include "AggregateView.h"
+
+using namespace std;
+
+namespace scidb {
+
+/**
+ * @brief The operator: scan_view().
+ *
+ * @par Synopsis:
+ *   scan_view( viewArray )
+ *
+ * @par Summary:
+ *   Produces the aggregates of a view made by create_view() as of its last refresh,
+ *   reading only the merged states of the view. <br>
+ *
+ * @par Input:
+ *   - viewArray: a view, or a version of it.
+ *
+ * @par Output array:
+ *        <
+ *   <br>   the aggregate calls' resultNames
+ *   <br> >
+ *   <br> [
+ *   <br>   groupbyDims (if any), or a single dimension 'i' with a single cell
+ *   <br> ]
+ *
+ * @par Examples:
+ *   n/a
+ *
+ * @par Errors:
+ *   - SCIDB_SE_INFER_SCHEMA::SCIDB_LE_NOT_A_VIEW, if viewArray is not a view.
+ *
+ * @par Notes:
+ *   - The result is the one aggregate() over the source array would have
+ *     produced at the version of the last refresh.
+ *
+ */
+class LogicalScanView: public LogicalOperator
+{
+public:
+    LogicalScanView(const string& logicalName, const std::string& alias):
+        LogicalOperator(logicalName, alias)
+    {
+        ADD_PARAM_INPUT()
+    }
+
+    ArrayDesc inferSchema(std::vector< ArrayDesc> schemas, std::shared_ptr< Query> query)
+    {
+        SCIDB_ASSERT(schemas.size() == 1);
+        ArrayDesc const& input = schemas[0];
+
+        ArrayID sourceId = 0;
+        ArrayID sourceVersionId = 0;
+        string definition;
+        if (input.getUAId() == 0 ||
+            !SystemCatalog::getInstance()->getView(input.getUAId(), sourceId, sourceVersionId, definition)) {
+            throw USER_EXCEPTION(SCIDB_SE_INFER_SCHEMA, SCIDB_LE_NOT_A_VIEW) << input.getName();
+        }
+        AggregateViewDesc view(input.getName(), definition);
+        return view.createResultDesc(input);
+    }
+};
+
+DECLARE_LOGICAL_OPERATOR_FACTORY(LogicalScanView, "scan_view")
+
+}  // namespace scidb
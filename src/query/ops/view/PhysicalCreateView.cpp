@@ -0,0 +1,111 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file PhysicalCreateView.cpp
+ *
+ * @brief The physical operator create_view(): the first refresh of a new view.
+ */
+
+#include <boost/bind.hpp>
+
+#include "array/DBArray.h"
+#include "system/SystemCatalog.h"
+#include "system/Exceptions.h"
+#include "AggregateView.h"
+
+using namespace std;
+
+namespace scidb {
+
+class PhysicalCreateView: public AggregateViewUpdate
+{
+  private:
+
+    static const string& getViewName(const Parameters& parameters)
+    {
+        SCIDB_ASSERT(!parameters.empty());
+        return ((std::shared_ptr<OperatorParamReference>&)parameters[0])->getObjectName();
+    }
+
+  public:
+    PhysicalCreateView(const string& logicalName,
+                       const string& physicalName,
+                       const Parameters& parameters,
+                       const ArrayDesc& schema):
+        AggregateViewUpdate(logicalName,
+                            physicalName,
+                            parameters,
+                            schema,
+                            getViewName(parameters))
+    {}
+
+    virtual void postSingleExecute(std::shared_ptr<Query> query)
+    {
+        // Finalizers run in the reverse order, so the view is registered
+        // after its array is added to the catalog
+        query->pushFinalizer(boost::bind(&PhysicalCreateView::recordView, this, _1));
+        AggregateViewUpdate::postSingleExecute(query);
+    }
+
+    std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
+    {
+        SCIDB_ASSERT(inputArrays.size() == 1);
+        if (dynamic_cast<DBArray*>(inputArrays[0].get()) == NULL) {
+            throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_VIEW_SOURCE_NOT_STORED) << getViewName(_parameters);
+        }
+        lockView(query);
+
+        ArrayDesc const& source = inputArrays[0]->getArrayDesc();
+        AggregateViewDesc view;
+        for (size_t i = 1; i < _parameters.size(); ++i)
+        {
+            if (_parameters[i]->getParamType() == PARAM_AGGREGATE_CALL)
+            {
+                view.addCall((std::shared_ptr<OperatorParamAggregateCall>&)_parameters[i], source);
+            }
+            else
+            {
+                view.addGroupBy((std::shared_ptr<OperatorParamDimensionReference>&)_parameters[i], source);
+            }
+        }
+        _sourceId = source.getUAId();
+        _sourceVersionId = source.getId();
+        _definition = view.toString();
+
+        return refresh(view, source, source.getUAId(), query);
+    }
+
+  private:
+
+    void recordView(const std::shared_ptr<Query>& query)
+    {
+        if (!query->wasCommitted()) {
+            return;
+        }
+        SystemCatalog::getInstance()->addView(_arrayUAID, _sourceId, _sourceVersionId, _definition);
+    }
+};
+
+DECLARE_PHYSICAL_OPERATOR_FACTORY(PhysicalCreateView, "create_view", "physicalCreateView")
+
+}  // namespace scidb
@@ -0,0 +1,136 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file PhysicalRefreshView.cpp
+ *
+ * @brief The physical operator refresh_view().
+ */
+
+#include <string.h>
+#include <boost/bind.hpp>
+
+#include "system/SystemCatalog.h"
+#include "system/Exceptions.h"
+#include "util/Network.h"
+#include "AggregateView.h"
+
+using namespace std;
+
+namespace scidb {
+
+class PhysicalRefreshView: public AggregateViewUpdate
+{
+  private:
+
+    /// The id of the source version the view is current with
+    ArrayID _fromVersionId;
+
+    static const string& getViewName(const Parameters& parameters)
+    {
+        SCIDB_ASSERT(!parameters.empty());
+        return ((std::shared_ptr<OperatorParamReference>&)parameters[0])->getObjectName();
+    }
+
+  public:
+    PhysicalRefreshView(const string& logicalName,
+                        const string& physicalName,
+                        const Parameters& parameters,
+                        const ArrayDesc& schema):
+        AggregateViewUpdate(logicalName,
+                            physicalName,
+                            parameters,
+                            schema,
+                            getViewName(parameters)),
+        _fromVersionId(0)
+    {}
+
+    virtual void preSingleExecute(std::shared_ptr<Query> query)
+    {
+        AggregateViewUpdate::preSingleExecute(query);
+
+        SystemCatalog* catalog = SystemCatalog::getInstance();
+        if (!catalog->getView(_arrayUAID, _sourceId, _fromVersionId, _definition)) {
+            throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NOT_A_VIEW) << _unversionedArrayName;
+        }
+        ArrayDesc sourceDesc;
+        catalog->getArrayDesc(_sourceId, sourceDesc);
+        const string& sourceName = sourceDesc.getName();
+        catalog->getArrayDesc(sourceName, query->getCatalogVersion(sourceName), LAST_VERSION, sourceDesc);
+        _sourceVersionId = sourceDesc.getId();
+    }
+
+    virtual void postSingleExecute(std::shared_ptr<Query> query)
+    {
+        // Finalizers run in the reverse order, so the view is updated
+        // after its new version is added to the catalog
+        query->pushFinalizer(boost::bind(&PhysicalRefreshView::recordView, this, _1));
+        AggregateViewUpdate::postSingleExecute(query);
+    }
+
+    std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
+    {
+        SCIDB_ASSERT(inputArrays.empty());
+        lockView(query);
+        exchangeVersions(query);
+
+        ArrayDesc source;
+        SystemCatalog::getInstance()->getArrayDesc(_sourceVersionId, source);
+        AggregateViewDesc view(_unversionedArrayName, _definition);
+
+        return refresh(view, source, _fromVersionId, query);
+    }
+
+  private:
+
+    /// Send the source versions and the definition of the view from the coordinator to the workers
+    void exchangeVersions(std::shared_ptr<Query>& query)
+    {
+        const size_t idsSize = 2 * sizeof(ArrayID);
+        if (query->isCoordinator()) {
+            std::shared_ptr<SharedBuffer> buf(new MemoryBuffer(NULL, idsSize + _definition.size()));
+            ArrayID* ids = static_cast<ArrayID*>(buf->getData());
+            ids[0] = _sourceVersionId;
+            ids[1] = _fromVersionId;
+            memcpy(static_cast<char*>(buf->getData()) + idsSize, _definition.data(), _definition.size());
+            BufBroadcast(buf, query);
+        } else {
+            std::shared_ptr<SharedBuffer> buf = BufReceive(query->getCoordinatorID(), query);
+            ArrayID const* ids = static_cast<ArrayID const*>(buf->getData());
+            _sourceVersionId = ids[0];
+            _fromVersionId = ids[1];
+            _definition.assign(static_cast<char const*>(buf->getData()) + idsSize, buf->getSize() - idsSize);
+        }
+    }
+
+    void recordView(const std::shared_ptr<Query>& query)
+    {
+        if (!query->wasCommitted()) {
+            return;
+        }
+        SystemCatalog::getInstance()->updateView(_arrayUAID, _sourceVersionId);
+    }
+};
+
+DECLARE_PHYSICAL_OPERATOR_FACTORY(PhysicalRefreshView, "refresh_view", "physicalRefreshView")
+
+}  // namespace scidb
@@ -0,0 +1,137 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file PhysicalScanView.cpp
+ *
+ * @brief The physical operator scan_view().
+ */
+
+#include "query/Operator.h"
+#include "array/DBArray.h"
+#include "array/MemArray.h"
+#include "system/SystemCatalog.h"
+#include "system/Exceptions.h"
+#include "../aggregates/Aggregator.h"
+#include "AggregateView.h"
+
+using namespace std;
+
+namespace scidb {
+
+class PhysicalScanView: public PhysicalOperator
+{
+public:
+    PhysicalScanView(const string& logicalName,
+                     const string& physicalName,
+                     const Parameters& parameters,
+                     const ArrayDesc& schema):
+        PhysicalOperator(logicalName, physicalName, parameters, schema)
+    {}
+
+    /**
+     * The merged states stay on the instances the view placed them on,
+     * which is not the default partitioning of the result.
+     */
+    virtual bool changesDistribution(std::vector<ArrayDesc> const&) const
+    {
+        return true;
+    }
+
+    virtual RedistributeContext getOutputDistribution(std::vector<RedistributeContext> const&,
+                                                      std::vector<ArrayDesc> const&) const
+    {
+        return RedistributeContext(psUndefined);
+    }
+
+    std::shared_ptr<Array> execute(vector< std::shared_ptr<Array> >& inputArrays, std::shared_ptr<Query> query)
+    {
+        SCIDB_ASSERT(inputArrays.size() == 1);
+        Array const& input = *inputArrays[0];
+        ArrayDesc const& inputDesc = input.getArrayDesc();
+
+        ArrayID sourceId = 0;
+        ArrayID sourceVersionId = 0;
+        string definition;
+        if (!SystemCatalog::getInstance()->getView(inputDesc.getUAId(), sourceId, sourceVersionId, definition)) {
+            throw USER_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_NOT_A_VIEW) << inputDesc.getName();
+        }
+        AggregateViewDesc view(inputDesc.getName(), definition);
+        vector<AggregatePtr> viewAggs = view.createAggregates();
+        const size_t nChunkDims = view.getNumberOfChunkDims(inputDesc);
+
+        // The merged states, without the chunk number dimensions
+        Attributes stateAttrs;
+        for (AttributeID i = 0; i < viewAggs.size(); ++i) {
+            stateAttrs.push_back(inputDesc.getAttributes()[i]);
+        }
+        ArrayDesc stateDesc(inputDesc.getName(), stateAttrs, _schema.getDimensions(), defaultPartitioning());
+        std::shared_ptr<MemArray> stateArray(std::make_shared<MemArray>(stateDesc, query));
+
+        // The stored chunks are visited in the order of their coordinates,
+        // so the merged ones at (-1, ..., -1, groupChunk) come first
+        const bool ordered = (dynamic_cast<DBArray const*>(&input) != NULL);
+        Coordinates statePos(_schema.getDimensions().size());
+        for (AttributeID i = 0; i < viewAggs.size(); ++i) {
+            std::shared_ptr<ArrayIterator> stateIter = stateArray->getIterator(i);
+            for (std::shared_ptr<ConstArrayIterator> inputIter = input.getConstIterator(i);
+                 !inputIter->end(); ++(*inputIter)) {
+                Coordinates const& chunkPos = inputIter->getPosition();
+                if (chunkPos[0] != -1) {
+                    if (ordered) {
+                        break;
+                    }
+                    continue;
+                }
+                std::copy(chunkPos.begin() + nChunkDims, chunkPos.end(), statePos.begin());
+                Chunk& stateChunk = stateIter->newChunk(statePos);
+                std::shared_ptr<ChunkIterator> out = stateChunk.getIterator(query);
+                for (std::shared_ptr<ConstChunkIterator> in = inputIter->getChunk().getConstIterator();
+                     !in->end(); ++(*in)) {
+                    Value const& state = in->getItem();
+                    if (state.isNull() && state.getMissingReason() == 0) {
+                        continue;
+                    }
+                    Coordinates const& cellPos = in->getPosition();
+                    std::copy(cellPos.begin() + nChunkDims, cellPos.end(), statePos.begin());
+                    if (!out->setPosition(statePos)) {
+                        throw SYSTEM_EXCEPTION(SCIDB_SE_EXECUTION, SCIDB_LE_OPERATION_FAILED) << "setPosition";
+                    }
+                    out->writeItem(state);
+                }
+                out->flush();
+            }
+        }
+
+        vector<AggregatePtr> aggs(_schema.getAttributes().size());
+        std::copy(viewAggs.begin(), viewAggs.end(), aggs.begin());
+        return std::shared_ptr<Array>(new FinalResultArray(_schema,
+                                                           stateArray,
+                                                           aggs,
+                                                           _schema.getEmptyBitmapAttribute() != NULL));
+    }
+};
+
+DECLARE_PHYSICAL_OPERATOR_FACTORY(PhysicalScanView, "scan_view", "physicalScanView")
+
+}  // namespace scidb
@@ -61,6 +61,7 @@ HabilisOptimizer::HabilisOptimizer(): _root(),
                      CONDENSE_SG
                    | INSERT_REDIMENSION_OR_REPARTITION
                    | REWRITE_STORING_SG
+                   | INSERT_EXCHANGE
          )
 {
     _featureMask |= INSERT_MATERIALIZATION;
@@ -118,6 +119,12 @@ PhysPlanPtr HabilisOptimizer::optimize(const std::shared_ptr<Query>& query,
             LOG4CXX_TRACE(logger, "CONDENSE_SG: end");
         }
 
+        const int nExchangeWorkers = Config::getInstance()->getOption<int>(CONFIG_EXCHANGE_WORKERS);
+        if (isFeatureEnabled(INSERT_EXCHANGE) && nExchangeWorkers > 1)
+        {
+            tw_insertExchangeNodes(_root, nExchangeWorkers);
+        }
+
         if (isFeatureEnabled(INSERT_MATERIALIZATION))
         {
             tw_insertChunkMaterializers(_root);
@@ -364,9 +371,10 @@ PhysNodePtr HabilisOptimizer::n_buildSgNode(const ArrayDesc & outputSchema,
     return sgNode;
 }
 
-PhysNodePtr HabilisOptimizer::n_buildReducerNode(PhysNodePtr const& child, PartitioningSchema partSchema)
+PhysNodePtr HabilisOptimizer::n_buildReducerNode(PhysNodePtr const& child, RedistributeContext const& dist)
 {
     //insert a distro reducer node. In this branch sgNeeded is always false.
+    const PartitioningSchema partSchema = dist.getPartitioningSchema();
     PhysicalOperator::Parameters reducerParams;
     std::shared_ptr<Expression> psConst = std::make_shared<Expression> ();
     Value ps(TypeLibrary::getType(TID_INT32));
@@ -377,6 +385,7 @@ PhysNodePtr HabilisOptimizer::n_buildReducerNode(PhysNodePtr const& child, Parti
     // reducer always changes the distribution
     ArrayDesc outputDesc(child->getPhysicalOperator()->getSchema());
     outputDesc.setPartitioningSchema(partSchema);
+    outputDesc.setPartitioningDimension(dist.getPartitioningDimension(), dist.getPartitioningBlock());
     PhysOpPtr reducerOp = OperatorLibrary::getInstance()->createPhysicalOperator("_reduce_distro",
                                                                                  "physicalReduceDistro",
                                                                                  reducerParams,
@@ -421,6 +430,79 @@ PhysNodePtr HabilisOptimizer::tw_createPhysicalTree(std::shared_ptr<LogicalQuery
     return physicalRoot;
 }
 
+/**
+ * Make an SG node place chunks by the partitioning dimension of dist, if it has one.
+ */
+static void s_setSgPartitioningDimension(PhysNodePtr sgNode,
+                                         RedistributeContext const& dist)
+{
+    if (!dist.hasPartitioningDimension()) {
+        return;
+    }
+    ArrayDesc sgSchema = sgNode->getPhysicalOperator()->getSchema();
+    if (sgSchema.getPartitioningDimension() != dist.getPartitioningDimension() ||
+        sgSchema.getPartitioningBlock() != dist.getPartitioningBlock()) {
+        sgSchema.setPartitioningDimension(dist.getPartitioningDimension(), dist.getPartitioningBlock());
+        sgNode->getPhysicalOperator()->setSchema(sgSchema);
+    }
+}
+
+/**
+ * @return true if dist places every chunk on a single instance chosen by the chunk position,
+ *         so that the matching chunks of two inputs with equal such distributions are collocated
+ */
+static bool s_isCollocating(RedistributeContext const& dist)
+{
+    return !dist.isViolated() &&
+           (dist.getPartitioningSchema() == defaultPartitioning() || dist.hasPartitioningDimension());
+}
+
+/**
+ * @return true if an SG can move the output of node into the distribution dist
+ *         that another input of their parent is collocated by
+ */
+static bool s_canMoveTo(PhysNodePtr const& node, RedistributeContext const& dist)
+{
+    if (!s_isCollocating(dist)) {
+        return false;
+    }
+    return !dist.hasPartitioningDimension() ||
+           dist.getPartitioningDimension() < node->getPhysicalOperator()->getSchema().getDimensions().size();
+}
+
+/**
+ * Choose an input of a binary operator accepting a replicated input to be replicated on every
+ * instance, so that the other input is joined where it is. An input which is replicated already
+ * is always chosen. Otherwise the smaller input is, if its estimated size is below the
+ * broadcast-join-threshold and it cannot move to the distribution of the larger one, which
+ * would then have to be redistributed as well.
+ * @return the index of the input to replicate, or -1 to collocate the inputs by moving them
+ */
+static ssize_t s_chooseBroadcastInput(PhysNodePtr const& root,
+                                      RedistributeContext const& lhs,
+                                      RedistributeContext const& rhs,
+                                      double leftDataWidth,
+                                      double rightDataWidth,
+                                      bool canMoveLeftToRight,
+                                      bool canMoveRightToLeft)
+{
+    if (!root->acceptsReplicatedInput()) {
+        return -1;
+    }
+    if (rhs.getPartitioningSchema() == psReplication) {
+        return 1;
+    }
+    if (lhs.getPartitioningSchema() == psReplication) {
+        return 0;
+    }
+    const double threshold = static_cast<double>(
+        Config::getInstance()->getOption<int>(CONFIG_BROADCAST_JOIN_THRESHOLD)) * MiB;
+    if (rightDataWidth <= leftDataWidth) {
+        return (rightDataWidth < threshold && !canMoveRightToLeft) ? 1 : -1;
+    }
+    return (leftDataWidth < threshold && !canMoveLeftToRight) ? 0 : -1;
+}
+
 static void s_setSgDistribution(PhysNodePtr sgNode,
                                 RedistributeContext const& dist,
                                 bool isStrict=true)
@@ -465,6 +547,7 @@ static void s_setSgDistribution(PhysNodePtr sgNode,
         sgSchema.setPartitioningSchema(dist.getPartitioningSchema());
         sgNode->getPhysicalOperator()->setSchema(sgSchema);
     }
+    s_setSgPartitioningDimension(sgNode, dist);
 
     if (newParameters.size() < 2)
     {   //if we don't have an instance parameter - add a fake instance
@@ -633,7 +716,7 @@ void HabilisOptimizer::tw_insertSgNodes(PhysNodePtr root)
                 if (reqDistro != cDist)
                 {
                     //insert a distro reducer node. In this branch sgNeeded is always false.
-                    PhysNodePtr reducerNode = n_buildReducerNode(child, reqDistro.getPartitioningSchema());
+                    PhysNodePtr reducerNode = n_buildReducerNode(child, reqDistro);
                     n_addParentNode(child, reducerNode);
                     reducerNode->inferBoundaries();
                     s_propagateDistribution(reducerNode, root);
@@ -689,22 +772,41 @@ void HabilisOptimizer::tw_insertSgNodes(PhysNodePtr root)
 
             if(root->getDistributionRequirement().getReqType() == DistributionRequirement::Collocated)
             {
-                if (lhs != rhs || lhs.getPartitioningSchema() != defaultPartitioning())
+                // equal distributions that place chunks by position alone are already collocated:
+                // the default one, and those partitioned by a dimension
+                if (lhs != rhs || !s_isCollocating(lhs))
                 {
-                    bool canMoveLeftToRight = (rhs.isViolated() == false && rhs.getPartitioningSchema() == defaultPartitioning());
-                    bool canMoveRightToLeft = (lhs.isViolated() == false && lhs.getPartitioningSchema() == defaultPartitioning());
-
                     PhysNodePtr leftCandidate = s_findThinPoint(root->getChildren()[0]);
                     PhysNodePtr rightCandidate = s_findThinPoint(root->getChildren()[1]);
 
+                    bool canMoveLeftToRight = s_canMoveTo(leftCandidate, rhs);
+                    bool canMoveRightToLeft = s_canMoveTo(rightCandidate, lhs);
+
                     double leftDataWidth = leftCandidate->getDataWidth();
                     double rightDataWidth = rightCandidate->getDataWidth();
 
-                    if (leftDataWidth < rightDataWidth && canMoveLeftToRight)
+                    ssize_t const broadcastInput = s_chooseBroadcastInput(root, lhs, rhs,
+                                                                          leftDataWidth, rightDataWidth,
+                                                                          canMoveLeftToRight, canMoveRightToLeft);
+                    if (broadcastInput >= 0)
+                    {   //replicate one input on every instance, leave the other one where it is
+                        RedistributeContext const& broadcastDist = broadcastInput == 0 ? lhs : rhs;
+                        if (broadcastDist.getPartitioningSchema() != psReplication)
+                        {
+                            PhysNodePtr candidate = broadcastInput == 0 ? leftCandidate : rightCandidate;
+                            PhysNodePtr sgNode = n_buildSgNode(candidate->getPhysicalOperator()->getSchema(), psReplication);
+                            n_addParentNode(candidate, sgNode);
+                            sgNode->inferBoundaries();
+                            sgNode->setSgMovable(false);
+                            sgNode->setSgOffsetable(false);
+                            s_propagateDistribution(sgNode, root);
+                        }
+                    }
+                    else if (leftDataWidth < rightDataWidth && canMoveLeftToRight)
                     {   //move left to right
                         if(lhs.getPartitioningSchema() == psReplication)
                         {   //left is replicated - reduce it
-                            PhysNodePtr reducerNode = n_buildReducerNode(root->getChildren()[0], rhs.getPartitioningSchema());
+                            PhysNodePtr reducerNode = n_buildReducerNode(root->getChildren()[0], rhs);
                             n_addParentNode(root->getChildren()[0], reducerNode);
                             reducerNode->inferBoundaries();
                             s_propagateDistribution(reducerNode, root);
@@ -712,6 +814,7 @@ void HabilisOptimizer::tw_insertSgNodes(PhysNodePtr root)
                         else
                         {   //left is not replicated - sg it
                             PhysNodePtr sgNode = n_buildSgNode(leftCandidate->getPhysicalOperator()->getSchema(), rhs.getPartitioningSchema());
+                            s_setSgPartitioningDimension(sgNode, rhs);
                             n_addParentNode(leftCandidate, sgNode);
                             sgNode->inferBoundaries();
                             s_propagateDistribution(sgNode, root);
@@ -721,7 +824,7 @@ void HabilisOptimizer::tw_insertSgNodes(PhysNodePtr root)
                     {   //move right to left
                         if(rhs.getPartitioningSchema() == psReplication)
                         {   //right is replicated - reduce it
-                            PhysNodePtr reducerNode = n_buildReducerNode(root->getChildren()[1], lhs.getPartitioningSchema());
+                            PhysNodePtr reducerNode = n_buildReducerNode(root->getChildren()[1], lhs);
                             n_addParentNode(root->getChildren()[1], reducerNode);
                             reducerNode->inferBoundaries();
                             s_propagateDistribution(reducerNode, root);
@@ -729,6 +832,7 @@ void HabilisOptimizer::tw_insertSgNodes(PhysNodePtr root)
                         else
                         {   //right is not replicated - sg it
                             PhysNodePtr sgNode = n_buildSgNode(rightCandidate->getPhysicalOperator()->getSchema(), lhs.getPartitioningSchema());
+                            s_setSgPartitioningDimension(sgNode, lhs);
                             n_addParentNode(rightCandidate, sgNode);
                             sgNode->inferBoundaries();
                             s_propagateDistribution(sgNode, root);
@@ -783,6 +887,16 @@ void HabilisOptimizer::tw_insertSgNodes(PhysNodePtr root)
                     throw SYSTEM_EXCEPTION(SCIDB_SE_OPTIMIZER, SCIDB_LE_DISTRIBUTION_SPECIFICATION_ERROR2);
                 }
                 needCollocation = true;
+
+                // children that all share a distribution placing chunks by position are collocated already
+                RedistributeContext const first = root->getChildren()[0]->getDistribution();
+                bool collocated = s_isCollocating(first);
+                for (size_t i=0; collocated && i<root->getChildren().size(); i++)
+                {
+                    collocated = root->getChildren()[i]->outputFullChunks() &&
+                                 root->getChildren()[i]->getDistribution() == first;
+                }
+                needCollocation = !collocated;
             }
 
             for(size_t i=0; i<root->getChildren().size(); i++)
@@ -1251,9 +1365,9 @@ void HabilisOptimizer::tw_rewriteStoringSG(PhysNodePtr root)
             ArrayDesc storeSchema = storeOp->getSchema();
 
             RedistributeContext distro = child->getDistribution();
-            if (distro != RedistributeContext(defaultPartitioning())) {
+            if (distro != RedistributeContext(storeSchema)) {
                 throw SYSTEM_EXCEPTION(SCIDB_SE_OPTIMIZER, SCIDB_LE_NOT_IMPLEMENTED)
-                    << " storing arrays in non-default distribution";
+                    << " storing arrays in a distribution other than their own";
             }
 
             SCIDB_ASSERT(storeOp->getParameters().size() == 1);
@@ -1262,7 +1376,7 @@ void HabilisOptimizer::tw_rewriteStoringSG(PhysNodePtr root)
             LOG4CXX_TRACE(logger, "Converting to storing SG node: schema="<<storeSchema);
 
             PhysNodePtr newSg = n_buildSgNode(storeSchema,
-                                              defaultPartitioning(),
+                                              storeSchema.getPartitioningSchema(),
                                               storeOp->getParameters()[0]/* array name*/);
             PhysNodePtr grandChild = child->getChildren()[0];
 
@@ -1496,6 +1610,53 @@ void HabilisOptimizer::tw_insertChunkMaterializers(PhysNodePtr root)
     }
 }
 
+void HabilisOptimizer::tw_insertExchangeNodes(PhysNodePtr root, uint32_t nWorkers)
+{
+    for (size_t i =0; i < root->getChildren().size(); i++)
+    {
+        tw_insertExchangeNodes(root->getChildren()[i], nWorkers);
+    }
+
+    // The query processor prefetches the chunks of the result on its own
+    if (!root->hasParent() || !root->computesChunksIndependently())
+    {
+        return;
+    }
+    PhysNodePtr parent = root->getParent();
+    if (parent->computesChunksIndependently() && parent->getChildren()[0] == root)
+    {
+        // not the top of the chain
+        return;
+    }
+
+    ArrayDesc const& schema = root->getPhysicalOperator()->getSchema();
+    bool ordered = !(parent->getChildren()[0] == root && parent->acceptsUnorderedChunks());
+
+    Value workersValue;
+    workersValue.setUint32(nWorkers);
+    std::shared_ptr<Expression> workersExpr = std::make_shared<Expression> ();
+    workersExpr->compile(false, TID_UINT32, workersValue);
+    Value orderedValue;
+    orderedValue.setBool(ordered);
+    std::shared_ptr<Expression> orderedExpr = std::make_shared<Expression> ();
+    orderedExpr->compile(false, TID_BOOL, orderedValue);
+    PhysicalOperator::Parameters params;
+    params.push_back(std::shared_ptr<OperatorParam> (new OperatorParamPhysicalExpression(std::make_shared<ParsingContext>(), workersExpr, true)));
+    params.push_back(std::shared_ptr<OperatorParam> (new OperatorParamPhysicalExpression(std::make_shared<ParsingContext>(), orderedExpr, true)));
+
+    PhysOpPtr exchangeOp = OperatorLibrary::getInstance()->createPhysicalOperator(
+        "_exchange", "impl_exchange", params, schema);
+    exchangeOp->setQuery(_query);
+
+    // The exchange hands over the chunks it gets in the tile mode of the chain
+    const bool tileMode = root->getPhysicalOperator()->getTileMode();
+    exchangeOp->setTileMode(tileMode);
+    PhysNodePtr exchangeNode(new PhysicalQueryPlanNode(exchangeOp, false, tileMode));
+    n_addParentNode(root, exchangeNode);
+    exchangeNode->inferBoundaries();
+    exchangeNode->inferDistribution();
+}
+
 std::shared_ptr<Optimizer> Optimizer::create()
 {
     LOG4CXX_DEBUG(logger, "Creating Habilis optimizer instance")
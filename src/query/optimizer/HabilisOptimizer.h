@@ -63,7 +63,8 @@ public:
         // INSERT_REPART                        = 0x02,  // replaced with INSERT_RESHAPE
         INSERT_MATERIALIZATION               = 0x04,
         REWRITE_STORING_SG                   = 0x08,
-        INSERT_REDIMENSION_OR_REPARTITION    = 0x10
+        INSERT_REDIMENSION_OR_REPARTITION    = 0x10,
+        INSERT_EXCHANGE                      = 0x20
    };
 
 private:
@@ -188,10 +189,10 @@ private:
      /**
       * Build a new ReduceDistro node based on a given child attributes.
       * @param[in] child the op whose distribution shall be reduced
-      * @param[in] partSchema the requested partitioning schema to reduce to
+      * @param[in] dist the requested distribution to reduce to
       */
      PhysNodePtr
-     n_buildReducerNode(PhysNodePtr const& child, PartitioningSchema partSchema);
+     n_buildReducerNode(PhysNodePtr const& child, RedistributeContext const& dist);
 
     //////Helper functions - chain walkers:
 
@@ -295,6 +296,16 @@ private:
 
     void
     tw_insertChunkMaterializers(PhysNodePtr root);
+
+    /**
+     * Insert an exchange on top of every chain of operators that compute their chunks
+     * independently, so that several chunks of the chain are evaluated concurrently.
+     * The exchange keeps the chunks in order unless the consumer of the chain accepts them unordered.
+     * @param root root of physical plan.
+     * @param nWorkers the number of chunks of each attribute an exchange evaluates concurrently.
+     */
+    void
+    tw_insertExchangeNodes(PhysNodePtr root, uint32_t nWorkers);
 };
 
 }
@@ -70,6 +70,7 @@ CPPUNIT_TEST_SUITE(OptimizerTests);
 //        CPPUNIT_TEST(testMultiply);
         CPPUNIT_TEST(testFlipStoreRewrite);
         CPPUNIT_TEST(testReplication);
+        CPPUNIT_TEST(testCoPartitioning);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -110,6 +111,13 @@ private:
     ArrayDesc _dummyReplicatedArray;
     ArrayID _dummyReplicatedArrayId;
 
+    ArrayDesc _dummyCoPartitionedArray;
+    ArrayID _dummyCoPartitionedArrayId;
+    ArrayID _dummyCoPartitionedArray2Id;
+
+    ArrayDesc _dummyRangeArray;
+    ArrayID _dummyRangeArrayId;
+
 public:
 
 #define ASSERT_OPERATOR(instance, opName) (CPPUNIT_ASSERT( instance ->getPhysicalOperator()->getPhysicalName() == opName ))
@@ -218,6 +226,19 @@ public:
         _dummyReplicatedArray = ArrayDesc("opttest_dummy_replicated_array", dummyArrayAttributes, dummyArrayDimensions, defaultPartitioning());
         _dummyReplicatedArrayId = s_addArray(_dummyReplicatedArray,_dummyArrayStart, _dummyArrayEnd, psReplication);
 
+        //CO-PARTITIONED AND RANGE PARTITIONED, by the second dimension
+        _dummyCoPartitionedArray = ArrayDesc("opttest_dummy_copartitioned_array", dummyArrayAttributes, dummyArrayDimensions, psCoPartitioned);
+        _dummyCoPartitionedArray.setPartitioningDimension(1, 1);
+        _dummyCoPartitionedArrayId = s_addArray(_dummyCoPartitionedArray, _dummyArrayStart, _dummyArrayEnd, psCoPartitioned);
+
+        ArrayDesc dummyCoPartitionedArray2 = _dummyCoPartitionedArray;
+        dummyCoPartitionedArray2.setName("opttest_dummy_copartitioned_array2");
+        _dummyCoPartitionedArray2Id = s_addArray(dummyCoPartitionedArray2, _dummyArrayStart, _dummyArrayEnd, psCoPartitioned);
+
+        _dummyRangeArray = ArrayDesc("opttest_dummy_range_array", dummyArrayAttributes, dummyArrayDimensions, psRangePartitioned);
+        _dummyRangeArray.setPartitioningDimension(1, 3);
+        _dummyRangeArrayId = s_addArray(_dummyRangeArray, _dummyArrayStart, _dummyArrayEnd, psRangePartitioned);
+
         ////////////////
 
         HabilisOptimizer *hopt = new HabilisOptimizer();
@@ -238,6 +259,9 @@ public:
         systemCat->deleteArray(_partiallyFilledId);
         systemCat->deleteArray(_dummyFlippedId);
         systemCat->deleteArray(_dummyReplicatedArrayId);
+        systemCat->deleteArray(_dummyCoPartitionedArrayId);
+        systemCat->deleteArray(_dummyCoPartitionedArray2Id);
+        systemCat->deleteArray(_dummyRangeArrayId);
     }
 
     std::shared_ptr<Query> getQuery()
@@ -1079,7 +1103,7 @@ public:
         root = root->getChildren()[0];
         ASSERT_OPERATOR(root, "physicalScan");
 
-        //Verify there's reduce distro inserted on the right
+        //Verify the replicated array on the right is joined where it is
         pp = habilis_generatePPlanFor( "join(opttest_dummy_array, opttest_dummy_replicated_array)");
 //        pp->toString(out);
 //        std::cout<<out.str();
@@ -1088,8 +1112,9 @@ public:
         ASSERT_OPERATOR(root, "physicalJoin");
         PhysNodePtr child = root->getChildren()[0];
         ASSERT_OPERATOR(child, "physicalScan");
-        child = root->getChildren()[1]->getChildren()[0];
-        ASSERT_OPERATOR(child, "physicalReduceDistro");
+        child = root->getChildren()[1];
+        ASSERT_OPERATOR(child, "physicalScan");
+        CPPUNIT_ASSERT(root->getDistribution() == RedistributeContext(defaultPartitioning()));
 
         //Verify there's reduce distro inserted on both sides
         pp = habilis_generatePPlanFor( "merge(opttest_dummy_replicated_array, opttest_dummy_replicated_array)");
@@ -1103,17 +1128,18 @@ public:
         child = root->getChildren()[1]->getChildren()[0];
         ASSERT_OPERATOR(child, "physicalReduceDistro");
 
-        //Verify there's reduce distro inserted on the left
+        //Verify the replicated array on the left is joined where it is
         pp = habilis_generatePPlanFor( "join(opttest_dummy_replicated_array, opttest_dummy_array)");
 //        pp->toString(out);
 //        std::cout<<out.str();
 //        out.str("");
         root = pp->getRoot();
         ASSERT_OPERATOR(root, "physicalJoin");
-        child = root->getChildren()[0]->getChildren()[0];
-        ASSERT_OPERATOR(child, "physicalReduceDistro");
+        child = root->getChildren()[0];
+        ASSERT_OPERATOR(child, "physicalScan");
         child = root->getChildren()[1];
         ASSERT_OPERATOR(child, "physicalScan");
+        CPPUNIT_ASSERT(root->getDistribution() == RedistributeContext(defaultPartitioning()));
 
         pp = habilis_generatePPlanFor( "merge(opttest_dummy_array, opttest_dummy_replicated_array)");
 //        pp->toString(out);
@@ -1127,6 +1153,56 @@ public:
         ASSERT_OPERATOR(child, "physicalReduceDistro");
     }
 
+    void testCoPartitioning()
+    {
+        SystemCatalog* systemCat = SystemCatalog::getInstance();
+        std::shared_ptr<PhysicalPlan> pp;
+        PhysNodePtr root;
+
+        //Verify the partitioning dimension and block are stored in the catalog
+        std::shared_ptr<ArrayDesc> desc = systemCat->getArrayDesc(_dummyCoPartitionedArrayId);
+        CPPUNIT_ASSERT(desc->getPartitioningSchema() == psCoPartitioned);
+        CPPUNIT_ASSERT(desc->getPartitioningDimension() == 1);
+        CPPUNIT_ASSERT(desc->getPartitioningBlock() == 1);
+
+        desc = systemCat->getArrayDesc(_dummyRangeArrayId);
+        CPPUNIT_ASSERT(desc->getPartitioningSchema() == psRangePartitioned);
+        CPPUNIT_ASSERT(desc->getPartitioningDimension() == 1);
+        CPPUNIT_ASSERT(desc->getPartitioningBlock() == 3);
+
+        desc = systemCat->getArrayDesc(_dummyArrayId);
+        CPPUNIT_ASSERT(desc->getPartitioningDimension() == 0);
+        CPPUNIT_ASSERT(desc->getPartitioningBlock() == 1);
+
+        //Verify two arrays co-partitioned alike are joined where they are
+        pp = habilis_generatePPlanFor( "join(opttest_dummy_copartitioned_array, opttest_dummy_copartitioned_array2)");
+        root = pp->getRoot();
+        ASSERT_OPERATOR(root, "physicalJoin");
+        PhysNodePtr child = root->getChildren()[0];
+        ASSERT_OPERATOR(child, "physicalScan");
+        child = root->getChildren()[1];
+        ASSERT_OPERATOR(child, "physicalScan");
+        CPPUNIT_ASSERT(root->getDistribution() == RedistributeContext(_dummyCoPartitionedArray));
+
+        //Verify one side is moved when the blocks differ
+        pp = habilis_generatePPlanFor( "join(opttest_dummy_copartitioned_array, opttest_dummy_range_array)");
+        root = pp->getRoot();
+        ASSERT_OPERATOR(root, "physicalJoin");
+        PhysNodePtr leftChild = root->getChildren()[0];
+        PhysNodePtr rightChild = root->getChildren()[1];
+        CPPUNIT_ASSERT(leftChild->getPhysicalOperator()->getPhysicalName() == "impl_sg" ||
+                       rightChild->getPhysicalOperator()->getPhysicalName() == "impl_sg");
+
+        //Verify the default distribution is still moved to collocate with a co-partitioned one
+        pp = habilis_generatePPlanFor( "join(opttest_dummy_copartitioned_array, opttest_dummy_array)");
+        root = pp->getRoot();
+        ASSERT_OPERATOR(root, "physicalJoin");
+        leftChild = root->getChildren()[0];
+        rightChild = root->getChildren()[1];
+        CPPUNIT_ASSERT(leftChild->getPhysicalOperator()->getPhysicalName() == "impl_sg" ||
+                       rightChild->getPhysicalOperator()->getPhysicalName() == "impl_sg");
+    }
+
 };
 CPPUNIT_TEST_SUITE_REGISTRATION(OptimizerTests);
 
@@ -29,6 +29,7 @@
 #include <query/ParsingContext.h>
 #include <query/FunctionDescription.h>
 #include <query/FunctionLibrary.h>
+#include <query/PlanCache.h>
 #include <query/Serialize.h>
 #include <usr_namespace/NamespacesCommunicator.h>
 #include <util/session/Session.h>
@@ -197,6 +198,12 @@ class Translator
 
             LEPtr             onAttributeReference(const Node*);
 
+            // A $name bound to a value supplied with the query becomes a constant that
+            // remembers the parameter, so a cached physical plan can be rebound to other
+            // values of it. Unbound $names keep referring to attributes and dimensions.
+            bool              isQueryParameter    (const Node*) const;
+            LEPtr             onQueryParameter    (const Node*);
+
  private:
             ContextPtr        newParsingContext(const Node*  n)                         {return make_shared<ParsingContext>(_txt,n->getWhere());}
             ContextPtr        newParsingContext(const std::shared_ptr<OperatorParam>&  n)    {return n->getParsingContext();}
@@ -1095,7 +1102,8 @@ bool Translator::matchOperatorParam(const Node* ast,
                  || ast->is(creal)
                  || ast->is(cstring)
                  || ast->is(cboolean)
-                 || ast->is(cinteger))
+                 || ast->is(cinteger)
+                 || isQueryParameter(ast))
                 {
                     LEPtr lExpr;
                     std::shared_ptr<Expression> pExpr = make_shared<Expression>();
@@ -1415,12 +1423,35 @@ bool Translator::resolveParamDimensionReference(const vector<ArrayDesc> &inputSc
 
 std::shared_ptr<OperatorParamAggregateCall> Translator::passAggregateCall(const Node* ast, const vector<ArrayDesc> &inputSchemas)
 {
-    if (ast->get(applicationArgOperands)->getSize() != 1)
+    const Node* const args = ast->get(applicationArgOperands);
+
+    if (args->getSize() < 1)
     {
         fail(SYNTAX(SCIDB_LE_WRONG_AGGREGATE_ARGUMENTS_COUNT,ast));
     }
 
-    const Node* const arg = ast->get(applicationArgOperands)->get(listArg0);
+    // Any further arguments must be numeric constants, parameters of the aggregate
+    vector<double> parameters;
+    for (size_t i = 1; i < args->getSize(); ++i)
+    {
+        const Node* const p = args->getList()[i];
+
+        if (p->is(cinteger))
+        {
+            parameters.push_back(static_cast<double>(p->getInteger()));
+        }
+        else
+        if (p->is(creal))
+        {
+            parameters.push_back(p->getReal());
+        }
+        else
+        {
+            fail(SYNTAX(SCIDB_LE_WRONG_AGGREGATE_ARGUMENTS_COUNT,ast));
+        }
+    }
+
+    const Node* const arg = args->get(listArg0);
 
     std::shared_ptr<OperatorParam> opParam;
 
@@ -1449,7 +1480,8 @@ std::shared_ptr<OperatorParamAggregateCall> Translator::passAggregateCall(const
             newParsingContext(ast),
             getStringApplicationArgName(ast),
             opParam,
-            getString(ast,applicationArgAlias));
+            getString(ast,applicationArgAlias),
+            parameters);
 }
 
 bool Translator::placeholdersVectorContainType(const vector<std::shared_ptr<OperatorParamPlaceholder> > &placeholders,
@@ -2447,8 +2479,9 @@ Node* Translator::decomposeExpression(
             if (isAggregate)
             {
                 LOG4CXX_TRACE(logger, "This is aggregate call");
-                // Currently framework supports only one argument aggregates so drop any other cases
-                if (funcArgs->getSize() != 1)
+                // Aggregates take one argument, possibly followed by numeric constants which
+                // passAggregateCall() checks
+                if (funcArgs->getSize() < 1)
                 {
                     LOG4CXX_TRACE(logger, "Passed too many arguments to aggregate call");
                     fail(SYNTAX(SCIDB_LE_WRONG_AGGREGATE_ARGUMENTS_COUNT,funcNode));
@@ -2539,10 +2572,16 @@ Node* Translator::decomposeExpression(
                         genUniqueObjectName("expr", internalNameCounter, inputSchemas, true));
 
                     // Aggregate call will be translated later into AGGREGATE(input, aggregate(preEvalAttName) as postEvalName)
+                    vector<Node*> aggregateArgs(1,
+                        _fac.newRef(ast->get(applicationArgOperands)->getWhere(),_fac.newCopy(preEvalAttName)));
+                    for (size_t i = 1; i < funcArgs->getSize(); ++i)
+                    {
+                        aggregateArgs.push_back(_fac.newCopy(funcArgs->getList()[i]));
+                    }
                     Node *aggregateExpression =
                         _fac.newApp(ast->getWhere(),
                         _fac.newCopy(getApplicationArgName(ast)),
-                        _fac.newRef(ast->get(applicationArgOperands)->getWhere(),_fac.newCopy(preEvalAttName)));
+                        aggregateArgs);
                     aggregateExpression->set(applicationArgAlias,postEvalAttName);
                     aggregateFunctions.push_back(aggregateExpression);
 
@@ -3673,7 +3712,7 @@ LEPtr Translator::AstToLogicalExpression(const Node* ast, size_t depthExpression
         case cboolean:          return onBoolean(ast);
         case cinteger:          return onInteger(ast);
         case application:       return onScalarFunction(ast, depthExpression);
-        case reference:         return onAttributeReference(ast);
+        case reference:         return isQueryParameter(ast) ? onQueryParameter(ast) : onAttributeReference(ast);
         case olapAggregate:     fail(SYNTAX(SCIDB_LE_WRONG_OVER_USAGE,ast));
         case asterisk:          fail(SYNTAX(SCIDB_LE_WRONG_ASTERISK_USAGE,ast));
         case selectArray:       fail(SYNTAX(SCIDB_LE_SUBQUERIES_NOT_SUPPORTED,ast));
@@ -3775,6 +3814,29 @@ LEPtr Translator::onAttributeReference(const Node* ast)
             getStringReferenceArgName(ast));
 }
 
+bool Translator::isQueryParameter(const Node* ast) const
+{
+    if (!ast->is(reference) || !_qry || getReferenceArgArrayName(ast) != 0)
+    {
+        return false;
+    }
+
+    chars name(getStringReferenceArgName(ast));
+
+    return name[0]=='$' && _qry->parameters.find(name + 1) != _qry->parameters.end();
+}
+
+LEPtr Translator::onQueryParameter(const Node* ast)
+{
+    assert(isQueryParameter(ast));
+
+    QueryParameters::const_iterator i = _qry->parameters.find(getStringReferenceArgName(ast) + 1);
+    TypeId type;
+    Value  value(parseQueryParameter(i->first,i->second,type));
+
+    return make_shared<Constant>(newParsingContext(ast),value,type,i->first);
+}
+
 void Translator::checkDepthExpression(size_t depthExpression)
 {
     if (depthExpression >= MAX_DEPTH_EXPRESSION) {
@@ -33,11 +33,14 @@
 #define INTERNAL_STORAGE_H_
 
 #include <dirent.h>
+#include <list>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <boost/shared_array.hpp>
 
 #include "Storage.h"
 #include "PersistentChunk.h"
@@ -83,6 +86,20 @@ namespace scidb
               bodyCRC(0) {}
     };
 
+    struct ChunkMapCheckpointHeader;
+
+    /**
+     * Directory entry of the chunk map checkpoint image: location of the
+     * segment holding the chunk descriptors of one array.
+     */
+    struct ChunkMapCheckpointSegment {
+        ArrayUAID uaid;
+        uint64_t  offset;
+        uint64_t  size;
+        uint64_t  nEntries;
+        uint32_t  crc;
+    };
+
     /**
      * Abstract class declaring methods for manipulation with deltas.
      */
@@ -149,6 +166,44 @@ namespace scidb
             ~ChunkInitializer();
         };
 
+        /**
+         * A new chunk being stored by writeChunks(): the image written to
+         * the datastore and the replicas sent to other instances
+         */
+        struct ChunkWrite
+        {
+            PersistentChunk* chunk;
+            boost::shared_array<char> buf;  // compressed chunk data
+            std::vector<char> delta;        // delta from the previous version of the chunk
+            void const* deflated;           // image stored in the datastore
+            size_t compressedSize;          // size of the stored image
+            std::vector<std::shared_ptr<ReplicationManager::Item> > replicas;
+            bool published;                 // unpinned and added to the cache, no cleanup on errors
+
+            ChunkWrite() : chunk(NULL), deflated(NULL), compressedSize(0), published(false) {}
+        };
+
+        /**
+         * New chunks written through one DBArrayIterator whose storage is
+         * deferred until write-batch-size KiB of them are pending, so that
+         * writeChunks() lays them out together and writes them at once.
+         * The batches of an array are flushed by flushWriteBatches() at the
+         * latest, and by loadChunk() when one of their chunks is needed.
+         */
+        struct WriteBatch
+        {
+            Mutex lock;
+            std::shared_ptr<const Array> array;
+            std::weak_ptr<Query> query;
+            std::vector<PersistentChunk*> chunks;  // pinned raw chunks, protected by lock
+            size_t bytes;                          // size of the chunks, protected by lock
+            Exception::Pointer error;              // first failure of a flush, protected by lock
+
+            WriteBatch(std::shared_ptr<const Array> const& arr, std::shared_ptr<Query> const& q)
+                : array(arr), query(q), bytes(0) {}
+        };
+        typedef std::map<ArrayID, std::set<std::shared_ptr<WriteBatch> > > WriteBatches;
+
         class DBArrayIterator;
 
         /**
@@ -321,6 +376,7 @@ namespace scidb
             std::weak_ptr<Query> _query;
             bool const _writeMode;
             std::shared_ptr<const Array> _array;
+            std::shared_ptr<WriteBatch> _writeBatch; // chunks written but not stored yet
 
         public:
             DBArrayIterator(CachedStorage* storage,
@@ -349,13 +405,19 @@ namespace scidb
             virtual std::shared_ptr<Query> getQuery() { return Query::getValidQueryPtr(_query); }
         };
 
+        class InnerChunkMap;
+
         /**
-         * Entry in the inner chunkmap.  It is either a) a shared pointer to a persistent chunk, or
-         * b) a tombstone.  If it is a tombstone, the chunk pointer will be NULL and the position
-         * of the tombstone descriptor will be stored.
+         * Entry in the inner chunkmap.  It is either a) a chunk, or b) a tombstone.  The
+         * PersistentChunk object of a chunk is created only when the chunk is accessed (see
+         * CachedStorage::getChunkObject); until then, and again once the chunk leaves the
+         * cache, the entry keeps just the packed descriptor of the chunk.  If it is a
+         * tombstone, the chunk pointer will be NULL and the position of the tombstone
+         * descriptor will be stored.
          */
         class InnerChunkMapEntry
         {
+            friend class InnerChunkMap;
         public:
             enum Status {
                 NORMAL = 2,
@@ -364,12 +426,13 @@ namespace scidb
             };
 
             InnerChunkMapEntry() :
-                _status(NORMAL),
-                _hdrpos(0)
-                {}
+                _status(NORMAL)
+                {
+                    ::memset(&_disk, 0, sizeof(_disk));
+                }
 
             /**
-             * Return pointer to chunk
+             * Return pointer to chunk object, NULL if it has not been created
              */
             std::shared_ptr<PersistentChunk>& getChunk()
                 {
@@ -383,6 +446,58 @@ namespace scidb
                     return _chunk;
                 }
 
+            /**
+             * Does the entry hold a chunk (with or without its object)?
+             */
+            bool hasChunk() const
+                { return _status == NORMAL && (_chunk || _disk.hdrPos != 0); }
+
+            /**
+             * Keep the descriptor of a stored chunk without creating its object
+             */
+            void setDescriptor(ChunkHeader const& hdr)
+                {
+                    assert(hdr.pos.hdrPos != 0);
+                    _status = NORMAL;
+                    _chunk.reset();
+                    _disk.offs = hdr.pos.offs;
+                    _disk.hdrPos = hdr.pos.hdrPos;
+                    _disk.compressedSize = hdr.compressedSize;
+                    _disk.size = hdr.size;
+                    _disk.allocatedSize = hdr.allocatedSize;
+                    _disk.nElems = hdr.nElems;
+                    _disk.storageVersion = hdr.storageVersion;
+                    _disk.instanceId = hdr.instanceId;
+                    _disk.compressionMethod = hdr.compressionMethod;
+                    _disk.flags = hdr.flags;
+                    _disk.crc = hdr.crc;
+                }
+
+            /**
+             * Drop the chunk object, keeping the descriptor of the stored chunk
+             */
+            void releaseChunk()
+                {
+                    assert(_chunk && _chunk->getHeader().pos.hdrPos != 0);
+                    ChunkHeader hdr = _chunk->getHeader();
+                    setDescriptor(hdr);
+                }
+
+            /**
+             * Return the instance the chunk belongs to
+             */
+            InstanceID getInstanceId() const
+                { return _chunk ? _chunk->getHeader().instanceId : _disk.instanceId; }
+
+            /**
+             * Is the chunk stored as a delta from its previous version?
+             */
+            bool isDelta() const
+                {
+                    return hasChunk() &&
+                        ((_chunk ? _chunk->getHeader().flags : _disk.flags) & ChunkHeader::DELTA_CHUNK) != 0;
+                }
+
             /**
              * Is this a tombstone?
              */
@@ -397,7 +512,8 @@ namespace scidb
                 {
                     assert(st != NORMAL);
                     _status = st;
-                    _hdrpos = pos;
+                    _chunk.reset();
+                    _disk.hdrPos = pos;
                 }
 
             /**
@@ -406,7 +522,7 @@ namespace scidb
             uint64_t getTombstonePos() const
                 {
                     assert(_status != NORMAL);
-                    return _hdrpos;
+                    return _disk.hdrPos;
                 }
 
             /**
@@ -417,18 +533,138 @@ namespace scidb
 
         private:
 
+            /* Chunk header fields which neither the key nor the array determine
+             */
+            struct PackedDescriptor
+            {
+                uint64_t offs;
+                uint64_t hdrPos;
+                uint64_t compressedSize;
+                uint64_t size;
+                uint64_t allocatedSize;
+                uint64_t nElems;
+                uint32_t storageVersion;
+                uint32_t instanceId;
+                int8_t   compressionMethod;
+                uint8_t  flags;
+                uint32_t crc;
+            };
+
             /* An entry is either:
-               NORMAL (pointer to persistent chunk)
+               NORMAL (chunk; the object is created on access, the
+                       packed descriptor describes it otherwise)
                INVALID (treated as tomstone in memory, but considered corrupt
                         on disk)
                TOMBSTONE (no chunk present at this location, but the position
                           of descriptor is stored)
              */
             Status                           _status;
-            uint64_t                         _hdrpos;
+            PackedDescriptor                 _disk;
             std::shared_ptr<PersistentChunk> _chunk;
         };
 
+        /**
+         * Chunk map of an unversioned array: the entries of all its chunks, ordered by
+         * attribute, coordinates and descending version.
+         */
+        class InnerChunkMap
+        {
+        public:
+            typedef std::map<StorageAddress, InnerChunkMapEntry> Entries;
+            typedef Entries::iterator iterator;
+            typedef Entries::const_iterator const_iterator;
+            typedef Entries::value_type value_type;
+
+            explicit InnerChunkMap(ArrayUAID uaId) :
+                _uaId(uaId)
+                {}
+
+            ArrayUAID getUAId() const { return _uaId; }
+
+            iterator begin() { return _entries.begin(); }
+            iterator end() { return _entries.end(); }
+            const_iterator begin() const { return _entries.begin(); }
+            const_iterator end() const { return _entries.end(); }
+            size_t size() const { return _entries.size(); }
+            bool empty() const { return _entries.empty(); }
+
+            iterator find(StorageAddress const& addr) { return _entries.find(addr); }
+            const_iterator find(StorageAddress const& addr) const { return _entries.find(addr); }
+            iterator lower_bound(StorageAddress const& addr) { return _entries.lower_bound(addr); }
+
+            /**
+             * Return the entry for addr, inserting an empty one if there is none
+             * @param hint position the entry is expected to precede
+             */
+            iterator insert(iterator hint, StorageAddress const& addr);
+
+            InnerChunkMapEntry& operator[](StorageAddress const& addr)
+                { return insert(_entries.end(), addr)->second; }
+
+            iterator erase(iterator i) { return _entries.erase(i); }
+            void erase(StorageAddress const& addr) { _entries.erase(addr); }
+
+            /**
+             * Fill hdr with the descriptor of the chunk at i
+             */
+            void getHeader(const_iterator i, ChunkHeader& hdr) const;
+
+        private:
+            ArrayUAID _uaId;
+            Entries   _entries;
+        };
+
+        /**
+         * Background verification of the stored chunks: periodically reads
+         * every checksummed chunk at no more than scrub-rate MiB per second
+         * and records those whose data does not match the checksum.
+         */
+        class ChunkScrubber
+        {
+        public:
+            ChunkScrubber(CachedStorage& storage);
+            ~ChunkScrubber();
+
+            void start(size_t bytesPerSec, int intervalSecs);
+            void stop();
+
+            bool isRunning()
+                { ScopedMutexLock cs(_lock); return _running; }
+
+            /**
+             * Account for bytes about to be read in the current pass,
+             * sleeping as long as needed to keep to the configured rate
+             * @return false if the scrubber was stopped meanwhile
+             */
+            bool throttle(size_t bytes);
+
+        private:
+            class ScrubJob : public Job
+            {
+            private:
+                ChunkScrubber* _scrubber;
+
+            public:
+                ScrubJob(ChunkScrubber* scrubber):
+                    Job(std::shared_ptr<Query>()),
+                    _scrubber(scrubber)
+                    {}
+
+                virtual void run();
+            };
+
+            CachedStorage& _storage;
+            std::shared_ptr<JobQueue> _queue;
+            std::shared_ptr<ThreadPool> _threadPool;
+            bool _running;
+            Mutex _lock;
+            size_t _bytesPerSec;
+            int _intervalSecs;
+            double _passStart;   // time the current pass started
+            uint64_t _passBytes; // bytes read so far by the current pass
+            std::shared_ptr<ScrubJob> _myJob;
+        };
+
     private:
 
         // Data members
@@ -443,7 +679,6 @@ namespace scidb
 
         std::vector<Compressor*> _compressors;
 
-        typedef std::map<StorageAddress, InnerChunkMapEntry> InnerChunkMap;
         typedef std::unordered_map<ArrayUAID, std::shared_ptr< InnerChunkMap > > ChunkMap;
         typedef std::tuple<DataStore::Guid, off_t, size_t, off_t> ChunkExtent;
         typedef std::set<ChunkExtent> Extents;
@@ -453,6 +688,9 @@ namespace scidb
         size_t _cacheSize;    // maximal size of memory used by cached chunks
         size_t _cacheUsed;    // current size of memory used by cached chunks
                               // (it can be larger than cacheSize if all chunks are pinned)
+        size_t _cacheMapped;  // current size of cached chunks mapped from datastores
+        size_t _mmapCacheSize; // maximal size of cached chunks mapped from datastores
+        int _mmapAdvice;      // madvise() hint for mapped chunks
         Mutex mutable _mutex; // mutex used to synchronize access to the storage
         Event _loadEvent;     // event to notify threads waiting for completion of chunk load
         Event _initEvent;     // event to notify threads waiting for completion of chunk load
@@ -471,15 +709,97 @@ namespace scidb
         File::FilePtr _hd;           // storage header file descriptor
         File::FilePtr _log[2];       // _transaction logs
         uint64_t _logSizeLimit;      // transaciton log size limit
-        uint64_t _logSize;
-        int _currLog;
+        uint64_t _logSize;           // only used by the leader, see below
+        int _currLog;                // only used by the leader, see below
+
+        /* Group commit of the transaction log: records appended by concurrent
+           writers are queued and made durable by a single synchronous write
+           performed by whichever waiter becomes the "leader".  All fields below
+           are protected by _logMutex.  _logSize and _currLog are not: the leader
+           updates them while writing its batch with _logMutex released, and
+           _logWriterActive makes sure there is only one leader at a time.
+           Lock ordering: _mutex may be held while acquiring _logMutex, never
+           the reverse.
+         */
+        Mutex _logMutex;
+        Event _logEvent;                        // signalled when a log batch completes
+        std::vector<TransLogRecord> _logQueue;  // records waiting to be written
+        uint64_t _logQueuedSeq;                 // sequence number of the last queued record
+        uint64_t _logSyncedSeq;                 // sequence number of the last completed record
+        uint64_t _logFailedSeq;                 // records after it are never durable, the first failed write
+                                                // disables the log until restart; UINT64_MAX if none failed
+        bool _logWriterActive;                  // a leader is currently writing a batch
+
+        /* Chunk descriptors (and the storage header) are not written to the storage
+           header file as each chunk is written. Instead they are kept here, keyed
+           by their position in the header file, and written in contiguous runs by
+           flushChunkDescriptors().  Protected by _mutex.
+         */
+        typedef std::map<uint64_t, ChunkDescriptor> PendingDescriptors;
+        PendingDescriptors _pendingDescriptors;
+        bool _hdrDirty;              // _hdr has changed since it was last written
+
+        /* Checkpoint of the chunk map used to speed up startup (see
+           writeChunkMapCheckpoint()).  The image describes the descriptor slots
+           below _ckptCurrPos.  Slots below _ckptCurrPos written since the image
+           was taken are appended to the checkpoint log (and kept in _ckptDirty)
+           before they are written, so that startup re-reads them together with
+           the slots above _ckptCurrPos.  The image names its log by generation.
+           While a new image is written without _mutex, _ckptNextDirty and
+           _ckptNextChanged collect what changes after its snapshot.  Protected
+           by _mutex.
+         */
+        std::string _ckptPath;
+        File::FilePtr _ckptImage;               // the current image, kept open for lazy loads
+        File::FilePtr _ckptLog;
+        uint64_t _ckptLogSize;
+        uint64_t _ckptCurrPos;                  // 0 if there is no valid checkpoint
+        uint64_t _ckptGeneration;               // of the current image, selects its log
+        std::set<uint64_t> _ckptDirty;
+        uint64_t _ckptNextPos;                  // currPos of the image being written, 0 if none
+        std::map<uint64_t, ArrayUAID> _ckptNextDirty; // its slots updated since, with their owner in it
+        std::set<ArrayUAID> _ckptNextChanged;   // arrays changed since its snapshot
+        std::set<uint64_t> _unpublishedHeaders; // slots taken by writeChunk whose descriptor is not queued yet
+        size_t _ckptUpdates;                    // descriptors written since the last checkpoint
+        size_t _ckptInterval;
+
+        /* Arrays are loaded into _chunkMap from their checkpoint segment on first
+           access (see loadChunkMap()).  _ckptSegments lists the arrays whose
+           segment in the current image matches their on-disk state, only those
+           can be evicted back to _lazyChunkMaps when more than _chunkMapLimit
+           chunk map entries are loaded.  _chunkMapLru lists the loaded arrays,
+           the most recently used first, with their number of entries when last
+           used; _chunkMapLruEntries is the sum of these.  Protected by _mutex.
+         */
+        typedef std::map<ArrayUAID, ChunkMapCheckpointSegment> CheckpointSegments;
+        typedef std::list<std::pair<ArrayUAID, size_t> > ChunkMapLru;
+        CheckpointSegments _ckptSegments;
+        CheckpointSegments _lazyChunkMaps;
+        std::set<ArrayUAID> _loadingChunkMaps;  // lazy arrays being read without _mutex
+        std::set<ArrayUAID> _ckptDirtyOwners;   // arrays owning logged slots, used on startup
+        ChunkMapLru _chunkMapLru;
+        std::unordered_map<ArrayUAID, ChunkMapLru::iterator> _chunkMapLruPos;
+        size_t _chunkMapLruEntries;
+        size_t _chunkMapLimit;
         size_t _redundancy;
         int _nInstances;
         bool _syncReplication;
-        bool _enableDeltaEncoding;
+        uint32_t _deltaChainLimit;   // maximal number of consecutive delta versions of a chunk
         bool _enableChunkmapRecovery;
         bool _skipChunkmapIntegrityCheck;
 
+        /* Chunks found not to match their checksum by reads or by the scrubber,
+           at most MAX_CORRUPT_CHUNKS of them.  Protected by _mutex.
+         */
+        std::vector<CorruptChunk> _corruptChunks;
+        std::shared_ptr<ChunkScrubber> _scrubber;
+
+        /* Pending write batches of the arrays being written, keyed by array
+           version.  Lock order: _mutex, then WriteBatch::lock.  Protected by _mutex.
+         */
+        WriteBatches _writeBatches;
+        size_t _writeBatchSize;      // bytes of chunks deferred per batch, 0 disables batching
+
         RWLock _latches[N_LATCHES];  //XXX TODO: figure out if latches are necessary after removal of clone logic
         std::set<uint64_t> _freeHeaders;
 
@@ -493,22 +813,271 @@ namespace scidb
          */
         void initStorageDescriptionFile(const std::string& storageDescriptorFilePath);
 
+        /**
+         * State accumulated while the chunk map is built on startup
+         */
+        struct ChunkMapLoader
+        {
+            std::set<ArrayID> removedArrays;
+            std::map<ArrayID, ArrayID> oldestVersions;
+            std::map<ArrayID, std::shared_ptr<ArrayDesc> > existentArrays;
+            Extents extents;
+        };
+
         /**
          * Initialize the chunk map from on-disk store
          */
         void initChunkMap();
 
+        /**
+         * Add the chunk descriptor read from position chunkPos of the storage
+         * header file to the chunk map being built.
+         */
+        void addChunkDescriptor(ChunkMapLoader& loader, ChunkDescriptor& desc, uint64_t chunkPos);
+
+        /**
+         * Replay a descriptor read from the storage header file on top of a
+         * loaded checkpoint: load the segment of its array first if it is
+         * still lazy, then add the descriptor to the chunk map.
+         */
+        void replayChunkDescriptor(ChunkMapLoader& loader, ChunkDescriptor& desc, uint64_t chunkPos);
+
+        /**
+         * Return the catalog descriptor of an unversioned array (cached in loader),
+         * or NULL if the array has been removed.
+         */
+        std::shared_ptr<ArrayDesc> getLoaderArrayDesc(ChunkMapLoader& loader, ArrayUAID uaId);
+
+        /**
+         * Find the inner chunk map of an array.  An array still lazy, because
+         * it has been evicted since the entry point called loadChunkMap(), is
+         * loaded from its checkpoint segment under _mutex.
+         * @pre _mutex is locked
+         */
+        ChunkMap::iterator findChunkMap(ArrayUAID uaId);
+
+        /**
+         * Load a lazily loaded array before its first access.  The segment is
+         * read and the array looked up in the catalog with _mutex released.
+         * Called by the storage entry points using the chunk map of an array
+         * before they lock _mutex.
+         * @pre _mutex is not locked by the calling thread
+         */
+        void loadChunkMap(ArrayUAID uaId);
+
+        /**
+         * Find the next chunk of an array in its inner chunk map.
+         * @see Storage::findNextChunk
+         * @pre _mutex is locked
+         */
+        bool findNextChunk(std::shared_ptr<InnerChunkMap> const& innerMap,
+                           ArrayDesc const& desc,
+                           std::shared_ptr<Query> const& query,
+                           StorageAddress& address);
+
+        /**
+         * Add the chunks of an array recorded in its checkpoint segment to the
+         * chunk map, skipping the slots rewritten since the checkpoint was taken.
+         * A corrupted segment is recovered by scanning the storage header file.
+         * @pre _mutex is locked
+         */
+        void loadChunkMapSegment(ChunkMapLoader& loader, ArrayUAID uaId);
+
+        /**
+         * Read a checkpoint segment and check its checksum and its structure.
+         * Does not need _mutex.
+         * @return false if the segment is corrupted
+         */
+        static bool readChunkMapSegment(File::FilePtr const& image,
+                                        ChunkMapCheckpointSegment const& seg,
+                                        std::vector<char>& buf);
+
+        /**
+         * Add the entries of a checkpoint segment checked by readChunkMapSegment()
+         * to the chunk map, skipping the slots rewritten since the checkpoint was taken.
+         * @pre _mutex is locked
+         */
+        void addChunkMapSegment(ChunkMapLoader& loader,
+                                ChunkMapCheckpointSegment const& seg,
+                                std::vector<char> const& buf);
+
+        /**
+         * Add the chunks of an array with a corrupted checkpoint segment to the
+         * chunk map by scanning the slots of the storage header the image covers.
+         * @pre _mutex is locked
+         */
+        void recoverChunkMapSegment(ChunkMapLoader& loader, ArrayUAID uaId);
+
+        /**
+         * Look up an array in the catalog before its chunks are added to the
+         * chunk map.  Does not need _mutex.
+         */
+        void prepareChunkMapLoader(ChunkMapLoader& loader, ArrayUAID uaId);
+
+        /**
+         * Load a lazily loaded array without releasing _mutex.
+         * @pre _mutex is locked
+         */
+        void loadLazyChunkMap(ArrayUAID uaId);
+
+        /**
+         * Add a lazily loaded array read by loadChunkMap() or loadLazyChunkMap()
+         * to the chunk map, then evict the least recently used arrays if too
+         * many chunk map entries are loaded.
+         * @param valid false if the segment is corrupted, the array is then
+         *        recovered by scanning the storage header file
+         * @pre _mutex is locked
+         */
+        void publishChunkMap(ChunkMapLoader& loader,
+                             ArrayUAID uaId,
+                             ChunkMapCheckpointSegment const& seg,
+                             std::vector<char> const& buf,
+                             bool valid);
+
+        /**
+         * Make a loaded array the most recently used one.
+         * @param nEntries its current number of chunk map entries
+         * @pre _mutex is locked
+         */
+        void touchChunkMap(ArrayUAID uaId, size_t nEntries);
+
+        /**
+         * Remove an array from the list of loaded arrays.
+         * @pre _mutex is locked
+         */
+        void forgetChunkMap(ArrayUAID uaId);
+
+        /**
+         * Drop from memory the chunk maps of the least recently used arrays
+         * until at most _chunkMapLimit entries are loaded.  Only arrays
+         * unchanged since the last checkpoint, with no chunk in use, are evicted.
+         * @pre _mutex is locked
+         */
+        void evictChunkMaps();
+
+        /**
+         * Open the chunk map checkpoint log and validate the checkpoint image,
+         * setting _ckptCurrPos and _ckptDirty.  An invalid image is removed.
+         */
+        void openChunkMapCheckpoint();
+
+        /**
+         * Add the chunks recorded in the checkpoint image to the chunk map,
+         * skipping the slots rewritten since the checkpoint was taken.
+         * @return false if there is no valid checkpoint (the chunk map is left empty)
+         */
+        bool loadChunkMapCheckpoint(ChunkMapLoader& loader);
+
+        /**
+         * Replace the checkpoint image with one describing the current chunk map
+         * and start the checkpoint log of the new image.  The pending descriptors
+         * are written and synced and the image is built from a snapshot taken
+         * under _mutex, then the image is written and synced with _mutex released.
+         * Called by flush() and close().  Does nothing if another thread is
+         * writing an image.
+         * @param minUpdates the number of descriptor updates since the last
+         *        checkpoint below which the image is not replaced
+         * @pre _mutex is not locked by the calling thread
+         */
+        void writeChunkMapCheckpoint(size_t minUpdates);
+
+        /**
+         * Write out the pending chunk descriptors and sync the storage header
+         * file and the datastore of an array (or all datastores), without
+         * replacing the chunk map checkpoint.  Can be called with _mutex locked.
+         */
+        void syncStorage(ArrayUAID uaId = INVALID_ARRAY_ID);
+
+        /**
+         * Write and sync a checkpoint image, completing hdr and dir.
+         * @param segments the segments of the loaded arrays listed in dir, whose
+         *        offsets are relative to the start of segments
+         * @param lazy the segments of the arrays not loaded, copied from oldImage
+         * @return the size of the image
+         */
+        uint64_t writeChunkMapImage(std::string const& path,
+                                    ChunkMapCheckpointHeader& hdr,
+                                    std::vector<uint64_t> const& freeSlots,
+                                    std::vector<char> const& segments,
+                                    std::vector<ChunkMapCheckpointSegment>& dir,
+                                    CheckpointSegments const& lazy,
+                                    File::FilePtr const& oldImage);
+
+        /**
+         * @return the path of the checkpoint log of the image of a generation
+         */
+        std::string getCheckpointLogPath(uint64_t generation) const;
+
+        /**
+         * @return the array a descriptor slot holds on disk, 0 if it is free
+         */
+        ArrayUAID getCheckpointedSlotOwner(uint64_t pos);
+
+        /**
+         * Note that an array no longer matches its checkpoint segment.
+         * @pre _mutex is locked
+         */
+        void invalidateChunkMapSegment(ArrayUAID uaId);
+
+        /**
+         * Durably record in the checkpoint log the pending descriptor slots
+         * covered by the checkpoint image, before they are overwritten, and
+         * note those covered by the image being written.
+         * @pre _mutex is locked
+         */
+        void logCheckpointedSlots(std::vector<uint64_t> const& positions);
+
+        /**
+         * Free and remove from the chunk map the chunks of an array which are
+         * not visible in any version starting from lastLiveArrId and which are
+         * not needed as the base of a delta-encoded live chunk.
+         * @param inner chunk map of the array
+         * @param ds datastore of the array
+         * @param lastLiveArrId oldest live version of the array, 0 to remove all chunks
+         * @param extents if not NULL, extent map from which removed chunks are erased
+         */
+        void pruneChunkVersions(InnerChunkMap& inner,
+                                std::shared_ptr<DataStore>& ds,
+                                ArrayID lastLiveArrId,
+                                Extents* extents);
+
+        /**
+         * Encode the new chunk as the difference from the previous version of the
+         * chunk at the same position.
+         * @param desc array descriptor
+         * @param chunk new chunk, its data must be in memory
+         * @param maxSize the delta is rejected if it is larger than this
+         * @param delta [out] the encoded delta
+         * @return true if the chunk should be written as a delta
+         */
+        bool encodeDelta(ArrayDesc const& desc,
+                         PersistentChunk& chunk,
+                         size_t maxSize,
+                         std::vector<char>& delta);
+
+        /**
+         * Reconstruct a delta-encoded chunk from its base version and the delta read
+         * from the datastore. The chunk buffer must already be allocated.
+         */
+        void fetchDeltaChunk(ArrayDesc const& desc, PersistentChunk& chunk, DataStore& ds);
+
+        /**
+         * Map an uncompressed chunk from the datastore instead of reading it into
+         * a heap buffer.  The chunk is then accounted in _cacheMapped.
+         * @return false if the chunk should be read, because it is smaller than
+         *         mmap-min-chunk-size (read on every call) or the mapped cache is full
+         */
+        bool mapChunk(PersistentChunk& chunk, DataStore& ds);
+
         /**
          * Record an extent in the extent map
          */
-        void recordExtent(Extents& extents,
-                          std::shared_ptr<PersistentChunk>& chunk);
+        void recordExtent(Extents& extents, ChunkHeader const& hdr);
 
         /**
          * Erase an extent from the extent map
          */
-        void eraseExtent(Extents& extents,
-                         std::shared_ptr<PersistentChunk>& chunk);
+        void eraseExtent(Extents& extents, ChunkHeader const& hdr);
 
         /**
          * Check extent map for overlaps on disk.  If in "recovery mode"
@@ -523,11 +1092,79 @@ namespace scidb
          */
         void doTxnRecoveryOnStartup();
 
+        /**
+         * Queue a transaction log record for writing.
+         * @param rec the record; the hdrCRC field must already be set
+         * @return the sequence number to pass to commitLog()
+         * @note may be called with _mutex held
+         */
+        uint64_t appendToLog(TransLogRecord const& rec);
+
+        /**
+         * Wait until all log records up to and including seq are durable.
+         * If no other thread is writing the log, this thread writes every record
+         * queued so far with a single synchronous write.
+         * @param seq sequence number returned by appendToLog()
+         * @throws SystemException if a log write failed at or before the batch containing seq
+         */
+        void commitLog(uint64_t seq);
+
+        /**
+         * Make every queued log record durable.
+         */
+        void syncLog();
+
+        /**
+         * Queue a chunk descriptor to be written to the storage header file
+         * at desc.hdr.pos.hdrPos.  The write is coalesced with other pending
+         * descriptors and performed by flushChunkDescriptors().
+         * @pre _mutex is locked and the undo log record for the chunk (if any) was committed
+         */
+        void deferDescriptorWrite(ChunkDescriptor const& desc);
+
+        /**
+         * Write the header part of a chunk descriptor, updating the pending
+         * copy of the descriptor if it has not been written yet.
+         * @pre _mutex is locked
+         */
+        void writeChunkHeader(ChunkHeader const& hdr);
+
+        /**
+         * Read the header part of a chunk descriptor at position pos,
+         * taking pending descriptors into account.
+         * @pre _mutex is locked
+         */
+        void readChunkHeader(ChunkHeader& hdr, uint64_t pos);
+
+        /**
+         * Write all pending chunk descriptors and the storage header to the
+         * storage header file.  Contiguous descriptors are written with one call.
+         * The transaction log is synced first so that no descriptor reaches the
+         * disk before its undo record.
+         * @pre _mutex is locked
+         */
+        void flushChunkDescriptors();
+
         /**
          * Mark a chunk as free in the on-disk and in-memory chunk map.  Also mark it as free
          * in the datastore ds if provided.
          */
-        void markChunkAsFree(InnerChunkMapEntry& entry, std::shared_ptr<DataStore>& ds);
+        void markChunkAsFree(InnerChunkMap& inner, InnerChunkMap::iterator entry,
+                             std::shared_ptr<DataStore>& ds);
+
+        /**
+         * Return the object of the chunk at entry of the chunk map of desc, creating it
+         * from the packed descriptor if necessary.
+         */
+        std::shared_ptr<PersistentChunk>& getChunkObject(ArrayDesc const& desc,
+                                                         InnerChunkMap& inner,
+                                                         InnerChunkMap::iterator entry);
+
+        /**
+         * Drop the object of a chunk evicted from the cache if only the chunk map
+         * refers to it; its entry keeps the packed descriptor.
+         */
+        void releaseChunkObject(PersistentChunk& chunk);
 
         /**
          * Wait for the replica items (i.e. chunks) to be sent to NetworkManager
@@ -573,6 +1210,12 @@ namespace scidb
             return _cacheUsed;
         }
 
+        uint64_t getMappedMemSize() const
+        {
+            // not synchronized, relying on 8byte atomic load
+            return _cacheMapped;
+        }
+
         /**
          * Write bytes to DataStore indicated by pos
          * @param pos DataStore and offset to which to write
@@ -593,12 +1236,113 @@ namespace scidb
          */
         void writeChunkToDataStore(DataStore& ds, PersistentChunk& chunk, void const* data);
 
+        /**
+         * Force writing of the data of several chunks to data store,
+         * chunks allocated back to back are written together
+         * Exception is thrown if write fails
+         */
+        void writeChunksToDataStore(DataStore& ds, std::vector<ChunkWrite> const& writes);
+
+        /**
+         * Count, compress, replicate and checksum a new chunk before it is stored
+         */
+        void prepareChunkWrite(ArrayDesc const& desc, ChunkWrite& write, std::shared_ptr<Query> const& query);
+
+        /**
+         * Store several new chunks of an array with one allocation, one gather
+         * write and one log commit
+         * @param desc descriptor of the array
+         * @param chunks new raw chunks created by newChunk()
+         * @param query performing the operation
+         */
+        void writeChunks(ArrayDesc const& desc,
+                         std::vector<PersistentChunk*> const& chunks,
+                         std::shared_ptr<Query> const& query);
+
+        /**
+         * Unpin and free the unpublished chunks of writeChunks() (in case of errors)
+         */
+        void cleanChunkWrites(std::vector<ChunkWrite>* writes);
+
+        /**
+         * Abort the replicas of the chunks of writeChunks() (in case of errors)
+         */
+        void abortChunkWriteReplicas(std::vector<ChunkWrite>* writes);
+
+        /**
+         * Write a new chunk written through a DBArrayIterator, deferring it
+         * in the iterator's write batch if batching applies to it
+         * @param batch write batch of the iterator, created if needed
+         * @param array the chunk belongs to
+         * @param chunk new chunk created by newChunk()
+         * @param query performing the operation
+         */
+        void queueChunkWrite(std::shared_ptr<WriteBatch>& batch,
+                             std::shared_ptr<const Array> const& array,
+                             PersistentChunk* chunk,
+                             std::shared_ptr<Query> const& query);
+
+        /**
+         * Store the chunks pending in a write batch
+         * @throws the error of this or an earlier flush of the batch
+         */
+        void flushWriteBatch(WriteBatch& batch);
+
+        /**
+         * Flush the write batch of a DBArrayIterator being destroyed and
+         * forget it; errors are kept for flushWriteBatches() to raise
+         */
+        void releaseWriteBatch(std::shared_ptr<WriteBatch>& batch);
+
+        /**
+         * Store a new chunk now if it is pending in a write batch
+         */
+        void flushPendingWrite(PersistentChunk const& chunk);
+
         /**
          * Read chunk data from the disk
          * Exception is thrown if read fails
          */
         void readChunkFromDataStore(DataStore& ds, PersistentChunk const& chunk, void* data);
 
+        /**
+         * Check the data of a chunk read from the disk against its checksum,
+         * if it has one.  A mismatch is recorded in _corruptChunks.
+         * @throws SystemException SCIDB_LE_DATASTORE_CHUNK_CHECKSUM_MISMATCH
+         */
+        void verifyChunkData(PersistentChunk const& chunk, void const* data);
+
+        /**
+         * Record a chunk which failed verification in _corruptChunks,
+         * unless it is already there.
+         */
+        void reportCorruptChunk(ChunkHeader const& hdr,
+                                Coordinates const& coords,
+                                uint32_t actualCrc,
+                                bool byScrub);
+
+        /**
+         * Release the data of a chunk that failed to load, so that the next
+         * access reads it again instead of using a partially loaded buffer.
+         */
+        void discardChunkData(PersistentChunk& chunk);
+
+        /**
+         * Verify the checksums of all stored chunks once.
+         * Runs on the ChunkScrubber thread.
+         */
+        void scrubChunks(ChunkScrubber& scrubber);
+
+        /**
+         * Does the chunk map still describe the chunk at addr of uaId with hdr
+         * (same location and checksum, data written)? The chunk map of a lazy
+         * array is not loaded: the chunk is current if it was read from the
+         * checkpoint segment seg the array still refers to.
+         * @pre _mutex is locked
+         */
+        bool isStoredChunk(ArrayUAID uaId, StorageAddress const& addr, ChunkHeader const& hdr,
+                           ChunkMapCheckpointSegment const* seg = NULL);
+
         /**
          * Fetch chunk from the disk
          */
@@ -621,7 +1365,8 @@ namespace scidb
         /**
          * Check if chunk should be considered by DBArraIterator
          */
-        bool isResponsibleFor(ArrayDesc const& desc, PersistentChunk const& chunk, std::shared_ptr<Query> const& query);
+        bool isResponsibleFor(ArrayDesc const& desc, InstanceID chunkInstanceId,
+                              StorageAddress const& address, std::shared_ptr<Query> const& query);
 
         /**
          * Determine if a given chunk is a primary replica on this instance
@@ -751,6 +1496,11 @@ namespace scidb
                                                                     AttributeID attId,
                                                                     std::shared_ptr<Query>& query);
 
+        /**
+         * @see Storage::flushWriteBatches
+         */
+        void flushWriteBatches(ArrayID arrId);
+
         /**
          * @see Storage::writeChunk
          */
@@ -795,6 +1545,11 @@ namespace scidb
          */
         void visitChunkMap(const ChunkMapVisitor&) const;
 
+        /**
+         * @see Storage::visitCorruptChunks
+         */
+        void visitCorruptChunks(const CorruptChunkVisitor&) const;
+
         /**
          * @see Storage::findNextChunk
          */
@@ -30,6 +30,7 @@
  * @author sfridella@paradigm4.com
  */
 
+#include <sys/mman.h>
 #include "PersistentChunk.h"
 
 using namespace boost;
@@ -65,11 +66,14 @@ PersistentChunk::PersistentChunk()
       _prev(NULL),
       _addr(),
       _data(NULL),
+      _mapping(NULL),
+      _mappedSize(0),
       _hdr(),
       _accessCount(0),
       _raw(false),
       _waiting(false),
       _timestamp(1),
+      _deltaDepth(0),
       _firstPosWithOverlaps(),
       _lastPos(),
       _lastPosWithOverlaps(),
@@ -116,6 +120,8 @@ void PersistentChunk::truncate(Coordinate lastCoord)
 void PersistentChunk::init()
 {
     _data = NULL;
+    _mapping = NULL;
+    _mappedSize = 0;
     LOG4CXX_TRACE(logger, "PersistentChunk::init =" << this << ", accessCount = "<<_accessCount);
     _accessCount = 0;
     _hdr.nElems = 0;
@@ -124,6 +130,7 @@ void PersistentChunk::init()
     _next = _prev = NULL;
     _storage = &StorageManager::getInstance();
     _timestamp = 1;
+    _deltaDepth = 0;
 }
 
 RWLock& PersistentChunk::getLatch()
@@ -216,6 +223,14 @@ void PersistentChunk::setAddress(const ArrayDesc& ad, const ChunkDescriptor& des
     calculateBoundaries(ad);
 }
 
+void PersistentChunk::setAddress(const ArrayDesc& ad, const StorageAddress& firstElem, const ChunkHeader& hdr)
+{
+    init();
+    _hdr = hdr;
+    _addr = firstElem;
+    calculateBoundaries(ad);
+}
+
 int PersistentChunk::getCompressionMethod() const
 {
     return _hdr.compressionMethod;
@@ -259,6 +274,20 @@ void PersistentChunk::allocate(size_t size)
 void PersistentChunk::reallocate(size_t size)
 {
     assert(size>0);
+    if (_mapping) {
+        // move the mapped data to the heap
+        void* tmp = arena::malloc(size);
+        if (!tmp) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_REALLOCATE_MEMORY);
+        }
+        memcpy(tmp, _data, std::min(size, _hdr.size));
+        ::munmap(_mapping, _mappedSize);
+        _mapping = NULL;
+        _mappedSize = 0;
+        _data = tmp;
+        _hdr.size = size;
+        return;
+    }
     void* tmp = arena::realloc(_data, size);
     if (!tmp) {
         throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_REALLOCATE_MEMORY);
@@ -269,11 +298,27 @@ void PersistentChunk::reallocate(size_t size)
 
 void PersistentChunk::free()
 {
+    if (_mapping) {
+        ::munmap(_mapping, _mappedSize);
+        _mapping = NULL;
+        _mappedSize = 0;
+        _data = NULL;
+        return;
+    }
     if (isDebug() && _data) { memset(_data,0,_hdr.size); }
     arena::free(_data);
     _data = NULL;
 }
 
+void PersistentChunk::setMapping(void* mapping, size_t mappedSize, void* data)
+{
+    assert(mapping && data);
+    free();
+    _mapping = mapping;
+    _mappedSize = mappedSize;
+    _data = data;
+}
+
 Coordinates const& PersistentChunk::getFirstPosition(bool withOverlap) const
 {
     return withOverlap ? _firstPosWithOverlaps : _addr.coords;
@@ -219,6 +219,13 @@ namespace scidb
          */
         AttributeID attId;
 
+        /**
+         * CRC-32C of the data as stored in the datastore (i.e. after compression),
+         * valid only if the CHECKSUM flag is set. Occupies what used to be
+         * alignment padding, so the on-disk header layout is unchanged.
+         */
+        uint32_t crc;
+
         /**
          * Size of the data after it has been compressed.
          */
@@ -265,7 +272,8 @@ namespace scidb
         enum Flags {
             DELTA_CHUNK = 2,
             INVALID = 4,
-            TOMBSTONE = 8
+            TOMBSTONE = 8,
+            CHECKSUM = 16
         };
 
         /**
@@ -315,6 +323,7 @@ namespace scidb
               pos(),
               arrId(0),
               attId(0),
+              crc(0),
               compressedSize(0),
               size(0),
               compressionMethod(0),
@@ -415,11 +424,14 @@ namespace scidb
         PersistentChunk* _prev;
         StorageAddress _addr; // StorageAddress of first chunk element
         void*   _data; // uncompressed data (may be NULL if swapped out)
+        void*   _mapping; // datastore mapping holding _data, NULL if _data is on the heap
+        size_t  _mappedSize; // length of _mapping
         ChunkHeader _hdr; // chunk header
         int     _accessCount; // number of active chunk accessors
         bool    _raw; // true if chunk is currently initialized or loaded from the disk
         bool    _waiting; // true if some thread is waiting completetion of chunk load from the disk
         uint64_t _timestamp;
+        uint32_t _deltaDepth; // number of delta versions between this chunk and a full version
         Coordinates _firstPosWithOverlaps;
         Coordinates _lastPos;
         Coordinates _lastPosWithOverlaps;
@@ -443,6 +455,7 @@ namespace scidb
         int getAccessCount() const { return _accessCount; }
         void setAddress(const ArrayDesc& ad, const ChunkDescriptor& desc);
         void setAddress(const ArrayDesc& ad, const StorageAddress& firstElem, int compressionMethod);
+        void setAddress(const ArrayDesc& ad, const StorageAddress& firstElem, const ChunkHeader& hdr);
 
         RWLock& getLatch();
 
@@ -462,6 +475,22 @@ namespace scidb
         void allocate(size_t size);
         void reallocate(size_t size);
         void free();
+
+        /**
+         * Use chunk data mapped from the datastore instead of a heap buffer
+         * @param mapping start of the mapping, released by free()
+         * @param mappedSize length of the mapping
+         * @param data address of the chunk data within the mapping
+         */
+        void setMapping(void* mapping, size_t mappedSize, void* data);
+
+        /**
+         * @return true if the chunk data is mapped from the datastore
+         */
+        bool isMapped() const
+        {
+            return _mapping != NULL;
+        }
         Coordinates const& getFirstPosition(bool withOverlap) const;
         Coordinates const& getLastPosition(bool withOverlap) const;
         bool pin() const;
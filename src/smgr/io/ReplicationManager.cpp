@@ -27,6 +27,9 @@
  */
 
 #include "ReplicationManager.h"
+#include <zlib.h>
+#include <network/proto/scidb_msg.pb.h>
+#include <system/Constants.h>
 
 using namespace std;
 using namespace boost;
@@ -50,6 +53,14 @@ void ReplicationManager::start(const std::shared_ptr<JobQueue>& jobQueue)
     // this queue is single-threaded because the order of replicas is important (per source)
     // and CachedStorage serializes everything anyway via THE mutex.
     _inboundReplicationQ = std::make_shared<WorkQueue>(jobQueue, 1, static_cast<uint64_t>(size));
+
+    // outbound batching: a sender may get as many batches ahead of the network
+    // as the network manager queues messages
+    int batchSize = Config::getInstance()->getOption<int>(CONFIG_REPLICATION_BATCH_SIZE);
+    _batchSize = batchSize > 0 ? static_cast<size_t>(batchSize) * KiB : 0;
+    int sendQueueSize = Config::getInstance()->getOption<int>(CONFIG_REPLICATION_SEND_QUEUE_SIZE);
+    _maxQueuedSize = _batchSize * static_cast<size_t>(std::max(sendQueueSize, 1));
+    _compressBatches = Config::getInstance()->getOption<bool>(CONFIG_REPLICATION_COMPRESSION);
     InjectedErrorListener<ReplicaSendInjectedError>::start();
     InjectedErrorListener<ReplicaWaitInjectedError>::start();
 }
@@ -72,14 +83,64 @@ void ReplicationManager::send(const std::shared_ptr<Item>& item)
     assert(_lsnrId);
 
     ScopedMutexLock cs(_repMutex);
-    std::shared_ptr<RepItems>& ri = _repQueue[item->getInstanceId()];
-    if (!ri) {
-        ri = std::shared_ptr<RepItems>(new RepItems);
+    std::shared_ptr<RepItems>& riRef = _repQueue[item->getInstanceId()];
+    if (!riRef) {
+        riRef = std::shared_ptr<RepItems>(new RepItems);
     }
+    std::shared_ptr<RepItems> ri(riRef);
+    item->_queuedSize = item->getPayloadSize();
     ri->push_back(item);
-    if (ri->size() == 1) {
-        assert(ri->front() == item);
-        sendItem(*ri);
+    _queuedSizes[item->getInstanceId()] += item->_queuedSize;
+    sendReady(*ri);
+
+    // Backpressure: the sender may not get too far ahead of the network
+    Event::ErrorChecker ec = bind(&ReplicationManager::checkQueryState, item);
+    while (_maxQueuedSize != 0 && _queuedSizes[item->getInstanceId()] > _maxQueuedSize) {
+        if (!sendItem(*ri) && !_repEvent.wait(_repMutex, ec)) {
+            break;
+        }
+    }
+}
+
+void ReplicationManager::deferWait(const std::vector<std::shared_ptr<Item> >& items)
+{
+    ScopedMutexLock cs(_repMutex);
+
+    // forget the queries which are gone and the items sent successfully
+    for (DeferredItems::iterator q = _deferred.begin(); q != _deferred.end(); ) {
+        RepItems& di = q->second;
+        while (!di.empty() && di.front()->isDone() && di.front()->validate(false)) {
+            di.pop_front();
+        }
+        if (di.empty() || !Query::isValidQueryPtr(di.front()->getQuery())) {
+            _deferred.erase(q++);
+        } else {
+            ++q;
+        }
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::shared_ptr<Query> query(items[i]->getQuery().lock());
+        if (query) {
+            _deferred[query->getQueryID()].push_back(items[i]);
+        }
+    }
+}
+
+void ReplicationManager::waitForQuery(QueryID queryId)
+{
+    RepItems di;
+    {
+        ScopedMutexLock cs(_repMutex);
+        DeferredItems::iterator q = _deferred.find(queryId);
+        if (q == _deferred.end()) {
+            return;
+        }
+        di.swap(q->second);
+        _deferred.erase(q);
+    }
+    for (RepItems::iterator i = di.begin(); i != di.end(); ++i) {
+        wait(*i);
+        assert((*i)->isDone());
     }
 }
 
@@ -165,35 +226,216 @@ bool ReplicationManager::sendItem(RepItems& ri)
 {
     ScopedMutexLock cs(_repMutex);
 
-    const std::shared_ptr<Item>& item = ri.front();
+    const std::shared_ptr<Item> item = ri.front();
 
     if (item->isDone()) {
-        ri.pop_front();
+        dequeue(ri, 1);
         return true;
     }
+    size_t size = 0;
+    const size_t nItems = getBatchLength(ri, size);
+    assert(nItems > 0 && nItems <= ri.size());
     try {
         std::shared_ptr<Query> q(Query::getValidQueryPtr(item->getQuery()));
 
         std::shared_ptr<MessageDesc> chunkMsg(item->getChunkMsg());
+        if (nItems > 1) {
+            std::vector<std::shared_ptr<MessageDesc> > chunkMsgs(nItems);
+            for (size_t i = 0; i < nItems; ++i) {
+                chunkMsgs[i] = ri[i]->getChunkMsg();
+            }
+            chunkMsg = makeBatch(chunkMsgs, _compressBatches);
+        }
         NetworkManager::getInstance()->sendPhysical(item->getInstanceId(), chunkMsg,
                                                    NetworkManager::mqtReplication);
         LOG4CXX_TRACE(logger, "ReplicationManager::sendItem: successful replica chunk send to instance="
                       << item->getInstanceId()
-                      << ", size=" << item->getChunkMsg()->getMessageSize()
+                      << ", size=" << chunkMsg->getMessageSize()
+                      << ", chunks=" << nItems
                       << ", query (" << q->getQueryID()<<")"
                       << ", queue size="<< ri.size());
         InjectedErrorListener<ReplicaSendInjectedError>::check();
-        item->setDone();
+        for (size_t i = 0; i < nItems; ++i) {
+            ri[i]->setDone();
+        }
     } catch (NetworkManager::OverflowException& e) {
         assert(e.getQueueType() == NetworkManager::mqtReplication);
         return false;
     } catch (Exception& e) {
-        item->setDone(e.copy());
+        std::shared_ptr<Exception> error(e.copy());
+        for (size_t i = 0; i < nItems; ++i) {
+            ri[i]->setDone(error);
+        }
     }
-    ri.pop_front();
+    dequeue(ri, nItems);
     return true;
 }
 
+void ReplicationManager::sendReady(RepItems& ri)
+{
+    // _repMutex must be locked
+    while (!ri.empty()) {
+        size_t size = 0;
+        const size_t nItems = getBatchLength(ri, size);
+        if (nItems == ri.size() && isBatchable(ri.front()) && size < _batchSize) {
+            // the batch may still grow, it is sent when full or when somebody waits for it;
+            // a synchronous writer waits for every chunk, so only async-replication
+            // (or several writers replicating to the same instance) fills the batches
+            break;
+        }
+        if (!sendItem(ri)) {
+            break;
+        }
+    }
+}
+
+bool ReplicationManager::isBatchable(const std::shared_ptr<Item>& item)
+{
+    if (item->isDone()) {
+        return false;
+    }
+    std::shared_ptr<MessageDesc> msg(item->getChunkMsg());
+    if (msg->getMessageType() != mtChunkReplica) {
+        return false;
+    }
+    std::shared_ptr<scidb_msg::Chunk> record = msg->getRecord<scidb_msg::Chunk>();
+    return !record->eof() && record->replicas_size() == 0;
+}
+
+size_t ReplicationManager::getBatchLength(RepItems& ri, size_t& size) const
+{
+    // _repMutex must be locked
+    assert(!ri.empty());
+    size = ri.front()->getPayloadSize();
+    if (_batchSize == 0 || !isBatchable(ri.front())) {
+        return 1;
+    }
+    std::shared_ptr<MessageDesc> first(ri.front()->getChunkMsg());
+    const ArrayID arrId = first->getRecord<scidb_msg::Chunk>()->array_id();
+    size_t n = 1;
+    for (; n < ri.size(); ++n) {
+        const std::shared_ptr<Item>& item = ri[n];
+        if (!isBatchable(item) ||
+            item->getChunkMsg()->getQueryID() != first->getQueryID() ||
+            item->getChunkMsg()->getRecord<scidb_msg::Chunk>()->array_id() != arrId ||
+            size + item->getPayloadSize() > _batchSize) {
+            break;
+        }
+        size += item->getPayloadSize();
+    }
+    return n;
+}
+
+void ReplicationManager::dequeue(RepItems& ri, size_t nItems)
+{
+    // _repMutex must be locked
+    assert(nItems > 0 && nItems <= ri.size());
+    size_t& queuedSize = _queuedSizes[ri.front()->getInstanceId()];
+    for (size_t i = 0; i < nItems; ++i) {
+        assert(queuedSize >= ri[i]->_queuedSize);
+        queuedSize -= ri[i]->_queuedSize;
+    }
+    ri.erase(ri.begin(), ri.begin() + nItems);
+}
+
+std::shared_ptr<MessageDesc>
+ReplicationManager::makeBatch(const std::vector<std::shared_ptr<MessageDesc> >& chunkMsgs, bool compress)
+{
+    assert(!chunkMsgs.empty());
+    size_t size = 0;
+    for (size_t i = 0; i < chunkMsgs.size(); ++i) {
+        std::shared_ptr<SharedBuffer> data(chunkMsgs[i]->getBinary());
+        size += data ? data->getSize() : 0;
+    }
+
+    std::shared_ptr<CompressedBuffer> payload;
+    if (size != 0) {
+        payload = std::make_shared<CompressedBuffer>();
+        payload->allocate(size);
+        char* dst = static_cast<char*>(payload->getData());
+        for (size_t i = 0; i < chunkMsgs.size(); ++i) {
+            std::shared_ptr<SharedBuffer> data(chunkMsgs[i]->getBinary());
+            if (data && data->getSize() != 0) {
+                memcpy(dst, data->getData(), data->getSize());
+                dst += data->getSize();
+            }
+        }
+        assert(dst == static_cast<char*>(payload->getData()) + size);
+    }
+
+    // zlib pays off for chunks stored without compression
+    uint64_t batchSize = 0;
+    if (compress && payload) {
+        std::shared_ptr<CompressedBuffer> packed = std::make_shared<CompressedBuffer>();
+        uLongf packedSize = compressBound(size);
+        packed->allocate(packedSize);
+        if (compress2(static_cast<Bytef*>(packed->getData()), &packedSize,
+                      static_cast<const Bytef*>(payload->getData()), size, Z_BEST_SPEED) == Z_OK &&
+            packedSize < size) {
+            packed->reallocate(packedSize);
+            payload = packed;
+            batchSize = size;
+        }
+    }
+
+    const std::shared_ptr<MessageDesc>& first(chunkMsgs.front());
+    std::shared_ptr<MessageDesc> batch = payload
+        ? std::make_shared<MessageDesc>(mtChunkReplica, payload)
+        : std::make_shared<MessageDesc>(mtChunkReplica);
+    batch->setQueryID(first->getQueryID());
+    std::shared_ptr<scidb_msg::Chunk> record = batch->getRecord<scidb_msg::Chunk>();
+    record->set_array_id(first->getRecord<scidb_msg::Chunk>()->array_id());
+    record->set_eof(false);
+    record->set_batch_size(batchSize);
+    for (size_t i = 0; i < chunkMsgs.size(); ++i) {
+        std::shared_ptr<SharedBuffer> data(chunkMsgs[i]->getBinary());
+        scidb_msg::Chunk* replica = record->add_replicas();
+        replica->CopyFrom(*chunkMsgs[i]->getRecord<scidb_msg::Chunk>());
+        replica->set_payload_size(data ? data->getSize() : 0);
+    }
+    return batch;
+}
+
+void ReplicationManager::unpackBatch(const std::shared_ptr<MessageDesc>& batch,
+                                     std::vector<std::shared_ptr<CompressedBuffer> >& payloads)
+{
+    std::shared_ptr<scidb_msg::Chunk> record = batch->getRecord<scidb_msg::Chunk>();
+    std::shared_ptr<SharedBuffer> data(batch->getBinary());
+    const char* src = data ? static_cast<const char*>(data->getData()) : NULL;
+    size_t available = data ? data->getSize() : 0;
+
+    std::vector<char> unpacked;
+    if (record->batch_size() != 0) {
+        unpacked.resize(record->batch_size());
+        uLongf unpackedSize = unpacked.size();
+        if (uncompress(reinterpret_cast<Bytef*>(&unpacked[0]), &unpackedSize,
+                       reinterpret_cast<const Bytef*>(src), available) != Z_OK ||
+            unpackedSize != unpacked.size()) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_REPLICATION, SCIDB_LE_UNKNOWN_ERROR)
+                << "Cannot decompress batch of replica chunks";
+        }
+        src = &unpacked[0];
+        available = unpacked.size();
+    }
+
+    payloads.clear();
+    payloads.resize(record->replicas_size());
+    for (int i = 0; i < record->replicas_size(); ++i) {
+        const size_t size = record->replicas(i).payload_size();
+        if (size > available) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_REPLICATION, SCIDB_LE_UNKNOWN_ERROR)
+                << "Batch of replica chunks is truncated";
+        }
+        if (size != 0) {
+            payloads[i] = std::make_shared<CompressedBuffer>();
+            payloads[i]->allocate(size);
+            memcpy(payloads[i]->getData(), src, size);
+            src += size;
+            available -= size;
+        }
+    }
+}
+
 void ReplicationManager::clear()
 {
     // mutex must be locked
@@ -205,6 +447,8 @@ void ReplicationManager::clear()
         }
     }
     _repQueue.clear();
+    _queuedSizes.clear();
+    _deferred.clear();
     _repEvent.signal();
 }
 
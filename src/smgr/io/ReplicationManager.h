@@ -31,6 +31,7 @@
 
 #include <deque>
 #include <map>
+#include <vector>
 #include <network/NetworkManager.h>
 #include <util/Event.h>
 #include <util/Mutex.h>
@@ -53,7 +54,7 @@ class ReplicationManager;
         Item(InstanceID instanceId,
              const std::shared_ptr<MessageDesc>& chunkMsg,
              const std::shared_ptr<Query>& query) :
-        _instanceId(instanceId), _chunkMsg(chunkMsg), _query(query), _isDone(false)
+        _instanceId(instanceId), _chunkMsg(chunkMsg), _query(query), _isDone(false), _queuedSize(0)
         {
             assert(instanceId != INVALID_INSTANCE);
             assert(chunkMsg);
@@ -63,6 +64,11 @@ class ReplicationManager;
         std::weak_ptr<Query> getQuery() { return _query; }
         InstanceID getInstanceId() { return _instanceId; }
         std::shared_ptr<MessageDesc> getChunkMsg() { return _chunkMsg; }
+        /// @return the size of the chunk data carried by the item, 0 once it is done
+        size_t getPayloadSize()
+        {
+            return (_chunkMsg && _chunkMsg->getBinary()) ? _chunkMsg->getBinary()->getSize() : 0;
+        }
         /**
          * @return true if the chunk has been sent to the network manager or an error has occurred
          */
@@ -104,6 +110,7 @@ class ReplicationManager;
         std::shared_ptr<MessageDesc> _chunkMsg;
         std::weak_ptr<Query> _query;
         bool _isDone;
+        size_t _queuedSize; // payload size accounted in ReplicationManager::_queuedSizes
         std::shared_ptr<scidb::Exception> _error;
     };
 
@@ -111,8 +118,10 @@ class ReplicationManager;
     typedef std::deque<std::shared_ptr<Item> > RepItems;
     // XXX TODO: convert this to a set
     typedef std::map<InstanceID, std::shared_ptr<RepItems> > RepQueue;
+    typedef std::map<QueryID, RepItems> DeferredItems;
+    typedef std::map<InstanceID, size_t> QueuedSizes;
  public:
-    ReplicationManager() {}
+    ReplicationManager() : _batchSize(0), _maxQueuedSize(0), _compressBatches(false) {}
     virtual ~ReplicationManager() {}
     /// start the operations
     void start(const std::shared_ptr<JobQueue>& jobQueue);
@@ -122,6 +131,11 @@ class ReplicationManager;
     void send(const std::shared_ptr<Item>& item);
     /// wait until the item is sent to network manager
     void wait(const std::shared_ptr<Item>& item);
+    /// leave the items to waitForQuery() instead of waiting for each of them
+    void deferWait(const std::vector<std::shared_ptr<Item> >& items);
+    /// wait until all the items deferred by a query are sent to network manager
+    /// @throw if the replication of any of them failed
+    void waitForQuery(QueryID queryId);
     /// discard the item
     void abort(const std::shared_ptr<Item>& item)
     {
@@ -157,6 +171,20 @@ class ReplicationManager;
         return item;
     }
 
+    /// Split the data of a batch of replica chunks received from another instance
+    /// @param batch mtChunkReplica message whose record lists the batched chunks in its replicas field
+    /// @param payloads set to the data of each batched chunk, NULL for tombstones
+    /// @throws SystemException if the data does not match the record
+    static void unpackBatch(const std::shared_ptr<MessageDesc>& batch,
+                            std::vector<std::shared_ptr<CompressedBuffer> >& payloads);
+
+    /// Coalesce replica chunks of the same query and array into one message
+    /// @param chunkMsgs mtChunkReplica messages without eof or replicas of their own
+    /// @param compress deflate the concatenated data with zlib if that makes it smaller
+    /// @return mtChunkReplica message accepted by unpackBatch()
+    static std::shared_ptr<MessageDesc>
+    makeBatch(const std::vector<std::shared_ptr<MessageDesc> >& chunkMsgs, bool compress);
+
  private:
 
     /// Class to manage space reservation and enqueing on the inbound replication queue
@@ -204,6 +232,10 @@ class ReplicationManager;
 
     void handleConnectionStatus(Notification<NetworkManager::ConnectionStatus>::MessageTypePtr connStatus);
     bool sendItem(RepItems& ri);
+    void sendReady(RepItems& ri);
+    size_t getBatchLength(RepItems& ri, size_t& size) const;
+    static bool isBatchable(const std::shared_ptr<Item>& item);
+    void dequeue(RepItems& ri, size_t nItems);
     void clear();
     static bool checkItemState(const std::shared_ptr<Item>& item)
     {
@@ -214,11 +246,21 @@ class ReplicationManager;
         }
         return Query::isValidQueryPtr(item->getQuery());
     }
+    static bool checkQueryState(const std::shared_ptr<Item>& item)
+    {
+        assert(item);
+        return Query::isValidQueryPtr(item->getQuery());
+    }
 
     ReplicationManager(const ReplicationManager&);
     ReplicationManager& operator=(const ReplicationManager&);
 
     RepQueue _repQueue;
+    QueuedSizes _queuedSizes; // payload bytes in _repQueue, by instance
+    DeferredItems _deferred; // items sent without waiting, by query
+    size_t   _batchSize;     // maximal size of a batch of replica chunks, 0 for no batching
+    size_t   _maxQueuedSize; // size of the replicas queued for an instance which blocks the sender, 0 for no limit
+    bool     _compressBatches;
     Mutex    _repMutex;
     Event    _repEvent;
     Notification<NetworkManager::ConnectionStatus>::ListenerID _lsnrId;
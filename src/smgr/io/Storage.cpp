@@ -31,8 +31,10 @@
  */
 
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <inttypes.h>
 #include <limits>
+#include <algorithm>
 #include <map>
 #include <unordered_set>
 #include <log4cxx/logger.h>
@@ -46,6 +48,7 @@
 #include <memory>
 
 #include <util/FileIO.h>
+#include <util/CRC32C.h>
 #include <system/Cluster.h>
 #include <system/Utils.h>
 #include <system/Config.h>
@@ -71,9 +74,87 @@ static log4cxx::LoggerPtr chunkLogger(log4cxx::Logger::getLogger("scidb.smgr.chu
 
 
 const size_t DEFAULT_TRANS_LOG_LIMIT = 1024; // default limit of transaction log file (in mebibytes)
+const size_t MAX_CORRUPT_CHUNKS = 1000;      // corrupt chunks remembered for list('corrupt chunks')
+const size_t MAX_WRITE_BATCH_CHUNKS = 256;   // chunks deferred in one write batch at most
 const size_t MAX_CFG_LINE_LENGTH = 1*KiB;
 const int MAX_REDUNDANCY = 8;
 const int MAX_INSTANCE_BITS = 10; // 2^MAX_INSTANCE_BITS = max number of instances
+const uint32_t DELTA_CHUNK_MAGIC = 0xDE17AC01;
+
+/**
+ * On-disk image of a delta chunk (ChunkHeader::DELTA_CHUNK): a DeltaChunkHeader
+ * followed by nRuns DeltaRun records, each immediately followed by the 'length'
+ * bytes which replace the data of the base chunk starting at 'offset'.
+ * ChunkHeader::size is the size of the reconstructed chunk and
+ * ChunkHeader::compressedSize the size of the delta image.
+ */
+struct DeltaChunkHeader
+{
+    uint32_t magic;
+    uint32_t depth;      // number of delta versions down to (and excluding) a full version
+    ArrayID  baseArrId;  // version of the chunk at the same address the delta applies to
+    uint64_t baseSize;
+    uint64_t size;
+    uint64_t nRuns;
+};
+
+struct DeltaRun
+{
+    uint64_t offset;
+    uint64_t length;
+};
+
+const uint32_t CHUNKMAP_CHECKPOINT_MAGIC = 0xC4EC4A9B;
+const uint32_t CHUNKMAP_CHECKPOINT_VERSION = 1;
+
+/**
+ * Chunk map checkpoint image: a ChunkMapCheckpointHeader, the nFree free
+ * descriptor slots, one segment per array and the segment directory.
+ * A segment holds, in chunk map order, a ChunkHeader followed by its
+ * hdr.nCoordinates coordinates for each chunk (and tombstone) of the array.
+ */
+struct ChunkMapCheckpointHeader
+{
+    uint32_t   magic;
+    uint32_t   version;
+    InstanceID instanceId;
+    uint64_t   currPos;     // storage header slots below currPos are described by the image
+    uint64_t   nFree;
+    uint64_t   nSegments;
+    uint64_t   dirOffset;
+    uint64_t   logGeneration; // the log of the image is <image>_log<logGeneration % 2>
+    uint32_t   freeCRC;
+    uint32_t   dirCRC;
+    uint32_t   hdrCRC;      // of the preceding fields
+};
+
+/**
+ * Entry of the chunk map checkpoint log: a descriptor slot covered by the
+ * image which has been rewritten since, and the array the image assigns it to.
+ */
+struct ChunkMapCheckpointLogEntry
+{
+    uint64_t  pos;
+    ArrayUAID owner;     // 0 if the slot was free in the image
+};
+
+/**
+ * Release a mutex held once by the calling thread for the lifetime of the object
+ */
+class ScopedMutexRelease
+{
+  public:
+    ScopedMutexRelease(Mutex& mutex) : _mutex(mutex)
+    {
+        _mutex.unlock();
+    }
+    ~ScopedMutexRelease()
+    {
+        _mutex.lock();
+    }
+  private:
+    Mutex& _mutex;
+};
 
 ///////////////////////////////////////////////////////////////////
 /// Static helper functions
@@ -121,6 +202,123 @@ inline static double getTimeSecs()
     return (((double) tv.tv_sec) * 1000000 + ((double) tv.tv_usec)) / 1000000;
 }
 
+/**
+ * Encode target as the list of byte ranges in which it differs from base.
+ * Ranges separated by fewer bytes than a DeltaRun record are merged.
+ * @param maxSize encoding gives up as soon as the delta grows beyond this
+ * @return true if the delta fits into maxSize
+ */
+static bool encodeChunkDelta(char const* base, size_t baseSize,
+                             char const* target, size_t targetSize,
+                             ArrayID baseArrId, uint32_t depth,
+                             size_t maxSize, vector<char>& delta)
+{
+    vector<DeltaRun> runs;
+    size_t deltaSize = sizeof(DeltaChunkHeader);
+    size_t const common = std::min(baseSize, targetSize);
+    size_t i = 0;
+
+    while (i < common)
+    {
+        if (base[i] == target[i])
+        {
+            ++i;
+            continue;
+        }
+        size_t end = i + 1;
+        for (size_t j = end; j < common && j - end < sizeof(DeltaRun); ++j)
+        {
+            if (base[j] != target[j])
+            {
+                end = j + 1;
+            }
+        }
+        DeltaRun run = { i, end - i };
+        runs.push_back(run);
+        deltaSize += sizeof(DeltaRun) + run.length;
+        if (deltaSize > maxSize)
+        {
+            return false;
+        }
+        i = end;
+    }
+    if (targetSize > common)
+    {
+        if (!runs.empty() && runs.back().offset + runs.back().length == common)
+        {
+            runs.back().length += targetSize - common;
+            deltaSize += targetSize - common;
+        }
+        else
+        {
+            DeltaRun run = { common, targetSize - common };
+            runs.push_back(run);
+            deltaSize += sizeof(DeltaRun) + run.length;
+        }
+        if (deltaSize > maxSize)
+        {
+            return false;
+        }
+    }
+
+    delta.resize(deltaSize);
+    char* dst = &delta[0];
+    DeltaChunkHeader hdr;
+    hdr.magic = DELTA_CHUNK_MAGIC;
+    hdr.depth = depth;
+    hdr.baseArrId = baseArrId;
+    hdr.baseSize = baseSize;
+    hdr.size = targetSize;
+    hdr.nRuns = runs.size();
+    memcpy(dst, &hdr, sizeof(hdr));
+    dst += sizeof(hdr);
+    for (size_t r = 0; r < runs.size(); r++)
+    {
+        memcpy(dst, &runs[r], sizeof(DeltaRun));
+        dst += sizeof(DeltaRun);
+        memcpy(dst, target + runs[r].offset, runs[r].length);
+        dst += runs[r].length;
+    }
+    assert(dst == &delta[0] + deltaSize);
+    return true;
+}
+
+/**
+ * Reconstruct the target chunk data from its base and a delta produced by
+ * encodeChunkDelta().
+ */
+static void applyChunkDelta(char const* delta, size_t deltaSize,
+                            char const* base, size_t baseSize,
+                            char* target, size_t targetSize)
+{
+    DeltaChunkHeader hdr;
+    memcpy(&hdr, delta, sizeof(hdr));
+    if (hdr.baseSize != baseSize || hdr.size != targetSize)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
+    }
+    memcpy(target, base, std::min(baseSize, targetSize));
+
+    char const* src = delta + sizeof(hdr);
+    char const* const srcEnd = delta + deltaSize;
+    for (uint64_t r = 0; r < hdr.nRuns; r++)
+    {
+        DeltaRun run;
+        if (src + sizeof(run) > srcEnd)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
+        }
+        memcpy(&run, src, sizeof(run));
+        src += sizeof(run);
+        if (run.length > size_t(srcEnd - src) || run.offset + run.length > targetSize)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
+        }
+        memcpy(target + run.offset, src, run.length);
+        src += run.length;
+    }
+}
+
 static void collectArraysToRollback(std::shared_ptr<std::map<ArrayID, VersionID> >& arrsToRollback, const VersionID& lastVersion,
                                     const ArrayID& baseArrayId, const ArrayID& newArrayId)
 {
@@ -141,6 +339,125 @@ CachedStorage::ChunkInitializer::~ChunkInitializer()
     storage.notifyChunkReady(chunk);
 }
 
+///////////////////////////////////////////////////////////////////
+/// ChunkScrubber
+///////////////////////////////////////////////////////////////////
+
+CachedStorage::ChunkScrubber::ChunkScrubber(CachedStorage& storage) :
+    _storage(storage),
+    _queue(std::make_shared<JobQueue>()),
+    _threadPool(std::make_shared<ThreadPool>(1, _queue)),
+    _running(false),
+    _bytesPerSec(0),
+    _intervalSecs(0),
+    _passStart(0),
+    _passBytes(0)
+{}
+
+/* Main loop of the scrubber: a pass over all chunks, then sleep for the
+   interval in short steps so that stop() does not have to wait for it
+ */
+void CachedStorage::ChunkScrubber::ScrubJob::run()
+{
+    while (true)
+    {
+        {
+            ScopedMutexLock cs(_scrubber->_lock);
+            _scrubber->_passStart = getTimeSecs();
+            _scrubber->_passBytes = 0;
+        }
+        try
+        {
+            _scrubber->_storage.scrubChunks(*_scrubber);
+        }
+        catch (Exception const& e)
+        {
+            LOG4CXX_ERROR(logger, "ChunkScrubber: scrubbing pass failed: " << e.what());
+        }
+        for (int i = 0; i < _scrubber->_intervalSecs; ++i)
+        {
+            if (!_scrubber->isRunning())
+            {
+                return;
+            }
+            ::sleep(1);
+        }
+        if (!_scrubber->isRunning())
+        {
+            return;
+        }
+    }
+}
+
+void CachedStorage::ChunkScrubber::start(size_t bytesPerSec, int intervalSecs)
+{
+    ScopedMutexLock cs(_lock);
+    if (_running)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED) <<
+            "ChunkScrubber: error on start; already running";
+    }
+
+    _running = true;
+    _bytesPerSec = bytesPerSec;
+    _intervalSecs = std::max(intervalSecs, 1);
+
+    if (!_threadPool->isStarted())
+    {
+        _threadPool->start();
+    }
+    _myJob.reset(new ScrubJob(this));
+    _queue->pushJob(_myJob);
+}
+
+void CachedStorage::ChunkScrubber::stop()
+{
+    {
+        ScopedMutexLock cs(_lock);
+        if (_running)
+        {
+            _running = false;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    if (!_myJob->wait())
+    {
+        LOG4CXX_ERROR(logger, "ChunkScrubber: error on stop.");
+    }
+}
+
+bool CachedStorage::ChunkScrubber::throttle(size_t bytes)
+{
+    double due;
+    {
+        ScopedMutexLock cs(_lock);
+        _passBytes += bytes;
+        due = _passStart + double(_passBytes) / _bytesPerSec;
+    }
+    while (true)
+    {
+        if (!isRunning())
+        {
+            return false;
+        }
+        double wait = due - getTimeSecs();
+        if (wait <= 0)
+        {
+            return true;
+        }
+        ::usleep(useconds_t(std::min(wait, 1.0) * 1000000));
+    }
+}
+
+CachedStorage::ChunkScrubber::~ChunkScrubber()
+{
+    stop();
+}
+
 ///////////////////////////////////////////////////////////////////
 /// CachedStorage class
 ///////////////////////////////////////////////////////////////////
@@ -148,6 +465,19 @@ CachedStorage::ChunkInitializer::~ChunkInitializer()
 /* Constructor
  */
 CachedStorage::CachedStorage() :
+    _logQueuedSeq(0),
+    _logSyncedSeq(0),
+    _logFailedSeq(UINT64_MAX),
+    _logWriterActive(false),
+    _hdrDirty(false),
+    _ckptLogSize(0),
+    _ckptCurrPos(0),
+    _ckptGeneration(0),
+    _ckptNextPos(0),
+    _ckptUpdates(0),
+    _ckptInterval(0),
+    _chunkMapLruEntries(0),
+    _chunkMapLimit(0),
     _replicationManager(NULL)
 {}
 
@@ -202,11 +532,51 @@ CachedStorage::initStorageDescriptionFile(const std::string& storageDescriptorFi
     fclose(f);
 }
 
+CachedStorage::InnerChunkMap::iterator
+CachedStorage::InnerChunkMap::insert(iterator hint, StorageAddress const& addr)
+{
+    bool hintFits = (hint == _entries.end() || addr < hint->first) &&
+        (hint == _entries.begin() || std::prev(hint)->first < addr);
+    iterator i = hintFits ? hint : _entries.lower_bound(addr);
+    if (i != _entries.end() && !(addr < i->first))
+    {
+        return i;
+    }
+    return _entries.insert(i, Entries::value_type(addr, InnerChunkMapEntry()));
+}
+
+void
+CachedStorage::InnerChunkMap::getHeader(const_iterator i, ChunkHeader& hdr) const
+{
+    InnerChunkMapEntry const& entry = i->second;
+    assert(entry.hasChunk());
+    if (entry._chunk)
+    {
+        hdr = entry._chunk->getHeader();
+        return;
+    }
+    ::memset(&hdr, 0, sizeof(hdr));
+    hdr.storageVersion = entry._disk.storageVersion;
+    hdr.pos.dsGuid = _uaId;
+    hdr.pos.hdrPos = entry._disk.hdrPos;
+    hdr.pos.offs = entry._disk.offs;
+    hdr.arrId = i->first.arrId;
+    hdr.attId = i->first.attId;
+    hdr.compressedSize = entry._disk.compressedSize;
+    hdr.size = entry._disk.size;
+    hdr.compressionMethod = entry._disk.compressionMethod;
+    hdr.flags = entry._disk.flags;
+    hdr.crc = entry._disk.crc;
+    hdr.nCoordinates = i->first.coords.size();
+    hdr.allocatedSize = entry._disk.allocatedSize;
+    hdr.nElems = entry._disk.nElems;
+    hdr.instanceId = entry._disk.instanceId;
+}
+
 /* Record an extent in the extent map
  */
 void
-CachedStorage::recordExtent(Extents& extents,
-                            std::shared_ptr<PersistentChunk>& chunk)
+CachedStorage::recordExtent(Extents& extents, ChunkHeader const& hdr)
 {
     if (_skipChunkmapIntegrityCheck)
     {
@@ -214,7 +584,6 @@ CachedStorage::recordExtent(Extents& extents,
     }
 
     ChunkExtent ext;
-    const ChunkHeader& hdr = chunk->getHeader();
 
     ext = std::make_tuple(hdr.pos.dsGuid,
                           hdr.pos.offs,
@@ -229,8 +598,7 @@ CachedStorage::recordExtent(Extents& extents,
 /* Erase an extent from the extent map
  */
 void
-CachedStorage::eraseExtent(Extents& extents,
-                           std::shared_ptr<PersistentChunk>& chunk)
+CachedStorage::eraseExtent(Extents& extents, ChunkHeader const& hdr)
 {
     if (_skipChunkmapIntegrityCheck)
     {
@@ -238,7 +606,6 @@ CachedStorage::eraseExtent(Extents& extents,
     }
 
     ChunkExtent ext;
-    const ChunkHeader& hdr = chunk->getHeader();
 
     ext = std::make_tuple(hdr.pos.dsGuid,
                           hdr.pos.offs,
@@ -356,6 +723,7 @@ CachedStorage::checkExtentsForOverlaps(Extents& extents)
                 ChunkMap::iterator cmiter = _chunkMap.find(desc.hdr.pos.dsGuid);
                 ASSERT_EXCEPTION((cmiter != _chunkMap.end()),
                                  "Attempt to create tombstone for unkown array");
+                invalidateChunkMapSegment(desc.hdr.pos.dsGuid);
                 std::shared_ptr<InnerChunkMap> inner = cmiter->second;
                 InnerChunkMap::iterator mapiter;
                 StorageAddress addr;
@@ -366,7 +734,6 @@ CachedStorage::checkExtentsForOverlaps(Extents& extents)
                      (mapiter = inner->find(addr)) != inner->end();
                      addr.attId++)
                 {
-                    mapiter->second.getChunk().reset();
                     mapiter->second.setTombstonePos(InnerChunkMapEntry::INVALID,
                                                     desc.hdr.pos.hdrPos);
                 }
@@ -398,15 +765,30 @@ CachedStorage::initChunkMap()
 
     ChunkDescriptor desc;
     uint64_t chunkPos = HEADER_SIZE;
-    StorageAddress addr;
-    set<ArrayID> removedArrays;
-    typedef map<ArrayID, ArrayID> ArrayMap;
-    ArrayMap oldestVersions;
-    typedef map<ArrayID, std::shared_ptr<ArrayDesc> > ArrayDescCache;
-    ArrayDescCache existentArrays;
-    Extents extents;
+    size_t i = 0;
+    size_t nReplayed = 0;
+    ChunkMapLoader loader;
 
-    for (size_t i = 0; i < _hdr.nChunks; i++, chunkPos += sizeof(ChunkDescriptor))
+    /* Start from the checkpoint if there is one: only the slots rewritten since
+       it was taken and the slots appended after it need to be read
+     */
+    if (loadChunkMapCheckpoint(loader))
+    {
+        for (set<uint64_t>::const_iterator d = _ckptDirty.begin(); d != _ckptDirty.end(); ++d)
+        {
+            size_t rc = _hd->read(&desc, sizeof(ChunkDescriptor), *d);
+            if (rc != sizeof(ChunkDescriptor))
+            {
+                desc.hdr.pos.hdrPos = 0;
+            }
+            replayChunkDescriptor(loader, desc, *d);
+        }
+        chunkPos = _ckptCurrPos;
+        i = (_ckptCurrPos - HEADER_SIZE) / sizeof(ChunkDescriptor);
+        nReplayed = _ckptDirty.size();
+    }
+
+    for (; i < _hdr.nChunks; i++, chunkPos += sizeof(ChunkDescriptor), nReplayed++)
     {
         size_t rc = _hd->read(&desc, sizeof(ChunkDescriptor), chunkPos);
         if (rc != sizeof(ChunkDescriptor))
@@ -421,177 +803,7 @@ CachedStorage::initChunkMap()
             _hdr.nChunks = i;
             break;
         }
-        if (desc.hdr.pos.hdrPos != chunkPos)
-        {
-            LOG4CXX_ERROR(logger, "Invalid chunk header " << i << " at position " << chunkPos
-                          << " desc.hdr.pos.hdrPos=" << desc.hdr.pos.hdrPos
-                          << " arrayID=" << desc.hdr.arrId
-                          << " hdr.nChunks=" << _hdr.nChunks);
-            _freeHeaders.insert(chunkPos);
-        }
-        else
-        {
-            assert(desc.hdr.nCoordinates < MAX_NUM_DIMS_SUPPORTED);
-
-            LOG4CXX_TRACE(chunkLogger,"chunkl: initchunkmap: found chunk desc " << desc.toString());
-            
-	if (desc.hdr.arrId != 0)
-            {
-                /* Check if unversioned array exists
-                 */
-                ArrayDescCache::iterator it = existentArrays.find(desc.hdr.pos.dsGuid);
-                if (it == existentArrays.end())
-                {
-                    if (removedArrays.count(desc.hdr.pos.dsGuid) == 0)
-                    {
-                        try
-                        {
-                            std::shared_ptr<ArrayDesc> ad =
-                                SystemCatalog::getInstance()->getArrayDesc(desc.hdr.pos.dsGuid);
-                            it = existentArrays.insert(
-                                ArrayDescCache::value_type(desc.hdr.pos.dsGuid, ad)
-                                ).first;
-                        }
-                        catch (SystemException const& x)
-                        {
-                            if (x.getLongErrorCode() == SCIDB_LE_ARRAYID_DOESNT_EXIST)
-                            {
-                                removedArrays.insert(desc.hdr.pos.dsGuid);
-                            }
-                            else
-                            {
-                                throw x;
-                            }
-                        }
-                    }
-                }
-
-                /* If the unversioned array does not exist... wipe the chunk
-                 */
-                if (it == existentArrays.end())
-                {
-                    desc.hdr.arrId = 0;
-                    LOG4CXX_TRACE(chunkLogger,"chunkl: initchunkmap: remove chunk desc "<< "for non-existant array at position " << chunkPos); 
-
-                    _hd->writeAll(&desc.hdr, sizeof(ChunkHeader), chunkPos);
-                    assert(desc.hdr.nCoordinates < MAX_NUM_DIMS_SUPPORTED);
-                    _freeHeaders.insert(chunkPos);
-                    continue;
-                }
-
-                /* Else add chunk to map (if it is live)
-                 */
-                else
-                {
-                    /* Init array descriptor
-                     */
-                    ArrayDesc& adesc = *it->second;
-                    assert(adesc.getUAId() == desc.hdr.pos.dsGuid);
-
-                    /* Find/init the inner chunk map
-                     */
-                    ChunkMap::iterator iter = _chunkMap.find(adesc.getUAId());
-                    if (iter == _chunkMap.end())
-                    {
-                        iter = _chunkMap.insert(make_pair(adesc.getUAId(),
-                                                          make_shared <InnerChunkMap> ())).first;
-                    }
-                    std::shared_ptr<InnerChunkMap>& innerMap = iter->second;
-
-                    /* Find the oldest version of array, and the storage address
-                       of the chunk currently in use by this version
-                    */
-                    ArrayMap::iterator oldest_it = oldestVersions.find(adesc.getUAId());
-                    if (oldest_it == oldestVersions.end())
-                    {
-                        oldestVersions[adesc.getUAId()] =
-                            SystemCatalog::getInstance()->getOldestArrayVersion(adesc.getUAId());
-                    }
-                    desc.getAddress(addr);
-                    StorageAddress oldestVersionAddr = addr;
-                    oldestVersionAddr.arrId = oldestVersions[adesc.getUAId()];
-                    StorageAddress oldestLiveChunkAddr;
-                    InnerChunkMap::iterator oldestLiveChunk =
-                        innerMap->lower_bound(oldestVersionAddr);
-                    if (oldestLiveChunk == innerMap->end() ||
-                        oldestLiveChunk->first.coords != oldestVersionAddr.coords ||
-                        oldestLiveChunk->first.attId != oldestVersionAddr.attId)
-                    {
-                        oldestLiveChunkAddr = oldestVersionAddr;
-                        oldestLiveChunkAddr.arrId = 0;
-                    }
-                    else
-                    {
-                        oldestLiveChunkAddr = oldestLiveChunk->first;
-                    }
-
-                    /* Chunk is live if and only if arrayID of chunk is > arrayID of chunk
-                       currently pointed to by oldest version
-                    */
-                    if (desc.hdr.arrId > oldestLiveChunkAddr.arrId)
-                    {
-                        /* Chunk is live, put it in the map
-                         */
-                        LOG4CXX_TRACE(chunkLogger,
-                                    "chunkl: initchunkmap: add live chunk to map for pos "
-                                     << chunkPos); 
-
-			std::shared_ptr<PersistentChunk>& chunk =(*innerMap)[addr].getChunk();
-                        ASSERT_EXCEPTION((!chunk), "smgr open: NOT unique chunk");
-                        if (!desc.hdr.is<ChunkHeader::TOMBSTONE>())
-                        {
-                            chunk.reset(new PersistentChunk());
-                            chunk->setAddress(adesc, desc);
-                            recordExtent(extents, chunk);
-                        }
-                        else
-                        {
-                            (*innerMap)[addr].setTombstonePos(
-                                InnerChunkMapEntry::TOMBSTONE,
-                                desc.hdr.pos.hdrPos);
-                        }
-
-                        /* Now check if by inserting this chunk we made the previous one dead...
-                         */
-                        if (oldestLiveChunkAddr.arrId &&
-                            desc.hdr.arrId <= oldestVersionAddr.arrId)
-                        {
-                            /* The oldestLiveChunk is now dead... wipe it out
-                             */
-                            std::shared_ptr<DataStore> ds =
-                                _datastores.getDataStore(desc.hdr.pos.dsGuid);
-                            if (!oldestLiveChunk->second.isTombstone())
-                            {
-                                eraseExtent(extents,
-                                            oldestLiveChunk->second.getChunk());
-                            }
-                            markChunkAsFree(oldestLiveChunk->second, ds);
-                            innerMap->erase(oldestLiveChunk);
-                        }
-                    }
-                    else
-                    {
-                        /* Chunk is dead, wipe it out
-                         */
-                        std::shared_ptr<DataStore> ds =
-                            _datastores.getDataStore(desc.hdr.pos.dsGuid);
-                        desc.hdr.arrId = 0;
-                        LOG4CXX_TRACE(chunkLogger, "chunkl: initchunkmap: "
-                                      << "remove dead chunk desc for non-existent "
- 	                              << "array version at position " << chunkPos); 
-
-                        _hd->writeAll(&desc.hdr, sizeof(ChunkHeader), chunkPos);
-                        assert(desc.hdr.nCoordinates < MAX_NUM_DIMS_SUPPORTED);
-                        _freeHeaders.insert(chunkPos);
-                        ds->freeChunk(desc.hdr.pos.offs, desc.hdr.allocatedSize);
-                    }
-                }
-            }
-            else
-            {
-                _freeHeaders.insert(chunkPos);
-            }
-        }
+        replayChunkDescriptor(loader, desc, chunkPos);
     }
 
     /* Perform some simple validation for storage header
@@ -602,11 +814,29 @@ CachedStorage::initChunkMap()
         _hdr.currPos = chunkPos;
     }
 
+    /* Wipe out the chunks which are dead: not visible in the oldest version
+       of their array and not needed as the base of a live delta chunk
+     */
+    for (map<ArrayID, ArrayID>::iterator oi = loader.oldestVersions.begin();
+         oi != loader.oldestVersions.end();
+         ++oi)
+    {
+        if (oi->second == 0)
+        {
+            continue;
+        }
+        ChunkMap::iterator iter = _chunkMap.find(oi->first);
+        assert(iter != _chunkMap.end());
+        std::shared_ptr<DataStore> ds = _datastores.getDataStore(oi->first);
+        pruneChunkVersions(*iter->second, ds, oi->second, &loader.extents);
+    }
+    flushChunkDescriptors();
+
     /* Run through removed arrays and try to remove the datastores (if they
        exist)
      */
-    set<ArrayID>::iterator remit = removedArrays.begin();
-    while (remit != removedArrays.end())
+    set<ArrayID>::iterator remit = loader.removedArrays.begin();
+    while (remit != loader.removedArrays.end())
     {
         _datastores.closeDataStore(*remit, true /* remove from disk */);
         ++remit;
@@ -614,578 +844,1704 @@ CachedStorage::initChunkMap()
 
     /* Check chunkmap for overlaps...
      */
-    checkExtentsForOverlaps(extents);
+    checkExtentsForOverlaps(loader.extents);
+
+    /* A long replay makes the next flush take a new checkpoint
+     */
+    _ckptUpdates += nReplayed;
+    LOG4CXX_DEBUG(logger, "smgr open:  chunk map loaded, " << nReplayed
+                  << " descriptors read from the storage header");
 }
 
-/* Read the storage description file to find path for chunk map file.
-   Iterate the chunk map file and build the chunk map in memory.
- */
 void
-CachedStorage::open(const string& storageDescriptorFilePath, size_t cacheSizeBytes)
+CachedStorage::addChunkDescriptor(ChunkMapLoader& loader, ChunkDescriptor& desc, uint64_t chunkPos)
 {
-    /* read/create the storage description file
-     */
-    initStorageDescriptionFile(storageDescriptorFilePath);
+    if (desc.hdr.pos.hdrPos != chunkPos)
+    {
+        LOG4CXX_ERROR(logger, "Invalid chunk header at position " << chunkPos
+                      << " desc.hdr.pos.hdrPos=" << desc.hdr.pos.hdrPos
+                      << " arrayID=" << desc.hdr.arrId
+                      << " hdr.nChunks=" << _hdr.nChunks);
+        _freeHeaders.insert(chunkPos);
+        return;
+    }
+    if (desc.hdr.arrId == 0)
+    {
+        _freeHeaders.insert(chunkPos);
+        return;
+    }
 
-    /* init cache
-     */
-    _cacheSize = cacheSizeBytes;
-    _compressors = CompressorFactory::getInstance().getCompressors();
-    _cacheUsed = 0;
-    _strictCacheLimit = Config::getInstance()->getOption<bool> (CONFIG_STRICT_CACHE_LIMIT);
-    _cacheOverflowFlag = false;
-    _timestamp = 1;
-    _lru.prune();
+    assert(desc.hdr.nCoordinates < MAX_NUM_DIMS_SUPPORTED);
+    LOG4CXX_TRACE(chunkLogger,"chunkl: initchunkmap: found chunk desc " << desc.toString());
 
-    /* Open metadata (chunk map) file and transcation log file
+    /* If the unversioned array does not exist... wipe the chunk
      */
-    int flags = O_LARGEFILE | O_RDWR | O_CREAT;
-    _hd = FileManager::getInstance()->openFileObj(_databaseHeader.c_str(), flags);
-    if (!_hd) {
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
-            _databaseHeader << ::strerror(errno) << errno;
-    }
+    std::shared_ptr<ArrayDesc> arrayDesc = getLoaderArrayDesc(loader, desc.hdr.pos.dsGuid);
+    if (!arrayDesc)
+    {
+        desc.hdr.arrId = 0;
+        LOG4CXX_TRACE(chunkLogger,"chunkl: initchunkmap: remove chunk desc "<< "for non-existant array at position " << chunkPos);
 
-    struct flock flc;
-    flc.l_type = F_WRLCK;
-    flc.l_whence = SEEK_SET;
-    flc.l_start = 0;
-    flc.l_len = 1;
+        deferDescriptorWrite(desc);
+        _freeHeaders.insert(chunkPos);
+        return;
+    }
 
-    if (_hd->fsetlock(&flc))
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_LOCK_DATABASE);
+    /* Else add chunk to map.  Chunks which are not visible in any live
+       version of the array are pruned once all the descriptors have been
+       read, since a live delta chunk may still need an older version at
+       the same position as its base.
+     */
+    ArrayDesc& adesc = *arrayDesc;
+    assert(adesc.getUAId() == desc.hdr.pos.dsGuid);
 
-    _log[0] = FileManager::getInstance()->openFileObj((_databaseLog + "_1").c_str(),
-                                                      O_LARGEFILE | O_SYNC | O_RDWR | O_CREAT);
-    if (!_log[0]) {
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
-            (_databaseLog + "_1") << ::strerror(errno) << errno;
+    /* Find/init the inner chunk map
+     */
+    ChunkMap::iterator iter = _chunkMap.find(adesc.getUAId());
+    if (iter == _chunkMap.end())
+    {
+        iter = _chunkMap.insert(make_pair(adesc.getUAId(),
+                                          std::make_shared <InnerChunkMap> (adesc.getUAId()))).first;
     }
+    std::shared_ptr<InnerChunkMap>& innerMap = iter->second;
 
-    _log[1] = FileManager::getInstance()->openFileObj((_databaseLog + "_2").c_str(),
-                                                      O_LARGEFILE | O_SYNC | O_RDWR | O_CREAT);
-    if (!_log[1]) {
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
-            (_databaseLog + "_2") << ::strerror(errno) << errno;
+    /* Remember the oldest version of array
+     */
+    if (loader.oldestVersions.find(adesc.getUAId()) == loader.oldestVersions.end())
+    {
+        loader.oldestVersions[adesc.getUAId()] =
+            SystemCatalog::getInstance()->getOldestArrayVersion(adesc.getUAId());
     }
+    StorageAddress addr;
+    desc.getAddress(addr);
 
-    _logSize = 0;
-    _currLog = 0;
+    LOG4CXX_TRACE(chunkLogger,
+                  "chunkl: initchunkmap: add chunk to map for pos "
+                  << chunkPos);
 
-    /* Initialize the data stores
+    /* Checkpoint segments are sorted in chunk map order, so inserting at the
+       end is the right hint for them
      */
-    string dataStoresBase = _databasePath + "/datastores";
-    _datastores.initDataStores(dataStoresBase.c_str());
-
-    /* Read/initialize metadata header
-     */
-    size_t rc = _hd->read(&_hdr, sizeof(_hdr), 0);
-    if (rc != 0 && rc != sizeof(_hdr)) {
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
-            << "read" << ::strerror(errno) << errno;
-    }
-
-    _writeLogThreshold = Config::getInstance()->getOption<int> (CONFIG_IO_LOG_THRESHOLD);
-    _enableDeltaEncoding = Config::getInstance()->getOption<bool> (CONFIG_ENABLE_DELTA_ENCODING);
-    _nInstances = SystemCatalog::getInstance()->getNumberOfInstances();
-    _redundancy = 0; // disable replication during rollback: each instance is perfroming rollback locally
-
-    if (rc == 0 || (_hdr.magic == SCIDB_STORAGE_HEADER_MAGIC && _hdr.currPos < HEADER_SIZE))
+    InnerChunkMapEntry& entry = innerMap->insert(innerMap->end(), addr)->second;
+    ASSERT_EXCEPTION((!entry.hasChunk()), "smgr open: NOT unique chunk");
+    if (!desc.hdr.is<ChunkHeader::TOMBSTONE>())
     {
-        LOG4CXX_TRACE(logger, "smgr open:  initializing storage header");
-
-        /* Database is not initialized
+        /* The chunk object is only created when the chunk is accessed
          */
-        ::memset(&_hdr, 0, sizeof(_hdr));
-        _hdr.magic = SCIDB_STORAGE_HEADER_MAGIC;
-        _hdr.versionLowerBound = SCIDB_STORAGE_FORMAT_VERSION;
-        _hdr.versionUpperBound = SCIDB_STORAGE_FORMAT_VERSION;
-        _hdr.currPos = HEADER_SIZE;
-        _hdr.instanceId = INVALID_INSTANCE;
-        _hdr.nChunks = 0;
+        desc.hdr.instanceId = getPrimaryInstanceId(adesc, addr);
+        entry.setDescriptor(desc.hdr);
+        recordExtent(loader.extents, desc.hdr);
     }
     else
     {
-        LOG4CXX_TRACE(logger, "smgr open:  opening storage header");
+        entry.setTombstonePos(InnerChunkMapEntry::TOMBSTONE, desc.hdr.pos.hdrPos);
+    }
+}
 
-        /* Check for corrupted metadata file
-         */
-        if (_hdr.magic != SCIDB_STORAGE_HEADER_MAGIC)
+void
+CachedStorage::replayChunkDescriptor(ChunkMapLoader& loader, ChunkDescriptor& desc, uint64_t chunkPos)
+{
+    /* The array of a descriptor written since the checkpoint is loaded in full
+       and its checkpoint segment is out of date
+     */
+    if (desc.hdr.pos.hdrPos == chunkPos && desc.hdr.arrId != 0)
+    {
+        loadChunkMapSegment(loader, desc.hdr.pos.dsGuid);
+        invalidateChunkMapSegment(desc.hdr.pos.dsGuid);
+    }
+    addChunkDescriptor(loader, desc, chunkPos);
+}
+
+std::shared_ptr<ArrayDesc>
+CachedStorage::getLoaderArrayDesc(ChunkMapLoader& loader, ArrayUAID uaId)
+{
+    typedef map<ArrayID, std::shared_ptr<ArrayDesc> > ArrayDescCache;
+    ArrayDescCache::iterator it = loader.existentArrays.find(uaId);
+    if (it != loader.existentArrays.end())
+    {
+        return it->second;
+    }
+    if (loader.removedArrays.count(uaId) == 0)
+    {
+        try
         {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_INVALID_STORAGE_HEADER);
+            std::shared_ptr<ArrayDesc> ad = SystemCatalog::getInstance()->getArrayDesc(uaId);
+            loader.existentArrays.insert(ArrayDescCache::value_type(uaId, ad));
+            return ad;
         }
-
-        /* At the moment, both upper and lower bound versions in the file must equal to the
-           current version in the code.
-         */
-        if (_hdr.versionLowerBound != SCIDB_STORAGE_FORMAT_VERSION ||
-            _hdr.versionUpperBound != SCIDB_STORAGE_FORMAT_VERSION)
+        catch (SystemException const& x)
         {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_MISMATCHED_STORAGE_FORMAT_VERSION)
-                  << _hdr.versionLowerBound
-                  << _hdr.versionUpperBound
-                  << SCIDB_STORAGE_FORMAT_VERSION;
+            if (x.getLongErrorCode() == SCIDB_LE_ARRAYID_DOESNT_EXIST)
+            {
+                loader.removedArrays.insert(uaId);
+            }
+            else
+            {
+                throw x;
+            }
         }
+    }
+    return std::shared_ptr<ArrayDesc>();
+}
 
-        /* Rollback uncommitted changes
-         */
-        doTxnRecoveryOnStartup();
+void
+CachedStorage::openChunkMapCheckpoint()
+{
+    const size_t interval = Config::getInstance()->getOption<int> (CONFIG_CHUNKMAP_CHECKPOINT_INTERVAL);
+    _ckptInterval = 0; // no new checkpoint until the chunk map is loaded
+    _ckptCurrPos = 0;
+    _ckptGeneration = 0;
+    _ckptNextPos = 0;
+    _ckptNextDirty.clear();
+    _ckptNextChanged.clear();
+    _ckptLog.reset();
+    _ckptLogSize = 0;
+    _ckptUpdates = 0;
+    _ckptDirty.clear();
+    _ckptDirtyOwners.clear();
+    _unpublishedHeaders.clear();
+    _ckptSegments.clear();
+    _lazyChunkMaps.clear();
+    _chunkMapLru.clear();
+    _chunkMapLruPos.clear();
+    _chunkMapLruEntries = 0;
+    _ckptImage.reset();
+
+    /* The image can only be trusted if it belongs to this storage header and
+       every update of the slots it covers has been logged since it was written
+     */
+    ChunkMapCheckpointHeader hdr;
+    bool valid = false;
+    File::FilePtr image = FileManager::getInstance()->openFileObj(_ckptPath.c_str(),
+                                                                 O_LARGEFILE | O_RDONLY);
+    if (image && interval != 0 &&
+        image->read(&hdr, sizeof(hdr), 0) == sizeof(hdr))
+    {
+        valid = hdr.magic == CHUNKMAP_CHECKPOINT_MAGIC &&
+            hdr.version == CHUNKMAP_CHECKPOINT_VERSION &&
+            hdr.hdrCRC == calculateCRC32(&hdr, offsetof(ChunkMapCheckpointHeader, hdrCRC)) &&
+            hdr.instanceId == _hdr.instanceId &&
+            hdr.currPos >= HEADER_SIZE &&
+            hdr.currPos <= _hdr.currPos;
+    }
 
-        /* Database is initialized: read information about all locally available chunks in map
-         */
-        initChunkMap();
+    if (!valid)
+    {
+        image.reset();
+        File::remove(_ckptPath.c_str(), false);
+        return;
+    }
 
-        /* Flush the datastores to capture freelist changes
-         */
-        _datastores.flushAllDataStores();
+    /* Only the log named by the image holds the slots updated since it was
+       written: the other one belongs to the previous image
+     */
+    const string logPath = getCheckpointLogPath(hdr.logGeneration);
+    _ckptLog = FileManager::getInstance()->openFileObj(logPath.c_str(), O_LARGEFILE | O_RDWR | O_CREAT);
+    if (!_ckptLog) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            logPath << ::strerror(errno) << errno;
     }
 
-    /* Start replication manager
+    /* A torn entry at the end of the log precedes a slot write which never happened
      */
-    _replicationManager = ReplicationManager::getInstance();
-    assert(_replicationManager);
-    assert(_replicationManager->isStarted());
-}
+    struct stat st;
+    if (_ckptLog->fstat(&st) != 0) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "fstat" << ::strerror(errno) << errno;
+    }
+    vector<ChunkMapCheckpointLogEntry> entries(st.st_size / sizeof(ChunkMapCheckpointLogEntry));
+    if (!entries.empty())
+    {
+        _ckptLog->readAll(&entries[0], entries.size() * sizeof(ChunkMapCheckpointLogEntry), 0);
+    }
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        _ckptDirty.insert(entries[i].pos);
+        if (entries[i].owner != 0)
+        {
+            _ckptDirtyOwners.insert(entries[i].owner);
+        }
+    }
+    _ckptLogSize = entries.size() * sizeof(ChunkMapCheckpointLogEntry);
+    _ckptCurrPos = hdr.currPos;
+    _ckptGeneration = hdr.logGeneration;
+    _ckptImage = image;
 
+    LOG4CXX_DEBUG(logger, "smgr open:  chunk map checkpoint covers position " << _ckptCurrPos
+                  << ", " << _ckptDirty.size() << " slots updated since");
+}
 
-/* Cleanup and close smgr
- */
-void
-CachedStorage::close()
+bool
+CachedStorage::loadChunkMapCheckpoint(ChunkMapLoader& loader)
 {
-    InjectedErrorListener<WriteChunkInjectedError>::stop();
+    if (_ckptCurrPos == 0)
+    {
+        return false;
+    }
+    File::FilePtr image = _ckptImage;
+    ChunkMapCheckpointHeader hdr;
+    image->readAll(&hdr, sizeof(hdr), 0);
 
-    for (ChunkMap::iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+    vector<uint64_t> freeSlots(hdr.nFree);
+    vector<ChunkMapCheckpointSegment> dir(hdr.nSegments);
+    if (!freeSlots.empty())
     {
-        std::shared_ptr<InnerChunkMap> & innerMap = i->second;
-        for (InnerChunkMap::iterator j = innerMap->begin(); j != innerMap->end(); ++j)
+        image->readAll(&freeSlots[0], freeSlots.size() * sizeof(uint64_t), sizeof(hdr));
+    }
+    if (!dir.empty())
+    {
+        image->readAll(&dir[0], dir.size() * sizeof(ChunkMapCheckpointSegment), hdr.dirOffset);
+    }
+
+    if (hdr.freeCRC != calculateCRC32(freeSlots.empty() ? NULL : &freeSlots[0],
+                                      freeSlots.size() * sizeof(uint64_t)) ||
+        hdr.dirCRC != calculateCRC32(dir.empty() ? NULL : &dir[0],
+                                     dir.size() * sizeof(ChunkMapCheckpointSegment)))
+    {
+        /* Fall back to reading the whole storage header
+         */
+        LOG4CXX_WARN(logger, "smgr open:  chunk map checkpoint " << _ckptPath
+                     << " is corrupted, reading all chunk descriptors");
+        _ckptCurrPos = 0;
+        _ckptImage.reset();
+        File::remove(_ckptPath.c_str(), false);
+        return false;
+    }
+
+    for (size_t i = 0; i < freeSlots.size(); i++)
+    {
+        if (_ckptDirty.count(freeSlots[i]) == 0)
         {
-            if (j->second.getChunk() && j->second.getChunk()->_accessCount != 0)
-                throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_PIN_UNPIN_DISBALANCE);
+            _freeHeaders.insert(freeSlots[i]);
         }
     }
-    _chunkMap.clear();
 
-    _hd.reset();
-    _log[0].reset();
-    _log[1].reset();
+    /* Arrays are only registered here and loaded on first access, except the
+       removed arrays (whose slots are freed now) and the arrays owning slots
+       written since the checkpoint (their segment is out of date)
+     */
+    for (size_t i = 0; i < dir.size(); i++)
+    {
+        _ckptSegments[dir[i].uaid] = dir[i];
+        _lazyChunkMaps[dir[i].uaid] = dir[i];
+    }
+    for (size_t i = 0; i < dir.size(); i++)
+    {
+        ArrayUAID uaId = dir[i].uaid;
+        if (_ckptDirtyOwners.count(uaId) != 0 || !getLoaderArrayDesc(loader, uaId))
+        {
+            loadChunkMapSegment(loader, uaId);
+            invalidateChunkMapSegment(uaId);
+        }
+    }
+    _ckptDirtyOwners.clear();
+
+    LOG4CXX_DEBUG(logger, "smgr open:  chunk map checkpoint lists " << dir.size()
+                  << " arrays, " << _lazyChunkMaps.size() << " of them are loaded on demand");
+    return true;
 }
 
-void CachedStorage::notifyChunkReady(PersistentChunk& chunk)
+void
+CachedStorage::loadChunkMapSegment(ChunkMapLoader& loader, ArrayUAID uaId)
 {
-    // This method is invoked with storage mutex locked
-    chunk._raw = false;
-    if (chunk._waiting)
+    CheckpointSegments::iterator lazy = _lazyChunkMaps.find(uaId);
+    if (lazy == _lazyChunkMaps.end())
     {
-        chunk._waiting = false;
-        _loadEvent.signal(); // wakeup all threads waiting for this chunk
+        return;
     }
-}
+    const ChunkMapCheckpointSegment seg = lazy->second;
+    _lazyChunkMaps.erase(lazy);
 
-void CachedStorage::pinChunk(PersistentChunk const* aChunk)
-{
-    ScopedMutexLock cs(_mutex);
-    PersistentChunk& chunk = *const_cast<PersistentChunk*>(aChunk);
-    LOG4CXX_TRACE(logger, "CachedStorage::pinChunk =" << &chunk << ", accessCount = "<<chunk._accessCount);
-    chunk.beginAccess();
+    vector<char> buf;
+    if (readChunkMapSegment(_ckptImage, seg, buf))
+    {
+        addChunkMapSegment(loader, seg, buf);
+    }
+    else
+    {
+        recoverChunkMapSegment(loader, uaId);
+    }
 }
 
-void CachedStorage::unpinChunk(PersistentChunk const* aChunk)
+bool
+CachedStorage::readChunkMapSegment(File::FilePtr const& image,
+                                   ChunkMapCheckpointSegment const& seg,
+                                   vector<char>& buf)
 {
-    ScopedMutexLock cs(_mutex);
-    PersistentChunk& chunk = *const_cast<PersistentChunk*>(aChunk);
-    LOG4CXX_TRACE(logger, "CachedStorage::unpinChunk =" << &chunk << ", accessCount = "<<chunk._accessCount);
-    assert(chunk._accessCount > 0);
-    if (--chunk._accessCount == 0)
+    /* The segment is read with a single call and checked completely before
+       its entries are inserted (in order)
+     */
+    buf.resize(seg.size);
+    bool valid = image && image->read(buf.empty() ? NULL : &buf[0], buf.size(), seg.offset) == buf.size();
+    valid = valid && seg.crc == calculateCRC32(buf.empty() ? NULL : &buf[0], buf.size());
+
+    char const* const begin = buf.empty() ? NULL : &buf[0];
+    char const* const end = begin + buf.size();
+    char const* src = begin;
+    ChunkHeader chdr;
+    for (uint64_t e = 0; valid && e < seg.nEntries; e++)
     {
-        // Chunk is not accessed any more by any thread, unpin it and include in LRU list
-        _lru.link(&chunk);
+        if (src + sizeof(ChunkHeader) > end)
+        {
+            valid = false;
+            break;
+        }
+        memcpy(&chdr, src, sizeof(ChunkHeader));
+        src += sizeof(ChunkHeader) + chdr.nCoordinates * sizeof(Coordinate);
+        valid = chdr.nCoordinates < MAX_NUM_DIMS_SUPPORTED && src <= end;
     }
+    return valid;
 }
 
-void CachedStorage::addChunkToCache(PersistentChunk& chunk)
+void
+CachedStorage::addChunkMapSegment(ChunkMapLoader& loader,
+                                  ChunkMapCheckpointSegment const& seg,
+                                  vector<char> const& buf)
 {
-    // Check amount of memory used by cached chunks and discard least recently used
-    // chunks from the cache
-    _mutex.checkForDeadlock();
-    while (_cacheUsed + chunk.getSize() > _cacheSize)
+    ChunkDescriptor desc;
+    char const* src = buf.empty() ? NULL : &buf[0];
+    for (uint64_t e = 0; e < seg.nEntries; e++)
     {
-        if (_lru.isEmpty())
+        memcpy(&desc.hdr, src, sizeof(ChunkHeader));
+        src += sizeof(ChunkHeader);
+        memcpy(desc.coords, src, desc.hdr.nCoordinates * sizeof(Coordinate));
+        src += desc.hdr.nCoordinates * sizeof(Coordinate);
+        if (_ckptDirty.count(desc.hdr.pos.hdrPos) == 0)
         {
-            if (_strictCacheLimit && _cacheUsed != 0)
-            {
-                Event::ErrorChecker noopEc;
-                _cacheOverflowFlag = true;
-                _cacheOverflowEvent.wait(_mutex, noopEc);
-            }
-            else
-            {
-                break;
-            }
+            addChunkDescriptor(loader, desc, desc.hdr.pos.hdrPos);
         }
-        internalFreeChunk(*_lru._prev);
     }
-
-    LOG4CXX_TRACE(logger, "CachedStorage::addChunkToCache chunk=" << &chunk
-                      << ", size = "<< chunk.getSize() << ", accessCount = "<<chunk._accessCount
-                      << ", cacheUsed="<<_cacheUsed);
-
-    _cacheUsed += chunk.getSize();
 }
 
-std::shared_ptr<PersistentChunk>
-CachedStorage::lookupChunk(ArrayDesc const& desc, StorageAddress const& addr)
+void
+CachedStorage::recoverChunkMapSegment(ChunkMapLoader& loader, ArrayUAID uaId)
 {
-    ScopedMutexLock cs(_mutex);
-    ChunkMap::iterator iter = _chunkMap.find(desc.getUAId());
-    if (iter != _chunkMap.end())
+    /* Recover the array from the slots covered by the checkpoint
+     */
+    LOG4CXX_ERROR(logger, "Chunk map checkpoint segment of array " << uaId
+                  << " is corrupted, scanning the storage header");
+    invalidateChunkMapSegment(uaId);
+    ChunkDescriptor desc;
+    for (uint64_t pos = HEADER_SIZE; pos < _ckptCurrPos; pos += sizeof(ChunkDescriptor))
     {
-        std::shared_ptr<InnerChunkMap>& innerMap = iter->second;
-        InnerChunkMap::iterator innerIter = innerMap->find(addr);
-        if (innerIter != innerMap->end())
+        if (_ckptDirty.count(pos) == 0 &&
+            _hd->read(&desc, sizeof(ChunkDescriptor), pos) == sizeof(ChunkDescriptor) &&
+            desc.hdr.pos.hdrPos == pos &&
+            desc.hdr.arrId != 0 &&
+            desc.hdr.pos.dsGuid == uaId)
         {
-            std::shared_ptr<PersistentChunk>& chunk = innerIter->second.getChunk();
-            if (chunk)
-            {
-                chunk->beginAccess();
-                return chunk;
-            }
+            addChunkDescriptor(loader, desc, pos);
         }
     }
-    std::shared_ptr<PersistentChunk> emptyChunk;
-    return emptyChunk;
 }
 
-void CachedStorage::decompressChunk(ArrayDesc const& desc, PersistentChunk* chunk, CompressedBuffer const& buf)
+void
+CachedStorage::prepareChunkMapLoader(ChunkMapLoader& loader, ArrayUAID uaId)
 {
-    chunk->allocate(buf.getDecompressedSize());
-
-    DBArrayChunkInternal intChunk(desc, chunk);
-    if (buf.getSize() != buf.getDecompressedSize())
-    {
-        _compressors[buf.getCompressionMethod()]->decompress(buf.getData(), buf.getSize(), intChunk);
-    }
-    else
+    if (getLoaderArrayDesc(loader, uaId))
     {
-        assert(chunk->getHeader().pos.hdrPos == 0);
-        memcpy(intChunk.getDataForLoad(), buf.getData(), buf.getSize());
+        loader.oldestVersions[uaId] = SystemCatalog::getInstance()->getOldestArrayVersion(uaId);
     }
 }
 
-void CachedStorage::compressChunk(ArrayDesc const& desc, PersistentChunk const* aChunk, CompressedBuffer& buf)
+void
+CachedStorage::loadChunkMap(ArrayUAID uaId)
 {
-    assert(aChunk);
-    PersistentChunk& chunk = *const_cast<PersistentChunk*>(aChunk);
-    std::shared_ptr<DataStore> ds = _datastores.getDataStore(desc.getUAId());
-    int compressionMethod = chunk.getCompressionMethod();
-    if (compressionMethod < 0) {
-        throw USER_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_COMPRESS_METHOD_NOT_DEFINED);
-    }
-    buf.setDecompressedSize(chunk.getSize());
-    buf.setCompressionMethod(compressionMethod);
+    ScopedMutexLock cs(_mutex);
+    _mutex.checkForDeadlock();
+
+    /* Read and check the segment and look the array up in the catalog without
+       holding _mutex, so that loading a cold array does not stall the other
+       storage operations.  The threads wanting the same array wait for the
+       load to complete.
+     */
+    while (_lazyChunkMaps.count(uaId) != 0)
     {
-        ScopedMutexLock cs(_mutex);
-        if (!chunk.isRaw() && chunk._data != NULL)
+        if (_loadingChunkMaps.count(uaId) != 0)
         {
-            PersistentChunk::Pinner scope(&chunk);
-            buf.allocate(chunk.getCompressedSize() != 0 ? chunk.getCompressedSize() : chunk.getSize());
-            DBArrayChunkInternal intChunk(desc, &chunk);
-            size_t compressedSize = _compressors[compressionMethod]->compress(buf.getData(), intChunk);
-            if (compressedSize == chunk.getSize())
-            {
-                memcpy(buf.getData(), chunk._data, compressedSize);
-            }
-            else if (compressedSize != buf.getSize())
+            Semaphore::ErrorChecker ec;
+            std::shared_ptr<Query> query = Query::getQueryByID(Query::getCurrentQueryID(), false);
+            if (query)
             {
-                buf.reallocate(compressedSize);
+                ec = bind(&Query::validate, query);
             }
+            _loadEvent.wait(_mutex, ec);
+            continue;
         }
-    }
+        const ChunkMapCheckpointSegment seg = _lazyChunkMaps[uaId];
+        File::FilePtr image = _ckptImage;
+        ChunkMapLoader loader;
+        vector<char> buf;
+        bool valid = false;
+        _loadingChunkMaps.insert(uaId);
+        try
+        {
+            ScopedMutexRelease unlocked(_mutex);
+            valid = readChunkMapSegment(image, seg, buf);
+            prepareChunkMapLoader(loader, uaId);
+        }
+        catch (...)
+        {
+            _loadingChunkMaps.erase(uaId);
+            _loadEvent.signal();
+            throw;
+        }
+        _loadingChunkMaps.erase(uaId);
+        _loadEvent.signal();
 
-    if (buf.getData() == NULL)
-    { // chunk data is not present in the cache so read compressed data from the disk
-        if (aChunk->_hdr.pos.hdrPos == 0)
+        /* Meanwhile findChunkMap() may have loaded the array under _mutex, and
+           it may even have been evicted again after a change: publish only
+           what is still current
+         */
+        CheckpointSegments::const_iterator lazy = _lazyChunkMaps.find(uaId);
+        if (lazy != _lazyChunkMaps.end() &&
+            lazy->second.crc == seg.crc &&
+            lazy->second.size == seg.size &&
+            lazy->second.nEntries == seg.nEntries)
         {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_ACCESS_TO_RAW_CHUNK) << aChunk->getHeader().arrId;
+            publishChunkMap(loader, uaId, seg, buf, valid);
         }
-        buf.allocate(aChunk->getCompressedSize());
-        readChunkFromDataStore(*ds, *aChunk, buf.getData());
     }
 }
 
-inline bool CachedStorage::isResponsibleFor(ArrayDesc const& desc,
-                                            PersistentChunk const& chunk,
-                                            std::shared_ptr<Query> const& query)
+void
+CachedStorage::loadLazyChunkMap(ArrayUAID uaId)
 {
-    ScopedMutexLock cs(_mutex);
-    Query::validateQueryPtr(query);
-    assert(chunk._hdr.instanceId < size_t(_nInstances));
+    CheckpointSegments::const_iterator lazy = _lazyChunkMaps.find(uaId);
+    assert(lazy != _lazyChunkMaps.end());
+    const ChunkMapCheckpointSegment seg = lazy->second;
+
+    ChunkMapLoader loader;
+    vector<char> buf;
+    const bool valid = readChunkMapSegment(_ckptImage, seg, buf);
+    prepareChunkMapLoader(loader, uaId);
+    publishChunkMap(loader, uaId, seg, buf, valid);
+}
 
-    if (chunk._hdr.instanceId == _hdr.instanceId)
-    {
-        return true;
+void
+CachedStorage::publishChunkMap(ChunkMapLoader& loader,
+                               ArrayUAID uaId,
+                               ChunkMapCheckpointSegment const& seg,
+                               vector<char> const& buf,
+                               bool valid)
+{
+    /* A lazy array has not changed since its segment was written, so the
+       segment is current even if the checkpoint was replaced meanwhile.
+     */
+    _lazyChunkMaps.erase(uaId);
+    if (valid)
+    {
+        addChunkMapSegment(loader, seg, buf);
     }
-    if (!query->isPhysicalInstanceDead(chunk._hdr.instanceId))
+    else
     {
-        return false;
+        recoverChunkMapSegment(loader, uaId);
     }
-    if (_redundancy == 1)
+
+    /* Same treatment as on startup: drop the dead versions, remove the array
+       if it no longer exists and check the extents
+     */
+    ChunkMap::iterator iter = _chunkMap.find(uaId);
+    map<ArrayID, ArrayID>::const_iterator oldest = loader.oldestVersions.find(uaId);
+    if (iter != _chunkMap.end() && oldest != loader.oldestVersions.end() && oldest->second != 0)
     {
-        return true;
+        std::shared_ptr<DataStore> ds = _datastores.getDataStore(uaId);
+        pruneChunkVersions(*iter->second, ds, oldest->second, &loader.extents);
     }
-    InstanceID replicas[MAX_REDUNDANCY + 1];
-    getReplicasInstanceId(replicas, desc, chunk.getAddress());
-    for (size_t i = 1; i <= _redundancy; i++)
+    if (loader.removedArrays.count(uaId) != 0)
     {
-        if (replicas[i] == _hdr.instanceId)
-        {
-            return true;
-        }
-        if (!query->isPhysicalInstanceDead(replicas[i]))
-        {
-            // instance with this replica is alive
-            return false;
-        }
+        _datastores.closeDataStore(uaId, true /* remove from disk */);
     }
-    return false;
+    checkExtentsForOverlaps(loader.extents);
+
+    LOG4CXX_DEBUG(logger, "Loaded chunk map of array " << uaId << ": "
+                  << (iter != _chunkMap.end() ? iter->second->size() : 0) << " entries");
+    if (iter != _chunkMap.end())
+    {
+        touchChunkMap(uaId, iter->second->size());
+    }
+    evictChunkMaps();
 }
 
-std::shared_ptr<PersistentChunk> CachedStorage::createChunk(ArrayDesc const& desc,
-                                                              StorageAddress const& addr,
-                                                              int compressionMethod,
-                                                              const std::shared_ptr<Query>& query)
+CachedStorage::ChunkMap::iterator
+CachedStorage::findChunkMap(ArrayUAID uaId)
 {
-    ScopedMutexLock cs(_mutex);
-    Query::validateQueryPtr(query);
-
-    assert(desc.getUAId()!=0);
-    ChunkMap::iterator iter = _chunkMap.find(desc.getUAId());
-    if (iter == _chunkMap.end())
+    if (_lazyChunkMaps.count(uaId) != 0)
     {
-        iter = _chunkMap.insert(make_pair(desc.getUAId(), make_shared <InnerChunkMap> ())).first;
+        /* Evicted again since the entry point loaded it with loadChunkMap():
+           load it under _mutex
+         */
+        loadLazyChunkMap(uaId);
     }
-    else if (iter->second->find(addr) != iter->second->end())
+    ChunkMap::iterator iter = _chunkMap.find(uaId);
+    if (iter != _chunkMap.end())
     {
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CHUNK_ALREADY_EXISTS)
-        << CoordsToStr(addr.coords);
+        touchChunkMap(uaId, iter->second->size());
     }
-
-    std::shared_ptr<PersistentChunk>& chunk = (*(iter->second))[addr].getChunk();
-    chunk.reset(new PersistentChunk());
-    chunk->setAddress(desc, addr, compressionMethod);
-    LOG4CXX_TRACE(chunkLogger, "chunkl: createchunk: chunk created for addr "
-                   << "[attrid=" << addr.attId << "][arrid=" << addr.arrId
-                   << "]" << CoordsToStr(addr.coords)); 
-
-    chunk->_accessCount = 1; // newly created chunk is pinned
-    chunk->_timestamp = ++_timestamp;
-    return chunk;
+    return iter;
 }
 
-void CachedStorage::deleteChunk(ArrayDesc const& desc, PersistentChunk& victim)
+void
+CachedStorage::touchChunkMap(ArrayUAID uaId, size_t nEntries)
 {
-    ScopedMutexLock cs(_mutex);
-
-    ChunkMap::const_iterator iter = _chunkMap.find(desc.getUAId());
-    if (iter != _chunkMap.end())
+    std::unordered_map<ArrayUAID, ChunkMapLru::iterator>::iterator pos = _chunkMapLruPos.find(uaId);
+    if (pos != _chunkMapLruPos.end())
     {
-        iter->second->erase(victim._addr);
+        _chunkMapLruEntries -= pos->second->second;
+        pos->second->second = nEntries;
+        _chunkMapLru.splice(_chunkMapLru.begin(), _chunkMapLru, pos->second);
+    }
+    else
+    {
+        _chunkMapLruPos[uaId] = _chunkMapLru.insert(_chunkMapLru.begin(), make_pair(uaId, nEntries));
     }
+    _chunkMapLruEntries += nEntries;
 }
 
-void CachedStorage::freeChunk(PersistentChunk* victim)
+void
+CachedStorage::forgetChunkMap(ArrayUAID uaId)
 {
-    ScopedMutexLock cs(_mutex);
-    internalFreeChunk(*victim);
+    std::unordered_map<ArrayUAID, ChunkMapLru::iterator>::iterator pos = _chunkMapLruPos.find(uaId);
+    if (pos != _chunkMapLruPos.end())
+    {
+        _chunkMapLruEntries -= pos->second->second;
+        _chunkMapLru.erase(pos->second);
+        _chunkMapLruPos.erase(pos);
+    }
 }
 
-void CachedStorage::internalFreeChunk(PersistentChunk& victim)
+void
+CachedStorage::evictChunkMaps()
 {
-    if (victim._data != NULL && victim._hdr.pos.hdrPos != 0)
+    /* The limit is read on every load so that setopt() takes effect at once
+     */
+    _chunkMapLimit = Config::getInstance()->getOption<int> (CONFIG_CHUNKMAP_LOADED_LIMIT);
+    if (_chunkMapLimit == 0)
     {
-        LOG4CXX_TRACE(logger, "CachedStorage::internalFreeChunk chunk=" << &victim
-                      << ", size = "<< victim.getSize() << ", accessCount = "<<victim._accessCount
-                      << ", cacheUsed="<<_cacheUsed);
+        return;
+    }
 
-        _cacheUsed -= victim.getSize();
-        if (_cacheOverflowFlag)
+    /* Walk from the least recently used array, the number of entries of each
+       array is the one it had when last used
+     */
+    ChunkMapLru::iterator victim = _chunkMapLru.end();
+    while (_chunkMapLruEntries > _chunkMapLimit && victim != _chunkMapLru.begin())
+    {
+        --victim;
+        ArrayUAID uaId = victim->first;
+        ChunkMap::iterator iter = _chunkMap.find(uaId);
+        CheckpointSegments::const_iterator seg = _ckptSegments.find(uaId);
+        if (iter == _chunkMap.end() || seg == _ckptSegments.end())
         {
-            _cacheOverflowFlag = false;
-            _cacheOverflowEvent.signal();
+            continue;
         }
+
+        /* Chunks in use (pinned or being loaded) keep their array in memory,
+           the others leave the cache with it
+         */
+        InnerChunkMap& inner = *iter->second;
+        bool inUse = false;
+        for (InnerChunkMap::const_iterator j = inner.begin(); j != inner.end() && !inUse; ++j)
+        {
+            std::shared_ptr<PersistentChunk> const& chunk = j->second.getChunk();
+            inUse = chunk && (chunk->_accessCount != 0 || chunk->_raw);
+        }
+        if (inUse)
+        {
+            continue;
+        }
+        for (InnerChunkMap::iterator j = inner.begin(); j != inner.end(); ++j)
+        {
+            std::shared_ptr<PersistentChunk>& chunk = j->second.getChunk();
+            if (chunk && chunk->_data != NULL)
+            {
+                internalFreeChunk(*chunk);
+            }
+        }
+
+        LOG4CXX_DEBUG(logger, "Evicting chunk map of array " << uaId << ": "
+                      << inner.size() << " entries");
+        _lazyChunkMaps[uaId] = seg->second;
+        _chunkMap.erase(iter);
+        _chunkMapLruEntries -= victim->second;
+        _chunkMapLruPos.erase(uaId);
+        victim = _chunkMapLru.erase(victim);
     }
-    if (victim._next != NULL)
-    {
-        victim.unlink();
-    }
-    victim.free();
 }
 
-/*
- Remove all versions prior to lastLiveArrId from the unversioned
- array uaId in the storage. If lastLiveArrId is 0, removes all
- versions. Does nothing if the specified array is not present.
-*/
-void CachedStorage::removeVersions(QueryID queryId,
-                                   ArrayUAID uaId,
-                                   ArrayID lastLiveArrId)
+void
+CachedStorage::writeChunkMapCheckpoint(size_t minUpdates)
 {
     ScopedMutexLock cs(_mutex);
-    std::shared_ptr<InnerChunkMap> innerMap;
-    ChunkMap::const_iterator iter = _chunkMap.find(uaId);
-    if (iter == _chunkMap.end())
+    _mutex.checkForDeadlock();
+    if (_ckptInterval == 0 || _ckptUpdates == 0 || _ckptUpdates < minUpdates || _ckptNextPos != 0)
     {
-        return;
+        return; // not due, or another thread is writing one
     }
-    innerMap = iter->second;
-
-    std::shared_ptr<DataStore> ds = _datastores.getDataStore(uaId);
-    set<StorageAddress> victims;
-    StorageAddress currentChunkAddr;
-    bool currentChunkIsLive = true;
-    for (InnerChunkMap::iterator i = innerMap->begin(); i != innerMap->end(); ++i)
+    flushChunkDescriptors();
+    if (_hd->fsync() != 0)
     {
-        StorageAddress const& address = i->first;
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "fsync" << ::strerror(errno) << errno;
+    }
 
-        /* If lastLiveArrId is non-zero, we must determine if the chunk is live.
-           If lastLiveArrId is zero, then we proceed immediately to remove chunk.
-        */
-        if (lastLiveArrId)
+    /* Take a snapshot of the chunk map under _mutex: the free slots, the
+       segments of the loaded arrays and the location of the lazy ones
+     */
+    ChunkMapCheckpointHeader hdr;
+    ::memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = CHUNKMAP_CHECKPOINT_MAGIC;
+    hdr.version = CHUNKMAP_CHECKPOINT_VERSION;
+    hdr.instanceId = _hdr.instanceId;
+    hdr.currPos = _hdr.currPos;
+    hdr.logGeneration = _ckptGeneration + 1;
+
+    vector<uint64_t> freeSlots(_freeHeaders.begin(), _freeHeaders.end());
+    vector<uint64_t> unpublished(_unpublishedHeaders.begin(), _unpublishedHeaders.end());
+    CheckpointSegments lazy(_lazyChunkMaps);
+    File::FilePtr oldImage = _ckptImage;
+
+    /* Slots taken by writes still in progress are left out of the image and
+       logged instead: their descriptors are written after the snapshot
+     */
+    vector<ChunkMapCheckpointSegment> dir;
+    vector<char> segments;              // the segments of dir, offsets relative to its start
+    ChunkHeader chdr;
+    for (ChunkMap::const_iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+    {
+        ChunkMapCheckpointSegment seg;
+        ::memset(&seg, 0, sizeof(seg));
+        seg.uaid = i->first;
+        seg.offset = segments.size();
+        for (InnerChunkMap::const_iterator j = i->second->begin(); j != i->second->end(); ++j)
         {
-            if (!address.sameBaseAddr(currentChunkAddr))
+            if (j->second.isTombstone())
             {
-                /* Move on to next coordinate
-                 */
-                currentChunkAddr = address;
-                currentChunkIsLive = true;
+                readChunkHeader(chdr, j->second.getTombstonePos());
+            }
+            else if (j->second.hasChunk())
+            {
+                i->second->getHeader(j, chdr);
             }
-            if (address.arrId > lastLiveArrId)
+            else
             {
-                /* Chunk was added after oldest version
-                   so it is still live
-                */
                 continue;
             }
-            else if (address.arrId == lastLiveArrId)
+            if (chdr.pos.hdrPos == 0 || _unpublishedHeaders.count(chdr.pos.hdrPos))
             {
-                /* Chunk was added in oldest version so it is
-                   still live, but any older chunks are not
-                */
-                currentChunkIsLive = false;
                 continue;
             }
-            else if (address.arrId < lastLiveArrId)
+            Coordinates const& coords = j->first.coords;
+            chdr.nCoordinates = coords.size();
+            segments.insert(segments.end(),
+                            reinterpret_cast<char const*>(&chdr),
+                            reinterpret_cast<char const*>(&chdr) + sizeof(chdr));
+            if (!coords.empty())
             {
-                /* Chunk was added prior to oldest version
-                 */
-                if (currentChunkIsLive)
-                {
-                    /* Chunk is still live, but older chunks are not
-                     */
-                    currentChunkIsLive = false;
-                        continue;
-                }
+                segments.insert(segments.end(),
+                                reinterpret_cast<char const*>(&coords[0]),
+                                reinterpret_cast<char const*>(&coords[0] + coords.size()));
             }
+            seg.nEntries += 1;
+        }
+        if (seg.nEntries == 0)
+        {
+            continue;
         }
+        seg.size = segments.size() - seg.offset;
+        seg.crc = calculateCRC32(&segments[seg.offset], seg.size);
+        dir.push_back(seg);
+    }
 
-        /* Chunk should be removed
-         */
-        markChunkAsFree(i->second, ds);
-        victims.insert(address);
+    /* The image is written and synced without _mutex; meanwhile
+       logCheckpointedSlots() and invalidateChunkMapSegment() note the slots
+       and arrays which change
+     */
+    const size_t nUpdates = _ckptUpdates;
+    _ckptUpdates = 0;
+    _ckptNextPos = hdr.currPos;
+    const string tmpPath = _ckptPath + ".tmp";
+    uint64_t size = 0;
+    try
+    {
+        ScopedMutexRelease unlocked(_mutex);
+        size = writeChunkMapImage(tmpPath, hdr, freeSlots, segments, dir, lazy, oldImage);
     }
-    _hd->writeAll(&_hdr, HEADER_SIZE, 0);
-    for(set<StorageAddress>::iterator i = victims.begin(); i != victims.end(); ++i)
+    catch (...)
+    {
+        _ckptNextPos = 0;
+        _ckptNextDirty.clear();
+        _ckptNextChanged.clear();
+        _ckptUpdates += nUpdates;
+        throw;
+    }
+    std::map<uint64_t, ArrayUAID> dirty;
+    std::set<ArrayUAID> changed;
+    dirty.swap(_ckptNextDirty);
+    changed.swap(_ckptNextChanged);
+    _ckptNextPos = 0;
+
+    /* Write the log of the new image before the image replaces the old one:
+       the slots left out of the snapshot and the ones updated since, with
+       the array the snapshot assigns them to
+     */
+    for (size_t i = 0; i < unpublished.size(); i++)
     {
-        StorageAddress const& address = *i;
-        innerMap->erase(address);
+        if (unpublished[i] < hdr.currPos && dirty.count(unpublished[i]) == 0)
+        {
+            dirty[unpublished[i]] = getCheckpointedSlotOwner(unpublished[i]);
+        }
     }
-    flush(uaId);
-    if (!lastLiveArrId)
+    vector<ChunkMapCheckpointLogEntry> entries;
+    entries.reserve(dirty.size());
+    for (std::map<uint64_t, ArrayUAID>::const_iterator i = dirty.begin(); i != dirty.end(); ++i)
     {
-        assert(innerMap->size() == 0);
-        _chunkMap.erase(uaId);
-        _datastores.closeDataStore(uaId, true /* remove from disk */);
+        ChunkMapCheckpointLogEntry entry;
+        entry.pos = i->first;
+        entry.owner = i->second;
+        entries.push_back(entry);
+    }
+    const string logPath = getCheckpointLogPath(hdr.logGeneration);
+    File::FilePtr log = FileManager::getInstance()->openFileObj(logPath.c_str(),
+                                                               O_LARGEFILE | O_RDWR | O_CREAT | O_TRUNC);
+    if (!log) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            logPath << ::strerror(errno) << errno;
     }
+    if (!entries.empty())
+    {
+        log->writeAll(&entries[0], entries.size() * sizeof(ChunkMapCheckpointLogEntry), 0);
+    }
+    if (log->fdatasync() != 0) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "fdatasync" << ::strerror(errno) << errno;
+    }
+
+    if (::rename(tmpPath.c_str(), _ckptPath.c_str()) != 0) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "rename" << ::strerror(errno) << errno;
+    }
+    _ckptImage = FileManager::getInstance()->openFileObj(_ckptPath.c_str(), O_LARGEFILE | O_RDONLY);
+    if (!_ckptImage) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            _ckptPath << ::strerror(errno) << errno;
+    }
+    _ckptLog = log;
+    _ckptLogSize = entries.size() * sizeof(ChunkMapCheckpointLogEntry);
+    _ckptGeneration = hdr.logGeneration;
+    _ckptCurrPos = hdr.currPos;
+    _ckptDirty.clear();
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        _ckptDirty.insert(entries[i].pos);
+    }
+
+    /* Arrays unchanged since the snapshot now match their segment in the new
+       image and can be evicted; the lazy ones are read from it from now on
+     */
+    _ckptSegments.clear();
+    for (size_t i = 0; i < dir.size(); i++)
+    {
+        ArrayUAID uaId = dir[i].uaid;
+        CheckpointSegments::iterator l = _lazyChunkMaps.find(uaId);
+        if (l != _lazyChunkMaps.end())
+        {
+            l->second = dir[i];
+        }
+        if (changed.count(uaId) == 0 && (l != _lazyChunkMaps.end() || _chunkMap.count(uaId) != 0))
+        {
+            _ckptSegments[uaId] = dir[i];
+        }
+    }
+    SCIDB_ASSERT(_lazyChunkMaps.size() <= _ckptSegments.size());
+    for (ChunkMap::const_iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+    {
+        if (_chunkMapLruPos.count(i->first) == 0)
+        {
+            _chunkMapLruPos[i->first] =
+                _chunkMapLru.insert(_chunkMapLru.end(), make_pair(i->first, i->second->size()));
+            _chunkMapLruEntries += i->second->size();
+        }
+    }
+
+    LOG4CXX_DEBUG(logger, "Chunk map checkpoint written: " << dir.size() << " arrays, "
+                  << size << " bytes, covers position " << _ckptCurrPos
+                  << ", " << entries.size() << " slots updated since");
 }
 
-void CachedStorage::removeVersionFromMemory(ArrayUAID uaId, ArrayID arrId)
+uint64_t
+CachedStorage::writeChunkMapImage(string const& path,
+                                  ChunkMapCheckpointHeader& hdr,
+                                  vector<uint64_t> const& freeSlots,
+                                  vector<char> const& segments,
+                                  vector<ChunkMapCheckpointSegment>& dir,
+                                  CheckpointSegments const& lazy,
+                                  File::FilePtr const& oldImage)
 {
-    ScopedMutexLock cs(_mutex);
-    std::shared_ptr<InnerChunkMap> innerMap;
-    ChunkMap::const_iterator iter = _chunkMap.find(uaId);
-    if (iter == _chunkMap.end())
+    File::FilePtr image = FileManager::getInstance()->openFileObj(path.c_str(),
+                                                                 O_LARGEFILE | O_RDWR | O_CREAT | O_TRUNC);
+    if (!image) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            path << ::strerror(errno) << errno;
+    }
+
+    hdr.nFree = freeSlots.size();
+    hdr.freeCRC = calculateCRC32(freeSlots.empty() ? NULL : &freeSlots[0],
+                                 freeSlots.size() * sizeof(uint64_t));
+    if (!freeSlots.empty())
     {
-        return;
+        image->writeAll(&freeSlots[0], freeSlots.size() * sizeof(uint64_t), sizeof(hdr));
     }
-    else
+    uint64_t offs = sizeof(hdr) + freeSlots.size() * sizeof(uint64_t);
+
+    if (!segments.empty())
     {
-        innerMap = iter->second;
+        image->writeAll(&segments[0], segments.size(), offs);
+    }
+    for (size_t i = 0; i < dir.size(); i++)
+    {
+        dir[i].offset += offs;
+    }
+    offs += segments.size();
+
+    /* Arrays not loaded in memory have not changed: copy their segments
+     */
+    if (!lazy.empty() && !oldImage) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            _ckptPath << ::strerror(errno) << errno;
     }
-    vector<StorageAddress> victims;
-    for (InnerChunkMap::iterator i = innerMap->begin(); i != innerMap->end(); ++i)
+    vector<char> buf;
+    for (CheckpointSegments::const_iterator l = lazy.begin(); l != lazy.end(); ++l)
     {
-        StorageAddress const& addr = i->first;
-        if (addr.arrId != arrId)
+        buf.resize(l->second.size);
+        if (!buf.empty())
         {
-            continue;
+            oldImage->readAll(&buf[0], buf.size(), l->second.offset);
+            image->writeAll(&buf[0], buf.size(), offs);
         }
-        victims.push_back(addr);
+        dir.push_back(l->second);
+        dir.back().offset = offs;
+        offs += buf.size();
     }
-    for(vector<StorageAddress>::iterator i = victims.begin(); i != victims.end(); ++i)
+
+    hdr.nSegments = dir.size();
+    hdr.dirOffset = offs;
+    hdr.dirCRC = calculateCRC32(dir.empty() ? NULL : &dir[0],
+                                dir.size() * sizeof(ChunkMapCheckpointSegment));
+    if (!dir.empty())
     {
-       StorageAddress const& address = *i;
-       innerMap->erase(address);
+        image->writeAll(&dir[0], dir.size() * sizeof(ChunkMapCheckpointSegment), offs);
     }
-    if (innerMap->size() == 0)
-    {
-       _chunkMap.erase(uaId);
+    hdr.hdrCRC = calculateCRC32(&hdr, offsetof(ChunkMapCheckpointHeader, hdrCRC));
+    image->writeAll(&hdr, sizeof(hdr), 0);
+    if (image->fsync() != 0) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "fsync" << ::strerror(errno) << errno;
     }
+    return offs + dir.size() * sizeof(ChunkMapCheckpointSegment);
 }
 
-InstanceID CachedStorage::getPrimaryInstanceId(ArrayDesc const& desc, StorageAddress const& address) const
+string
+CachedStorage::getCheckpointLogPath(uint64_t generation) const
 {
-    //in this context we have to be careful to use nInstances which was set at the beginning of system lifetime
-    //this method must return the same value regardless of whether or not there were failures
-    return desc.getPrimaryInstanceId(address.coords, _nInstances);
+    return _ckptPath + (generation % 2 == 0 ? "_log0" : "_log1");
 }
 
-void CachedStorage::getReplicasInstanceId(InstanceID* replicas, ArrayDesc const& desc, StorageAddress const& address) const
+ArrayUAID
+CachedStorage::getCheckpointedSlotOwner(uint64_t pos)
 {
-    replicas[0] = getPrimaryInstanceId(desc, address);
-    for (size_t i = 0; i < _redundancy; i++)
+    ChunkHeader chdr;
+    if (_hd->read(&chdr, sizeof(ChunkHeader), pos) == sizeof(ChunkHeader) &&
+        chdr.pos.hdrPos == pos && chdr.arrId != 0)
     {
-        // A prime number can be used to smear the replicas as follows
-        // InstanceID instanceId = (chunk.getArrayDesc().getHashedChunkNumber(chunk.addr.coords) + (i+1)) % PRIME_NUMBER % nInstances;
-        // the PRIME_NUMBER needs to be just shy of the number of instances to work, so we would need a table.
-        // For Fibonacci no table is required, and it seems to work OK.
+        return chdr.pos.dsGuid;
+    }
+    return 0;
+}
 
-        const uint64_t nReplicas = (_redundancy + 1);
-        const uint64_t currReplica = (i + 1);
-        //XXX TODO: each array/distribution should implement the replica mapping function
-        //XXX TODO: for now hard-wire psHashPartitioned mapping
-        //XXX TODO: this implies that the replicas are NOT distributed with the distribution of the primary chunks
-        const static size_t infinity(std::numeric_limits<size_t>::max());
-        Dimensions const& dims = desc.getDimensions();
-        const uint64_t chunkId =
-            getPrimaryInstanceForChunk(psHashPartitioned, address.coords, dims, infinity) * (nReplicas) + currReplica;
-        InstanceID instanceId = fibHash64(chunkId, MAX_INSTANCE_BITS) % _nInstances;
-        for (size_t j = 0; j <= i; j++)
+void
+CachedStorage::invalidateChunkMapSegment(ArrayUAID uaId)
+{
+    _ckptSegments.erase(uaId);
+    if (_ckptNextPos != 0)
+    {
+        _ckptNextChanged.insert(uaId);
+    }
+}
+
+void
+CachedStorage::logCheckpointedSlots(vector<uint64_t> const& positions)
+{
+    /* While a new image is written from a snapshot, remember the slots it
+       covers which are about to change, and the array they hold in it
+     */
+    if (_ckptNextPos != 0)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
         {
-            if (replicas[j] == instanceId)
+            if (positions[i] < _ckptNextPos && _ckptNextDirty.count(positions[i]) == 0)
             {
-                instanceId = (instanceId + 1) % _nInstances;
-                j = -1;
+                _ckptNextDirty[positions[i]] = getCheckpointedSlotOwner(positions[i]);
             }
         }
-        replicas[i + 1] = instanceId;
     }
-}
+    if (_ckptCurrPos == 0)
+    {
+        return;
+    }
 
-void CachedStorage::replicate(ArrayDesc const& desc,
-                              StorageAddress const& addr,
-                              PersistentChunk* chunk,
-                              void const* data,
-                              size_t compressedSize,
+    /* Slots logged for the first time still hold what the image says: record
+       the array the image assigns them to, which must not be loaded lazily
+       from its segment after a restart
+     */
+    vector<ChunkMapCheckpointLogEntry> entries;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (positions[i] < _ckptCurrPos && _ckptDirty.count(positions[i]) == 0)
+        {
+            ChunkMapCheckpointLogEntry entry;
+            entry.pos = positions[i];
+            entry.owner = getCheckpointedSlotOwner(positions[i]);
+            entries.push_back(entry);
+        }
+    }
+    if (entries.empty())
+    {
+        return;
+    }
+    _ckptLog->writeAll(&entries[0], entries.size() * sizeof(ChunkMapCheckpointLogEntry), _ckptLogSize);
+    if (_ckptLog->fdatasync() != 0) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "fdatasync" << ::strerror(errno) << errno;
+    }
+    _ckptLogSize += entries.size() * sizeof(ChunkMapCheckpointLogEntry);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        _ckptDirty.insert(entries[i].pos);
+    }
+}
+
+/* Read the storage description file to find path for chunk map file.
+   Iterate the chunk map file and build the chunk map in memory.
+ */
+void
+CachedStorage::open(const string& storageDescriptorFilePath, size_t cacheSizeBytes)
+{
+    /* read/create the storage description file
+     */
+    initStorageDescriptionFile(storageDescriptorFilePath);
+
+    /* init cache
+     */
+    _cacheSize = cacheSizeBytes;
+    _compressors = CompressorFactory::getInstance().getCompressors();
+    _cacheUsed = 0;
+    _cacheMapped = 0;
+    _mmapCacheSize = Config::getInstance()->getOption<int>(CONFIG_MMAP_CACHE_SIZE) * MiB;
+    const string advice = Config::getInstance()->getOption<string>(CONFIG_MMAP_ADVICE);
+    if (advice == "sequential") {
+        _mmapAdvice = MADV_SEQUENTIAL;
+    } else if (advice == "random") {
+        _mmapAdvice = MADV_RANDOM;
+    } else if (advice == "willneed") {
+        _mmapAdvice = MADV_WILLNEED;
+    } else if (advice == "normal") {
+        _mmapAdvice = MADV_NORMAL;
+    } else {
+        throw USER_EXCEPTION(SCIDB_SE_CONFIG, SCIDB_LE_ERROR_NEAR_CONFIG_OPTION)
+            << advice << "mmap-advice";
+    }
+    _strictCacheLimit = Config::getInstance()->getOption<bool> (CONFIG_STRICT_CACHE_LIMIT);
+    _cacheOverflowFlag = false;
+    _timestamp = 1;
+    _lru.prune();
+
+    /* Open metadata (chunk map) file and transcation log file
+     */
+    int flags = O_LARGEFILE | O_RDWR | O_CREAT;
+    _hd = FileManager::getInstance()->openFileObj(_databaseHeader.c_str(), flags);
+    if (!_hd) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            _databaseHeader << ::strerror(errno) << errno;
+    }
+
+    struct flock flc;
+    flc.l_type = F_WRLCK;
+    flc.l_whence = SEEK_SET;
+    flc.l_start = 0;
+    flc.l_len = 1;
+
+    if (_hd->fsetlock(&flc))
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_LOCK_DATABASE);
+
+    _log[0] = FileManager::getInstance()->openFileObj((_databaseLog + "_1").c_str(),
+                                                      O_LARGEFILE | O_SYNC | O_RDWR | O_CREAT);
+    if (!_log[0]) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            (_databaseLog + "_1") << ::strerror(errno) << errno;
+    }
+
+    _log[1] = FileManager::getInstance()->openFileObj((_databaseLog + "_2").c_str(),
+                                                      O_LARGEFILE | O_SYNC | O_RDWR | O_CREAT);
+    if (!_log[1]) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE) <<
+            (_databaseLog + "_2") << ::strerror(errno) << errno;
+    }
+
+    _logSize = 0;
+    _currLog = 0;
+    _logQueue.clear();
+    _logQueuedSeq = _logSyncedSeq = 0;
+    _logFailedSeq = UINT64_MAX;
+    _logWriterActive = false;
+    _pendingDescriptors.clear();
+    _hdrDirty = false;
+    _ckptPath = _databaseHeader + ".ckpt";
+
+    /* Initialize the data stores
+     */
+    string dataStoresBase = _databasePath + "/datastores";
+    _datastores.initDataStores(dataStoresBase.c_str(),
+                               Config::getInstance()->getOption<string>(CONFIG_STORAGE_TIERS));
+
+    /* Read/initialize metadata header
+     */
+    size_t rc = _hd->read(&_hdr, sizeof(_hdr), 0);
+    if (rc != 0 && rc != sizeof(_hdr)) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "read" << ::strerror(errno) << errno;
+    }
+
+    _writeLogThreshold = Config::getInstance()->getOption<int> (CONFIG_IO_LOG_THRESHOLD);
+    _deltaChainLimit = Config::getInstance()->getOption<int> (CONFIG_DELTA_CHAIN_LIMIT);
+    _nInstances = SystemCatalog::getInstance()->getNumberOfInstances();
+    _redundancy = 0; // disable replication during rollback: each instance is perfroming rollback locally
+
+    if (rc == 0 || (_hdr.magic == SCIDB_STORAGE_HEADER_MAGIC && _hdr.currPos < HEADER_SIZE))
+    {
+        LOG4CXX_TRACE(logger, "smgr open:  initializing storage header");
+
+        /* Database is not initialized
+         */
+        ::memset(&_hdr, 0, sizeof(_hdr));
+        _hdr.magic = SCIDB_STORAGE_HEADER_MAGIC;
+        _hdr.versionLowerBound = SCIDB_STORAGE_FORMAT_VERSION;
+        _hdr.versionUpperBound = SCIDB_STORAGE_FORMAT_VERSION;
+        _hdr.currPos = HEADER_SIZE;
+        _hdr.instanceId = INVALID_INSTANCE;
+        _hdr.nChunks = 0;
+
+        openChunkMapCheckpoint();
+    }
+    else
+    {
+        LOG4CXX_TRACE(logger, "smgr open:  opening storage header");
+
+        /* Check for corrupted metadata file
+         */
+        if (_hdr.magic != SCIDB_STORAGE_HEADER_MAGIC)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_INVALID_STORAGE_HEADER);
+        }
+
+        /* At the moment, both upper and lower bound versions in the file must equal to the
+           current version in the code.
+         */
+        if (_hdr.versionLowerBound != SCIDB_STORAGE_FORMAT_VERSION ||
+            _hdr.versionUpperBound != SCIDB_STORAGE_FORMAT_VERSION)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_MISMATCHED_STORAGE_FORMAT_VERSION)
+                  << _hdr.versionLowerBound
+                  << _hdr.versionUpperBound
+                  << SCIDB_STORAGE_FORMAT_VERSION;
+        }
+
+        /* The checkpoint log must be open before rollback updates any descriptor
+         */
+        openChunkMapCheckpoint();
+
+        /* Rollback uncommitted changes
+         */
+        doTxnRecoveryOnStartup();
+
+        /* Database is initialized: read information about all locally available chunks in map
+         */
+        initChunkMap();
+
+        /* Flush the datastores to capture freelist changes
+         */
+        _datastores.flushAllDataStores();
+    }
+    _ckptInterval = Config::getInstance()->getOption<int> (CONFIG_CHUNKMAP_CHECKPOINT_INTERVAL);
+    _chunkMapLimit = Config::getInstance()->getOption<int> (CONFIG_CHUNKMAP_LOADED_LIMIT);
+    _corruptChunks.clear();
+    _writeBatches.clear();
+    _writeBatchSize = size_t(Config::getInstance()->getOption<int> (CONFIG_WRITE_BATCH_SIZE)) * KiB;
+
+    /* Start verifying the stored chunks in the background
+     */
+    int scrubRate = Config::getInstance()->getOption<int> (CONFIG_SCRUB_RATE);
+    if (scrubRate > 0)
+    {
+        _scrubber = std::make_shared<ChunkScrubber>(*this);
+        _scrubber->start(size_t(scrubRate) * MiB,
+                         Config::getInstance()->getOption<int> (CONFIG_SCRUB_INTERVAL));
+    }
+
+    /* Start replication manager
+     */
+    _replicationManager = ReplicationManager::getInstance();
+    assert(_replicationManager);
+    assert(_replicationManager->isStarted());
+}
+
+
+/* Cleanup and close smgr
+ */
+void
+CachedStorage::close()
+{
+    InjectedErrorListener<WriteChunkInjectedError>::stop();
+
+    if (_scrubber)
+    {
+        _scrubber->stop();
+        _scrubber.reset();
+    }
+
+    for (ChunkMap::iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+    {
+        std::shared_ptr<InnerChunkMap> & innerMap = i->second;
+        for (InnerChunkMap::iterator j = innerMap->begin(); j != innerMap->end(); ++j)
+        {
+            if (j->second.getChunk() && j->second.getChunk()->_accessCount != 0)
+                throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_PIN_UNPIN_DISBALANCE);
+        }
+    }
+
+    if (_hd)
+    {
+        bool synced = false;
+        {
+            ScopedMutexLock cs(_mutex);
+            flushChunkDescriptors();
+            synced = _hd->fsync() == 0;
+        }
+
+        /* Leave a current checkpoint behind for a fast restart;
+           the image is built from the chunk map, so it must not be cleared yet
+         */
+        if (synced)
+        {
+            writeChunkMapCheckpoint(1);
+        }
+    }
+    _chunkMap.clear();
+    _lazyChunkMaps.clear();
+    _ckptSegments.clear();
+    _chunkMapLru.clear();
+    _chunkMapLruPos.clear();
+    _chunkMapLruEntries = 0;
+
+    _hd.reset();
+    _ckptImage.reset();
+    _ckptLog.reset();
+    _log[0].reset();
+    _log[1].reset();
+}
+
+void CachedStorage::notifyChunkReady(PersistentChunk& chunk)
+{
+    // This method is invoked with storage mutex locked
+    chunk._raw = false;
+    if (chunk._waiting)
+    {
+        chunk._waiting = false;
+        _loadEvent.signal(); // wakeup all threads waiting for this chunk
+    }
+}
+
+void CachedStorage::pinChunk(PersistentChunk const* aChunk)
+{
+    ScopedMutexLock cs(_mutex);
+    PersistentChunk& chunk = *const_cast<PersistentChunk*>(aChunk);
+    LOG4CXX_TRACE(logger, "CachedStorage::pinChunk =" << &chunk << ", accessCount = "<<chunk._accessCount);
+    chunk.beginAccess();
+}
+
+void CachedStorage::unpinChunk(PersistentChunk const* aChunk)
+{
+    ScopedMutexLock cs(_mutex);
+    PersistentChunk& chunk = *const_cast<PersistentChunk*>(aChunk);
+    LOG4CXX_TRACE(logger, "CachedStorage::unpinChunk =" << &chunk << ", accessCount = "<<chunk._accessCount);
+    assert(chunk._accessCount > 0);
+    if (--chunk._accessCount == 0)
+    {
+        // Chunk is not accessed any more by any thread, unpin it and include in LRU list
+        _lru.link(&chunk);
+    }
+}
+
+void CachedStorage::addChunkToCache(PersistentChunk& chunk)
+{
+    // Check amount of memory used by cached chunks and discard least recently used
+    // chunks from the cache
+    _mutex.checkForDeadlock();
+    while (_cacheUsed + chunk.getSize() > _cacheSize)
+    {
+        if (_lru.isEmpty())
+        {
+            if (_strictCacheLimit && _cacheUsed != 0)
+            {
+                Event::ErrorChecker noopEc;
+                _cacheOverflowFlag = true;
+                _cacheOverflowEvent.wait(_mutex, noopEc);
+            }
+            else
+            {
+                break;
+            }
+        }
+        PersistentChunk& victim = *_lru._prev;
+        internalFreeChunk(victim);
+        releaseChunkObject(victim);
+    }
+
+    LOG4CXX_TRACE(logger, "CachedStorage::addChunkToCache chunk=" << &chunk
+                      << ", size = "<< chunk.getSize() << ", accessCount = "<<chunk._accessCount
+                      << ", cacheUsed="<<_cacheUsed);
+
+    _cacheUsed += chunk.getSize();
+}
+
+std::shared_ptr<PersistentChunk>
+CachedStorage::lookupChunk(ArrayDesc const& desc, StorageAddress const& addr)
+{
+    loadChunkMap(desc.getUAId());
+    ScopedMutexLock cs(_mutex);
+    ChunkMap::iterator iter = findChunkMap(desc.getUAId());
+    if (iter != _chunkMap.end())
+    {
+        std::shared_ptr<InnerChunkMap>& innerMap = iter->second;
+        InnerChunkMap::iterator innerIter = innerMap->find(addr);
+        if (innerIter != innerMap->end() && innerIter->second.hasChunk())
+        {
+            std::shared_ptr<PersistentChunk>& chunk = getChunkObject(desc, *innerMap, innerIter);
+            chunk->beginAccess();
+            return chunk;
+        }
+    }
+    std::shared_ptr<PersistentChunk> emptyChunk;
+    return emptyChunk;
+}
+
+std::shared_ptr<PersistentChunk>&
+CachedStorage::getChunkObject(ArrayDesc const& desc,
+                              InnerChunkMap& inner,
+                              InnerChunkMap::iterator entry)
+{
+    std::shared_ptr<PersistentChunk>& chunk = entry->second.getChunk();
+    if (!chunk)
+    {
+        assert(entry->second.hasChunk());
+        ChunkHeader hdr;
+        inner.getHeader(entry, hdr);
+        chunk.reset(new PersistentChunk());
+        chunk->setAddress(desc, entry->first, hdr);
+    }
+    return chunk;
+}
+
+void CachedStorage::releaseChunkObject(PersistentChunk& chunk)
+{
+    if (chunk._hdr.pos.hdrPos == 0 || chunk._accessCount != 0 || chunk._raw)
+    {
+        return;
+    }
+    ChunkMap::iterator iter = _chunkMap.find(chunk._hdr.pos.dsGuid);
+    if (iter == _chunkMap.end())
+    {
+        return;
+    }
+    InnerChunkMap::iterator i = iter->second->find(chunk._addr);
+    if (i != iter->second->end() &&
+        i->second.getChunk().get() == &chunk &&
+        i->second.getChunk().use_count() == 1)
+    {
+        i->second.releaseChunk(); // destroys chunk
+    }
+}
+
+void CachedStorage::decompressChunk(ArrayDesc const& desc, PersistentChunk* chunk, CompressedBuffer const& buf)
+{
+    chunk->allocate(buf.getDecompressedSize());
+
+    DBArrayChunkInternal intChunk(desc, chunk);
+    if (buf.getSize() != buf.getDecompressedSize())
+    {
+        _compressors[buf.getCompressionMethod()]->decompress(buf.getData(), buf.getSize(), intChunk);
+    }
+    else
+    {
+        assert(chunk->getHeader().pos.hdrPos == 0);
+        memcpy(intChunk.getDataForLoad(), buf.getData(), buf.getSize());
+    }
+}
+
+void CachedStorage::compressChunk(ArrayDesc const& desc, PersistentChunk const* aChunk, CompressedBuffer& buf)
+{
+    assert(aChunk);
+    PersistentChunk& chunk = *const_cast<PersistentChunk*>(aChunk);
+    std::shared_ptr<DataStore> ds = _datastores.getDataStore(desc.getUAId());
+    int compressionMethod = chunk.getCompressionMethod();
+    if (compressionMethod < 0) {
+        throw USER_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_COMPRESS_METHOD_NOT_DEFINED);
+    }
+    buf.setDecompressedSize(chunk.getSize());
+    buf.setCompressionMethod(compressionMethod);
+    /* The on-disk image of a delta chunk is not in the compressed format:
+       reconstruct the chunk and compress it from memory, keeping it pinned
+       so that it cannot be evicted in between
+     */
+    const bool isDelta = chunk.isDelta() && chunk._hdr.pos.hdrPos != 0;
+    PersistentChunk::UnPinner deltaScope(NULL);
+    if (isDelta)
+    {
+        pinChunk(&chunk);
+        deltaScope.set(&chunk);
+        loadChunk(desc, &chunk);
+    }
+    {
+        ScopedMutexLock cs(_mutex);
+        if (!chunk.isRaw() && chunk._data != NULL)
+        {
+            PersistentChunk::Pinner scope(&chunk);
+            buf.allocate(chunk.getCompressedSize() != 0 ? chunk.getCompressedSize() : chunk.getSize());
+            DBArrayChunkInternal intChunk(desc, &chunk);
+            size_t compressedSize = _compressors[compressionMethod]->compress(buf.getData(), intChunk);
+            if (compressedSize == chunk.getSize())
+            {
+                memcpy(buf.getData(), chunk._data, compressedSize);
+            }
+            else if (compressedSize != buf.getSize())
+            {
+                buf.reallocate(compressedSize);
+            }
+        }
+    }
+
+    if (buf.getData() == NULL)
+    { // chunk data is not present in the cache so read compressed data from the disk
+        if (aChunk->_hdr.pos.hdrPos == 0)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_ACCESS_TO_RAW_CHUNK) << aChunk->getHeader().arrId;
+        }
+        if (isDelta)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED)
+                << "compress delta chunk: the reconstructed chunk is missing";
+        }
+        buf.allocate(aChunk->getCompressedSize());
+        readChunkFromDataStore(*ds, *aChunk, buf.getData());
+    }
+}
+
+inline bool CachedStorage::isResponsibleFor(ArrayDesc const& desc,
+                                            InstanceID chunkInstanceId,
+                                            StorageAddress const& address,
+                                            std::shared_ptr<Query> const& query)
+{
+    ScopedMutexLock cs(_mutex);
+    Query::validateQueryPtr(query);
+    assert(chunkInstanceId < size_t(_nInstances));
+
+    if (chunkInstanceId == _hdr.instanceId)
+    {
+        return true;
+    }
+    if (!query->isPhysicalInstanceDead(chunkInstanceId))
+    {
+        return false;
+    }
+    if (_redundancy == 1)
+    {
+        return true;
+    }
+    InstanceID replicas[MAX_REDUNDANCY + 1];
+    getReplicasInstanceId(replicas, desc, address);
+    for (size_t i = 1; i <= _redundancy; i++)
+    {
+        if (replicas[i] == _hdr.instanceId)
+        {
+            return true;
+        }
+        if (!query->isPhysicalInstanceDead(replicas[i]))
+        {
+            // instance with this replica is alive
+            return false;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<PersistentChunk> CachedStorage::createChunk(ArrayDesc const& desc,
+                                                              StorageAddress const& addr,
+                                                              int compressionMethod,
+                                                              const std::shared_ptr<Query>& query)
+{
+    loadChunkMap(desc.getUAId());
+    ScopedMutexLock cs(_mutex);
+    Query::validateQueryPtr(query);
+
+    assert(desc.getUAId()!=0);
+    ChunkMap::iterator iter = findChunkMap(desc.getUAId());
+    if (iter == _chunkMap.end())
+    {
+        iter = _chunkMap.insert(make_pair(desc.getUAId(), std::make_shared <InnerChunkMap> (desc.getUAId()))).first;
+    }
+    else if (iter->second->find(addr) != iter->second->end())
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CHUNK_ALREADY_EXISTS)
+        << CoordsToStr(addr.coords);
+    }
+    invalidateChunkMapSegment(desc.getUAId()); // the array now differs from its checkpoint segment
+
+    std::shared_ptr<PersistentChunk>& chunk = (*(iter->second))[addr].getChunk();
+    chunk.reset(new PersistentChunk());
+    chunk->setAddress(desc, addr, compressionMethod);
+    LOG4CXX_TRACE(chunkLogger, "chunkl: createchunk: chunk created for addr "
+                   << "[attrid=" << addr.attId << "][arrid=" << addr.arrId
+                   << "]" << CoordsToStr(addr.coords)); 
+
+    chunk->_accessCount = 1; // newly created chunk is pinned
+    chunk->_timestamp = ++_timestamp;
+    return chunk;
+}
+
+void CachedStorage::deleteChunk(ArrayDesc const& desc, PersistentChunk& victim)
+{
+    ScopedMutexLock cs(_mutex);
+
+    ChunkMap::const_iterator iter = _chunkMap.find(desc.getUAId());
+    if (iter != _chunkMap.end())
+    {
+        iter->second->erase(victim._addr);
+    }
+}
+
+void CachedStorage::freeChunk(PersistentChunk* victim)
+{
+    ScopedMutexLock cs(_mutex);
+    internalFreeChunk(*victim);
+}
+
+void CachedStorage::internalFreeChunk(PersistentChunk& victim)
+{
+    if (victim._data != NULL && victim._hdr.pos.hdrPos != 0)
+    {
+        LOG4CXX_TRACE(logger, "CachedStorage::internalFreeChunk chunk=" << &victim
+                      << ", size = "<< victim.getSize() << ", accessCount = "<<victim._accessCount
+                      << ", cacheUsed="<<_cacheUsed << ", mapped=" << victim.isMapped());
+
+        if (victim.isMapped())
+        {
+            _cacheMapped -= victim.getSize();
+        }
+        else
+        {
+            _cacheUsed -= victim.getSize();
+        }
+        if (_cacheOverflowFlag)
+        {
+            _cacheOverflowFlag = false;
+            _cacheOverflowEvent.signal();
+        }
+    }
+    if (victim._next != NULL)
+    {
+        victim.unlink();
+    }
+    victim.free();
+}
+
+/*
+ Remove all versions prior to lastLiveArrId from the unversioned
+ array uaId in the storage. If lastLiveArrId is 0, removes all
+ versions. Does nothing if the specified array is not present.
+*/
+void CachedStorage::removeVersions(QueryID queryId,
+                                   ArrayUAID uaId,
+                                   ArrayID lastLiveArrId)
+{
+    loadChunkMap(uaId);
+    ScopedMutexLock cs(_mutex);
+    std::shared_ptr<InnerChunkMap> innerMap;
+    ChunkMap::iterator iter = findChunkMap(uaId);
+    if (iter == _chunkMap.end())
+    {
+        return;
+    }
+    innerMap = iter->second;
+
+    std::shared_ptr<DataStore> ds = _datastores.getDataStore(uaId);
+    pruneChunkVersions(*innerMap, ds, lastLiveArrId, NULL);
+    _hdrDirty = true;
+    syncStorage(uaId);
+    if (!lastLiveArrId)
+    {
+        assert(innerMap->size() == 0);
+        _chunkMap.erase(uaId);
+        invalidateChunkMapSegment(uaId);
+        forgetChunkMap(uaId);
+        _datastores.closeDataStore(uaId, true /* remove from disk */);
+    }
+}
+
+/*
+ Walk the versions of each chunk from the newest to the oldest: chunks added
+ after lastLiveArrId are live, as is the newest chunk added no later than
+ lastLiveArrId.  An older chunk is kept only if the chunk above it is a delta
+ which needs it as its base.
+*/
+void CachedStorage::pruneChunkVersions(InnerChunkMap& inner,
+                                       std::shared_ptr<DataStore>& ds,
+                                       ArrayID lastLiveArrId,
+                                       Extents* extents)
+{
+    StorageAddress currentChunkAddr;
+    bool currentChunkIsLive = true;
+    bool baseNeeded = false;
+    InnerChunkMap::iterator i = inner.begin();
+    while (i != inner.end())
+    {
+        StorageAddress const& key = i->first;
+        bool keep = false;
+
+        if (lastLiveArrId)
+        {
+            if (!key.sameBaseAddr(currentChunkAddr))
+            {
+                /* Move on to next coordinate
+                 */
+                currentChunkAddr = key;
+                currentChunkIsLive = true;
+                baseNeeded = false;
+            }
+            if (key.arrId > lastLiveArrId)
+            {
+                keep = true;
+            }
+            else if (currentChunkIsLive)
+            {
+                /* Chunk is visible in the oldest version, older chunks are not
+                 */
+                currentChunkIsLive = false;
+                keep = true;
+            }
+            else
+            {
+                keep = baseNeeded;
+            }
+        }
+
+        if (keep)
+        {
+            baseNeeded = i->second.isDelta();
+            ++i;
+            continue;
+        }
+
+        /* Chunk should be removed
+         */
+        if (extents && i->second.hasChunk())
+        {
+            ChunkHeader hdr;
+            inner.getHeader(i, hdr);
+            eraseExtent(*extents, hdr);
+        }
+        markChunkAsFree(inner, i, ds);
+        i = inner.erase(i);
+    }
+}
+
+void CachedStorage::removeVersionFromMemory(ArrayUAID uaId, ArrayID arrId)
+{
+    ScopedMutexLock cs(_mutex);
+    std::shared_ptr<InnerChunkMap> innerMap;
+    ChunkMap::const_iterator iter = _chunkMap.find(uaId);
+    if (iter == _chunkMap.end())
+    {
+        return;
+    }
+    else
+    {
+        innerMap = iter->second;
+    }
+    invalidateChunkMapSegment(uaId);
+    for (InnerChunkMap::iterator i = innerMap->begin(); i != innerMap->end(); )
+    {
+        if (i->first.arrId != arrId)
+        {
+            ++i;
+            continue;
+        }
+        i = innerMap->erase(i);
+    }
+    if (innerMap->size() == 0)
+    {
+       _chunkMap.erase(uaId);
+       forgetChunkMap(uaId);
+    }
+}
+
+InstanceID CachedStorage::getPrimaryInstanceId(ArrayDesc const& desc, StorageAddress const& address) const
+{
+    //in this context we have to be careful to use nInstances which was set at the beginning of system lifetime
+    //this method must return the same value regardless of whether or not there were failures
+    if (desc.getPartitioningSchema() == psReplication)
+    {
+        return _hdr.instanceId;
+    }
+    return desc.getPrimaryInstanceId(address.coords, _nInstances);
+}
+
+void CachedStorage::getReplicasInstanceId(InstanceID* replicas, ArrayDesc const& desc, StorageAddress const& address) const
+{
+    replicas[0] = getPrimaryInstanceId(desc, address);
+    for (size_t i = 0; i < _redundancy; i++)
+    {
+        // A prime number can be used to smear the replicas as follows
+        // InstanceID instanceId = (chunk.getArrayDesc().getHashedChunkNumber(chunk.addr.coords) + (i+1)) % PRIME_NUMBER % nInstances;
+        // the PRIME_NUMBER needs to be just shy of the number of instances to work, so we would need a table.
+        // For Fibonacci no table is required, and it seems to work OK.
+
+        const uint64_t nReplicas = (_redundancy + 1);
+        const uint64_t currReplica = (i + 1);
+        //XXX TODO: each array/distribution should implement the replica mapping function
+        //XXX TODO: for now hard-wire psHashPartitioned mapping
+        //XXX TODO: this implies that the replicas are NOT distributed with the distribution of the primary chunks
+        const static size_t infinity(std::numeric_limits<size_t>::max());
+        Dimensions const& dims = desc.getDimensions();
+        const uint64_t chunkId =
+            getPrimaryInstanceForChunk(psHashPartitioned, address.coords, dims, infinity) * (nReplicas) + currReplica;
+        InstanceID instanceId = fibHash64(chunkId, MAX_INSTANCE_BITS) % _nInstances;
+        for (size_t j = 0; j <= i; j++)
+        {
+            if (replicas[j] == instanceId)
+            {
+                instanceId = (instanceId + 1) % _nInstances;
+                j = -1;
+            }
+        }
+        replicas[i + 1] = instanceId;
+    }
+}
+
+void CachedStorage::replicate(ArrayDesc const& desc,
+                              StorageAddress const& addr,
+                              PersistentChunk* chunk,
+                              void const* data,
+                              size_t compressedSize,
                               size_t decompressedSize,
                               std::shared_ptr<Query> const& query,
                               vector<std::shared_ptr<ReplicationManager::Item> >& replicasVec)
@@ -1193,491 +2549,1148 @@ void CachedStorage::replicate(ArrayDesc const& desc,
     ScopedMutexLock cs(_mutex);
     Query::validateQueryPtr(query);
 
-    if (_redundancy <= 0 || (chunk && !isPrimaryReplica(chunk)))
-    { // self chunk
-        return;
+    if (_redundancy <= 0 || (chunk && !isPrimaryReplica(chunk)))
+    { // self chunk
+        return;
+    }
+    if (desc.getPartitioningSchema() == psReplication)
+    { // every instance stores its own copy already
+        return;
+    }
+    replicasVec.reserve(_redundancy);
+    InstanceID replicas[MAX_REDUNDANCY + 1];
+    getReplicasInstanceId(replicas, desc, addr);
+
+    QueryID queryId = query->getQueryID();
+    assert(queryId != 0);
+    std::shared_ptr<MessageDesc> chunkMsg;
+    if (chunk && data)
+    {
+        std::shared_ptr<CompressedBuffer> buffer = std::make_shared<CompressedBuffer>();
+        buffer->allocate(compressedSize);
+        memcpy(buffer->getData(), data, compressedSize);
+        chunkMsg = std::make_shared<MessageDesc>(mtChunkReplica, buffer);
+    }
+    else
+    {
+        chunkMsg = std::make_shared<MessageDesc>(mtChunkReplica);
+    }
+    chunkMsg->setQueryID(queryId);
+    std::shared_ptr<scidb_msg::Chunk> chunkRecord = chunkMsg->getRecord<scidb_msg::Chunk> ();
+    chunkRecord->set_attribute_id(addr.attId);
+    chunkRecord->set_array_id(addr.arrId);
+    for (size_t k = 0; k < addr.coords.size(); k++)
+    {
+        chunkRecord->add_coordinates(addr.coords[k]);
+    }
+    chunkRecord->set_eof(false);
+
+    if(chunk)
+    {
+        chunkRecord->set_compression_method(chunk->getCompressionMethod());
+        chunkRecord->set_decompressed_size(decompressedSize);
+        chunkRecord->set_count(0);
+        LOG4CXX_TRACE(logger, "Replicate chunk of array ID=" << addr.arrId << " attribute ID=" << addr.attId);
+        assert(data != NULL); //TODO: need an exception ?
+    }
+    else
+    {
+        chunkRecord->set_tombstone(true);
+    }
+
+    for (size_t i = 1; i <= _redundancy; i++)
+    {
+        std::shared_ptr<ReplicationManager::Item> item = make_shared <ReplicationManager::Item>(replicas[i], chunkMsg, query);
+        assert(_replicationManager);
+        _replicationManager->send(item);
+        replicasVec.push_back(item);
+    }
+}
+
+void CachedStorage::abortReplicas(vector<std::shared_ptr<ReplicationManager::Item> >* replicasVec)
+{
+    assert(replicasVec);
+    for (size_t i = 0; i < replicasVec->size(); ++i)
+    {
+        const std::shared_ptr<ReplicationManager::Item>& item = (*replicasVec)[i];
+        assert(_replicationManager);
+        _replicationManager->abort(item);
+        assert(item->isDone());
+    }
+}
+
+void CachedStorage::waitForReplicas(vector<std::shared_ptr<ReplicationManager::Item> >& replicasVec)
+{
+    // _mutex must NOT be locked
+    for (size_t i = 0; i < replicasVec.size(); ++i)
+    {
+        const std::shared_ptr<ReplicationManager::Item>& item = replicasVec[i];
+        assert(_replicationManager);
+        _replicationManager->wait(item);
+        assert(item->isDone());
+        assert(item->validate(false));
+    }
+}
+
+/* Write bytes to DataStore indicated by pos
+ * @param pos DataStore and offset to which to write
+ * @param data Bytes to write
+ * @param len Number of bytes to write
+ * @pre position in DataStore must be previously allocated
+ * @throws userException if an error occurs
+ */
+void
+CachedStorage::writeBytesToDataStore(DiskPos const& pos,
+                                     void const* data,
+                                     size_t len,
+                                     size_t allocated)
+{
+    double t0 = 0, t1 = 0, writeTime = 0;
+    std::shared_ptr<DataStore> ds = _datastores.getDataStore(pos.dsGuid);
+
+    if (!ds)
+    {
+        throw USER_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_DATASTORE_NOT_FOUND);
+    }
+
+    if (_writeLogThreshold >= 0)
+    {
+        t0 = getTimeSecs();
+    }
+    ds->writeData(pos.offs, data, len, allocated);
+    if (_writeLogThreshold >= 0)
+    {
+        t1 = getTimeSecs();
+        writeTime = t1 - t0;
+    }
+
+    if (_writeLogThreshold >= 0 && writeTime * 1000 > _writeLogThreshold)
+    {
+        LOG4CXX_DEBUG(logger, "CWR: pwrite ds " << ds << " time " << writeTime);
+    }
+}
+
+/* Force writing of chunk data to data store
+   Exception is thrown if write failed
+*/
+void
+CachedStorage::writeChunkToDataStore(DataStore& ds, PersistentChunk& chunk, void const* data)
+{
+    double t0 = 0, t1 = 0, writeTime = 0;
+
+    if (_writeLogThreshold >= 0)
+    {
+        t0 = getTimeSecs();
+    }
+    ds.writeData(chunk._hdr.pos.offs,
+                 data,
+                 chunk._hdr.compressedSize,
+                 chunk._hdr.allocatedSize);
+    if (_writeLogThreshold >= 0)
+    {
+        t1 = getTimeSecs();
+        writeTime = t1 - t0;
+    }
+
+    if (_writeLogThreshold >= 0 && writeTime * 1000 > _writeLogThreshold)
+    {
+        LOG4CXX_DEBUG(logger, "CWR: pwrite ds chunk "<< chunk.getHeader() <<" time "<< writeTime);
+    }
+}
+
+/* Force writing of the data of the chunks of a writeChunks() call to data store,
+   chunks laid out back to back are written with a single gather write
+   Exception is thrown if write failed
+*/
+void
+CachedStorage::writeChunksToDataStore(DataStore& ds, vector<ChunkWrite> const& writes)
+{
+    if (writes.size() == 1)
+    {
+        writeChunkToDataStore(ds, *writes[0].chunk, writes[0].deflated);
+        return;
+    }
+
+    double t0 = 0, t1 = 0, writeTime = 0;
+
+    if (_writeLogThreshold >= 0)
+    {
+        t0 = getTimeSecs();
+    }
+    vector<off_t> offsets(writes.size());
+    vector<void const*> data(writes.size());
+    vector<size_t> lens(writes.size());
+    vector<size_t> allocatedSizes(writes.size());
+    for (size_t i = 0; i < writes.size(); ++i)
+    {
+        ChunkHeader const& hdr = writes[i].chunk->getHeader();
+        offsets[i] = hdr.pos.offs;
+        data[i] = writes[i].deflated;
+        lens[i] = hdr.compressedSize;
+        allocatedSizes[i] = hdr.allocatedSize;
+    }
+    ds.writeData(offsets, data, lens, allocatedSizes);
+    if (_writeLogThreshold >= 0)
+    {
+        t1 = getTimeSecs();
+        writeTime = t1 - t0;
+    }
+
+    if (_writeLogThreshold >= 0 && writeTime * 1000 > _writeLogThreshold)
+    {
+        LOG4CXX_DEBUG(logger, "CWR: pwrite ds " << writes.size() << " chunks time " << writeTime);
+    }
+}
+
+/* Read chunk data from the disk
+   Exception is thrown if read failed
+*/
+void
+CachedStorage::readChunkFromDataStore(DataStore& ds, PersistentChunk const& chunk, void* data)
+{
+    double t0 = 0, t1 = 0, readTime = 0;
+    if (_writeLogThreshold >= 0)
+    {
+        t0 = getTimeSecs();
+    }
+    ds.readData(chunk._hdr.pos.offs, data, chunk._hdr.compressedSize);
+    if (_writeLogThreshold >= 0)
+    {
+        t1 = getTimeSecs();
+        readTime = t1 - t0;
+    }
+    if (_writeLogThreshold >= 0 && readTime * 1000 > _writeLogThreshold)
+    {
+        LOG4CXX_DEBUG(logger, "CWR: pread ds chunk "<< chunk.getHeader() <<" time "<< readTime);
+    }
+    verifyChunkData(chunk, data);
+}
+
+void
+CachedStorage::verifyChunkData(PersistentChunk const& chunk, void const* data)
+{
+    if (!chunk._hdr.is<ChunkHeader::CHECKSUM>())
+    {
+        return; // written before chunks were checksummed
+    }
+    uint32_t crc = calculateCRC32C(data, chunk._hdr.compressedSize);
+    if (crc != chunk._hdr.crc)
+    {
+        reportCorruptChunk(chunk._hdr, chunk._addr.coords, crc, false);
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_DATASTORE_CHUNK_CHECKSUM_MISMATCH)
+            << chunk._hdr.pos.dsGuid << chunk._hdr.pos.offs;
+    }
+}
+
+void
+CachedStorage::reportCorruptChunk(ChunkHeader const& hdr,
+                                  Coordinates const& coords,
+                                  uint32_t actualCrc,
+                                  bool byScrub)
+{
+    LOG4CXX_ERROR(logger, "Checksum mismatch of chunk " << hdr << " coords " << CoordsToStr(coords)
+                  << ": expected " << hdr.crc << ", found " << actualCrc
+                  << (byScrub ? " (scrub)" : " (read)"));
+
+    ScopedMutexLock cs(_mutex);
+    for (size_t i = 0; i < _corruptChunks.size(); ++i)
+    {
+        if (_corruptChunks[i].uaid == hdr.pos.dsGuid && _corruptChunks[i].offs == hdr.pos.offs)
+        {
+            return;
+        }
+    }
+    if (_corruptChunks.size() >= MAX_CORRUPT_CHUNKS)
+    {
+        return;
+    }
+    CorruptChunk corrupt;
+    corrupt.uaid = hdr.pos.dsGuid;
+    corrupt.arrId = hdr.arrId;
+    corrupt.attId = hdr.attId;
+    corrupt.coords = coords;
+    corrupt.offs = hdr.pos.offs;
+    corrupt.expectedCrc = hdr.crc;
+    corrupt.actualCrc = actualCrc;
+    corrupt.detected = ::time(NULL);
+    corrupt.byScrub = byScrub;
+    _corruptChunks.push_back(corrupt);
+}
+
+RWLock& CachedStorage::getChunkLatch(PersistentChunk* chunk)
+{
+    return _latches[(size_t) chunk->_hdr.pos.offs % N_LATCHES];
+}
+
+void CachedStorage::getChunkPositions(ArrayDesc const& desc, std::shared_ptr<Query> const& query, CoordinateSet& chunkPositions)
+{
+    StorageAddress readAddress (desc.getId(), 0, Coordinates());
+    while(findNextChunk(desc, query, readAddress))
+    {
+        chunkPositions.insert(readAddress.coords);
+    }
+}
+
+bool CachedStorage::findNextChunk(ArrayDesc const& desc,
+                                  std::shared_ptr<Query> const& query,
+                                  StorageAddress& address)
+{
+    loadChunkMap(desc.getUAId());
+    ScopedMutexLock cs(_mutex);
+    Query::validateQueryPtr(query);
+
+    ChunkMap::iterator iter = findChunkMap(desc.getUAId());
+    if (iter == _chunkMap.end())
+    {
+        address.coords.clear();
+        return false;
+    }
+    return findNextChunk(iter->second, desc, query, address);
+}
+
+bool CachedStorage::findNextChunk(std::shared_ptr<InnerChunkMap> const& innerMap,
+                                  ArrayDesc const& desc,
+                                  std::shared_ptr<Query> const& query,
+                                  StorageAddress& address)
+{
+    assert(address.attId < desc.getAttributes().size() && address.arrId <= desc.getId());
+    if(address.coords.size())
+    {
+        address.coords[address.coords.size()-1] += desc.getDimensions()[desc.getDimensions().size() - 1].getChunkInterval();
+    }
+    address.arrId = desc.getId();
+    InnerChunkMap::iterator innerIter = innerMap->lower_bound(address);
+    while (true)
+    {
+        if (innerIter == innerMap->end() || innerIter->first.attId != address.attId)
+        {
+            address.coords.clear();
+            return false;
+        }
+        if(innerIter->first.arrId <= desc.getId())
+        {
+            address.arrId = innerIter->first.arrId;
+            address.coords = innerIter->first.coords;
+            if(innerIter->second.hasChunk() &&
+               isResponsibleFor(desc, innerIter->second.getInstanceId(), address, query))
+            {
+                return true;
+            }
+            else
+            {
+                address.arrId = desc.getId();
+                address.coords[address.coords.size()-1] += desc.getDimensions()[desc.getDimensions().size() - 1].getChunkInterval();
+                innerIter = innerMap->lower_bound(address);
+            }
+        }
+        while(innerIter != innerMap->end() && innerIter->first.arrId > address.arrId && innerIter->first.attId == address.attId)
+        {
+            ++innerIter;
+        }
+    }
+}
+
+bool CachedStorage::findChunk(ArrayDesc const& desc, std::shared_ptr<Query> const& query, StorageAddress& address)
+{
+    loadChunkMap(desc.getUAId());
+    ScopedMutexLock cs(_mutex);
+    Query::validateQueryPtr(query);
+
+    ChunkMap::iterator iter = findChunkMap(desc.getUAId());
+    if (iter == _chunkMap.end())
+    {
+        address.coords.clear();
+        return false;
+    }
+    std::shared_ptr<InnerChunkMap> const& innerMap = iter->second;
+    address.arrId = desc.getId();
+    InnerChunkMap::iterator innerIter = innerMap->lower_bound(address);
+    if (innerIter == innerMap->end() || !innerIter->first.sameBaseAddr(address))
+    {
+        address.coords.clear();
+        return false;
     }
-    replicasVec.reserve(_redundancy);
-    InstanceID replicas[MAX_REDUNDANCY + 1];
-    getReplicasInstanceId(replicas, desc, addr);
 
-    QueryID queryId = query->getQueryID();
-    assert(queryId != 0);
-    std::shared_ptr<MessageDesc> chunkMsg;
-    if (chunk && data)
+    assert(innerIter->first.arrId <= address.arrId);
+    // XXX empty query used? to represent what ? NID chunk ?
+    address.arrId = innerIter->first.arrId;
+    if(innerIter->second.hasChunk() &&
+       (!query || isResponsibleFor(desc, innerIter->second.getInstanceId(), address, query)))
     {
-        std::shared_ptr<CompressedBuffer> buffer = std::make_shared<CompressedBuffer>();
-        buffer->allocate(compressedSize);
-        memcpy(buffer->getData(), data, compressedSize);
-        chunkMsg = std::make_shared<MessageDesc>(mtChunkReplica, buffer);
+        return true;
     }
     else
     {
-        chunkMsg = std::make_shared<MessageDesc>(mtChunkReplica);
+        address.coords.clear();
+        return false;
     }
-    chunkMsg->setQueryID(queryId);
-    std::shared_ptr<scidb_msg::Chunk> chunkRecord = chunkMsg->getRecord<scidb_msg::Chunk> ();
-    chunkRecord->set_attribute_id(addr.attId);
-    chunkRecord->set_array_id(addr.arrId);
-    for (size_t k = 0; k < addr.coords.size(); k++)
+}
+
+void CachedStorage::cleanChunk(PersistentChunk* chunk)
+{
+    ScopedMutexLock cs(_mutex);
+    LOG4CXX_TRACE(logger, "CachedStorage::cleanChunk =" << chunk << ", accessCount = "<<chunk->_accessCount);
+    assert(chunk->_accessCount>0);
+    --chunk->_accessCount;
+    // Free the chunk regardless of _accessCount to avoid incorrect
+    // _cacheUsed accounting done in internalFreeChunk()
+    // (_accessCount can be >1 because we are double pinning sometimes,
+    // e.g. in ArrayIterator::newChunk & ChunkIterator::ChunkIterator).
+    // If we are here, we have failed to writeChunk() and the chunk is invalid
+    chunk->free();
+    notifyChunkReady(*chunk);
+}
+
+bool CachedStorage::encodeDelta(ArrayDesc const& desc,
+                                PersistentChunk& chunk,
+                                size_t maxSize,
+                                vector<char>& delta)
+{
+    /* Find the previous version of the chunk: it immediately follows the new
+       chunk in the inner chunk map
+     */
+    std::shared_ptr<PersistentChunk> base;
+    loadChunkMap(desc.getUAId());
     {
-        chunkRecord->add_coordinates(addr.coords[k]);
+        ScopedMutexLock cs(_mutex);
+        ChunkMap::iterator iter = findChunkMap(desc.getUAId());
+        if (iter == _chunkMap.end())
+        {
+            return false;
+        }
+        InnerChunkMap::iterator i = iter->second->find(chunk._addr);
+        if (i == iter->second->end() || ++i == iter->second->end() ||
+            !i->first.sameBaseAddr(chunk._addr) || i->second.isTombstone())
+        {
+            return false;
+        }
+        if (!i->second.hasChunk())
+        {
+            return false;
+        }
+        base = getChunkObject(desc, *iter->second, i);
+        if (base->_hdr.pos.hdrPos == 0)
+        {
+            return false;
+        }
+        base->beginAccess();
     }
-    chunkRecord->set_eof(false);
+    PersistentChunk::UnPinner scope(base.get());
+    loadChunk(desc, base.get());
 
-    if(chunk)
+    /* Bound the cost of reconstructing the chunk: once the chain of deltas is
+       long enough the complete chunk is written and starts a new chain
+     */
+    if (base->_deltaDepth >= _deltaChainLimit)
     {
-        chunkRecord->set_compression_method(chunk->getCompressionMethod());
-        chunkRecord->set_decompressed_size(decompressedSize);
-        chunkRecord->set_count(0);
-        LOG4CXX_TRACE(logger, "Replicate chunk of array ID=" << addr.arrId << " attribute ID=" << addr.attId);
-        assert(data != NULL); //TODO: need an exception ?
+        return false;
     }
-    else
+    if (!encodeChunkDelta(static_cast<char const*>(base->_data), base->getSize(),
+                          static_cast<char const*>(chunk._data), chunk.getSize(),
+                          base->_addr.arrId, base->_deltaDepth + 1,
+                          maxSize, delta))
     {
-        chunkRecord->set_tombstone(true);
+        return false;
     }
+    chunk._deltaDepth = base->_deltaDepth + 1;
+    return true;
+}
 
-    for (size_t i = 1; i <= _redundancy; i++)
+/* Write new chunk into the smgr.
+ */
+void
+CachedStorage::writeChunk(ArrayDesc const& adesc,
+                          PersistentChunk* newChunk,
+                          const std::shared_ptr<Query>& query)
+{
+    vector<PersistentChunk*> newChunks(1, newChunk);
+    writeChunks(adesc, newChunks, query);
+}
+
+/* Unpin and free the chunks of a writeChunks() call which were not published
+   (in case of errors)
+ */
+void CachedStorage::cleanChunkWrites(vector<ChunkWrite>* writes)
+{
+    for (size_t i = 0; i < writes->size(); ++i)
     {
-        std::shared_ptr<ReplicationManager::Item> item = make_shared <ReplicationManager::Item>(replicas[i], chunkMsg, query);
-        assert(_replicationManager);
-        _replicationManager->send(item);
-        replicasVec.push_back(item);
+        if (!(*writes)[i].published)
+        {
+            cleanChunk((*writes)[i].chunk);
+        }
     }
 }
 
-void CachedStorage::abortReplicas(vector<std::shared_ptr<ReplicationManager::Item> >* replicasVec)
+/* Abort the replicas of the chunks of a writeChunks() call (in case of errors)
+ */
+void CachedStorage::abortChunkWriteReplicas(vector<ChunkWrite>* writes)
 {
-    assert(replicasVec);
-    for (size_t i = 0; i < replicasVec->size(); ++i)
+    for (size_t i = 0; i < writes->size(); ++i)
     {
-        const std::shared_ptr<ReplicationManager::Item>& item = (*replicasVec)[i];
-        assert(_replicationManager);
-        _replicationManager->abort(item);
-        assert(item->isDone());
+        abortReplicas(&(*writes)[i].replicas);
     }
 }
 
-void CachedStorage::waitForReplicas(vector<std::shared_ptr<ReplicationManager::Item> >& replicasVec)
+/* Count the elements of a new chunk, compress and replicate it, and prepare the
+   image of the chunk to be stored in the datastore.
+ */
+void
+CachedStorage::prepareChunkWrite(ArrayDesc const& adesc,
+                                 ChunkWrite& write,
+                                 const std::shared_ptr<Query>& query)
 {
-    // _mutex must NOT be locked
-    for (size_t i = 0; i < replicasVec.size(); ++i)
+    PersistentChunk& chunk = *write.chunk;
+
+    /* Update value count in Chunk Header
+     */
+    const AttributeDesc& attrDesc = adesc.getAttributes()[chunk.getAddress().attId];
+
+    if (attrDesc.isEmptyIndicator()) {
+        ConstRLEEmptyBitmap bitmap(static_cast<const char*>(chunk._data));
+        chunk._hdr.nElems = bitmap.count();
+    } else {
+        ConstRLEPayload payload(static_cast<const char*>(chunk._data));
+        chunk._hdr.nElems = payload.count();
+    }
+
+    /* Grab buffer to use for compressing chunk data and try to compress
+     */
+    const size_t bufSize = chunk.getSize();
+    write.buf.reset(new char[bufSize]);
+    if (!write.buf) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_ALLOCATE_MEMORY);
+    }
+    setToZeroInDebug(write.buf.get(), bufSize);
+
+    currentStatistics->allocatedSize += bufSize;
+    currentStatistics->allocatedChunks++;
+
+    write.deflated = write.buf.get();
+    DBArrayChunkInternal intChunk(adesc, &chunk);
+    write.compressedSize = _compressors[chunk.getCompressionMethod()]->compress(write.buf.get(), intChunk);
+    assert(write.compressedSize <= chunk.getSize());
+    if (write.compressedSize == chunk.getSize())
+    { // no compression
+        write.deflated = chunk._data;
+    }
+
+    /* Replicate chunk data to other instances
+     */
+    replicate(adesc, chunk._addr, &chunk, write.deflated,
+              write.compressedSize, chunk.getSize(), query, write.replicas);
+
+    /* Store the chunk locally as a delta from its previous version if that is
+       substantially smaller than the compressed chunk (replicas always receive
+       the complete chunk).  The option is read on every write so that setopt()
+       takes effect at once.
+     */
+    if (Config::getInstance()->getOption<bool>(CONFIG_ENABLE_DELTA_ENCODING) &&
+        encodeDelta(adesc, chunk, write.compressedSize / 2, write.delta))
     {
-        const std::shared_ptr<ReplicationManager::Item>& item = replicasVec[i];
-        assert(_replicationManager);
-        _replicationManager->wait(item);
-        assert(item->isDone());
-        assert(item->validate(false));
+        write.deflated = &write.delta[0];
+        write.compressedSize = write.delta.size();
+        chunk._hdr.set<ChunkHeader::DELTA_CHUNK>(true);
     }
+
+    /* Checksum the image of the chunk as it is stored, so that reads and the
+       scrubber can detect corruption of the datastore
+     */
+    chunk._hdr.crc = calculateCRC32C(write.deflated, write.compressedSize);
+    chunk._hdr.set<ChunkHeader::CHECKSUM>(true);
 }
 
-/* Write bytes to DataStore indicated by pos
- * @param pos DataStore and offset to which to write
- * @param data Bytes to write
- * @param len Number of bytes to write
- * @pre position in DataStore must be previously allocated
- * @throws userException if an error occurs
+/* Write new chunks of one array into the smgr.  The chunks are laid out in one
+   extent of the datastore and written together, one log commit covers them all.
  */
 void
-CachedStorage::writeBytesToDataStore(DiskPos const& pos,
-                                     void const* data,
-                                     size_t len,
-                                     size_t allocated)
+CachedStorage::writeChunks(ArrayDesc const& adesc,
+                           vector<PersistentChunk*> const& newChunks,
+                           const std::shared_ptr<Query>& query)
 {
-    double t0 = 0, t1 = 0, writeTime = 0;
-    std::shared_ptr<DataStore> ds = _datastores.getDataStore(pos.dsGuid);
+    /* XXX TODO: consider locking mutex here to avoid writing replica chunks for a rolled-back query
+     */
+    const size_t nChunks = newChunks.size();
+    vector<ChunkWrite> writes(nChunks);
+    for (size_t i = 0; i < nChunks; ++i)
+    {
+        writes[i].chunk = newChunks[i];
+    }
 
-    if (!ds)
+    /* To deal with exceptions: unpin and free
+     */
+    boost::function<void()> func = boost::bind(&CachedStorage::cleanChunkWrites, this, &writes);
+    Destructor<boost::function<void()> > chunkCleaner(func);
+    func = boost::bind(&CachedStorage::abortChunkWriteReplicas, this, &writes);
+    Destructor<boost::function<void()> > replicasCleaner(func);
+    func.clear();
+
+    Query::validateQueryPtr(query);
+
+    for (size_t i = 0; i < nChunks; ++i)
     {
-        throw USER_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_DATASTORE_NOT_FOUND);
+        prepareChunkWrite(adesc, writes[i], query);
     }
 
-    if (_writeLogThreshold >= 0)
+    /* Reserve space for the chunks and their descriptors and queue the write ahead
+       UNDO log records
+     */
+    VersionID dstVersion = adesc.getVersionId();
+    std::shared_ptr<DataStore> ds;
+    uint64_t logSeq = 0;
     {
-        t0 = getTimeSecs();
+        ScopedMutexLock cs(_mutex);
+        Query::validateQueryPtr(query);
+        ds = _datastores.getDataStore(adesc.getUAId());
+
+        vector<size_t> sizes(nChunks);
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            assert(writes[i].chunk->isRaw()); // new chunk is raw
+            sizes[i] = writes[i].compressedSize;
+        }
+        vector<off_t> offsets;
+        vector<size_t> allocatedSizes;
+        ds->allocateSpace(sizes, offsets, allocatedSizes);
+
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            PersistentChunk& chunk = *writes[i].chunk;
+
+            /* Fill in the chunk descriptor
+             */
+            chunk._hdr.compressedSize = writes[i].compressedSize;
+            chunk._hdr.pos.dsGuid = adesc.getUAId();
+            chunk._hdr.pos.offs = offsets[i];
+            chunk._hdr.allocatedSize = allocatedSizes[i];
+
+            /* Locate spot for chunk descriptor
+             */
+            if (_freeHeaders.empty())
+            {
+                chunk._hdr.pos.hdrPos = _hdr.currPos;
+                _hdr.currPos += sizeof(ChunkDescriptor);
+                _hdr.nChunks += 1;
+                _hdrDirty = true;
+            }
+            else
+            {
+                set<uint64_t>::iterator h = _freeHeaders.begin();
+                chunk._hdr.pos.hdrPos = *h;
+                assert(chunk._hdr.pos.hdrPos != 0);
+                _freeHeaders.erase(h);
+            }
+            _unpublishedHeaders.insert(chunk._hdr.pos.hdrPos);
+
+            if (dstVersion != 0)
+            {
+                TransLogRecord transLogRecord;
+                setToZeroInDebug(&transLogRecord, sizeof(transLogRecord));
+
+                transLogRecord.arrayUAID = adesc.getUAId();
+                transLogRecord.arrayId = chunk._addr.arrId;
+                transLogRecord.version = dstVersion;
+                transLogRecord.hdr = chunk._hdr;
+                transLogRecord.oldSize = 0;
+                transLogRecord.hdrCRC = calculateCRC32(&transLogRecord,
+                                                       sizeof(TransLogRecordHeader));
+                LOG4CXX_TRACE(logger, "CachedStorage::writeChunk: queue log entry chunk pos "
+                              << transLogRecord.hdr.pos.offs);
+                logSeq = appendToLog(transLogRecord);
+            }
+        }
     }
-    ds->writeData(pos.offs, data, len, allocated);
-    if (_writeLogThreshold >= 0)
+
+    /* Wait for the log records to become durable: concurrent writers share
+       a single synchronous log write
+     */
+    if (logSeq != 0)
     {
-        t1 = getTimeSecs();
-        writeTime = t1 - t0;
+        commitLog(logSeq);
     }
 
-    if (_writeLogThreshold >= 0 && writeTime * 1000 > _writeLogThreshold)
+    /* Write chunks locally into storage
+     */
+    vector<std::shared_ptr<ReplicationManager::Item> > replicasVec;
     {
-        LOG4CXX_DEBUG(logger, "CWR: pwrite ds " << ds << " time " << writeTime);
+        ScopedMutexLock cs(_mutex);
+        Query::validateQueryPtr(query);
+
+        /* Write chunk data
+         */
+        writeChunksToDataStore(*ds, writes);
+
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            PersistentChunk& chunk = *writes[i].chunk;
+            writes[i].buf.reset();
+            vector<char>().swap(writes[i].delta);
+
+            /* Queue chunk descriptor for the storage header (written on flush)
+             */
+            ChunkDescriptor cdesc;
+            cdesc.hdr = chunk._hdr;
+            for (size_t j = 0; j < chunk._addr.coords.size(); j++)
+            {
+                cdesc.coords[j] = chunk._addr.coords[j];
+            }
+            assert(chunk._hdr.pos.hdrPos != 0);
+
+            LOG4CXX_TRACE(chunkLogger, "chunkl: writechunk: write chunk desc at pos "
+                          << chunk._hdr.pos.hdrPos);
+            LOG4CXX_TRACE(chunkLogger, "chunkl: writechunk: desc: "
+                          << cdesc.toString());
+
+            deferDescriptorWrite(cdesc);
+            _unpublishedHeaders.erase(cdesc.hdr.pos.hdrPos);
+
+            InjectedErrorListener<WriteChunkInjectedError>::check();
+
+            if (isPrimaryReplica(&chunk)) {
+                writes[i].published = true;
+                chunk.unPin();
+                notifyChunkReady(chunk);
+                addChunkToCache(chunk);
+            } // else chunkCleaner will dec accessCount and free
+        }
+    }
+
+    /* Wait for replication to complete.  With asynchronous replication the query
+       waits for all of its replicas at once in ReplicationContext::replicationSync()
+     */
+    for (size_t i = 0; i < nChunks; ++i)
+    {
+        replicasVec.insert(replicasVec.end(), writes[i].replicas.begin(), writes[i].replicas.end());
     }
+    if (_syncReplication || replicasVec.empty()) {
+        waitForReplicas(replicasVec);
+    } else {
+        _replicationManager->deferWait(replicasVec);
+    }
+    replicasCleaner.disarm();
 }
 
-/* Force writing of chunk data to data store
-   Exception is thrown if write failed
-*/
+/* Write a new chunk written through a DBArrayIterator.  Chunks are deferred in
+   the iterator's write batch until write-batch-size of them are pending, so
+   that writeChunks() stores them with one allocation and one gather write.
+ */
 void
-CachedStorage::writeChunkToDataStore(DataStore& ds, PersistentChunk& chunk, void const* data)
+CachedStorage::queueChunkWrite(std::shared_ptr<WriteBatch>& batch,
+                               std::shared_ptr<const Array> const& array,
+                               PersistentChunk* chunk,
+                               std::shared_ptr<Query> const& query)
 {
-    double t0 = 0, t1 = 0, writeTime = 0;
+    ArrayDesc const& adesc = array->getArrayDesc();
 
-    if (_writeLogThreshold >= 0)
+    /* Replicas received from other instances and chunks too large to gain
+       anything from batching are stored at once, after the pending chunks
+       to keep the order in which they were written
+     */
+    if (_writeBatchSize == 0 || chunk->getSize() >= _writeBatchSize || !isPrimaryReplica(chunk))
     {
-        t0 = getTimeSecs();
+        if (batch)
+        {
+            flushWriteBatch(*batch);
+        }
+        writeChunk(adesc, chunk, query);
+        return;
     }
-    ds.writeData(chunk._hdr.pos.offs,
-                 data,
-                 chunk._hdr.compressedSize,
-                 chunk._hdr.allocatedSize);
-    if (_writeLogThreshold >= 0)
+
+    if (!batch)
     {
-        t1 = getTimeSecs();
-        writeTime = t1 - t0;
+        batch = std::make_shared<WriteBatch>(array, query);
+    }
+    bool first = false;
+    bool full = false;
+    {
+        ScopedMutexLock bl(batch->lock);
+        batch->chunks.push_back(chunk);
+        batch->bytes += chunk->getSize();
+        first = (batch->chunks.size() == 1);
+        full = (batch->bytes >= _writeBatchSize || batch->chunks.size() >= MAX_WRITE_BATCH_CHUNKS);
     }
 
-    if (_writeLogThreshold >= 0 && writeTime * 1000 > _writeLogThreshold)
+    /* (Re)register the batch once it holds chunks, so that flushWriteBatches()
+       and loadChunk() can find them
+     */
+    if (first)
     {
-        LOG4CXX_DEBUG(logger, "CWR: pwrite ds chunk "<< chunk.getHeader() <<" time "<< writeTime);
+        ScopedMutexLock cs(_mutex);
+        _writeBatches[adesc.getId()].insert(batch);
+    }
+    if (full)
+    {
+        flushWriteBatch(*batch);
     }
 }
 
-/* Read chunk data from the disk
-   Exception is thrown if read failed
-*/
-void
-CachedStorage::readChunkFromDataStore(DataStore& ds, PersistentChunk const& chunk, void* data)
+/* Store the chunks pending in a write batch.  The first failure is kept in
+   the batch and raised again by later flushes, for the writer to see it.
+ */
+void CachedStorage::flushWriteBatch(WriteBatch& batch)
 {
-    double t0 = 0, t1 = 0, readTime = 0;
-    if (_writeLogThreshold >= 0)
+    vector<PersistentChunk*> chunks;
+    Exception::Pointer error;
     {
-        t0 = getTimeSecs();
+        ScopedMutexLock bl(batch.lock);
+        chunks.swap(batch.chunks);
+        batch.bytes = 0;
+        error = batch.error;
     }
-    ds.readData(chunk._hdr.pos.offs, data, chunk._hdr.compressedSize);
-    if (_writeLogThreshold >= 0)
+    if (error)
     {
-        t1 = getTimeSecs();
-        readTime = t1 - t0;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            cleanChunk(chunks[i]);
+        }
+        error->raise();
     }
-    if (_writeLogThreshold >= 0 && readTime * 1000 > _writeLogThreshold)
+    if (chunks.empty())
     {
-        LOG4CXX_DEBUG(logger, "CWR: pread ds chunk "<< chunk.getHeader() <<" time "<< readTime);
+        return;
     }
-}
-
-RWLock& CachedStorage::getChunkLatch(PersistentChunk* chunk)
-{
-    return _latches[(size_t) chunk->_hdr.pos.offs % N_LATCHES];
-}
-
-void CachedStorage::getChunkPositions(ArrayDesc const& desc, std::shared_ptr<Query> const& query, CoordinateSet& chunkPositions)
-{
-    StorageAddress readAddress (desc.getId(), 0, Coordinates());
-    while(findNextChunk(desc, query, readAddress))
+    try
     {
-        chunkPositions.insert(readAddress.coords);
+        std::shared_ptr<Query> query(batch.query.lock());
+        writeChunks(batch.array->getArrayDesc(), chunks, query);
+    }
+    catch (Exception const& e)
+    {
+        ScopedMutexLock bl(batch.lock);
+        if (!batch.error)
+        {
+            batch.error = e.copy();
+        }
+        throw;
     }
 }
 
-bool CachedStorage::findNextChunk(ArrayDesc const& desc,
-                                  std::shared_ptr<Query> const& query,
-                                  StorageAddress& address)
+/* Flush the write batch of a DBArrayIterator being destroyed.  A failed batch
+   stays registered so that flushWriteBatches() raises its error to the writer.
+ */
+void CachedStorage::releaseWriteBatch(std::shared_ptr<WriteBatch>& batch)
 {
-    ScopedMutexLock cs(_mutex);
-    assert(address.attId < desc.getAttributes().size() && address.arrId <= desc.getId());
-    Query::validateQueryPtr(query);
-
-    ChunkMap::iterator iter = _chunkMap.find(desc.getUAId());
-    if (iter == _chunkMap.end())
+    try
     {
-        address.coords.clear();
-        return false;
+        flushWriteBatch(*batch);
     }
-    std::shared_ptr<InnerChunkMap> const& innerMap = iter->second;
-    if(address.coords.size())
+    catch (Exception const& e)
     {
-        address.coords[address.coords.size()-1] += desc.getDimensions()[desc.getDimensions().size() - 1].getChunkInterval();
+        LOG4CXX_ERROR(logger, "CachedStorage: deferred write of chunks failed: " << e.what());
+        batch.reset();
+        return;
     }
-    address.arrId = desc.getId();
-    InnerChunkMap::iterator innerIter = innerMap->lower_bound(address);
-    while (true)
     {
-        if (innerIter == innerMap->end() || innerIter->first.attId != address.attId)
-        {
-            address.coords.clear();
-            return false;
-        }
-        if(innerIter->first.arrId <= desc.getId())
+        ScopedMutexLock cs(_mutex);
+        WriteBatches::iterator i = _writeBatches.find(batch->array->getArrayDesc().getId());
+        if (i != _writeBatches.end())
         {
-            if(innerIter->second.getChunk() && isResponsibleFor( desc, *(innerIter->second.getChunk()), query))
-            {
-                address.arrId = innerIter->first.arrId;
-                address.coords = innerIter->first.coords;
-                return true;
-            }
-            else
+            i->second.erase(batch);
+            if (i->second.empty())
             {
-                address.arrId = desc.getId();
-                address.coords = innerIter->first.coords;
-                address.coords[address.coords.size()-1] += desc.getDimensions()[desc.getDimensions().size() - 1].getChunkInterval();
-                innerIter = innerMap->lower_bound(address);
+                _writeBatches.erase(i);
             }
         }
-        while(innerIter != innerMap->end() && innerIter->first.arrId > address.arrId && innerIter->first.attId == address.attId)
-        {
-            ++innerIter;
-        }
     }
+    batch.reset();
 }
 
-bool CachedStorage::findChunk(ArrayDesc const& desc, std::shared_ptr<Query> const& query, StorageAddress& address)
+/* Store a new chunk now if it is pending in a write batch: it is raw until
+   it is stored, so that loading it would wait forever.
+ */
+void CachedStorage::flushPendingWrite(PersistentChunk const& chunk)
 {
-    ScopedMutexLock cs(_mutex);
-    Query::validateQueryPtr(query);
-
-    ChunkMap::iterator iter = _chunkMap.find(desc.getUAId());
-    if (iter == _chunkMap.end())
+    std::shared_ptr<WriteBatch> pending;
     {
-        address.coords.clear();
-        return false;
+        ScopedMutexLock cs(_mutex);
+        if (!chunk._raw || _writeBatches.empty())
+        {
+            return;
+        }
+        WriteBatches::iterator i = _writeBatches.find(chunk._addr.arrId);
+        if (i == _writeBatches.end())
+        {
+            return;
+        }
+        for (set<std::shared_ptr<WriteBatch> >::iterator b = i->second.begin();
+             b != i->second.end() && !pending;
+             ++b)
+        {
+            ScopedMutexLock bl((*b)->lock);
+            if (std::find((*b)->chunks.begin(), (*b)->chunks.end(), &chunk) != (*b)->chunks.end())
+            {
+                pending = *b;
+            }
+        }
     }
-    std::shared_ptr<InnerChunkMap> const& innerMap = iter->second;
-    address.arrId = desc.getId();
-    InnerChunkMap::iterator innerIter = innerMap->lower_bound(address);
-    if (innerIter == innerMap->end() || innerIter->first.coords != address.coords || innerIter->first.attId != address.attId)
+    if (pending)
     {
-        address.coords.clear();
-        return false;
+        flushWriteBatch(*pending);
     }
+}
 
-    assert(innerIter->first.arrId <= address.arrId && innerIter->first.coords == address.coords);
-    // XXX empty query used? to represent what ? NID chunk ?
-    if(innerIter->second.getChunk() && (!query || isResponsibleFor(desc, *(innerIter->second.getChunk()), query)))
+/* Store the chunks of an array version still pending in write batches
+ */
+void CachedStorage::flushWriteBatches(ArrayID arrId)
+{
+    set<std::shared_ptr<WriteBatch> > batches;
     {
-        address.arrId = innerIter->first.arrId;
-        return true;
+        ScopedMutexLock cs(_mutex);
+        WriteBatches::iterator i = _writeBatches.find(arrId);
+        if (i == _writeBatches.end())
+        {
+            return;
+        }
+        batches.swap(i->second);
+        _writeBatches.erase(i);
     }
-    else
+
+    /* Flush all of the batches even if some fail, raise the first error
+     */
+    Exception::Pointer error;
+    for (set<std::shared_ptr<WriteBatch> >::iterator b = batches.begin(); b != batches.end(); ++b)
     {
-        address.coords.clear();
-        return false;
+        try
+        {
+            flushWriteBatch(**b);
+        }
+        catch (Exception const& e)
+        {
+            if (!error)
+            {
+                error = e.copy();
+            }
+        }
+    }
+    if (error)
+    {
+        error->raise();
     }
 }
 
-void CachedStorage::cleanChunk(PersistentChunk* chunk)
-{
-    ScopedMutexLock cs(_mutex);
-    LOG4CXX_TRACE(logger, "CachedStorage::cleanChunk =" << chunk << ", accessCount = "<<chunk->_accessCount);
-    assert(chunk->_accessCount>0);
-    --chunk->_accessCount;
-    // Free the chunk regardless of _accessCount to avoid incorrect
-    // _cacheUsed accounting done in internalFreeChunk()
-    // (_accessCount can be >1 because we are double pinning sometimes,
-    // e.g. in ArrayIterator::newChunk & ChunkIterator::ChunkIterator).
-    // If we are here, we have failed to writeChunk() and the chunk is invalid
-    chunk->free();
-    notifyChunkReady(*chunk);
-}
-
-/* Write new chunk into the smgr.
+/* Mark a chunk as free in the on-disk and in-memory chunk map.  Also mark it as free
+   in the datastore.
  */
-void
-CachedStorage::writeChunk(ArrayDesc const& adesc,
-                          PersistentChunk* newChunk,
-                          const std::shared_ptr<Query>& query)
+void CachedStorage::markChunkAsFree(InnerChunkMap& inner,
+                                    InnerChunkMap::iterator entry,
+                                    std::shared_ptr<DataStore>& ds)
 {
-    /* XXX TODO: consider locking mutex here to avoid writing replica chunks for a rolled-back query
-     */
-    PersistentChunk& chunk = *newChunk;
-
-    /* To deal with exceptions: unpin and free
-     */
-    boost::function<void()> func = boost::bind(&CachedStorage::cleanChunk, this, &chunk);
-    Destructor<boost::function<void()> > chunkCleaner(func);
-
-    Query::validateQueryPtr(query);
-
-    /* Update value count in Chunk Header
-     */
-    const AttributeDesc& attrDesc = adesc.getAttributes()[chunk.getAddress().attId];
-
-    if (attrDesc.isEmptyIndicator()) {
-        ConstRLEEmptyBitmap bitmap(static_cast<const char*>(chunk._data));
-        chunk._hdr.nElems = bitmap.count();
-    } else {
-        ConstRLEPayload payload(static_cast<const char*>(chunk._data));
-        chunk._hdr.nElems = payload.count();
-    }
+    ChunkHeader header;
 
-    /* Grab buffer to use for compressing chunk data and try to compress
-     */
-    const size_t bufSize = chunk.getSize();
-    boost::scoped_array<char> buf(new char[bufSize]);
-    if (!buf) {
-        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_ALLOCATE_MEMORY);
+    if (!entry->second.hasChunk())
+    {
+        /* Handle tombstone chunks
+         */
+        readChunkHeader(header, entry->second.getTombstonePos());
     }
-    setToZeroInDebug(buf.get(), bufSize);
-
-    currentStatistics->allocatedSize += bufSize;
-    currentStatistics->allocatedChunks++;
-
-    VersionID dstVersion = adesc.getVersionId();
-    void const* deflated = buf.get();
-    int nCoordinates = chunk._addr.coords.size();
-    DBArrayChunkInternal intChunk(adesc, &chunk);
-    size_t compressedSize = _compressors[chunk.getCompressionMethod()]->compress(buf.get(), intChunk);
-    assert(compressedSize <= chunk.getSize());
-    if (compressedSize == chunk.getSize())
-    { // no compression
-        deflated = chunk._data;
+    else
+    {
+        /* Handle live chunks
+         */
+        inner.getHeader(entry, header);
+        if (ds)
+            ds->freeChunk(header.pos.offs, header.allocatedSize);
     }
 
-    /* Replicate chunk data to other instances
+    /* Update header as free and write back to storage header file
      */
-    vector<std::shared_ptr<ReplicationManager::Item> > replicasVec;
-    func = boost::bind(&CachedStorage::abortReplicas, this, &replicasVec);
-    Destructor<boost::function<void()> > replicasCleaner(func);
-    func.clear();
-    replicate(adesc, chunk._addr, &chunk, deflated,
-              compressedSize, chunk.getSize(), query, replicasVec);
+    header.arrId = 0;
+    LOG4CXX_TRACE(chunkLogger,
+ 	         "chunkl: markchunkasfree: free chunk descriptor at position "
+ 	         << header.pos.hdrPos);
 
-    /* Write chunk locally into storage
-     */
-    {
-        ScopedMutexLock cs(_mutex);
-        assert(chunk.isRaw()); // new chunk is raw
-        Query::validateQueryPtr(query);
-        std::shared_ptr<DataStore> ds = _datastores.getDataStore(adesc.getUAId());
+    writeChunkHeader(header);
+    assert(header.nCoordinates < MAX_NUM_DIMS_SUPPORTED);
+    _freeHeaders.insert(header.pos.hdrPos);
+}
 
-        /* Fill in the chunk descriptor
-         */
-        chunk._hdr.compressedSize = compressedSize;
-        chunk._hdr.pos.dsGuid = adesc.getUAId();
-        chunk._hdr.pos.offs = ds->allocateSpace(compressedSize,
-                                                chunk._hdr.allocatedSize);
+uint64_t CachedStorage::appendToLog(TransLogRecord const& rec)
+{
+    ScopedMutexLock cs(_logMutex);
+    _logQueue.push_back(rec);
+    return ++_logQueuedSeq;
+}
 
-        /* Locate spot for chunk descriptor
-         */
-        if (_freeHeaders.empty())
-        {
-            chunk._hdr.pos.hdrPos = _hdr.currPos;
-            _hdr.currPos += sizeof(ChunkDescriptor);
-            _hdr.nChunks += 1;
-        }
-        else
+void CachedStorage::commitLog(uint64_t seq)
+{
+    ScopedMutexLock cs(_logMutex);
+    while (_logSyncedSeq < seq)
+    {
+        if (_logWriterActive)
         {
-            set<uint64_t>::iterator i = _freeHeaders.begin();
-            chunk._hdr.pos.hdrPos = *i;
-            assert(chunk._hdr.pos.hdrPos != 0);
-            _freeHeaders.erase(i);
+            /* Some other thread is writing the log: wait for its batch to complete
+             */
+            Event::ErrorChecker noopEc;
+            _logEvent.wait(_logMutex, noopEc);
+            continue;
         }
 
-        /* Write ahead UNDO log
+        /* Become the leader: write everything queued so far with one synchronous write
          */
-        if (dstVersion != 0)
+        std::vector<TransLogRecord> batch;
+        batch.swap(_logQueue);
+        const uint64_t batchFrom = _logSyncedSeq;
+        const uint64_t batchTo = _logQueuedSeq;
+        const size_t nRecords = batch.size();
+        assert(nRecords == batchTo - batchFrom);
+        if (_logFailedSeq != UINT64_MAX)
         {
-            // Second entry in this array is the end-of-record sentinel.
-            TransLogRecord transLogRecord[2];
-            setToZeroInDebug(transLogRecord, sizeof(transLogRecord));
+            /* The log is disabled, the records are dropped and their writers fail
+             */
+            _logSyncedSeq = batchTo;
+            _logEvent.signal();
+            continue;
+        }
+        _logWriterActive = true;
 
-            transLogRecord->arrayUAID = adesc.getUAId();
-            transLogRecord->arrayId = chunk._addr.arrId;
-            transLogRecord->version = dstVersion;
-            transLogRecord->hdr = chunk._hdr;
-            transLogRecord->oldSize = 0;
-            transLogRecord->hdrCRC = calculateCRC32(transLogRecord,
-                                                    sizeof(TransLogRecordHeader));
+        bool failed = false;
+        _logMutex.unlock();
+        try
+        {
+            // Last entry in the batch is the end-of-log sentinel.
+            batch.push_back(TransLogRecord());
+            ::memset(&batch.back(), 0, sizeof(TransLogRecord));
 
-            if (_logSize + sizeof(TransLogRecord) > _logSizeLimit)
+            if (_logSize + nRecords * sizeof(TransLogRecord) > _logSizeLimit)
             {
                 _logSize = 0;
                 _currLog ^= 1;
             }
-           LOG4CXX_TRACE(logger, "CachedStorage::writeChunk: write log entry chunk pos "
- 	                 << transLogRecord->hdr.pos.offs << " at log pos " << _logSize); 
+            LOG4CXX_TRACE(logger, "CachedStorage::commitLog: write " << nRecords
+                          << " log records at log pos " << _logSize);
 
-            /* Write the transaction... log is opened O_SYNC so no flush is necessary
+            /* The log is opened O_SYNC so no flush is necessary
              */
-            _log[_currLog]->writeAll(transLogRecord, sizeof(TransLogRecord) * 2, _logSize);
-            _logSize += sizeof(TransLogRecord);
+            _log[_currLog]->writeAll(&batch[0], sizeof(TransLogRecord) * (nRecords + 1), _logSize);
+            _logSize += sizeof(TransLogRecord) * nRecords;
         }
+        catch (std::exception const& e)
+        {
+            LOG4CXX_ERROR(logger, "CachedStorage::commitLog: failed to write "
+                          << nRecords << " log records, the transaction log is disabled until restart: "
+                          << e.what());
+            failed = true;
+        }
+        _logMutex.lock();
 
-        /* Write chunk data
-         */
-        writeChunkToDataStore(*ds, chunk, deflated);
-        buf.reset();
-
-        /* Write chunk descriptor in storage header
-         */
-        ChunkDescriptor cdesc;
-        cdesc.hdr = chunk._hdr;
-        for (int i = 0; i < nCoordinates; i++)
+        if (failed)
         {
-            cdesc.coords[i] = chunk._addr.coords[i];
+            /* Whether a later batch reaches the disk or not, the records of this
+               one are lost: every writer from here on fails
+             */
+            _logFailedSeq = batchFrom;
         }
-        assert(chunk._hdr.pos.hdrPos != 0);
+        _logSyncedSeq = batchTo;
+        _logWriterActive = false;
+        _logEvent.signal();
+    }
+    if (seq > _logFailedSeq)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED) << "write transaction log";
+    }
+}
+
+void CachedStorage::syncLog()
+{
+    uint64_t seq = 0;
+    {
+        ScopedMutexLock cs(_logMutex);
+        seq = _logQueuedSeq;
+    }
+    commitLog(seq);
+}
 
-        LOG4CXX_TRACE(chunkLogger, "chunkl: writechunk: write chunk desc at pos "
- 	            << chunk._hdr.pos.hdrPos);
- 	LOG4CXX_TRACE(chunkLogger, "chunkl: writechunk: desc: "
- 	            << cdesc.toString());   
-        
-        _hd->writeAll(&cdesc, sizeof(ChunkDescriptor), chunk._hdr.pos.hdrPos);
+void CachedStorage::deferDescriptorWrite(ChunkDescriptor const& desc)
+{
+    invalidateChunkMapSegment(desc.hdr.pos.dsGuid);
+    assert(desc.hdr.pos.hdrPos >= HEADER_SIZE);
+    _pendingDescriptors[desc.hdr.pos.hdrPos] = desc;
+}
 
-        /* Update storage header (for nchunks field)
-         */
-        _hd->writeAll(&_hdr, HEADER_SIZE, 0);
+void CachedStorage::writeChunkHeader(ChunkHeader const& hdr)
+{
+    /* Every update of the storage header file goes through flushChunkDescriptors()
+       so that the slots covered by the chunk map checkpoint are logged first
+     */
+    invalidateChunkMapSegment(hdr.pos.dsGuid);
+    PendingDescriptors::iterator it = _pendingDescriptors.find(hdr.pos.hdrPos);
+    if (it == _pendingDescriptors.end())
+    {
+        ChunkDescriptor desc;
+        _hd->readAll(&desc, sizeof(ChunkDescriptor), hdr.pos.hdrPos);
+        it = _pendingDescriptors.insert(make_pair(hdr.pos.hdrPos, desc)).first;
+    }
+    it->second.hdr = hdr;
+}
 
-        InjectedErrorListener<WriteChunkInjectedError>::check();
+void CachedStorage::readChunkHeader(ChunkHeader& hdr, uint64_t pos)
+{
+    PendingDescriptors::const_iterator it = _pendingDescriptors.find(pos);
+    if (it != _pendingDescriptors.end())
+    {
+        hdr = it->second.hdr;
+        return;
+    }
+    size_t rc = _hd->read(&hdr, sizeof(ChunkHeader), pos);
+    if (rc != 0 && rc != sizeof(ChunkHeader)) {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE,
+                               SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
+            << "read" << ::strerror(errno) << errno;
+    }
+}
 
-        if (isPrimaryReplica(&chunk)) {
-            chunkCleaner.disarm();
-            chunk.unPin();
-            notifyChunkReady(chunk);
-            addChunkToCache(chunk);
-        } // else chunkCleaner will dec accessCount and free
+void CachedStorage::flushChunkDescriptors()
+{
+    if (_pendingDescriptors.empty() && !_hdrDirty)
+    {
+        return;
     }
 
-    /* Wait for replication to complete
+    /* Descriptors must not reach the disk before their undo records
      */
-    waitForReplicas(replicasVec);
-    replicasCleaner.disarm();
-}
+    syncLog();
 
-/* Mark a chunk as free in the on-disk and in-memory chunk map.  Also mark it as free
-   in the datastore.
- */
-void CachedStorage::markChunkAsFree(InnerChunkMapEntry& entry, std::shared_ptr<DataStore>& ds)
-{
-    ChunkHeader header;
-    std::shared_ptr<PersistentChunk>& chunk = entry.getChunk();
+    /* Slots covered by the chunk map checkpoint must be logged before they change
+     */
+    vector<uint64_t> positions;
+    positions.reserve(_pendingDescriptors.size());
+    for (PendingDescriptors::const_iterator it = _pendingDescriptors.begin();
+         it != _pendingDescriptors.end(); ++it)
+    {
+        positions.push_back(it->first);
+    }
+    logCheckpointedSlots(positions);
 
-    if (!chunk)
+    /* Write runs of adjacent descriptors with a single write each
+     */
+    vector<ChunkDescriptor> run;
+    uint64_t runPos = 0;
+    for (PendingDescriptors::const_iterator it = _pendingDescriptors.begin();
+         it != _pendingDescriptors.end(); ++it)
     {
-        /* Handle tombstone chunks
-         */
-        int rc = _hd->read(&header, sizeof(ChunkHeader), entry.getTombstonePos());
-        if (rc != 0 && rc != sizeof(ChunkHeader)) {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE,
-                                   SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
-                << "read" << ::strerror(errno) << errno;
+        if (!run.empty() && it->first != runPos + run.size() * sizeof(ChunkDescriptor))
+        {
+            _hd->writeAll(&run[0], run.size() * sizeof(ChunkDescriptor), runPos);
+            run.clear();
+        }
+        if (run.empty())
+        {
+            runPos = it->first;
         }
+        run.push_back(it->second);
     }
-    else
+    if (!run.empty())
     {
-        /* Handle live chunks
-         */
-        memcpy(&header, &(chunk->_hdr), sizeof(ChunkHeader));
-        if (ds)
-            ds->freeChunk(chunk->_hdr.pos.offs, chunk->_hdr.allocatedSize);
+        _hd->writeAll(&run[0], run.size() * sizeof(ChunkDescriptor), runPos);
     }
+    LOG4CXX_TRACE(logger, "CachedStorage::flushChunkDescriptors: wrote "
+                  << _pendingDescriptors.size() << " descriptors");
+    _ckptUpdates += _pendingDescriptors.size();
+    _pendingDescriptors.clear();
 
-    /* Update header as free and write back to storage header file
+    /* Update storage header (for nchunks field)
      */
-    header.arrId = 0;
-    LOG4CXX_TRACE(chunkLogger,
- 	         "chunkl: markchunkasfree: free chunk descriptor at position "
- 	         << header.pos.hdrPos);
-
-    _hd->writeAll(&header, sizeof(ChunkHeader), header.pos.hdrPos);
-    assert(header.nCoordinates < MAX_NUM_DIMS_SUPPORTED);
-    _freeHeaders.insert(header.pos.hdrPos);
+    _hd->writeAll(&_hdr, HEADER_SIZE, 0);
+    _hdrDirty = false;
 }
 
 void CachedStorage::removeDeadChunks(ArrayDesc const& arrayDesc,
@@ -1686,12 +3699,14 @@ void CachedStorage::removeDeadChunks(ArrayDesc const& arrayDesc,
 {
     typedef set<Coordinates, CoordinatesLess> DeadChunks;
     DeadChunks deadChunks;
+    loadChunkMap(arrayDesc.getUAId());
     {
         ScopedMutexLock cs(_mutex);
         Query::validateQueryPtr(query);
 
+        ChunkMap::iterator iter = findChunkMap(arrayDesc.getUAId());
         StorageAddress readAddress (arrayDesc.getId(), 0, Coordinates());
-        while(findNextChunk(arrayDesc, query, readAddress))
+        while(iter != _chunkMap.end() && findNextChunk(iter->second, arrayDesc, query, readAddress))
         {
             if(liveChunks.count(readAddress.coords) == 0)
             {
@@ -1725,6 +3740,7 @@ void CachedStorage::removeLocalChunkVersion(ArrayDesc const& arrayDesc,
                                             Coordinates const& coords,
                                             std::shared_ptr<Query> const& query)
 {
+    loadChunkMap(arrayDesc.getUAId());
     ScopedMutexLock cs(_mutex);
     Query::validateQueryPtr(query);
 
@@ -1751,26 +3767,28 @@ void CachedStorage::removeLocalChunkVersion(ArrayDesc const& arrayDesc,
         tombstoneDesc.coords[i] = coords[i];
     }
     //WAL
-    TransLogRecord transLogRecord[2];
-    setToZeroInDebug(transLogRecord, sizeof(transLogRecord));
-    transLogRecord->arrayUAID = arrayDesc.getUAId();
-    transLogRecord->arrayId = arrayDesc.getId();
-    transLogRecord->version = dstVersion;
-    transLogRecord->oldSize = 0;
-    ::memset(&transLogRecord[1], 0, sizeof(TransLogRecord)); // end of log marker
-    ChunkMap::iterator iter = _chunkMap.find(arrayDesc.getUAId());
+    TransLogRecord transLogRecord;
+    setToZeroInDebug(&transLogRecord, sizeof(transLogRecord));
+    transLogRecord.arrayUAID = arrayDesc.getUAId();
+    transLogRecord.arrayId = arrayDesc.getId();
+    transLogRecord.version = dstVersion;
+    transLogRecord.oldSize = 0;
+    ChunkMap::iterator iter = findChunkMap(arrayDesc.getUAId());
     if(iter == _chunkMap.end())
     {
         throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "Attempt to create tombstone for unexistent array";
     }
     std::shared_ptr<InnerChunkMap> inner = iter->second;
+    vector<ChunkDescriptor> tombstones;
+    tombstones.reserve(arrayDesc.getAttributes().size());
+    uint64_t logSeq = 0;
     for (AttributeID i =0; i<arrayDesc.getAttributes().size(); i++)
     {
         query->validate();
 
         tombstoneDesc.hdr.attId = i;
         StorageAddress addr (arrayDesc.getId(), i, coords);
-        if( (*inner)[addr].getChunk() != NULL)
+        if( (*inner)[addr].hasChunk())
         {
             throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CHUNK_ALREADY_EXISTS)
             << CoordsToStr(addr.coords);
@@ -1780,6 +3798,7 @@ void CachedStorage::removeLocalChunkVersion(ArrayDesc const& arrayDesc,
             tombstoneDesc.hdr.pos.hdrPos = _hdr.currPos;
             _hdr.currPos += sizeof(ChunkDescriptor);
             _hdr.nChunks += 1;
+            _hdrDirty = true;
         }
         else
         {
@@ -1790,27 +3809,27 @@ void CachedStorage::removeLocalChunkVersion(ArrayDesc const& arrayDesc,
         }
         (*inner)[addr].setTombstonePos(InnerChunkMapEntry::TOMBSTONE,
                                        tombstoneDesc.hdr.pos.hdrPos);
-        transLogRecord->hdr = tombstoneDesc.hdr;
-        transLogRecord->hdrCRC = calculateCRC32(transLogRecord, sizeof(TransLogRecordHeader));
-        if (_logSize + sizeof(TransLogRecord) > _logSizeLimit)
-        {
-            _logSize = 0;
-            _currLog ^= 1;
-        }
-        LOG4CXX_TRACE(logger, "ChunkDesc: Write in log chunk tombstone header " << transLogRecord->hdr.pos.offs
-                      << " at position " << _logSize);
+        transLogRecord.hdr = tombstoneDesc.hdr;
+        transLogRecord.hdrCRC = calculateCRC32(&transLogRecord, sizeof(TransLogRecordHeader));
+        LOG4CXX_TRACE(logger, "ChunkDesc: Queue log record for chunk tombstone header at "
+                      << tombstoneDesc.hdr.pos.hdrPos);
+        logSeq = appendToLog(transLogRecord);
+        tombstones.push_back(tombstoneDesc);
+    }
 
-        _log[_currLog]->writeAll(transLogRecord, sizeof(TransLogRecord) * 2, _logSize);
-        _logSize += sizeof(TransLogRecord);
+    /* All attributes share one log write
+     */
+    commitLog(logSeq);
 
+    for (size_t i = 0; i < tombstones.size(); ++i)
+    {
         LOG4CXX_TRACE(chunkLogger, "chunkl: removelocalchunkversion: "
-             << "write chunk tombstone at pos " <<  tombstoneDesc.hdr.pos.hdrPos);
+             << "write chunk tombstone at pos " <<  tombstones[i].hdr.pos.hdrPos);
         LOG4CXX_TRACE(chunkLogger, "chunkl: removelocalchunkversion: "
- 	     << "tombstone to write: " << tombstoneDesc.toString());
-        
-        _hd->writeAll(&tombstoneDesc, sizeof(ChunkDescriptor), tombstoneDesc.hdr.pos.hdrPos);
+ 	     << "tombstone to write: " << tombstones[i].toString());
+
+        deferDescriptorWrite(tombstones[i]);
     }
-    _hd->writeAll(&_hdr, HEADER_SIZE, 0);
     InjectedErrorListener<WriteChunkInjectedError>::check();
 }
 
@@ -1823,6 +3842,31 @@ void CachedStorage::rollback(std::map<ArrayID, VersionID> const& undoUpdates)
     LOG4CXX_DEBUG(logger, "Performing rollback");
 
     ScopedMutexLock cs(_mutex);
+
+    /* Drop the chunks of the rolled back arrays still pending in write batches
+     */
+    for (WriteBatches::iterator b = _writeBatches.begin(); b != _writeBatches.end(); )
+    {
+        set<std::shared_ptr<WriteBatch> >& batches = b->second;
+        if (batches.empty() ||
+            undoUpdates.find((*batches.begin())->array->getArrayDesc().getUAId()) == undoUpdates.end())
+        {
+            ++b;
+            continue;
+        }
+        for (set<std::shared_ptr<WriteBatch> >::iterator i = batches.begin(); i != batches.end(); ++i)
+        {
+            ScopedMutexLock bl((*i)->lock);
+            for (size_t j = 0; j < (*i)->chunks.size(); ++j)
+            {
+                cleanChunk((*i)->chunks[j]);
+            }
+            (*i)->chunks.clear();
+            (*i)->bytes = 0;
+        }
+        _writeBatches.erase(b++);
+    }
+    syncLog();
     for (int i = 0; i < 2; i++)
     {
         uint64_t pos = 0;
@@ -1858,8 +3902,13 @@ void CachedStorage::rollback(std::map<ArrayID, VersionID> const& undoUpdates)
                              << transLogRecord.hdr.pos.hdrPos); 
                 LOG4CXX_TRACE(chunkLogger, "chunkl: rollback: hdr: "
  	                     << transLogRecord.hdr.toString()); 
-                _hd->writeAll(&transLogRecord.hdr, sizeof(ChunkHeader), transLogRecord.hdr.pos.hdrPos);
-                _freeHeaders.insert(transLogRecord.hdr.pos.hdrPos);
+                if (transLogRecord.hdr.pos.hdrPos < _hdr.currPos)
+                {
+                    writeChunkHeader(transLogRecord.hdr);
+                    _freeHeaders.insert(transLogRecord.hdr.pos.hdrPos);
+                }
+                // else the descriptor slot was allocated but the storage header
+                // recording it never reached the disk: the slot is reused via currPos
 
                 /* Update the free list for the data store
                  */
@@ -1875,7 +3924,7 @@ void CachedStorage::rollback(std::map<ArrayID, VersionID> const& undoUpdates)
             pos += transLogRecord.oldSize;
         }
     }
-    flush();
+    syncStorage();
 
     for(std::map<ArrayID, VersionID>::const_iterator it = undoUpdates.begin();
         it != undoUpdates.end();
@@ -1972,11 +4021,23 @@ void CachedStorage::doTxnRecoveryOnStartup()
 void
 CachedStorage::flush(ArrayUAID uaId)
 {
-    int rc;
+    syncStorage(uaId);
+
+    /* Periodically replace the chunk map checkpoint
+     */
+    writeChunkMapCheckpoint(_ckptInterval);
+}
 
-    /* flush the chunk map file
+void
+CachedStorage::syncStorage(ArrayUAID uaId)
+{
+    /* write out pending chunk descriptors and flush the chunk map file
      */
-    rc = _hd->fsync();
+    {
+        ScopedMutexLock cs(_mutex);
+        flushChunkDescriptors();
+    }
+    int rc = _hd->fsync();
     if (rc != 0)
     {
         throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED_WITH_ERRNO)
@@ -2020,32 +4081,137 @@ void CachedStorage::fetchChunk(ArrayDesc const& desc, PersistentChunk& chunk)
                                SCIDB_LE_ACCESS_TO_RAW_CHUNK) << chunk.getHeader().arrId;
     }
     size_t chunkSize = chunk.getSize();
-    chunk.allocate(chunkSize);
-    if (chunk.getCompressedSize() != chunkSize)
-    {
-        const size_t bufSize = chunk.getCompressedSize();
-        boost::scoped_array<char> buf(new char[bufSize]);
-        currentStatistics->allocatedSize += bufSize;
-        currentStatistics->allocatedChunks++;
-        if (!buf) {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_ALLOCATE_MEMORY);
-        }
-        readChunkFromDataStore(*ds, chunk, buf.get());
-        DBArrayChunkInternal intChunk(desc, &chunk);
-        size_t rc = _compressors[chunk.getCompressionMethod()]->decompress(buf.get(), chunk.getCompressedSize(), intChunk);
-        if (rc != chunk.getSize())
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
-        buf.reset();
+    try
+    {
+        if (!chunk.isDelta() && chunk.getCompressedSize() == chunkSize && mapChunk(chunk, *ds))
+        {
+            return;
+        }
+        chunk.allocate(chunkSize);
+        if (chunk.isDelta())
+        {
+            fetchDeltaChunk(desc, chunk, *ds);
+        }
+        else if (chunk.getCompressedSize() != chunkSize)
+        {
+            const size_t bufSize = chunk.getCompressedSize();
+            boost::scoped_array<char> buf(new char[bufSize]);
+            currentStatistics->allocatedSize += bufSize;
+            currentStatistics->allocatedChunks++;
+            if (!buf) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_ALLOCATE_MEMORY);
+            }
+            readChunkFromDataStore(*ds, chunk, buf.get());
+            DBArrayChunkInternal intChunk(desc, &chunk);
+            size_t rc = _compressors[chunk.getCompressionMethod()]->decompress(buf.get(), chunk.getCompressedSize(), intChunk);
+            if (rc != chunk.getSize())
+                throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
+            buf.reset();
+        }
+        else
+        {
+            readChunkFromDataStore(*ds, chunk, chunk._data);
+        }
+    }
+    catch (Exception const&)
+    {
+        discardChunkData(chunk);
+        throw;
+    }
+}
+
+void CachedStorage::discardChunkData(PersistentChunk& chunk)
+{
+    ScopedMutexLock cs(_mutex);
+    if (chunk._data == NULL)
+    {
+        /* addChunkToCache() accounted the chunk before it was allocated
+         */
+        _cacheUsed -= chunk.getSize();
     }
     else
     {
-        readChunkFromDataStore(*ds, chunk, chunk._data);
+        internalFreeChunk(chunk);
+    }
+}
+
+bool CachedStorage::mapChunk(PersistentChunk& chunk, DataStore& ds)
+{
+    const size_t size = chunk.getSize();
+    const size_t minSize = Config::getInstance()->getOption<int>(CONFIG_MMAP_MIN_CHUNK_SIZE) * KiB;
+    if (minSize == 0 || size < minSize)
+    {
+        return false;
+    }
+    {
+        ScopedMutexLock cs(_mutex);
+        if (_cacheMapped + size > _mmapCacheSize)
+        {
+            return false;
+        }
+    }
+
+    void* mapping = NULL;
+    size_t mappedSize = 0;
+    void* data = ds.mapData(chunk._hdr.pos.offs, chunk._hdr.compressedSize, _mmapAdvice,
+                            mapping, mappedSize);
+
+    /* addChunkToCache() has accounted the chunk as heap memory
+     */
+    {
+        ScopedMutexLock cs(_mutex);
+        chunk.setMapping(mapping, mappedSize, data);
+        _cacheUsed -= size;
+        _cacheMapped += size;
+        if (_cacheOverflowFlag)
+        {
+            _cacheOverflowFlag = false;
+            _cacheOverflowEvent.signal();
+        }
+    }
+    verifyChunkData(chunk, data);
+    return true;
+}
+
+void CachedStorage::fetchDeltaChunk(ArrayDesc const& desc, PersistentChunk& chunk, DataStore& ds)
+{
+    const size_t deltaSize = chunk.getCompressedSize();
+    boost::scoped_array<char> buf(new char[deltaSize]);
+    currentStatistics->allocatedSize += deltaSize;
+    currentStatistics->allocatedChunks++;
+    readChunkFromDataStore(ds, chunk, buf.get());
+
+    DeltaChunkHeader hdr;
+    if (deltaSize < sizeof(hdr))
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
+    }
+    memcpy(&hdr, buf.get(), sizeof(hdr));
+    if (hdr.magic != DELTA_CHUNK_MAGIC)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_DECOMPRESS_CHUNK);
+    }
+
+    /* Load the base version (itself possibly a delta) and apply the delta to it
+     */
+    StorageAddress baseAddr(hdr.baseArrId, chunk._addr.attId, chunk._addr.coords);
+    std::shared_ptr<PersistentChunk> base = lookupChunk(desc, baseAddr);
+    if (!base)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CHUNK_NOT_FOUND);
     }
+    PersistentChunk::UnPinner scope(base.get());
+    loadChunk(desc, base.get());
+    applyChunkDelta(buf.get(), deltaSize,
+                    static_cast<char const*>(base->_data), base->getSize(),
+                    static_cast<char*>(chunk._data), chunk.getSize());
+    chunk._deltaDepth = hdr.depth;
 }
 
 void CachedStorage::loadChunk(ArrayDesc const& desc, PersistentChunk* aChunk)
 {
     PersistentChunk& chunk = *aChunk;
+    flushPendingWrite(chunk);
     {
         ScopedMutexLock cs(_mutex);
         if (chunk._accessCount < 2)
@@ -2121,6 +4287,9 @@ void CachedStorage::setInstanceId(InstanceID id)
 void CachedStorage::getDiskInfo(DiskInfo& info)
 {
     ::memset(&info, 0, sizeof info);
+    ScopedMutexLock cs(_mutex);
+    info.cacheUsed = _cacheUsed;
+    info.cacheMapped = _cacheMapped;
 }
 
 void CachedStorage::visitChunkDescriptors(const ChunkDescriptorVisitor& visit) const
@@ -2130,26 +4299,64 @@ void CachedStorage::visitChunkDescriptors(const ChunkDescriptorVisitor& visit) c
     uint64_t chunkPos = HEADER_SIZE;
     for (size_t i = 0; i < _hdr.nChunks; i++, chunkPos += sizeof(ChunkDescriptor))
     {
-        _hd->readAll(&cd, sizeof(ChunkDescriptor), chunkPos);
+        PendingDescriptors::const_iterator pending = _pendingDescriptors.find(chunkPos);
+        if (pending != _pendingDescriptors.end())
+        {
+            cd = pending->second;
+        }
+        else
+        {
+            _hd->readAll(&cd, sizeof(ChunkDescriptor), chunkPos);
+        }
         visit(cd, _freeHeaders.count(chunkPos));
     }
 }
 
 void CachedStorage::visitChunkMap(const ChunkMapVisitor& visit) const
 {
-    ScopedMutexLock cs(_mutex);
-    for (ChunkMap::const_iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+    // Loading a lazy chunk map only fills a cache, so the visit remains logically const
+    CachedStorage* self = const_cast<CachedStorage*>(this);
+    vector<ArrayUAID> uaids;
+    {
+        ScopedMutexLock cs(_mutex);
+        for (ChunkMap::const_iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+        {
+            uaids.push_back(i->first);
+        }
+        for (CheckpointSegments::const_iterator i = _lazyChunkMaps.begin(); i != _lazyChunkMaps.end(); ++i)
+        {
+            uaids.push_back(i->first);
+        }
+    }
+
+    /* The arrays are visited one at a time, each of them under _mutex, so
+       that the lazy ones can be loaded in turn without holding it
+     */
+    for (size_t u = 0; u < uaids.size(); ++u)
     {
+        self->loadChunkMap(uaids[u]);
+        ScopedMutexLock cs(_mutex);
+        ChunkMap::iterator i = self->findChunkMap(uaids[u]);
+        if (i == self->_chunkMap.end())
+        {
+            continue;
+        }
         for (InnerChunkMap::const_iterator j = i->second->begin(); j != i->second->end(); ++j)
         {
             uint64_t tombstonePos = 0;
+            ChunkHeader hdr;
 
             if (j->second.isTombstone())
             {
                 tombstonePos = j->second.getTombstonePos();
             }
+            else if (j->second.hasChunk())
+            {
+                i->second->getHeader(j, hdr);
+            }
             visit(i->first,
                   j->first,
+                  j->second.hasChunk() ? &hdr : NULL,
                   j->second.getChunk().get(),
                   tombstonePos,
                   j->second.isValid());
@@ -2157,6 +4364,193 @@ void CachedStorage::visitChunkMap(const ChunkMapVisitor& visit) const
     }
 }
 
+void CachedStorage::visitCorruptChunks(const CorruptChunkVisitor& visit) const
+{
+    ScopedMutexLock cs(_mutex);
+    for (size_t i = 0; i < _corruptChunks.size(); ++i)
+    {
+        visit(_corruptChunks[i]);
+    }
+}
+
+bool CachedStorage::isStoredChunk(ArrayUAID uaId, StorageAddress const& addr, ChunkHeader const& hdr,
+                                  ChunkMapCheckpointSegment const* seg)
+{
+    /* A lazy array is left alone: it has not changed since its checkpoint
+       segment was written, so a chunk taken from the same segment is current
+     */
+    CheckpointSegments::const_iterator lazy = _lazyChunkMaps.find(uaId);
+    if (lazy != _lazyChunkMaps.end())
+    {
+        return seg != NULL &&
+            lazy->second.crc == seg->crc &&
+            lazy->second.size == seg->size &&
+            lazy->second.nEntries == seg->nEntries;
+    }
+    ChunkMap::iterator i = _chunkMap.find(uaId);
+    if (i == _chunkMap.end())
+    {
+        return false;
+    }
+    InnerChunkMap::iterator j = i->second->find(addr);
+    if (j == i->second->end() || !j->second.hasChunk())
+    {
+        return false;
+    }
+    ChunkHeader current;
+    i->second->getHeader(j, current);
+    return current.pos.offs == hdr.pos.offs &&
+        current.crc == hdr.crc &&
+        current.is<ChunkHeader::CHECKSUM>() &&
+        _unpublishedHeaders.count(current.pos.hdrPos) == 0;
+}
+
+void CachedStorage::scrubChunks(ChunkScrubber& scrubber)
+{
+    /* Lazily loaded arrays are scrubbed straight from their checkpoint
+       segments: loading them here would bring every chunk map into memory
+       regardless of the chunkmap-loaded-limit
+     */
+    vector<ArrayUAID> uaids;
+    vector<ChunkMapCheckpointSegment> segs;
+    File::FilePtr image;
+    {
+        ScopedMutexLock cs(_mutex);
+        for (ChunkMap::const_iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i)
+        {
+            uaids.push_back(i->first);
+        }
+        for (CheckpointSegments::const_iterator i = _lazyChunkMaps.begin(); i != _lazyChunkMaps.end(); ++i)
+        {
+            segs.push_back(i->second);
+        }
+        image = _ckptImage;
+    }
+
+    size_t nChunks = 0;
+    uint64_t nBytes = 0;
+    vector<char> buf;
+    for (size_t u = 0; u < uaids.size() + segs.size(); ++u)
+    {
+        /* Snapshot the descriptors of the checksummed chunks of the array
+         */
+        vector<pair<StorageAddress, ChunkHeader> > chunks;
+        ChunkMapCheckpointSegment const* seg = u < uaids.size() ? NULL : &segs[u - uaids.size()];
+        ArrayUAID const uaId = seg ? seg->uaid : uaids[u];
+        if (seg)
+        {
+            if (!readChunkMapSegment(image, *seg, buf))
+            {
+                LOG4CXX_DEBUG(logger, "ChunkScrubber: cannot read checkpoint segment of array " << uaId);
+                continue;
+            }
+            ChunkDescriptor desc;
+            char const* src = buf.empty() ? NULL : &buf[0];
+            for (uint64_t e = 0; e < seg->nEntries; e++)
+            {
+                memcpy(&desc.hdr, src, sizeof(ChunkHeader));
+                src += sizeof(ChunkHeader);
+                memcpy(desc.coords, src, desc.hdr.nCoordinates * sizeof(Coordinate));
+                src += desc.hdr.nCoordinates * sizeof(Coordinate);
+                if (desc.hdr.arrId != 0 &&
+                    !desc.hdr.is<ChunkHeader::TOMBSTONE>() &&
+                    desc.hdr.is<ChunkHeader::CHECKSUM>() &&
+                    desc.hdr.compressedSize != 0)
+                {
+                    StorageAddress addr;
+                    desc.getAddress(addr);
+                    chunks.push_back(make_pair(addr, desc.hdr));
+                }
+            }
+        }
+        else
+        {
+            ScopedMutexLock cs(_mutex);
+            ChunkMap::iterator i = _chunkMap.find(uaId);
+            if (i == _chunkMap.end())
+            {
+                continue;
+            }
+            for (InnerChunkMap::const_iterator j = i->second->begin(); j != i->second->end(); ++j)
+            {
+                if (!j->second.hasChunk())
+                {
+                    continue;
+                }
+                ChunkHeader hdr;
+                i->second->getHeader(j, hdr);
+                if (hdr.is<ChunkHeader::CHECKSUM>() && hdr.compressedSize != 0)
+                {
+                    chunks.push_back(make_pair(j->first, hdr));
+                }
+            }
+        }
+
+        for (size_t c = 0; c < chunks.size(); ++c)
+        {
+            StorageAddress const& addr = chunks[c].first;
+            ChunkHeader const& hdr = chunks[c].second;
+            if (!scrubber.throttle(hdr.compressedSize))
+            {
+                return;
+            }
+
+            /* The chunk may have been removed (and its space reused) since the snapshot
+             */
+            std::shared_ptr<DataStore> ds;
+            {
+                ScopedMutexLock cs(_mutex);
+                if (!isStoredChunk(uaId, addr, hdr, seg))
+                {
+                    continue;
+                }
+                ds = _datastores.getDataStore(uaId);
+            }
+
+            /* A mismatch is only reported if the chunk is still there, unchanged,
+               when the data is read again
+             */
+            uint32_t crc = hdr.crc;
+            for (int attempt = 0; attempt < 2; ++attempt)
+            {
+                buf.resize(hdr.compressedSize);
+                try
+                {
+                    ds->readData(hdr.pos.offs, &buf[0], hdr.compressedSize, false);
+                    crc = calculateCRC32C(&buf[0], hdr.compressedSize);
+                }
+                catch (Exception const& e)
+                {
+                    /* Unreadable data (bad datastore chunk header, I/O error)
+                       counts as corrupt, reported with a zero checksum
+                     */
+                    LOG4CXX_DEBUG(logger, "ChunkScrubber: cannot read chunk " << hdr << ": " << e.what());
+                    crc = 0;
+                }
+                if (crc == hdr.crc)
+                {
+                    break;
+                }
+            }
+            nChunks += 1;
+            nBytes += hdr.compressedSize;
+            if (crc != hdr.crc)
+            {
+                bool stored;
+                {
+                    ScopedMutexLock cs(_mutex);
+                    stored = isStoredChunk(uaId, addr, hdr, seg);
+                }
+                if (stored)
+                {
+                    reportCorruptChunk(hdr, addr.coords, crc, true);
+                }
+            }
+        }
+    }
+    LOG4CXX_DEBUG(logger, "ChunkScrubber: verified " << nChunks << " chunks, " << nBytes << " bytes");
+}
+
 ///////////////////////////////////////////////////////////////////
 /// DBArrayIterator
 ///////////////////////////////////////////////////////////////////
@@ -2178,7 +4572,12 @@ CachedStorage::DBArrayIterator::DBArrayIterator(CachedStorage* storage,
 
 
 CachedStorage::DBArrayIterator::~DBArrayIterator()
-{}
+{
+    if (_writeBatch)
+    {
+        _storage->releaseWriteBatch(_writeBatch);
+    }
+}
 
 CachedStorage::DBArrayChunk* CachedStorage::DBArrayIterator::getDBArrayChunk(std::shared_ptr<PersistentChunk>& dbChunk)
 {
@@ -2378,7 +4777,8 @@ Chunk& CachedStorage::DBArrayIterator::copyChunk(ConstChunk const& srcChunk,
                     assert(_currChunk);
                     return *_currChunk;
                 }
-                //else new delta code goes here!
+                // else the chunk is copied below; writeChunk() stores it as a delta
+                // from dstChunk when delta encoding is enabled
             }
         }
     }
@@ -2745,7 +5145,7 @@ void CachedStorage::DBArrayChunk::write(const std::shared_ptr<Query>& query)
 
     if (--_nWriters <= 0)
     {
-        _arrayIter._storage->writeChunk(getArrayDesc(), dbChunk, query);
+        _arrayIter._storage->queueChunkWrite(_arrayIter._writeBatch, _arrayIter._array, dbChunk, query);
         _nWriters = 0;
     }
 }
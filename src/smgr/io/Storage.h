@@ -176,10 +176,27 @@ namespace scidb
         }
     };
 
+    /**
+     * A chunk whose data in the datastore did not match its checksum
+     */
+    struct CorruptChunk
+    {
+        ArrayUAID uaid;
+        ArrayID arrId;
+        AttributeID attId;
+        Coordinates coords;
+        uint64_t offs;          /* position of the chunk data in the datastore */
+        uint32_t expectedCrc;   /* checksum recorded when the chunk was written */
+        uint32_t actualCrc;     /* checksum of the data found on disk */
+        time_t detected;
+        bool byScrub;           /* found by the background scrubber rather than a read */
+    };
+
     class ListChunkDescriptorsArrayBuilder;
     class ListChunkMapArrayBuilder;
     class PersistentChunk;
     class ChunkDescriptor;
+    struct ChunkHeader;
     class DataStores;
 
     /**
@@ -190,10 +207,12 @@ namespace scidb
       public:
         typedef boost::function<void(const ArrayUAID&,
                                      const StorageAddress&,
+                                     const ChunkHeader*,
                                      const PersistentChunk*,
                                      uint64_t,
                                      bool)>    ChunkMapVisitor;
         typedef boost::function<void(const ChunkDescriptor&,bool)>                                      ChunkDescriptorVisitor;
+        typedef boost::function<void(const CorruptChunk&)>                                              CorruptChunkVisitor;
 
       public:
         virtual ~Storage() {}
@@ -246,6 +265,15 @@ namespace scidb
          */
         virtual void flush(ArrayUAID uaId = INVALID_ARRAY_ID) = 0;
 
+        /**
+         * Store the chunks of the indicated array version whose writes are
+         * still deferred in write batches.  Writers call it (through
+         * ReplicationContext::replicationSync) once all chunks are written.
+         * @param arrId versioned array ID
+         * @throws the first error met storing the deferred chunks
+         */
+        virtual void flushWriteBatches(ArrayID arrId) {}
+
         /**
          * Close storage manager
          */
@@ -294,6 +322,8 @@ namespace scidb
             uint64_t clusterSize;
             uint64_t nFreeClusters;
             uint64_t nSegments;
+            uint64_t cacheUsed;      // chunk cache heap buffers
+            uint64_t cacheMapped;    // chunk cache mapped from datastores
         };
 
         virtual void getDiskInfo(DiskInfo& info) = 0;
@@ -302,6 +332,12 @@ namespace scidb
 
         virtual uint64_t getUsedMemSize() const = 0;
 
+        /**
+         * @return size of the cached chunks mapped from datastores,
+         *         not included in getUsedMemSize()
+         */
+        virtual uint64_t getMappedMemSize() const = 0;
+
         /**
          * Method for creating a list of chunk descriptors. Implemented by LocalStorage.
          * @param builder a class that creates a list array
@@ -320,6 +356,15 @@ namespace scidb
             throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "chunk map retrieval is not supported by this storage type.";
         }
 
+        /**
+         * Method for creating a list of chunks which failed checksum verification. Implemented by LocalStorage.
+         * @param visitor called for each corrupt chunk found since startup
+         */
+        virtual void visitCorruptChunks(const CorruptChunkVisitor&) const
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "corrupt chunk retrieval is not supported by this storage type.";
+        }
+
         /**
          * Decompress chunk from the specified buffer
          * @param chunk destination chunk to receive decompressed data
@@ -408,6 +453,8 @@ namespace scidb
          * Given an array descriptor and an address of a chunk - compute the InstanceID of the primary instance
          * that shall be responsible for this chunk. Currently this uses our primitive round-robin hashing
          * for all cases except replication. To be improved.
+         * Every instance holds its own copy of a chunk of a replicated (psReplication) array,
+         * so the local instance is the primary instance of the chunks of such arrays.
          * Note the same replication scheme is used for both - regular chunks and tombstones.
          * @param desc the array descriptor
          * @param address the address of the chunk (or tombstone entry)
@@ -155,7 +155,7 @@ void initConfig(int argc, char* argv[])
         (CONFIG_VERSION, 'V', "version", "", "", Config::BOOLEAN, "Version.",
                 false, false)
         (CONFIG_STAT_MONITOR, 0, "stat-monitor", "STAT_MONITOR", "", Config::INTEGER,
-                "Statistics monitor type: 0 - none, 1 - Logger, 2 - Postgres", 0, false)
+                "Statistics monitor type: 0 - none, 1 - Logger, 2 - Postgres, 3 - Logger, one line of counters per query", 0, false)
         (CONFIG_STAT_MONITOR_PARAMS, 0, "stat-monitor-params", "STAT_MONITOR_PARAMS", "STAT_MONITOR_PARAMS",
             Config::STRING, "Parameters for statistics monitor: logger name or connection string", string(""), false)
         (CONFIG_LOG_LEVEL, 0, "log-level", "LOG_LEVEL", "LOG_LEVEL", Config::STRING,
@@ -208,6 +208,28 @@ void initConfig(int argc, char* argv[])
                 "Security mode.", string("trust"), false)
         (CONFIG_ENABLE_CHUNKMAP_RECOVERY, 0, "enable-chunkmap-recovery", "ENABLE_CHUNKMAP_RECOVERY", "", Config::BOOLEAN, "Set to true to enable recovery of corrupt chunk-map entires on startup.", false, false)
         (CONFIG_SKIP_CHUNKMAP_INTEGRITY_CHECK, 0, "skip-chunkmap-integrity-check", "SKIP_CHUNKMAP_INTEGRITY_CHECK", "", Config::BOOLEAN, "Set to true to skip all chunkmap integrity checks on startup.", false, false)
+        (CONFIG_DELTA_CHAIN_LIMIT, 0, "delta-chain-limit", "DELTA_CHAIN_LIMIT", "", Config::INTEGER, "Maximal number of consecutive delta-encoded versions of a chunk before a full version is written (used with enable-delta-encoding).", 8, false)
+        (CONFIG_CHUNKMAP_CHECKPOINT_INTERVAL, 0, "chunkmap-checkpoint-interval", "CHUNKMAP_CHECKPOINT_INTERVAL", "", Config::INTEGER, "Number of chunk descriptor updates after which the chunk map checkpoint used for fast startup is rewritten, 0 to disable the checkpoint.", 100000, false)
+        (CONFIG_CHUNKMAP_LOADED_LIMIT, 0, "chunkmap-loaded-limit", "CHUNKMAP_LOADED_LIMIT", "", Config::INTEGER, "Maximal number of chunk map entries kept in memory; arrays unchanged since the last chunk map checkpoint are evicted and reloaded on access, 0 for no limit.", 0, false)
+        (CONFIG_REPLICATION_BATCH_SIZE, 0, "replication-batch-size", "REPLICATION_BATCH_SIZE", "", Config::INTEGER, "Size in KiB up to which replica chunks for the same instance are batched into one message, 0 to send every replica chunk separately. Batches fill only with async-replication, a synchronous writer sends each chunk as it waits for it.", 1024, false)
+        (CONFIG_REPLICATION_COMPRESSION, 0, "replication-compression", "REPLICATION_COMPRESSION", "", Config::BOOLEAN, "Compress batches of replica chunks with zlib when it makes them smaller.", true, false)
+        (CONFIG_STORAGE_TIERS, 0, "storage-tiers", "STORAGE_TIERS", "", Config::STRING, "Comma separated directories of additional storage tiers, from the fastest to the slowest device. Datastores are created in the storage directory and move between tiers by access frequency.", string(""), false)
+        (CONFIG_STORAGE_TIER_INTERVAL, 0, "storage-tier-interval", "STORAGE_TIER_INTERVAL", "", Config::INTEGER, "Interval in seconds between passes of the storage tier placement policy.", 60, false)
+        (CONFIG_STORAGE_TIER_COLD_SECONDS, 0, "storage-tier-cold-seconds", "STORAGE_TIER_COLD_SECONDS", "", Config::INTEGER, "Number of seconds without access after which a datastore moves to the next slower storage tier, 0 to never demote.", 3600, false)
+        (CONFIG_STORAGE_TIER_HOT_ACCESSES, 0, "storage-tier-hot-accesses", "STORAGE_TIER_HOT_ACCESSES", "", Config::INTEGER, "Number of chunk reads and writes during one storage-tier-interval after which a datastore moves back to the fastest storage tier, 0 to never promote.", 1000, false)
+        (CONFIG_MMAP_MIN_CHUNK_SIZE, 0, "mmap-min-chunk-size", "MMAP_MIN_CHUNK_SIZE", "", Config::INTEGER, "Size in KiB from which uncompressed chunks are mapped from the datastore instead of being read into the chunk cache, 0 to always read. Takes effect for the chunks read after it changes.", 1024, false)
+        (CONFIG_MMAP_CACHE_SIZE, 0, "mmap-cache-size", "MMAP_CACHE_SIZE", "", Config::INTEGER, "Size in MiB of the mapped chunks kept in the chunk cache in addition to smgr-cache-size.", 4096, false)
+        (CONFIG_MMAP_ADVICE, 0, "mmap-advice", "MMAP_ADVICE", "", Config::STRING, "Access pattern hint given to the kernel for mapped chunks [normal | sequential | random | willneed].", string("sequential"), false)
+        (CONFIG_SCRUB_RATE, 0, "scrub-rate", "SCRUB_RATE", "", Config::INTEGER, "Rate in MiB per second at which stored chunks are read back in the background to verify their checksums, 0 to disable scrubbing.", 0, false)
+        (CONFIG_SCRUB_INTERVAL, 0, "scrub-interval", "SCRUB_INTERVAL", "", Config::INTEGER, "Interval in seconds between the end of a scrubbing pass over all stored chunks and the start of the next one.", 86400, false)
+        (CONFIG_WRITE_BATCH_SIZE, 0, "write-batch-size", "WRITE_BATCH_SIZE", "", Config::INTEGER, "Size in KiB of the new chunks an array iterator defers to allocate and write them to the datastore together, 0 to write each chunk at once.", 1024, false)
+        (CONFIG_PLAN_CACHE_SIZE, 0, "plan-cache-size", "PLAN_CACHE_SIZE", "", Config::INTEGER, "Maximum number of physical plans of read-only queries the coordinator keeps for reuse by queries that differ only in their bind parameter values, 0 to disable the cache.", 256, false)
+        (CONFIG_EXCHANGE_WORKERS, 0, "exchange-workers", "EXCHANGE_WORKERS", "", Config::INTEGER, "Number of chunks the optimizer lets an exchange evaluate concurrently on top of each chain of pipelined operators such as apply() and filter(), 0 to insert no exchanges.", 0, false)
+        (CONFIG_STORE_MORSEL_SIZE, 0, "store-morsel-size", "STORE_MORSEL_SIZE", "", Config::INTEGER, "Number of consecutive chunk positions store() and insert() hand at once to each of result-prefetch-threads jobs writing their input in parallel, 0 to write with a single job.", 8, false)
+        (CONFIG_MERGE_FAN_IN, 0, "merge-fan-in", "MERGE_FAN_IN", "", Config::INTEGER, "Number of partial chunks from other instances from which the chunk at a position is merged in groups on up to result-prefetch-threads threads instead of one by one, 0 to always merge one by one.", 8, false)
+        (CONFIG_SG_LOCAL_BYPASS, 0, "sg-local-bypass", "SG_LOCAL_BYPASS", "", Config::BOOLEAN, "Hand the chunks a redistribution keeps on the same instance over uncompressed, by pointer, instead of compressing and decompressing a copy of them.", true, false)
+        (CONFIG_REPART_DISABLE_TILE_MODE, 0, "repart-disable-tile-mode", "REPART_DISABLE_TILE_MODE", "", Config::BOOLEAN, "Repartition arrays of fixed size attributes with redimension cell by cell instead of copying the runs of cells shared by the input and output chunks.", false, false)
+        (CONFIG_BROADCAST_JOIN_THRESHOLD, 0, "broadcast-join-threshold", "BROADCAST_JOIN_THRESHOLD", "", Config::INTEGER, "Estimated size in MiB below which the optimizer replicates the smaller input of join() on every instance instead of redistributing the larger one, 0 to never replicate it.", 64, false)
         ;
 
     cfg->addHook(configHook);
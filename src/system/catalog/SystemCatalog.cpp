@@ -465,17 +465,22 @@ namespace scidb
             }
         }
 
-        string sql1 = "insert into \"array\"(id, name, partitioning_schema, flags) values ($1, $2, $3, $4)";
+        string sql1 = "insert into \"array\"(id, name, partitioning_schema, flags,"
+            " partitioning_dimension, partitioning_block) values ($1, $2, $3, $4, $5, $6)";
         _connection->prepare(sql1, sql1)
             ("bigint", treat_direct)
             ("varchar", treat_string)
             ("integer", treat_direct)
-            ("integer", treat_direct);
+            ("integer", treat_direct)
+            ("integer", treat_direct)
+            ("bigint", treat_direct);
             tr->prepared(sql1)
             (arrId)
             (array_desc.getName())
             ((int) array_desc.getPartitioningSchema())
-            (array_desc.getFlags()).exec();
+            (array_desc.getFlags())
+            ((int) array_desc.getPartitioningDimension())
+            ((int64_t) array_desc.getPartitioningBlock()).exec();
 
         string sql2 = "insert into \"array_attribute\"(array_id, id, name, type, flags, "
         " default_compression_method, reserve, default_missing_reason, default_value) values ($1, $2, $3, $4, $5, $6, $7, $8, $9)";
@@ -1530,11 +1535,14 @@ void SystemCatalog::getArrayInfo(const std::string &array_name,
                                  string& arrName,
                                  int& arrPs,
                                  int& arrFlags,
+                                 int& arrPsDimension,
+                                 int64_t& arrPsBlock,
                                  pqxx::basic_transaction* tr)
 {
     assert(_connection);
 
-    string sql = "select id, name, partitioning_schema, flags from \"array\" where name = $1 and id <= $2";
+    string sql = "select id, name, partitioning_schema, flags, partitioning_dimension, partitioning_block"
+        " from \"array\" where name = $1 and id <= $2";
     _connection->prepare(sql, sql)
     ("varchar", treat_string)
     ("bigint", treat_direct);
@@ -1549,6 +1557,8 @@ void SystemCatalog::getArrayInfo(const std::string &array_name,
     arrName  = query_res[0].at("name").as(string());
     arrFlags = query_res[0].at("flags").as(int());
     arrPs    = query_res[0].at("partitioning_schema").as(int());
+    arrPsDimension = query_res[0].at("partitioning_dimension").as(int());
+    arrPsBlock     = query_res[0].at("partitioning_block").as(int64_t());
 }
 
 void SystemCatalog::_getArrayDesc(const std::string &array_name,
@@ -1564,12 +1574,16 @@ void SystemCatalog::_getArrayDesc(const std::string &array_name,
     int flags(0);
     string metadataArrName;
     int ps(0);
+    int psDimension(0);
+    int64_t psBlock(1);
     getArrayInfo(array_name,
                  catalogVersion,
                  array_id,
                  metadataArrName,
                  ps,
                  flags,
+                 psDimension,
+                 psBlock,
                  tr);
     assert(metadataArrName == array_name);
 
@@ -1670,6 +1684,7 @@ void SystemCatalog::_getArrayDesc(const std::string &array_name,
                       defaultPartitioning(),
                       flags);
     newDesc.setPartitioningSchema(PartitioningSchema(ps));
+    newDesc.setPartitioningDimension(psDimension, psBlock);
     array_desc = newDesc;
 
     assert(array_desc.getUAId()!=0);
@@ -1702,7 +1717,8 @@ void SystemCatalog::_getArrayDesc(const std::string &array_name,
         try
         {
             work tr(*_connection);
-            string sql1 = "select id, name, partitioning_schema, flags from \"array\" where id = $1";
+            string sql1 = "select id, name, partitioning_schema, flags, partitioning_dimension, partitioning_block"
+                " from \"array\" where id = $1";
             _connection->prepare("find-by-id", sql1)("bigint", treat_direct);
             result query_res1 = tr.prepared("find-by-id")(array_id).exec();
             if (query_res1.size() <= 0)
@@ -1804,6 +1820,8 @@ void SystemCatalog::_getArrayDesc(const std::string &array_name,
                                                                  defaultPartitioning(),
                                                                  query_res1[0].at("flags").as(int())));
             newDesc->setPartitioningSchema((PartitioningSchema)query_res1[0].at("partitioning_schema").as(int()));
+            newDesc->setPartitioningDimension(query_res1[0].at("partitioning_dimension").as(int()),
+                                              query_res1[0].at("partitioning_block").as(int64_t()));
             tr.commit();
         }
         catch (const broken_connection &e)
@@ -3115,6 +3133,200 @@ VersionID SystemCatalog::_getLastVersion(const ArrayID array_id,
     }
 
 
+    void SystemCatalog::addView(ArrayID viewId, ArrayID sourceId, ArrayID sourceVersionId,
+                                const string& definition)
+    {
+        boost::function<void()> work = boost::bind(&SystemCatalog::_addView,
+                this, viewId, sourceId, sourceVersionId, boost::cref(definition));
+        Query::runRestartableWork<void, broken_connection>(work, _reconnectTries);
+    }
+
+    void SystemCatalog::_addView(ArrayID viewId, ArrayID sourceId, ArrayID sourceVersionId,
+                                 const string& definition)
+    {
+        LOG4CXX_TRACE(logger, "SystemCatalog::addView( viewId = " << viewId
+                      << ", sourceId = " << sourceId
+                      << ", sourceVersionId = " << sourceVersionId << ")");
+
+        ScopedMutexLock mutexLock(_pgLock);
+
+        assert(_connection);
+
+        try
+        {
+            work tr(*_connection);
+
+            string sql1 = "insert into \"array_view\"(array_id, source_array_id, source_version_array_id, definition)"
+                " values ($1, $2, $3, $4)";
+            _connection->prepare("addView", sql1)
+                ("bigint", treat_direct)
+                ("bigint", treat_direct)
+                ("bigint", treat_direct)
+                ("varchar", treat_string);
+            tr.prepared("addView")
+                (viewId)
+                (sourceId)
+                (sourceVersionId)
+                (definition).exec();
+            _connection->unprepare("addView");
+            tr.commit();
+        }
+        catch (const broken_connection &e)
+        {
+            throw;
+        }
+        catch (const sql_error &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_PG_QUERY_EXECUTION_FAILED) << e.query() << e.what();
+        }
+        catch (const pqxx::failure &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_UNKNOWN_ERROR) << e.what();
+        }
+    }
+
+    bool SystemCatalog::getView(ArrayID viewId, ArrayID& sourceId, ArrayID& sourceVersionId,
+                                string& definition)
+    {
+        boost::function<bool()> work = boost::bind(&SystemCatalog::_getView,
+                this, viewId, boost::ref(sourceId), boost::ref(sourceVersionId), boost::ref(definition));
+        return Query::runRestartableWork<bool, broken_connection>(work, _reconnectTries);
+    }
+
+    bool SystemCatalog::_getView(ArrayID viewId, ArrayID& sourceId, ArrayID& sourceVersionId,
+                                 string& definition)
+    {
+        LOG4CXX_TRACE(logger, "SystemCatalog::getView( viewId = " << viewId << ")");
+
+        ScopedMutexLock mutexLock(_pgLock);
+
+        assert(_connection);
+        bool rc = false;
+        try
+        {
+            work tr(*_connection);
+
+            string sql1 = "select source_array_id, source_version_array_id, definition"
+                " from \"array_view\" where array_id = $1";
+            _connection->prepare("getView", sql1)
+                ("bigint", treat_direct);
+            result query_res = tr.prepared("getView")
+                (viewId).exec();
+            if (query_res.size() > 0) {
+                sourceId = query_res[0].at("source_array_id").as(int64_t());
+                sourceVersionId = query_res[0].at("source_version_array_id").as(int64_t());
+                definition = query_res[0].at("definition").as(string());
+                rc = true;
+            }
+            _connection->unprepare("getView");
+            tr.commit();
+        }
+        catch (const broken_connection &e)
+        {
+            throw;
+        }
+        catch (const sql_error &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_PG_QUERY_EXECUTION_FAILED) << e.query() << e.what();
+        }
+        catch (const pqxx::failure &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_UNKNOWN_ERROR) << e.what();
+        }
+        return rc;
+    }
+
+    void SystemCatalog::updateView(ArrayID viewId, ArrayID sourceVersionId)
+    {
+        boost::function<void()> work = boost::bind(&SystemCatalog::_updateView,
+                this, viewId, sourceVersionId);
+        Query::runRestartableWork<void, broken_connection>(work, _reconnectTries);
+    }
+
+    void SystemCatalog::_updateView(ArrayID viewId, ArrayID sourceVersionId)
+    {
+        LOG4CXX_TRACE(logger, "SystemCatalog::updateView( viewId = " << viewId
+                      << ", sourceVersionId = " << sourceVersionId << ")");
+
+        ScopedMutexLock mutexLock(_pgLock);
+
+        assert(_connection);
+
+        try
+        {
+            work tr(*_connection);
+            string sql1 = "update \"array_view\" set source_version_array_id = $2 where array_id = $1";
+            _connection->prepare("updateView", sql1)
+                ("bigint", treat_direct)
+                ("bigint", treat_direct);
+            tr.prepared("updateView")
+                (viewId)
+                (sourceVersionId).exec();
+            _connection->unprepare("updateView");
+            tr.commit();
+        }
+        catch (const broken_connection &e)
+        {
+            throw;
+        }
+        catch (const sql_error &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_PG_QUERY_EXECUTION_FAILED) << e.query() << e.what();
+        }
+        catch (const pqxx::failure &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_UNKNOWN_ERROR) << e.what();
+        }
+    }
+
+    bool SystemCatalog::findView(ArrayID sourceId, string& viewName)
+    {
+        boost::function<bool()> work = boost::bind(&SystemCatalog::_findView,
+                this, sourceId, boost::ref(viewName));
+        return Query::runRestartableWork<bool, broken_connection>(work, _reconnectTries);
+    }
+
+    bool SystemCatalog::_findView(ArrayID sourceId, string& viewName)
+    {
+        LOG4CXX_TRACE(logger, "SystemCatalog::findView( sourceId = " << sourceId << ")");
+
+        ScopedMutexLock mutexLock(_pgLock);
+
+        assert(_connection);
+        bool rc = false;
+        try
+        {
+            work tr(*_connection);
+
+            string sql1 = "select ARR.name from \"array_view\" as V, \"array\" as ARR"
+                " where V.source_array_id = $1 and ARR.id = V.array_id order by ARR.name limit 1";
+            _connection->prepare("findView", sql1)
+                ("bigint", treat_direct);
+            result query_res = tr.prepared("findView")
+                (sourceId).exec();
+            if (query_res.size() > 0) {
+                viewName = query_res[0].at("name").as(string());
+                rc = true;
+            }
+            _connection->unprepare("findView");
+            tr.commit();
+        }
+        catch (const broken_connection &e)
+        {
+            throw;
+        }
+        catch (const sql_error &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_PG_QUERY_EXECUTION_FAILED) << e.query() << e.what();
+        }
+        catch (const pqxx::failure &e)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_SYSCAT, SCIDB_LE_UNKNOWN_ERROR) << e.what();
+        }
+        return rc;
+    }
+
+
     SystemCatalog::SystemCatalog() :
     _initialized(false),
     _connection(NULL),
@@ -0,0 +1,20 @@
+--upgrade from 3 to 4
+
+
+-- ---------------------------------------------------------------------
+-- CREATE TABLES
+-- ---------------------------------------------------------------------
+
+-- ---------------------------------------------------------------------
+create table "array_view"
+(
+  array_id bigint primary key references "array" (id) on delete cascade,
+  source_array_id bigint references "array" (id) on delete cascade,
+  source_version_array_id bigint,
+  definition varchar
+);
+
+-- ---------------------------------------------------------------------
+-- CLUSTER VERSION UPDATE
+-- ---------------------------------------------------------------------
+update "cluster" set metadata_version = 4;
@@ -0,0 +1,15 @@
+--upgrade from 4 to 5
+
+
+-- ---------------------------------------------------------------------
+-- ALTER TABLES
+-- ---------------------------------------------------------------------
+
+-- ---------------------------------------------------------------------
+alter table "array" add column partitioning_dimension integer default 0;
+alter table "array" add column partitioning_block bigint default 1;
+
+-- ---------------------------------------------------------------------
+-- CLUSTER VERSION UPDATE
+-- ---------------------------------------------------------------------
+update "cluster" set metadata_version = 5;
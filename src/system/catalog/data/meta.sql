@@ -28,6 +28,7 @@ drop table if exists "libraries" cascade;
 drop table if exists "users" cascade;
 drop table if exists "namespaces" cascade;
 drop table if exists "namespace_members" cascade;
+drop table if exists "array_view" cascade;
 
 -- ---------------------------------------------------------------------
 -- DROP SEQUENCES
@@ -99,6 +100,13 @@ create table "cluster"
 --                     0. Replication of the array's contents on all instances.
 --                     1. Round Robin allocation of chunks to instances.
 --
+-- public.array.partitioning_dimension - for range and co-partitioned arrays,
+--                     the number of the dimension chunks are placed by.
+--
+-- public.array.partitioning_block - for range and co-partitioned arrays, the
+--                     number of consecutive chunks along that dimension placed
+--                     on the same instance.
+--
 -- public.array.flags - records details about the array's status.
 --
 --
@@ -107,7 +115,9 @@ create table "array"
   id bigint primary key default nextval('array_id_seq'),
   name varchar unique,
   partitioning_schema integer,
-  flags integer
+  flags integer,
+  partitioning_dimension integer default 0,
+  partitioning_block bigint default 1
 );
 --
 --   Table: public.array_version
@@ -382,6 +392,33 @@ create table "namespace_members"
   primary key(namespace_id, array_id)
 );
 
+--
+--  Table: public.array_view
+--
+--  Materialized aggregate views, see the create_view() operator.
+--
+--  public.array_view.array_id - The array.id of the (unversioned) array
+--      holding the partial aggregate states of the view
+--
+--  public.array_view.source_array_id - The array.id of the (unversioned)
+--      array the view aggregates
+--
+--  public.array_view.source_version_array_id - The array.id of the source
+--      array version the view was last refreshed to
+--
+--  public.array_view.definition - The aggregate calls and the grouping
+--      dimensions of the view
+--
+--
+create table "array_view"
+(
+  array_id bigint primary key references "array" (id) on delete cascade,
+  source_array_id bigint references "array" (id) on delete cascade,
+  source_version_array_id bigint,
+  definition varchar
+);
+
+
 
 create or replace function uuid_generate_v1()
 returns uuid
@@ -389,7 +426,7 @@ as '$libdir/uuid-ossp', 'uuid_generate_v1'
 volatile strict language C;
 
 
--- The version number (3) corresponds to the var METADATA_VERSION from Constants.h
+-- The version number (5) corresponds to the var METADATA_VERSION from Constants.h
 -- If we start and find that cluster.metadata_version is less than METADATA_VERSION
 -- upgrade. The upgrade files are provided as sql scripts in
 -- src/system/catalog/data/[NUMBER].sql. They are converted to string
@@ -397,7 +434,7 @@ volatile strict language C;
 -- and then linked in at build time.
 -- @see SystemCatalog::connect(const string&, bool)
 -- Note: there is no downgrade path at the moment.
-insert into "cluster" values (uuid_generate_v1(), 3);
+insert into "cluster" values (uuid_generate_v1(), 5);
 
 insert into users (name, password, method) values (
     'root',
@@ -0,0 +1,116 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file CRC32C.cpp
+ * @brief Implementation of the CRC-32C checksum
+ */
+
+#include <string.h>
+#include <util/CRC32C.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace scidb
+{
+
+namespace
+{
+/* Lookup table of the reflected Castagnoli polynomial for the portable version
+ */
+class CRC32CTable
+{
+public:
+    uint32_t entries[256];
+
+    CRC32CTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; ++k)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+const CRC32CTable crc32cTable;
+
+uint32_t crc32cPortable(unsigned char const* p, size_t length, uint32_t crc)
+{
+    while (length-- != 0)
+    {
+        crc = (crc >> 8) ^ crc32cTable.entries[(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(unsigned char const* p, size_t length, uint32_t crc)
+{
+    uint64_t crc64 = crc;
+    while (length >= sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += sizeof(word);
+        length -= sizeof(word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (length-- != 0)
+    {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+bool detectHardwareCRC32C()
+{
+    __builtin_cpu_init(); // needed before main()
+    return __builtin_cpu_supports("sse4.2");
+}
+
+const bool haveHardwareCRC32C = detectHardwareCRC32C();
+#endif
+}
+
+uint32_t calculateCRC32C(void const* content, size_t length, uint32_t crc)
+{
+    unsigned char const* p = static_cast<unsigned char const*>(content);
+    crc = ~crc;
+#if defined(__x86_64__)
+    if (haveHardwareCRC32C)
+    {
+        return ~crc32cHardware(p, length, crc);
+    }
+#endif
+    return ~crc32cPortable(p, length, crc);
+}
+
+}
@@ -43,6 +43,7 @@ void CoordinatesMapper::init(CoordinateCRange f,CoordinateCRange l)
     _origin.assign(f.begin(),f.end());
     _nDims  = f.size();
     _chunkIntervals.resize(f.size());
+    _divisors.resize(f.size());
     _logicalChunkSize = 1;
 
     for (size_t i=0; i!=_nDims; ++i)
@@ -50,9 +51,24 @@ void CoordinatesMapper::init(CoordinateCRange f,CoordinateCRange l)
         assert(l[i] >= _origin[i]);
 
         _chunkIntervals[i] = l[i] - _origin[i] + 1;
+        _divisors[i] = FastDivisor(_chunkIntervals[i]);
         _logicalChunkSize *= _chunkIntervals[i];
     }
 
+    switch (_nDims)
+    {
+        case 1:  _pos2coord = &CoordinatesMapper::pos2coordFixed<1>;
+                 _coord2pos = &CoordinatesMapper::coord2posFixed<1>; break;
+        case 2:  _pos2coord = &CoordinatesMapper::pos2coordFixed<2>;
+                 _coord2pos = &CoordinatesMapper::coord2posFixed<2>; break;
+        case 3:  _pos2coord = &CoordinatesMapper::pos2coordFixed<3>;
+                 _coord2pos = &CoordinatesMapper::coord2posFixed<3>; break;
+        case 4:  _pos2coord = &CoordinatesMapper::pos2coordFixed<4>;
+                 _coord2pos = &CoordinatesMapper::coord2posFixed<4>; break;
+        default: _pos2coord = &CoordinatesMapper::pos2coordFixed<0>;
+                 _coord2pos = &CoordinatesMapper::coord2posFixed<0>; break;
+    }
+
     assert(!_origin.empty());
 }
 
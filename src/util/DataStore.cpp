@@ -36,7 +36,10 @@
       chunk that spans the entire file.
  */
 
+#include <sys/mman.h>
+#include <limits.h>
 #include <log4cxx/logger.h>
+#include <boost/algorithm/string.hpp>
 #include <util/DataStore.h>
 #include <util/Platform.h>
 #include <util/FileIO.h>
@@ -55,6 +58,12 @@ static log4cxx::LoggerPtr logger(log4cxx::Logger::getLogger("scidb.smgr.datastor
 const size_t DataStore::DiskChunkHeader::usedValue = 0xfeedfacefeedface;
 const size_t DataStore::DiskChunkHeader::freeValue = 0xdeadbeefdeadbeef;
 
+/* Unused tail of a chunk which a gather write may fill with zeros to reach
+   the next chunk, rather than issuing a separate write
+ */
+static const size_t MAX_WRITE_GAP = 64*KiB;
+static const char zeroGap[MAX_WRITE_GAP] = { 0 };
+
 /* Construct an flb structure from a bucket on the free list
  */
 DataStore::FreelistBucket::FreelistBucket(size_t key, std::set<off_t>& bucket)
@@ -178,6 +187,7 @@ DataStore::allocateSpace(size_t requestedSize, size_t& allocatedSize)
                   _file->getPath());
 
     invalidateFreelistFile();
+    ++_changes;
 
     /* Round up required size to next power-of-two
      */
@@ -209,6 +219,77 @@ DataStore::allocateSpace(size_t requestedSize, size_t& allocatedSize)
     return ret;
 }
 
+/* Find space for several chunks written together: they are laid out
+   one after the other, in order, within a single extent
+ */
+void
+DataStore::allocateSpace(std::vector<size_t> const& requestedSizes,
+                         std::vector<off_t>& offsets,
+                         std::vector<size_t>& allocatedSizes)
+{
+    const size_t n = requestedSizes.size();
+    offsets.resize(n);
+    allocatedSizes.resize(n);
+    if (n == 1)
+    {
+        offsets[0] = allocateSpace(requestedSizes[0], allocatedSizes[0]);
+        return;
+    }
+    if (n == 0)
+    {
+        return;
+    }
+
+    ScopedMutexLock sm(_dslock);
+
+    invalidateFreelistFile();
+    ++_changes;
+
+    /* Lay the power-of-two blocks out relative to the start of the extent.
+       The extent is aligned on its own size, which is at least that of any
+       block, so aligning a block within the extent aligns it in the file.
+     */
+    size_t extentUsed = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t requiredSize = requestedSizes[i] + sizeof(DiskChunkHeader);
+        if (requiredSize < _dsm->getMinAllocSize())
+            requiredSize = _dsm->getMinAllocSize();
+        requiredSize = roundUpPowerOf2(requiredSize);
+
+        extentUsed = (extentUsed + requiredSize - 1) & ~(requiredSize - 1);
+        offsets[i] = extentUsed;
+        allocatedSizes[i] = requiredSize;
+        extentUsed += requiredSize;
+    }
+    const size_t extentSize = roundUpPowerOf2(extentUsed);
+
+    if (extentSize > _largestFreeChunk)
+    {
+        makeMoreSpace(extentSize);
+    }
+    SCIDB_ASSERT(extentSize <= _largestFreeChunk);
+    const off_t base = searchFreelist(extentSize);
+
+    /* Return the alignment holes between blocks and the tail of the
+       extent to the free lists
+     */
+    off_t end = base;
+    for (size_t i = 0; i < n; ++i)
+    {
+        offsets[i] += base;
+        addRangeToFreelist(end, offsets[i]);
+        end = offsets[i] + allocatedSizes[i];
+    }
+    addRangeToFreelist(end, base + extentSize);
+
+    calcLargestFreeChunk();
+
+    LOG4CXX_TRACE(logger, "datastore: allocate space for " << n << " chunks in "
+                  << _file->getPath() << " returned extent " << base
+                  << " of size " << extentSize);
+}
+
 /* Write bytes to the DataStore, to a location that is already
    allocated
  */
@@ -233,6 +314,78 @@ DataStore::writeData(off_t off,
     /* Issue the write
      */
     _file->writeAllv(iovs, 2, off);
+    ++_changes;
+    noteAccess();
+
+    /* Update the dirty flag and schedule flush if necessary
+     */
+    if (!_dirty)
+    {
+        _dirty = true;
+        _dsm->getFlusher().add(_guid);
+    }
+}
+
+/* Write several chunks to the DataStore, gathering back to back chunks
+   into a single write
+ */
+void
+DataStore::writeData(std::vector<off_t> const& offsets,
+                     std::vector<void const*> const& buffers,
+                     std::vector<size_t> const& lens,
+                     std::vector<size_t> const& allocatedSizes)
+{
+    ScopedMutexLock sm(_dslock);
+
+    const size_t n = offsets.size();
+    std::vector<DiskChunkHeader> hdrs;
+    hdrs.reserve(n);   // the iovecs point into hdrs
+    std::vector<struct iovec> iovs;
+    iovs.reserve(std::min(n * 3, size_t(IOV_MAX)));
+    off_t runStart = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        SCIDB_ASSERT(i == 0 || offsets[i] > offsets[i - 1]);
+
+        if (iovs.empty())
+        {
+            runStart = offsets[i];
+        }
+        hdrs.push_back(DiskChunkHeader(false, allocatedSizes[i]));
+
+        struct iovec iov;
+        iov.iov_base = (char*) &hdrs.back();
+        iov.iov_len = sizeof(DiskChunkHeader);
+        iovs.push_back(iov);
+        iov.iov_base = (char*) buffers[i];
+        iov.iov_len = lens[i];
+        iovs.push_back(iov);
+
+        /* Extend the write to the next chunk if it starts right after this
+           one's allocated block, filling the unused tail of the block
+         */
+        const size_t gap = allocatedSizes[i] - sizeof(DiskChunkHeader) - lens[i];
+        if (i + 1 < n &&
+            offsets[i + 1] == offsets[i] + off_t(allocatedSizes[i]) &&
+            gap <= MAX_WRITE_GAP &&
+            iovs.size() + 3 <= size_t(IOV_MAX))
+        {
+            if (gap != 0)
+            {
+                iov.iov_base = (char*) zeroGap;
+                iov.iov_len = gap;
+                iovs.push_back(iov);
+            }
+        }
+        else
+        {
+            _file->writeAllv(&iovs[0], iovs.size(), runStart);
+            iovs.clear();
+        }
+    }
+    ++_changes;
+    noteAccess();
 
     /* Update the dirty flag and schedule flush if necessary
      */
@@ -246,7 +399,7 @@ DataStore::writeData(off_t off,
 /* Read a chunk from the DataStore
  */
 void
-DataStore::readData(off_t off, void* buffer, size_t len)
+DataStore::readData(off_t off, void* buffer, size_t len, bool countAccess)
 {
     DiskChunkHeader hdr;
     struct iovec iovs[2];
@@ -258,26 +411,245 @@ DataStore::readData(off_t off, void* buffer, size_t len)
     iovs[1].iov_base = (char*) buffer;
     iovs[1].iov_len = len;
 
+    /* The file may be switched by a migration to another tier
+     */
+    File::FilePtr file;
+    {
+        ScopedMutexLock sm(_dslock);
+        if (countAccess)
+        {
+            noteAccess();
+        }
+        file = _file;
+    }
+
     /* Issue the read
      */
-    _file->readAllv(iovs, 2, off);
+    file->readAllv(iovs, 2, off);
 
     /* Check validity of header
      */
     if (!hdr.isValid())
     {
         throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_DATASTORE_CHUNK_CORRUPTED)
-            << _file->getPath() << off;
+            << file->getPath() << off;
     }
 }
 
+/* Map a chunk of the DataStore into memory
+ */
+void*
+DataStore::mapData(off_t off, size_t len, int advice, void*& mapping, size_t& mappedLen)
+{
+    static const off_t pageSize = ::sysconf(_SC_PAGESIZE);
+
+    File::FilePtr file;
+    {
+        ScopedMutexLock sm(_dslock);
+        noteAccess();
+        file = _file;
+    }
+
+    /* The mapping must start on a page boundary, the chunk header follows
+     */
+    off_t start = off & ~(pageSize - 1);
+    mappedLen = (off - start) + sizeof(DiskChunkHeader) + len;
+    mapping = file->mmap(mappedLen, start);
+
+    DiskChunkHeader* hdr =
+        reinterpret_cast<DiskChunkHeader*>(static_cast<char*>(mapping) + (off - start));
+    if (!hdr->isValid())
+    {
+        ::munmap(mapping, mappedLen);
+        mapping = NULL;
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_DATASTORE_CHUNK_CORRUPTED)
+            << file->getPath() << off;
+    }
+    if (advice != MADV_NORMAL && ::madvise(mapping, mappedLen, advice) != 0)
+    {
+        LOG4CXX_DEBUG(logger, "datastore: madvise failed for " << file->getPath()
+                      << " errno " << errno);
+    }
+    return hdr + 1;
+}
+
+/* Count a read or write for the tier placement policy
+   @pre caller has locked the DataStore
+ */
+void
+DataStore::noteAccess()
+{
+    ++_accesses;
+    _lastAccess = ::time(NULL);
+}
+
+/* Set the data store to be removed from disk on close
+ */
+void
+DataStore::removeOnClose()
+{
+    ScopedMutexLock sm(_dslock);
+    _removed = true;
+    ++_changes;
+    _file->removeOnClose();
+}
+
+/* Return the number of accesses since the previous call and the
+   idle time
+ */
+void
+DataStore::takeAccessStats(uint64_t& accesses, time_t& idleSeconds)
+{
+    ScopedMutexLock sm(_dslock);
+    accesses = _accesses;
+    idleSeconds = ::time(NULL) - _lastAccess;
+    _accesses = 0;
+}
+
+namespace
+{
+/* Copy size bytes from the beginning of one file to another
+ */
+void copyFileData(File::FilePtr const& src, File::FilePtr const& dst, off_t size)
+{
+    const size_t blockSize = 1024*1024;
+    boost::scoped_array<char> buf(new char[blockSize]);
+    for (off_t off = 0; off < size; off += blockSize)
+    {
+        size_t len = std::min(static_cast<off_t>(blockSize), size - off);
+        src->readAll(buf.get(), len, off);
+        dst->writeAll(buf.get(), len, off);
+    }
+    if (dst->fsync() != 0)
+    {
+        throw USER_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED) <<
+            "fsync " + dst->getPath();
+    }
+}
+}
+
+/* Move the data store to the storage root of another tier
+ */
+bool
+DataStore::migrate(size_t tier, std::string const& filename)
+{
+    /* Make the data and free-list files consistent on disk, then copy
+       them without holding the lock so that queries are not blocked.
+     */
+    flush();
+
+    File::FilePtr src;
+    uint64_t changes = 0;
+    off_t size = 0;
+    {
+        ScopedMutexLock sm(_dslock);
+        if (tier == _tier || _removed)
+        {
+            return false;
+        }
+        src = _file;
+        changes = _changes;
+        size = _allocatedSize;
+    }
+
+    LOG4CXX_DEBUG(logger, "datastore: migrating " << src->getPath() << " to tier "
+                  << tier << " as " << filename);
+
+    std::string tmpname = filename + ".migrating";
+    File::FilePtr dst =
+        FileManager::getInstance()->openFileObj(tmpname, O_LARGEFILE | O_RDWR | O_CREAT | O_TRUNC);
+    if (!dst)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE)
+            << tmpname << ::strerror(errno) << errno;
+    }
+    try
+    {
+        copyFileData(src, dst, size);
+
+        File::FilePtr srcfl = FileManager::getInstance()->openFileObj(src->getPath() + ".fl", O_RDONLY);
+        struct stat st;
+        if (srcfl && srcfl->fstat(&st) == 0 && st.st_size > 0)
+        {
+            File::FilePtr dstfl =
+                FileManager::getInstance()->openFileObj(filename + ".fl", O_RDWR | O_CREAT | O_TRUNC);
+            if (!dstfl)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE)
+                    << filename + ".fl" << ::strerror(errno) << errno;
+            }
+            copyFileData(srcfl, dstfl, st.st_size);
+        }
+    }
+    catch (Exception const&)
+    {
+        dst->removeOnClose();
+        File::remove((filename + ".fl").c_str(), false);
+        throw;
+    }
+
+    ScopedMutexLock sm(_dslock);
+
+    if (_removed || _changes != changes || _file != src)
+    {
+        /* Removed or written meanwhile, in the latter case the placement
+           pass will try again later
+         */
+        LOG4CXX_DEBUG(logger, "datastore: " << src->getPath()
+                      << (_removed ? " removed" : " changed") << " during migration");
+        dst->removeOnClose();
+        File::remove((filename + ".fl").c_str(), false);
+        return false;
+    }
+
+    /* Publish the copy under its final name.  If we crash before the
+       original is removed DataStores::findDataStoreFile() keeps the copy,
+       which is the most recently modified.
+     */
+    dst.reset();
+    if (::rename(tmpname.c_str(), filename.c_str()) != 0)
+    {
+        int err = errno;
+        File::remove(tmpname.c_str(), false);
+        File::remove((filename + ".fl").c_str(), false);
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_SYSCALL_ERROR)
+            << "rename" << -1 << err << ::strerror(err) << tmpname;
+    }
+
+    /* The new directory entries must be durable before the original goes away
+     */
+    std::string dirname = filename.substr(0, filename.find_last_of('/') + 1);
+    if (File::syncDir(dirname.empty() ? std::string(".") : dirname) != 0)
+    {
+        int err = errno;
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_SYSCALL_ERROR)
+            << "fsync" << -1 << err << ::strerror(err) << dirname;
+    }
+    File::FilePtr moved = FileManager::getInstance()->openFileObj(filename, O_LARGEFILE | O_RDWR);
+    if (!moved)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_OPEN_FILE)
+            << filename << ::strerror(errno) << errno;
+    }
+
+    /* Readers still holding the original finish with it before it is unlinked
+     */
+    File::remove((src->getPath() + ".fl").c_str(), false);
+    src->removeOnClose();
+    _file = moved;
+    _tier = tier;
+
+    LOG4CXX_INFO(logger, "datastore: " << _guid << " moved to tier " << tier);
+    return true;
+}
+
 /* Flush dirty data and metadata for the DataStore
  */
 void
 DataStore::flush()
 {
-    LOG4CXX_TRACE(logger, "DataStore::flush for ds " << _file->getPath());
     ScopedMutexLock sm(_dslock);
+    LOG4CXX_TRACE(logger, "DataStore::flush for ds " << _file->getPath());
 
     if (_dirty)
     {
@@ -308,6 +680,7 @@ DataStore::freeChunk(off_t off, size_t allocated)
                   _file->getPath());
 
     invalidateFreelistFile();
+    ++_changes;
 
     /* Update the free list
      */
@@ -629,13 +1002,13 @@ DataStore::verifyFreelistInternal()
 }
 
 /* Remove the free-list file from disk
-   @pre caller has locked the DataStore
  */
 void
 DataStore::removeFreelistFile()
 {
     /* Try to remove the freelist file
      */
+    ScopedMutexLock sm(_dslock);
     std::string filename = _file->getPath() + ".fl";
     File::remove(filename.c_str(), false);
 }
@@ -648,14 +1021,19 @@ DataStore::~DataStore()
 
 /* Construct a new DataStore object
  */
-DataStore::DataStore(char const* filename, Guid guid, DataStores& parent) :
+DataStore::DataStore(char const* filename, Guid guid, DataStores& parent, size_t tier) :
     _dsm(&parent),
     _dslock(),
     _guid(guid),
     _frees(0),
     _largestFreeChunk(0),
     _dirty(false),
-    _fldirty(false)
+    _fldirty(false),
+    _tier(tier),
+    _changes(0),
+    _removed(false),
+    _accesses(0),
+    _lastAccess(::time(NULL))
 {
     /* Open the file
      */
@@ -826,6 +1204,29 @@ DataStore::addToFreelist(size_t bucket, off_t off)
     }
 }
 
+/* Add the unused range [from, to) of the file to the free lists
+ */
+void
+DataStore::addRangeToFreelist(off_t from, off_t to)
+{
+    while (from < to)
+    {
+        /* Largest power-of-two block that fits and is aligned at from
+         */
+        size_t block = roundUpPowerOf2(to - from);
+        if (off_t(block) > to - from)
+        {
+            block /= 2;
+        }
+        while (from % block != 0)
+        {
+            block /= 2;
+        }
+        addToFreelist(block, from);
+        from += block;
+    }
+}
+
 /* Update the largest free chunk member
  */
 void
@@ -844,7 +1245,7 @@ DataStore::calcLargestFreeChunk()
 /* Initialize the global DataStore state
  */
 void
-DataStores::initDataStores(char const* basepath)
+DataStores::initDataStores(char const* basepath, std::string const& tiers)
 {
     ScopedMutexLock sm(_dataStoreLock);
 
@@ -854,12 +1255,31 @@ DataStores::initDataStores(char const* basepath)
         _basePath += "/";
         _minAllocSize = Config::getInstance()->getOption<int>(CONFIG_STORAGE_MIN_ALLOC_SIZE_BYTES);
 
-        /* Create the datastore directory if necessary
+        /* Collect the storage roots of the slower tiers
+         */
+        _initTime = ::time(NULL);
+        _tierPaths.clear();
+        _tierPaths.push_back(_basePath);
+        vector<string> roots;
+        boost::split(roots, tiers, boost::is_any_of(","));
+        for (size_t i = 0; i < roots.size(); ++i)
+        {
+            boost::trim(roots[i]);
+            if (!roots[i].empty())
+            {
+                _tierPaths.push_back(roots[i] + "/");
+            }
+        }
+
+        /* Create the datastore directories if necessary
          */
-        if (!File::createDir(_basePath))
+        for (size_t i = 0; i < _tierPaths.size(); ++i)
         {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_CREATE_DIRECTORY)
-                << _basePath;
+            if (!File::createDir(_tierPaths[i]))
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_CANT_CREATE_DIRECTORY)
+                    << _tierPaths[i];
+            }
         }
 
         /* Start background flusher
@@ -872,12 +1292,75 @@ DataStores::initDataStores(char const* basepath)
 
         _theDataStores = new DataStoreMap();
 
+        /* Start tier placement
+         */
+        if (_tierPaths.size() > 1)
+        {
+            _dsmigrator.start(
+                Config::getInstance()->getOption<int>(CONFIG_STORAGE_TIER_INTERVAL));
+        }
+
         /* Start error listener
          */
         _listener.start();
     }
 }
 
+/* Return the path of the data file in the given tier
+ */
+std::string
+DataStores::getDataStorePath(DataStore::Guid guid, size_t tier) const
+{
+    SCIDB_ASSERT(tier < _tierPaths.size());
+    stringstream filepath;
+    filepath << _tierPaths[tier] << guid << ".data";
+    return filepath.str();
+}
+
+/* Find the tier holding the data file
+ */
+std::string
+DataStores::findDataStoreFile(DataStore::Guid guid, size_t& tier)
+{
+    tier = 0;
+    if (_tierPaths.size() == 1)
+    {
+        return getDataStorePath(guid, 0);
+    }
+
+    bool found = false;
+    struct timespec newest = { 0, 0 };
+    for (size_t i = 0; i < _tierPaths.size(); ++i)
+    {
+        struct stat st;
+        string path = getDataStorePath(guid, i);
+        if (::stat(path.c_str(), &st) != 0)
+        {
+            continue;
+        }
+        if (found &&
+            (st.st_mtim.tv_sec < newest.tv_sec ||
+             (st.st_mtim.tv_sec == newest.tv_sec && st.st_mtim.tv_nsec <= newest.tv_nsec)))
+        {
+            LOG4CXX_WARN(logger, "DataStores: removing stale copy " << path);
+            File::remove(path.c_str(), false);
+            File::remove((path + ".fl").c_str(), false);
+            continue;
+        }
+        if (found)
+        {
+            string stale = getDataStorePath(guid, tier);
+            LOG4CXX_WARN(logger, "DataStores: removing stale copy " << stale);
+            File::remove(stale.c_str(), false);
+            File::remove((stale + ".fl").c_str(), false);
+        }
+        found = true;
+        newest = st.st_mtim;
+        tier = i;
+    }
+    return getDataStorePath(guid, tier);
+}
+
 /* Get a reference to a specific DataStore
  */
 std::shared_ptr<DataStore>
@@ -899,11 +1382,12 @@ DataStores::getDataStore(DataStore::Guid guid)
 
     /* Not found, construct the object
      */
-    stringstream filepath;
-    filepath << _basePath << guid << ".data";
-    retval = std::make_shared<DataStore>(filepath.str().c_str(),
+    size_t tier = 0;
+    string filepath = findDataStoreFile(guid, tier);
+    retval = std::make_shared<DataStore>(filepath.c_str(),
                                            guid,
-                                           boost::ref(*this));
+                                           boost::ref(*this),
+                                           tier);
     (*_theDataStores)[guid] = retval;
 
     return retval;
@@ -929,15 +1413,16 @@ DataStores::closeDataStore(DataStore::Guid guid, bool remove)
          */
         if (remove)
         {
-            stringstream filepath;
-            filepath << _basePath << guid << ".data";
+            size_t tier = 0;
+            string filepath = findDataStoreFile(guid, tier);
             it =
                 _theDataStores->insert(
                     make_pair(
                         guid,
-                        std::make_shared<DataStore>(filepath.str().c_str(),
+                        std::make_shared<DataStore>(filepath.c_str(),
                                                       guid,
-                                                      boost::ref(*this))
+                                                      boost::ref(*this),
+                                                      tier)
                         )
                     ).first;
         }
@@ -991,14 +1476,25 @@ DataStores::flushAllDataStores()
     }
 }
 
-/* Clear all datastore files from the basepath
+/* Clear all datastore files from the basepath and the other tiers
  */
 void
 DataStores::clearAllDataStores()
+{
+    for (size_t i = 0; i < _tierPaths.size(); ++i)
+    {
+        clearDataStoreDir(_tierPaths[i]);
+    }
+}
+
+/* Clear all datastore files from one storage root
+ */
+void
+DataStores::clearDataStoreDir(std::string const& basePath)
 {
     /* Try to open the base dir
      */
-    DIR* dirp = ::opendir(_basePath.c_str());
+    DIR* dirp = ::opendir(basePath.c_str());
 
     if (dirp == NULL)
     {
@@ -1006,7 +1502,7 @@ DataStores::clearAllDataStores()
         return;
     }
 
-    boost::function<int()> f = boost::bind(&File::closeDir, _basePath.c_str(), dirp, false);
+    boost::function<int()> f = boost::bind(&File::closeDir, basePath.c_str(), dirp, false);
     scidb::Destructor<boost::function<int()> >  dirCloser(f);
 
     struct dirent entry;
@@ -1027,23 +1523,26 @@ DataStores::clearAllDataStores()
 
         LOG4CXX_TRACE(logger, "DataStores::clearAllDataStores: found entry " << entry.d_name);
 
-        /* If its a datastore or fl file, go ahead and try to remove it
+        /* If its a datastore, fl or interrupted migration file, go ahead and try to remove it
          */
         size_t entrylen = strlen(entry.d_name);
         size_t fllen = strlen(".fl");
         size_t datalen = strlen(".data");
+        size_t miglen = strlen(".migrating");
         const char* entryend = entry.d_name + entrylen;
 
-        /* Check if entry ends in ".fl" or ".data"
+        /* Check if entry ends in ".fl", ".data" or ".migrating"
          */
         if (((entrylen > fllen) &&
              (strcmp(entryend - fllen, ".fl") == 0)) ||
             ((entrylen > datalen) &&
-             (strcmp(entryend - datalen, ".data") == 0))
+             (strcmp(entryend - datalen, ".data") == 0)) ||
+            ((entrylen > miglen) &&
+             (strcmp(entryend - miglen, ".migrating") == 0))
             )
         {
             LOG4CXX_TRACE(logger, "DataStores::clearAllDataStores: deleting entry " << entry.d_name);
-            std::string fullpath = _basePath + "/" + entry.d_name;
+            std::string fullpath = basePath + "/" + entry.d_name;
             File::remove(fullpath.c_str(), false);
         }
     }
@@ -1064,10 +1563,98 @@ DataStores::visitDataStores(const Visitor& visit) const
     }
 }
 
+/* Apply the tier placement policy to the datastores
+ */
+void
+DataStores::migrateDataStores()
+{
+    const uint64_t hotAccesses =
+        Config::getInstance()->getOption<int>(CONFIG_STORAGE_TIER_HOT_ACCESSES);
+    const time_t coldSeconds =
+        Config::getInstance()->getOption<int>(CONFIG_STORAGE_TIER_COLD_SECONDS);
+
+    vector< std::shared_ptr<DataStore> > stores;
+    {
+        ScopedMutexLock sm(_dataStoreLock);
+        SCIDB_ASSERT(_theDataStores);
+        for (DataStoreMap::iterator it = _theDataStores->begin();
+             it != _theDataStores->end();
+             ++it)
+        {
+            stores.push_back(it->second);
+        }
+    }
+
+    for (size_t i = 0; i < stores.size(); ++i)
+    {
+        uint64_t accesses = 0;
+        time_t idle = 0;
+        stores[i]->takeAccessStats(accesses, idle);
+        size_t tier = stores[i]->getTier();
+
+        /* Hot data goes back to the fastest tier, cold data sinks one tier at a time
+         */
+        size_t target = tier;
+        if (tier > 0 && hotAccesses > 0 && accesses >= hotAccesses)
+        {
+            target = 0;
+        }
+        else if (tier + 1 < _tierPaths.size() && coldSeconds > 0 && idle >= coldSeconds)
+        {
+            target = tier + 1;
+        }
+        if (target != tier)
+        {
+            stores[i]->migrate(target, getDataStorePath(stores[i]->getGuid(), target));
+        }
+    }
+
+    /* Datastores not opened since startup have no access statistics, they
+       are cold once startup and their last modification are old enough.
+       They stay open after moving down so the next passes track them.
+     */
+    const time_t now = ::time(NULL);
+    if (coldSeconds <= 0 || now - _initTime < coldSeconds)
+    {
+        return;
+    }
+    set<DataStore::Guid> open;
+    for (size_t i = 0; i < stores.size(); ++i)
+    {
+        open.insert(stores[i]->getGuid());
+    }
+    for (size_t tier = 0; tier + 1 < _tierPaths.size(); ++tier)
+    {
+        list<string> entries;
+        File::readDir(_tierPaths[tier].c_str(), entries);
+        for (list<string>::const_iterator e = entries.begin(); e != entries.end(); ++e)
+        {
+            char* end = NULL;
+            const DataStore::Guid guid = strtoull(e->c_str(), &end, 10);
+            if (end == e->c_str() || strcmp(end, ".data") != 0 || open.count(guid) != 0)
+            {
+                continue;
+            }
+            struct stat st;
+            const string path = _tierPaths[tier] + *e;
+            if (::stat(path.c_str(), &st) != 0 || now - st.st_mtime < coldSeconds)
+            {
+                continue;
+            }
+            std::shared_ptr<DataStore> ds = getDataStore(guid);
+            if (ds->getTier() == tier)
+            {
+                ds->migrate(tier + 1, getDataStorePath(guid, tier + 1));
+            }
+        }
+    }
+}
+
 /* Destroy the DataStores object
  */
 DataStores::~DataStores()
 {
+    _dsmigrator.stop();
     _dsflusher.stop();
     _listener.stop();
 }
@@ -1207,5 +1794,89 @@ DataStoreFlusher::~DataStoreFlusher()
     stop();
 }
 
-} // namespace scidb
+/* Main loop for DataStoreMigrator
+ */
+void
+DataStoreMigrator::MigrateJob::run()
+{
+    while (true)
+    {
+        /* Sleep in short steps so that stop() does not wait for a whole interval
+         */
+        for (int i = 0; i < _timeIntervalSecs; ++i)
+        {
+            if (!_migrator->isRunning())
+            {
+                return;
+            }
+            ::sleep(1);
+        }
+        if (!_migrator->isRunning())
+        {
+            return;
+        }
+
+        try
+        {
+            _migrator->_dsm.migrateDataStores();
+        }
+        catch (Exception const& e)
+        {
+            LOG4CXX_ERROR(logger, "DataStoreMigrator: migration failed: " << e.what());
+        }
+    }
+}
+
+/* Start the data store migrator
+ */
+void
+DataStoreMigrator::start(int timeIntervalSecs)
+{
+    ScopedMutexLock cs(_lock);
+    if (_running)
+    {
+        throw SYSTEM_EXCEPTION(SCIDB_SE_STORAGE, SCIDB_LE_OPERATION_FAILED) <<
+            "DataStoreMigrator: error on start; already running";
+    }
+
+    _running = true;
+
+    if (!_threadPool->isStarted())
+    {
+        _threadPool->start();
+    }
+    _myJob.reset(new MigrateJob(std::max(timeIntervalSecs, 1), this));
+    _queue->pushJob(_myJob);
+}
 
+/* Shut down the data store migrator
+ */
+void
+DataStoreMigrator::stop()
+{
+    {
+        ScopedMutexLock cs(_lock);
+        if (_running)
+        {
+            _running = false;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    if(!_myJob->wait())
+    {
+        LOG4CXX_ERROR(logger, "DataStoreMigrator: error on stop.");
+    }
+}
+
+/* Destroy the migrator
+ */
+DataStoreMigrator::~DataStoreMigrator()
+{
+    stop();
+}
+
+} // namespace scidb
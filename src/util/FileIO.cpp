@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
+#include <sys/mman.h>
 #include <dirent.h>
 #include <string.h>
 #include <boost/function.hpp>
@@ -175,6 +176,25 @@ namespace scidb
         return rc;
     }
 
+    /* Fsync a directory (restarting after signal interrupt if necessary)
+     */
+    int
+    File::syncDir(const std::string& dirPath)
+    {
+        int fd = File::openFile(dirPath, O_RDONLY | O_DIRECTORY);
+        if (fd < 0) {
+            return -1;
+        }
+        int rc = 0;
+        do {
+            rc = ::fsync(fd);
+        } while (rc != 0 && errno == EINTR);
+        int err = errno;
+        File::closeFd(fd);
+        errno = err;
+        return rc;
+    }
+
     /* Open a file (restarting after signal interrupt if necessary)
      */
     int
@@ -594,6 +614,28 @@ namespace scidb
         return rc;
     }
 
+    /* Map a region of the file into memory
+     */
+    void*
+    File::mmap(size_t size, uint64_t offs)
+    {
+        /* Verify that the fd is open
+         */
+        checkClosedByUser();
+        FileMonitor fm(_fm, *this);
+
+        assert(_fd >= 0);
+        assert(_pin);
+
+        void* addr = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _fd, offs);
+        if (addr == MAP_FAILED)
+        {
+            throw (SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_SYSCALL_ERROR)
+                   << "mmap" << -1 << errno << ::strerror(errno) << _path);
+        }
+        return addr;
+    }
+
 
     /* ftruncate a file (restarting after signal interrupt in necessary)
      */
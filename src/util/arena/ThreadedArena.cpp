@@ -22,6 +22,10 @@
 
 /****************************************************************************/
 
+#include <algorithm>                                     // For fill
+#include <atomic>                                        // For atomic
+#include <map>                                           // For map
+#include <vector>                                        // For vector
 #include <util/arena/ArenaDecorator.h>                   // For ArenaDecorator
 #include <util/Mutex.h>                                  // For Mutex
 #include "ArenaDetails.h"                                // For implementation
@@ -76,12 +80,333 @@ class ThreadedArena : public ArenaDecorator
 
 /****************************************************************************/
 
+/**
+ *  @brief      Caches small blocks in per-thread free lists in front of a
+ *              ThreadedArena.
+ *
+ *  @details    Class CachingArena removes most of the contention on the mutex
+ *              of a ThreadedArena that is shared by many worker threads, as a
+ *              query or operator %arena is when its containers are filled in
+ *              parallel. Blocks of up to 'classes' * 'granule' bytes are taken
+ *              from the delegate in batches of the same size class under one
+ *              acquisition of the mutex, handed out from and returned to a free
+ *              list owned by the calling thread, and given back to the delegate
+ *              in batches once a list grows beyond its capacity.
+ *
+ *              Each thread's cache has a mutex of its own that only the thread
+ *              itself takes in the normal course of events, so is uncontended;
+ *              it exists so that flush() can drain the caches of every thread.
+ *              We flush before reporting our statistics, before checkpointing,
+ *              when reset, and when destroyed, so the figures seen by both the
+ *              monitor and the parent %arena are exact at those points, and in
+ *              particular when the query ends. The delegate counts blocks at
+ *              the size of their class, however,  and sees cached blocks as in
+ *              use in between. If the delegate is exhausted we flush and retry
+ *              once, so cached blocks never cause a LimitedArena to throw early.
+ *
+ *              Blocks are rounded up to their size class when allocated  from
+ *              the delegate, which is only safe because every block of a given
+ *              class goes back to the delegate at that same size.
+ */
+class CachingArena : public ThreadedArena
+{
+ public:                   // Construction
+                              CachingArena(const ArenaPtr& p);
+                             ~CachingArena();
+
+ public:                   // Attributes
+    virtual size_t            available()                const                 {flush();return ThreadedArena::available();}
+    virtual size_t            allocated()                const                 {flush();return ThreadedArena::allocated();}
+    virtual size_t            allocations()              const                 {flush();return ThreadedArena::allocations();}
+    virtual void              checkpoint(name_t l)       const                 {flush();return ThreadedArena::checkpoint(l);}
+    virtual void              insert(std::ostream& o)    const                 {flush();return ThreadedArena::insert(o);}
+
+ public:                   // Operations
+    virtual void*             allocate(size_t n)                               {return Arena::allocate(n);}
+    virtual void*             allocate(size_t n,finalizer_t f)                 {return Arena::allocate(n,f);}
+    virtual void*             allocate(size_t n,finalizer_t f,count_t c)       {return Arena::allocate(n,f,c);}
+    virtual void              recycle(void* p)                                 {return Arena::recycle(p);}
+    virtual void              destroy(void* p,count_t c)                       {return Arena::destroy(p,c);}
+    virtual void              reset()                                          {flush();return ThreadedArena::reset();}
+
+ public:                   // Implementation
+    virtual void*             doMalloc(size_t);
+    virtual void              doFree  (void*,size_t);
+
+ private:                  // Size classes
+    static  size_t const      granule = 16;              // Class spacing
+    static  size_t const      classes = 64;              // Largest is 1 KiB
+    static  size_t            sizeClass(size_t n)                              {return (n + granule - 1) / granule - 1;}
+    static  size_t            classSize(size_t c)                              {return (c + 1) * granule;}
+    static  size_t            capacity (size_t c)                              {size_t n = 4*KiB / classSize(c);return n < 4 ? 4 : n > 64 ? 64 : n;}
+    static  size_t            batch    (size_t c)                              {return capacity(c) / 2;}
+
+ private:                  // Per-thread caches
+    struct Cache
+    {
+        struct Link {Link* next;};                       // Threads free list
+                              Cache();
+            void              push(size_t c,void* p)                           {Link* l = static_cast<Link*>(p);l->next = heads[c];heads[c] = l;++counts[c];}
+            void*             pop (size_t c)                                   {Link* l = heads[c];heads[c] = l->next;--counts[c];return l;}
+
+            Mutex     mutable mutex;                     // Guards the lists
+            std::atomic<bool> retired;                   // Arena has gone
+            Link*             heads [classes];           // The free lists
+            size_t            counts[classes];           // Their lengths
+    };
+    typedef std::shared_ptr<Cache>  CachePtr;
+
+            Cache&            getCache()                 const;
+            void              refill(Cache&,size_t c)    const;
+            void              drain (Cache&,size_t c,size_t n) const;
+            void              flush()                    const;
+
+ private:                  // Representation
+            uint64_t    const _serial;                   // Unique identifier
+    mutable std::vector<CachePtr> _caches;               // Guarded by _mutex
+};
+
+namespace {
+std::atomic<uint64_t> cachingArenaSerial(0);             // Last serial issued
+__thread uint64_t     lastCachingArena = 0;              // Serial of arena...
+__thread void*        lastCache        = 0;              // ...and its cache
+}
+
+    CachingArena::Cache::Cache()
+                : retired(false)
+{
+    std::fill(heads, heads + classes,static_cast<Link*>(0));
+    std::fill(counts,counts+ classes,size_t(0));
+}
+
+    CachingArena::CachingArena(const ArenaPtr& p)
+                : ThreadedArena(p),
+                  _serial(++cachingArenaSerial)
+{}
+
+    CachingArena::~CachingArena()
+{
+    flush();                                             // Return all blocks
+
+    for (CachePtr const& k : _caches)                    // For each cache
+    {
+        k->retired = true;                               // ...owner may drop
+    }
+}
+
+/**
+ *  Return the cache of the calling thread,  creating and registering it first
+ *  if this is the first time the thread has called us. The last cache we hand
+ *  out is remembered, so the common case costs just a comparison; otherwise a
+ *  thread-local map finds it, and the caches of arenas that have since gone
+ *  away are dropped from this map as we go.
+ */
+CachingArena::Cache& CachingArena::getCache() const
+{
+    if (lastCachingArena == _serial)                     // Same as last time?
+    {
+        return *static_cast<Cache*>(lastCache);          // ...the common case
+    }
+
+    thread_local std::map<uint64_t,CachePtr> caches;     // Caches for thread
+
+    CachePtr& k = caches[_serial];                       // Find or insert
+
+    if (!k)                                              // First call here?
+    {
+        for (auto i = caches.begin(); i != caches.end(); )
+        {
+            if (i->second && i->second->retired)         // ...arena is gone?
+            {
+                i = caches.erase(i);                     // ....so drop it
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        k = std::make_shared<Cache>();                   // ...new cache
+        ScopedMutexLock x(_mutex);                       // ...and register
+        _caches.push_back(k);                            // ...it with us
+    }
+
+    lastCachingArena = _serial;                          // Remember for next
+    lastCache        = k.get();                          // time we're called
+    return *static_cast<Cache*>(lastCache);
+}
+
+/**
+ *  Allocate a batch of blocks of class 'c' from the delegate %arena under one
+ *  acquisition of the mutex and push them onto the cache 'k',  whose mutex the
+ *  caller holds. Throws only if not even one block could be allocated.
+ */
+void CachingArena::refill(Cache& k,size_t c) const
+{
+    size_t const s = classSize(c);                       // Size of each block
+    ScopedMutexLock x(_mutex);                           // Lock the delegate
+
+    for (size_t i = 0,n = batch(c); i != n; ++i)         // For each block
+    {
+        void* p;
+
+        try
+        {
+            p = _arena->doMalloc(s);                     // ...allocate it
+        }
+        catch (Exhausted&)
+        {
+            if (i == 0)                                  // ...got nothing?
+            {
+                throw;                                   // ....then give up
+            }
+            break;                                       // ...make do
+        }
+
+        k.push(c,p);                                     // ...cache it
+    }
+}
+
+/**
+ *  Return the first 'n' blocks of class 'c' in the cache 'k',  whose mutex the
+ *  caller holds, to the delegate %arena under one acquisition of the mutex.
+ */
+void CachingArena::drain(Cache& k,size_t c,size_t n) const
+{
+    if (n == 0)                                          // Nothing to drain?
+    {
+        return;                                          // ...all done
+    }
+
+    size_t const s = classSize(c);                       // Size of each block
+    ScopedMutexLock x(_mutex);                           // Lock the delegate
+
+    for (size_t i = 0; i != n; ++i)                      // For each block
+    {
+        _arena->doFree(k.pop(c),s);                      // ...give it back
+    }
+}
+
+/**
+ *  Return every cached block of every thread to the delegate %arena,  so that
+ *  its statistics are once again exact, and forget the caches of threads that
+ *  have since exited.
+ */
+void CachingArena::flush() const
+{
+    std::vector<CachePtr> caches;                        // Copy of the list
+
+    {
+        ScopedMutexLock x(_mutex);                       // Lock the list
+        caches = _caches;                                // ...and copy it
+    }
+
+    for (CachePtr const& k : caches)                     // For each cache
+    {
+        ScopedMutexLock y(k->mutex);                     // ...lock it
+
+        for (size_t c = 0; c != classes; ++c)            // ...each class
+        {
+            drain(*k,c,k->counts[c]);                    // ....drain it all
+        }
+    }
+
+    caches.clear();                                      // Drop our copies
+
+    ScopedMutexLock x(_mutex);                           // Lock the list
+
+    for (auto i = _caches.begin(); i != _caches.end(); )
+    {
+        if (i->use_count() == 1)                         // Thread has exited?
+        {
+            i = _caches.erase(i);                        // ...forget cache
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+/**
+ *  Allocate 'size' bytes of raw storage, from the cache of the calling thread
+ *  if the request is small enough, and from the delegate %arena otherwise.
+ */
+void* CachingArena::doMalloc(size_t size)
+{
+    assert(size != 0);                                   // Validate arguments
+
+    if (size > classes * granule)                        // Too big to cache?
+    {
+        ScopedMutexLock x(_mutex);                       // ...lock delegate
+        return _arena->doMalloc(size);                   // ...and pass it on
+    }
+
+    size_t const c = sizeClass(size);                    // The size class
+
+    try
+    {
+        Cache& k(getCache());                            // Our thread's cache
+        ScopedMutexLock y(k.mutex);                      // ...uncontended
+
+        if (k.heads[c] == 0)                             // ...list is empty?
+        {
+            refill(k,c);                                 // ....fill it up
+        }
+
+        return k.pop(c);                                 // ...take the first
+    }
+    catch (Exhausted&)
+    {}
+
+ /* The delegate is out of memory, but some of it may be sitting in the caches
+    of our threads, so give it all back and try again, this time just the once
+    and without caching...*/
+
+    flush();                                             // Return all blocks
+    ScopedMutexLock x(_mutex);                           // Lock the delegate
+    return _arena->doMalloc(classSize(c));               // Try again or throw
+}
+
+/**
+ *  Return the 'size' bytes at 'payload' to the cache of the calling thread if
+ *  it is small enough, draining a batch of the blocks of its class should the
+ *  list now exceed its capacity, and to the delegate %arena otherwise.
+ */
+void CachingArena::doFree(void* payload,size_t size)
+{
+    assert(aligned(payload) && size!=0);                 // Validate arguments
+
+    if (size > classes * granule)                        // Too big to cache?
+    {
+        ScopedMutexLock x(_mutex);                       // ...lock delegate
+        return _arena->doFree(payload,size);             // ...and pass it on
+    }
+
+    size_t const c = sizeClass(size);                    // The size class
+    Cache&       k(getCache());                          // Our thread's cache
+    ScopedMutexLock y(k.mutex);                          // ...uncontended
+
+    k.push(c,payload);                                   // Cache the block
+
+    if (k.counts[c] > capacity(c))                       // Too many cached?
+    {
+        drain(k,c,batch(c));                             // ...give some back
+    }
+}
+
+/****************************************************************************/
+
 /**
  *  Add support for thread locking to the %arena o.parent() if it does not yet
  *  support this feature.
  *
  *  Notice that it is an error to try to add thread locking to an %arena whose
  *  parent %arena does not also support this feature.
+ *
+ *  Recycling arenas are given a per-thread cache of small blocks as well,  but
+ *  not when debugging, so that leaks and guard overwrites are caught as soon
+ *  as the allocations are returned.
  */
 ArenaPtr addThreading(const Options& o)
 {
@@ -94,6 +419,11 @@ ArenaPtr addThreading(const Options& o)
         return p;                                        // ...no need to add
     }
 
+    if (p->supports(recycling) && !p->supports(debugging))
+    {
+        return std::make_shared<CachingArena>(p);        // Cache small blocks
+    }
+
     return std::make_shared<ThreadedArena>(p);         // Attach decoration
 }
 
@@ -0,0 +1,103 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file ArenaBenchmarks.h
+ *
+ * @brief Allocation and release of small blocks of memory by the arenas.
+ */
+
+#ifndef ARENA_BENCHMARKS_H_
+#define ARENA_BENCHMARKS_H_
+
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <system/Constants.h>
+#include <util/Arena.h>
+
+#include "MicroBenchmark.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+static size_t const ARENA_BLOCKS = 1 << 12;
+
+static arena::ArenaPtr makeRootArena()
+{
+    return arena::getArena();
+}
+
+static arena::ArenaPtr makeLimitedArena()
+{
+    return arena::newArena(arena::Options("micro_benchmark_limited").limited(arena::getArena(), 1 * GiB));
+}
+
+static arena::ArenaPtr makeScopedArena()
+{
+    return arena::newArena(arena::Options("micro_benchmark_scoped").scoped(arena::getArena()));
+}
+
+static arena::ArenaPtr makeLeaArena()
+{
+    return arena::newArena(arena::Options("micro_benchmark_lea").lea(arena::getArena(), 1 * MiB));
+}
+
+/**
+ * Allocate ARENA_BLOCKS blocks of 8 to 512 bytes, then recycle them one by one if the
+ * arena supports it, or else reset the arena.
+ */
+static void allocateBlocks(BenchmarkState& state, arena::ArenaPtr (*makeArena)())
+{
+    arena::ArenaPtr a = makeArena();
+    bool const recycling = a->supports(arena::recycling);
+    std::vector<void*> blocks(ARENA_BLOCKS);
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        for (size_t j = 0; j < ARENA_BLOCKS; ++j) {
+            blocks[j] = a->allocate(8 + (j * 37) % 505);
+        }
+        if (recycling) {
+            for (size_t j = 0; j < ARENA_BLOCKS; ++j) {
+                a->recycle(blocks[j]);
+            }
+        } else {
+            a->reset();
+        }
+    }
+    state.stop();
+    state.setItemsPerIteration(ARENA_BLOCKS);
+}
+
+MICRO_BENCHMARK("arena/root", boost::bind(&allocateBlocks, _1, &makeRootArena));
+MICRO_BENCHMARK("arena/limited", boost::bind(&allocateBlocks, _1, &makeLimitedArena));
+MICRO_BENCHMARK("arena/scoped", boost::bind(&allocateBlocks, _1, &makeScopedArena));
+MICRO_BENCHMARK("arena/lea", boost::bind(&allocateBlocks, _1, &makeLeaArena));
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* ARENA_BENCHMARKS_H_ */
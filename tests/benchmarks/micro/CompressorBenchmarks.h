@@ -0,0 +1,117 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file CompressorBenchmarks.h
+ *
+ * @brief Compression and decompression of a chunk by every registered compressor.
+ */
+
+#ifndef COMPRESSOR_BENCHMARKS_H_
+#define COMPRESSOR_BENCHMARKS_H_
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <array/Compressor.h>
+#include <array/MemChunk.h>
+
+#include "MicroBenchmark.h"
+#include "MemChunkBenchmarks.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+/// The chunk compressed by the benchmarks, runs of 8 equal values out of a thousand
+static MemChunk const& getCompressorInput()
+{
+    static MemChunk chunk;
+    if (chunk.getConstData() == NULL) {
+        writeVectorChunk(chunk, 8);
+    }
+    return chunk;
+}
+
+static void compressChunk(BenchmarkState& state, Compressor* compressor)
+{
+    MemChunk const& chunk = getCompressorInput();
+    std::vector<char> buffer(chunk.getSize());
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        size_t compressedSize = compressor->compress(&buffer[0], chunk);
+        doNotOptimize(compressedSize);
+    }
+    state.stop();
+    state.setBytesPerIteration(chunk.getSize());
+}
+
+static void decompressChunk(BenchmarkState& state, Compressor* compressor)
+{
+    MemChunk const& chunk = getCompressorInput();
+    std::vector<char> buffer(chunk.getSize());
+    size_t const compressedSize = compressor->compress(&buffer[0], chunk);
+
+    MemChunk output;
+    output.initialize(chunk);
+    output.allocate(chunk.getSize());
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        if (compressedSize == chunk.getSize()) {
+            // the storage keeps the data of chunks it cannot compress as is
+            memcpy(output.getDataForLoad(), chunk.getConstData(), compressedSize);
+        } else {
+            size_t decompressedSize = compressor->decompress(&buffer[0], compressedSize, output);
+            doNotOptimize(decompressedSize);
+        }
+    }
+    state.stop();
+    state.setBytesPerIteration(chunk.getSize());
+}
+
+/**
+ * Register a compression and a decompression benchmark for every compressor of the
+ * CompressorFactory. This must be called from main(), after the factory is constructed.
+ */
+inline void registerCompressorBenchmarks()
+{
+    std::vector<Compressor*> const& compressors = CompressorFactory::getInstance().getCompressors();
+    for (size_t i = 0; i < compressors.size(); ++i) {
+        std::string const name = compressors[i]->getName();
+        BenchmarkRegistrar(("compression/" + name + "_compress").c_str(),
+                           boost::bind(&compressChunk, _1, compressors[i]));
+        BenchmarkRegistrar(("compression/" + name + "_decompress").c_str(),
+                           boost::bind(&decompressChunk, _1, compressors[i]));
+    }
+}
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* COMPRESSOR_BENCHMARKS_H_ */
@@ -0,0 +1,131 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file CoordinatesMapperBenchmarks.h
+ *
+ * @brief Conversions between the coordinates of cells and their positions in a chunk.
+ */
+
+#ifndef COORDINATES_MAPPER_BENCHMARKS_H_
+#define COORDINATES_MAPPER_BENCHMARKS_H_
+
+#include <boost/bind.hpp>
+
+#include <util/CoordinatesMapper.h>
+
+#include "MicroBenchmark.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+static size_t const MAPPER_CELLS = 1 << 20;
+
+/**
+ * A mapper of a chunk of MAPPER_CELLS cells with nDims dimensions, the intervals of
+ * all but the first of which are 16, and whose first cell is not at the origin.
+ */
+static CoordinatesMapper makeMapper(size_t nDims)
+{
+    Coordinates first(nDims), last(nDims);
+    size_t interval = MAPPER_CELLS;
+    for (size_t i = nDims; i-- > 0; ) {
+        size_t const length = i == 0 ? interval : 16;
+        first[i] = 1000 * (i + 1);
+        last[i] = first[i] + length - 1;
+        interval /= length;
+    }
+    return CoordinatesMapper(first, last);
+}
+
+static void mapperPos2coord(BenchmarkState& state, size_t nDims)
+{
+    CoordinatesMapper const mapper = makeMapper(nDims);
+    Coordinates coords(nDims);
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        for (position_t pos = 0; pos < static_cast<position_t>(MAPPER_CELLS); ++pos) {
+            mapper.pos2coord(pos, coords);
+            doNotOptimize(coords[nDims - 1]);
+        }
+    }
+    state.stop();
+    state.setItemsPerIteration(MAPPER_CELLS);
+}
+
+static void mapperCoord2pos(BenchmarkState& state, size_t nDims)
+{
+    CoordinatesMapper const mapper = makeMapper(nDims);
+    std::vector<Coordinates> cells(MAPPER_CELLS, Coordinates(nDims));
+    for (size_t pos = 0; pos < MAPPER_CELLS; ++pos) {
+        mapper.pos2coord(pos, cells[pos]);
+    }
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        position_t sum = 0;
+        for (size_t j = 0; j < MAPPER_CELLS; ++j) {
+            sum += mapper.coord2pos(cells[j]);
+        }
+        doNotOptimize(sum);
+    }
+    state.stop();
+    state.setItemsPerIteration(MAPPER_CELLS);
+}
+
+/// Step through the coordinates of every cell in order, as chunk iterators do
+static void mapperAdvance(BenchmarkState& state, size_t nDims)
+{
+    CoordinatesMapper const mapper = makeMapper(nDims);
+    Coordinates coords(nDims);
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        mapper.pos2coord(0, coords);
+        for (size_t pos = 1; pos < MAPPER_CELLS; ++pos) {
+            mapper.advance(coords);
+            doNotOptimize(coords[nDims - 1]);
+        }
+    }
+    state.stop();
+    state.setItemsPerIteration(MAPPER_CELLS);
+}
+
+MICRO_BENCHMARK("coordinates_mapper/pos2coord_1d", boost::bind(&mapperPos2coord, _1, 1));
+MICRO_BENCHMARK("coordinates_mapper/pos2coord_2d", boost::bind(&mapperPos2coord, _1, 2));
+MICRO_BENCHMARK("coordinates_mapper/pos2coord_3d", boost::bind(&mapperPos2coord, _1, 3));
+MICRO_BENCHMARK("coordinates_mapper/pos2coord_4d", boost::bind(&mapperPos2coord, _1, 4));
+MICRO_BENCHMARK("coordinates_mapper/coord2pos_1d", boost::bind(&mapperCoord2pos, _1, 1));
+MICRO_BENCHMARK("coordinates_mapper/coord2pos_2d", boost::bind(&mapperCoord2pos, _1, 2));
+MICRO_BENCHMARK("coordinates_mapper/coord2pos_3d", boost::bind(&mapperCoord2pos, _1, 3));
+MICRO_BENCHMARK("coordinates_mapper/coord2pos_4d", boost::bind(&mapperCoord2pos, _1, 4));
+MICRO_BENCHMARK("coordinates_mapper/advance_2d", boost::bind(&mapperAdvance, _1, 2));
+MICRO_BENCHMARK("coordinates_mapper/advance_3d", boost::bind(&mapperAdvance, _1, 3));
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* COORDINATES_MAPPER_BENCHMARKS_H_ */
@@ -0,0 +1,92 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file ExpressionBenchmarks.h
+ *
+ * @brief Evaluation of compiled scalar expressions, one cell at a time.
+ */
+
+#ifndef EXPRESSION_BENCHMARKS_H_
+#define EXPRESSION_BENCHMARKS_H_
+
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <query/Expression.h>
+#include <query/TypeSystem.h>
+
+#include "MicroBenchmark.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+static size_t const EXPRESSION_CELLS = 1 << 16;
+
+/**
+ * Evaluate an expression of the variables a, b, c and x over EXPRESSION_CELLS values of x.
+ * @param expression the expression, in AFL
+ * @param type the type of all the variables
+ */
+static void evaluateExpression(BenchmarkState& state, std::string const& expression, TypeId const& type)
+{
+    std::vector<std::string> names;
+    names.push_back("a");
+    names.push_back("b");
+    names.push_back("c");
+    names.push_back("x");
+    std::vector<TypeId> types(names.size(), type);
+
+    Expression e;
+    e.compile(expression, names, types);
+    ExpressionContext ec(e);
+    for (size_t i = 0; i < 3; ++i) {
+        DoubleToValue(type, i + 2, ec[i]);
+    }
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        for (size_t x = 0; x < EXPRESSION_CELLS; ++x) {
+            DoubleToValue(type, x, ec[3]);
+            Value const& result = e.evaluate(ec);
+            doNotOptimize(result);
+        }
+    }
+    state.stop();
+    state.setItemsPerIteration(EXPRESSION_CELLS);
+}
+
+MICRO_BENCHMARK("expression/polynomial_int64",
+                boost::bind(&evaluateExpression, _1, "a*x*x+b*x+c", TID_INT64));
+MICRO_BENCHMARK("expression/polynomial_double",
+                boost::bind(&evaluateExpression, _1, "a*x*x+b*x+c", TID_DOUBLE));
+MICRO_BENCHMARK("expression/predicate_int64",
+                boost::bind(&evaluateExpression, _1, "x > a and x % b = c or x = 0", TID_INT64));
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* EXPRESSION_BENCHMARKS_H_ */
@@ -0,0 +1,193 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file MemChunkBenchmarks.h
+ *
+ * @brief Writing and reading the cells of a stand-alone MemChunk.
+ */
+
+#ifndef MEM_CHUNK_BENCHMARKS_H_
+#define MEM_CHUNK_BENCHMARKS_H_
+
+#include <math.h>
+
+#include <string>
+#include <boost/bind.hpp>
+
+#include <array/Compressor.h>
+#include <array/MemChunk.h>
+#include <array/Metadata.h>
+#include <util/CoordinatesMapper.h>
+#include <query/TypeSystem.h>
+
+#include "MicroBenchmark.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+static size_t const CHUNK_CELLS = 1 << 18;
+
+/// The schema of a vector of int64 values held in a single chunk
+static ArrayDesc const& getVectorSchema()
+{
+    static ArrayDesc schema;
+    if (schema.getDimensions().empty()) {
+        Attributes attributes;
+        attributes.push_back(AttributeDesc(0, "v", TID_INT64, 0, CompressorFactory::NO_COMPRESSION));
+        Dimensions dimensions;
+        dimensions.push_back(DimensionDesc("i", 0, CHUNK_CELLS - 1, CHUNK_CELLS, 0));
+        schema = ArrayDesc("micro_benchmark_vector", attributes, dimensions, defaultPartitioning());
+    }
+    return schema;
+}
+
+/**
+ * Write every cell of a chunk of the vector schema in order.
+ * @param runLength the number of consecutive cells holding the same value
+ */
+static void writeVectorChunk(MemChunk& chunk, size_t runLength)
+{
+    ArrayDesc const& schema = getVectorSchema();
+    Address address(0, Coordinates(1, 0));
+    chunk.initialize(NULL, &schema, address, CompressorFactory::NO_COMPRESSION);
+
+    std::shared_ptr<Query> noQuery;  // a stand-alone MemChunk is written without a query
+    std::shared_ptr<ChunkIterator> it = chunk.getIterator(noQuery, ChunkIterator::SEQUENTIAL_WRITE);
+    Value value(TypeLibrary::getType(TID_INT64));
+    Coordinates pos(1);
+    for (size_t i = 0; i < CHUNK_CELLS; ++i) {
+        pos[0] = i;
+        it->setPosition(pos);
+        value.setInt64(i / runLength % 1000);
+        it->writeItem(value);
+    }
+    it->flush();
+}
+
+static void memChunkWrite(BenchmarkState& state, size_t runLength)
+{
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        MemChunk chunk;
+        writeVectorChunk(chunk, runLength);
+        doNotOptimize(chunk.getConstData());
+    }
+    state.stop();
+    state.setItemsPerIteration(CHUNK_CELLS);
+    state.setBytesPerIteration(CHUNK_CELLS * sizeof(int64_t));
+}
+
+static void memChunkRead(BenchmarkState& state, size_t runLength)
+{
+    MemChunk chunk;
+    writeVectorChunk(chunk, runLength);
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        int64_t sum = 0;
+        std::shared_ptr<ConstChunkIterator> it = chunk.getConstIterator(ConstChunkIterator::IGNORE_OVERLAPS);
+        for (; !it->end(); ++(*it)) {
+            sum += it->getItem().getInt64();
+        }
+        doNotOptimize(sum);
+    }
+    state.stop();
+    state.setItemsPerIteration(CHUNK_CELLS);
+    state.setBytesPerIteration(CHUNK_CELLS * sizeof(int64_t));
+}
+
+/**
+ * The schema of a grid of int64 values held in a single chunk of CHUNK_CELLS cells,
+ * with nDims dimensions of equal length.
+ */
+static ArrayDesc makeGridSchema(size_t nDims)
+{
+    size_t length = 1;
+    while (pow(length + 1, nDims) <= CHUNK_CELLS) {
+        ++length;
+    }
+    Attributes attributes;
+    attributes.push_back(AttributeDesc(0, "v", TID_INT64, 0, CompressorFactory::NO_COMPRESSION));
+    Dimensions dimensions;
+    for (size_t i = 0; i < nDims; ++i) {
+        std::string const name(1, static_cast<char>('i' + i));
+        dimensions.push_back(DimensionDesc(name, 0, length - 1, length, 0));
+    }
+    return ArrayDesc("micro_benchmark_grid", attributes, dimensions, defaultPartitioning());
+}
+
+/// Read every cell of a chunk with nDims dimensions along with its coordinates
+static void memChunkIterate(BenchmarkState& state, size_t nDims)
+{
+    ArrayDesc const schema = makeGridSchema(nDims);
+    Address address(0, Coordinates(nDims, 0));
+    MemChunk chunk;
+    chunk.initialize(NULL, &schema, address, CompressorFactory::NO_COMPRESSION);
+
+    std::shared_ptr<Query> noQuery;
+    std::shared_ptr<ChunkIterator> writer = chunk.getIterator(noQuery, ChunkIterator::SEQUENTIAL_WRITE);
+    Value value(TypeLibrary::getType(TID_INT64));
+    CoordinatesMapper const mapper(chunk);
+    size_t nCells = 1;
+    for (size_t i = 0; i < nDims; ++i) {
+        nCells *= mapper.getChunkInterval(i);
+    }
+    Coordinates pos(nDims);
+    for (size_t i = 0; i < nCells; ++i) {
+        mapper.pos2coord(i, pos);
+        writer->setPosition(pos);
+        value.setInt64(i % 1000);
+        writer->writeItem(value);
+    }
+    writer->flush();
+    writer.reset();
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        int64_t sum = 0;
+        std::shared_ptr<ConstChunkIterator> it = chunk.getConstIterator(ConstChunkIterator::IGNORE_OVERLAPS);
+        for (; !it->end(); ++(*it)) {
+            Coordinates const& pos = it->getPosition();
+            sum += pos[nDims - 1] + it->getItem().getInt64();
+        }
+        doNotOptimize(sum);
+    }
+    state.stop();
+    state.setItemsPerIteration(nCells);
+    state.setBytesPerIteration(nCells * sizeof(int64_t));
+}
+
+MICRO_BENCHMARK("memchunk/write_literal", boost::bind(&memChunkWrite, _1, 1));
+MICRO_BENCHMARK("memchunk/write_runs", boost::bind(&memChunkWrite, _1, 64));
+MICRO_BENCHMARK("memchunk/read_literal", boost::bind(&memChunkRead, _1, 1));
+MICRO_BENCHMARK("memchunk/read_runs", boost::bind(&memChunkRead, _1, 64));
+MICRO_BENCHMARK("memchunk/iterate_2d", boost::bind(&memChunkIterate, _1, 2));
+MICRO_BENCHMARK("memchunk/iterate_3d", boost::bind(&memChunkIterate, _1, 3));
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* MEM_CHUNK_BENCHMARKS_H_ */
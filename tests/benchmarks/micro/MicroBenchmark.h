@@ -0,0 +1,168 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/**
+ * @file MicroBenchmark.h
+ *
+ * @brief A minimal framework for timing engine primitives in a single process.
+ *
+ * A benchmark is a function taking a BenchmarkState. It prepares its input, then runs
+ * its loop state.getIterations() times, between state.start() and state.stop(). The
+ * runner first doubles the number of iterations until a run lasts at least the minimum
+ * time, then times the requested number of runs of that many iterations and reports the
+ * median, the fastest and the slowest time per iteration, one result per line.
+ */
+
+#ifndef MICRO_BENCHMARK_H_
+#define MICRO_BENCHMARK_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+
+namespace scidb
+{
+namespace bench
+{
+
+/// The timing of one run of a benchmark
+class BenchmarkState
+{
+public:
+    explicit BenchmarkState(uint64_t iterations)
+        : _iterations(iterations), _elapsedNs(0), _startNs(0), _items(0), _bytes(0)
+    {}
+
+    /// @return the number of times the benchmark must run its loop
+    uint64_t getIterations() const
+    {
+        return _iterations;
+    }
+
+    /// Start, or resume, timing
+    void start()
+    {
+        _startNs = now();
+    }
+
+    /// Stop, or pause, timing
+    void stop()
+    {
+        _elapsedNs += now() - _startNs;
+    }
+
+    /// Set the number of items (cells, values, tuples...) processed by one iteration
+    void setItemsPerIteration(uint64_t items)
+    {
+        _items = items;
+    }
+
+    /// Set the number of bytes processed by one iteration
+    void setBytesPerIteration(uint64_t bytes)
+    {
+        _bytes = bytes;
+    }
+
+    uint64_t getElapsedNs() const
+    {
+        return _elapsedNs;
+    }
+
+    uint64_t getItemsPerIteration() const
+    {
+        return _items;
+    }
+
+    uint64_t getBytesPerIteration() const
+    {
+        return _bytes;
+    }
+
+private:
+    static uint64_t now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    uint64_t const _iterations;
+    uint64_t _elapsedNs;
+    uint64_t _startNs;
+    uint64_t _items;
+    uint64_t _bytes;
+};
+
+typedef boost::function<void (BenchmarkState&)> BenchmarkFunction;
+
+/// A named benchmark
+struct Benchmark
+{
+    std::string name;
+    BenchmarkFunction function;
+};
+
+/// @return all benchmarks, in the order they were registered
+inline std::vector<Benchmark>& getBenchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+/// Registers a benchmark on construction, @see MICRO_BENCHMARK
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(char const* name, BenchmarkFunction const& function)
+    {
+        Benchmark benchmark;
+        benchmark.name = name;
+        benchmark.function = function;
+        getBenchmarks().push_back(benchmark);
+    }
+};
+
+/// Keep the compiler from optimizing away the computation of a value
+template<typename T>
+inline void doNotOptimize(T const& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+} // namespace bench
+} // namespace scidb
+
+#define MICRO_BENCHMARK_CONCAT2(a, b) a##b
+#define MICRO_BENCHMARK_CONCAT(a, b) MICRO_BENCHMARK_CONCAT2(a, b)
+
+/**
+ * Register a benchmark.
+ * @param name the name of the benchmark in the results, such as "rle/payload_iterate"
+ * @param function the benchmark, any callable taking a BenchmarkState&
+ */
+#define MICRO_BENCHMARK(name, function)                                             \
+    static scidb::bench::BenchmarkRegistrar                                         \
+        MICRO_BENCHMARK_CONCAT(_microBenchmarkRegistrar, __COUNTER__)(name, function)
+
+#endif /* MICRO_BENCHMARK_H_ */
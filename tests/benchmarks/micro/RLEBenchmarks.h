@@ -0,0 +1,140 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file RLEBenchmarks.h
+ *
+ * @brief Iteration over RLE payloads and empty bitmaps.
+ */
+
+#ifndef RLE_BENCHMARKS_H_
+#define RLE_BENCHMARKS_H_
+
+#include <boost/bind.hpp>
+
+#include <array/RLE.h>
+#include <query/TypeSystem.h>
+
+#include "MicroBenchmark.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+static size_t const RLE_CELLS = 1 << 20;
+
+/// Fill a payload of int64 values with runs of runLength equal values
+static void rleFillPayload(RLEPayload& payload, size_t runLength)
+{
+    RLEPayload::append_iterator appender(&payload);
+    Value value(TypeLibrary::getType(TID_INT64));
+    for (size_t i = 0; i < RLE_CELLS; i += runLength) {
+        value.setInt64(i);
+        appender.add(value, runLength);
+    }
+    appender.flush();
+}
+
+/// Read every value of a payload one cell at a time
+static void rlePayloadIterate(BenchmarkState& state, size_t runLength)
+{
+    RLEPayload payload(TypeLibrary::getType(TID_INT64));
+    rleFillPayload(payload, runLength);
+
+    Value value;
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        int64_t sum = 0;
+        for (ConstRLEPayload::iterator it(&payload); !it.end(); ++it) {
+            it.getItem(value);
+            sum += value.getInt64();
+        }
+        doNotOptimize(sum);
+    }
+    state.stop();
+    state.setItemsPerIteration(RLE_CELLS);
+    state.setBytesPerIteration(RLE_CELLS * sizeof(int64_t));
+}
+
+/// Read every value of a payload one segment at a time, as the tile mode operators do
+static void rlePayloadSegments(BenchmarkState& state, size_t runLength)
+{
+    RLEPayload payload(TypeLibrary::getType(TID_INT64));
+    rleFillPayload(payload, runLength);
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        int64_t sum = 0;
+        for (ConstRLEPayload::iterator it(&payload); !it.end(); it.toNextSegment()) {
+            int64_t const* values = reinterpret_cast<int64_t const*>(it.getFixedValues());
+            if (it.isSame()) {
+                sum += values[0] * it.getSegLength();
+            } else {
+                for (size_t j = 0, n = it.getSegLength(); j < n; ++j) {
+                    sum += values[j];
+                }
+            }
+        }
+        doNotOptimize(sum);
+    }
+    state.stop();
+    state.setItemsPerIteration(RLE_CELLS);
+    state.setBytesPerIteration(RLE_CELLS * sizeof(int64_t));
+}
+
+/// Visit every set bit of a bitmap holding runs of runLength set bits separated by as many cleared ones
+static void rleBitmapIterate(BenchmarkState& state, size_t runLength)
+{
+    RLEEmptyBitmap bitmap;
+    ConstRLEEmptyBitmap::Segment segment;
+    segment._length = runLength;
+    for (size_t i = 0; i < RLE_CELLS; i += runLength) {
+        segment._lPosition = 2 * i;
+        segment._pPosition = i;
+        bitmap.addSegment(segment);
+    }
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        position_t sum = 0;
+        for (ConstRLEEmptyBitmap::iterator it(&bitmap); !it.end(); ++it) {
+            sum += it.getLPos() ^ it.getPPos();
+        }
+        doNotOptimize(sum);
+    }
+    state.stop();
+    state.setItemsPerIteration(RLE_CELLS);
+}
+
+MICRO_BENCHMARK("rle/payload_iterate_literal", boost::bind(&rlePayloadIterate, _1, 1));
+MICRO_BENCHMARK("rle/payload_iterate_runs", boost::bind(&rlePayloadIterate, _1, 64));
+MICRO_BENCHMARK("rle/payload_segments_literal", boost::bind(&rlePayloadSegments, _1, 1));
+MICRO_BENCHMARK("rle/payload_segments_runs", boost::bind(&rlePayloadSegments, _1, 64));
+MICRO_BENCHMARK("rle/bitmap_iterate_short_runs", boost::bind(&rleBitmapIterate, _1, 4));
+MICRO_BENCHMARK("rle/bitmap_iterate_long_runs", boost::bind(&rleBitmapIterate, _1, 4096));
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* RLE_BENCHMARKS_H_ */
@@ -0,0 +1,135 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file SortBenchmarks.h
+ *
+ * @brief The in-memory sort of tuples by which sort() orders each of its runs.
+ */
+
+#ifndef SORT_BENCHMARKS_H_
+#define SORT_BENCHMARKS_H_
+
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <array/Compressor.h>
+#include <array/Metadata.h>
+#include <array/TupleArray.h>
+#include <query/TypeSystem.h>
+#include <util/Arena.h>
+
+#include "MicroBenchmark.h"
+
+namespace scidb
+{
+namespace bench
+{
+
+static size_t const SORT_TUPLES = 1 << 16;
+
+/// The schema of tuples made of a key of the given type and of a double
+static ArrayDesc makeTupleSchema(TypeId const& keyType)
+{
+    Attributes attributes;
+    attributes.push_back(AttributeDesc(0, "key", keyType, 0, CompressorFactory::NO_COMPRESSION));
+    attributes.push_back(AttributeDesc(1, "value", TID_DOUBLE, 0, CompressorFactory::NO_COMPRESSION));
+    Dimensions dimensions;
+    dimensions.push_back(DimensionDesc("n", 0, SORT_TUPLES - 1, SORT_TUPLES, 0));
+    return ArrayDesc("micro_benchmark_tuples", attributes, dimensions, defaultPartitioning());
+}
+
+/// Make SORT_TUPLES tuples of pseudo-random keys, the same ones every time, one after the other
+static void makeTuples(std::vector<Value>& tuples, TypeId const& keyType)
+{
+    tuples.clear();
+    uint64_t key = 1;
+    for (size_t i = 0; i < SORT_TUPLES; ++i) {
+        key = key * 6364136223846793005ULL + 1442695040888963407ULL;
+        Value keyValue(TypeLibrary::getType(keyType));
+        if (keyType == TID_STRING) {
+            keyValue.setString(boost::lexical_cast<std::string>(key >> 16));
+        } else {
+            keyValue.setInt64(key >> 16);
+        }
+        tuples.push_back(keyValue);
+        tuples.push_back(Value(TypeLibrary::getType(TID_DOUBLE)));
+        tuples.back().setDouble(i);
+    }
+}
+
+/// Sort SORT_TUPLES tuples by their key, ascending
+static void sortTuples(BenchmarkState& state, TypeId const& keyType)
+{
+    ArrayDesc const schema = makeTupleSchema(keyType);
+    SortingAttributeInfo const byKey = { 0, true };
+    std::shared_ptr<TupleComparator> comparator =
+        std::make_shared<TupleComparator>(PointerRange<const SortingAttributeInfo>(1, &byKey), schema);
+    arena::ArenaPtr arena = arena::newArena(arena::Options("micro_benchmark_sort"));
+    std::vector<Value> values;
+    makeTuples(values, keyType);
+
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        TupleArray tuples(schema, arena);
+        for (size_t j = 0; j < SORT_TUPLES; ++j) {
+            tuples.appendTuple(PointerRange<const Value>(2, &values[2 * j]));
+        }
+        state.start();
+        tuples.sort(comparator);
+        state.stop();
+    }
+    state.setItemsPerIteration(SORT_TUPLES);
+}
+
+/// Compare consecutive unsorted tuples
+static void compareTuples(BenchmarkState& state, TypeId const& keyType)
+{
+    ArrayDesc const schema = makeTupleSchema(keyType);
+    SortingAttributeInfo const byKey = { 0, true };
+    TupleComparator comparator(PointerRange<const SortingAttributeInfo>(1, &byKey), schema);
+    std::vector<Value> tuples;
+    makeTuples(tuples, keyType);
+
+    state.start();
+    for (uint64_t i = 0; i < state.getIterations(); ++i) {
+        int less = 0;
+        for (size_t j = 1; j < SORT_TUPLES; ++j) {
+            less += comparator.compare(&tuples[2 * (j - 1)], &tuples[2 * j]) < 0;
+        }
+        doNotOptimize(less);
+    }
+    state.stop();
+    state.setItemsPerIteration(SORT_TUPLES - 1);
+}
+
+MICRO_BENCHMARK("sort/compare_int64", boost::bind(&compareTuples, _1, TID_INT64));
+MICRO_BENCHMARK("sort/compare_string", boost::bind(&compareTuples, _1, TID_STRING));
+MICRO_BENCHMARK("sort/tuples_int64", boost::bind(&sortTuples, _1, TID_INT64));
+MICRO_BENCHMARK("sort/tuples_string", boost::bind(&sortTuples, _1, TID_STRING));
+
+} // namespace bench
+} // namespace scidb
+
+#endif /* SORT_BENCHMARKS_H_ */
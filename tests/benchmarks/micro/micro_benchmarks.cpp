@@ -0,0 +1,261 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/**
+ * @file micro_benchmarks.cpp
+ *
+ * @brief Runs the micro benchmarks of the engine primitives in a single process, without
+ * a cluster or a catalog, and prints their results one line per benchmark.
+ *
+ * By default every result is a JSON object on a line of its own, carrying the label given
+ * with --label (such as a commit id) so that the results of successive builds can be
+ * appended to one file and compared. --format=csv prints a header and comma separated
+ * values instead.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <boost/regex.hpp>
+
+#include <log4cxx/logger.h>
+#include <log4cxx/basicconfigurator.h>
+
+#include <query/FunctionLibrary.h>
+#include <query/TypeSystem.h>
+#include <system/Config.h>
+#include <system/SciDBConfigOptions.h>
+
+#include "MicroBenchmark.h"
+#include "ArenaBenchmarks.h"
+#include "CompressorBenchmarks.h"
+#include "CoordinatesMapperBenchmarks.h"
+#include "ExpressionBenchmarks.h"
+#include "MemChunkBenchmarks.h"
+#include "RLEBenchmarks.h"
+#include "SortBenchmarks.h"
+
+using namespace std;
+using namespace scidb;
+using namespace scidb::bench;
+
+namespace po = boost::program_options;
+
+namespace
+{
+
+/// The timing of a benchmark over all its runs
+struct Result
+{
+    string name;
+    uint64_t iterations;
+    size_t repetitions;
+    double medianNs;
+    double minNs;
+    double maxNs;
+    double itemsPerSecond;
+    double bytesPerSecond;
+};
+
+/**
+ * Time a benchmark.
+ * @param minTimeNs the minimum duration of a run, from which the number of iterations per run is set
+ * @param repetitions the number of timed runs
+ */
+Result runBenchmark(Benchmark const& benchmark, uint64_t minTimeNs, size_t repetitions)
+{
+    uint64_t iterations = 1;
+    while (true) {
+        BenchmarkState state(iterations);
+        benchmark.function(state);
+        if (state.getElapsedNs() >= minTimeNs || iterations >= (uint64_t(1) << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    vector<double> nsPerIteration;
+    uint64_t items = 0;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < repetitions; ++i) {
+        BenchmarkState state(iterations);
+        benchmark.function(state);
+        nsPerIteration.push_back(static_cast<double>(state.getElapsedNs()) / iterations);
+        items = state.getItemsPerIteration();
+        bytes = state.getBytesPerIteration();
+    }
+    sort(nsPerIteration.begin(), nsPerIteration.end());
+
+    Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.repetitions = repetitions;
+    result.medianNs = nsPerIteration[nsPerIteration.size() / 2];
+    result.minNs = nsPerIteration.front();
+    result.maxNs = nsPerIteration.back();
+    result.itemsPerSecond = result.medianNs > 0 ? items * 1e9 / result.medianNs : 0;
+    result.bytesPerSecond = result.medianNs > 0 ? bytes * 1e9 / result.medianNs : 0;
+    return result;
+}
+
+/// @return a string as a JSON string literal
+string quote(string const& s)
+{
+    ostringstream out;
+    out << '"';
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '"' || s[i] == '\\') {
+            out << '\\';
+        }
+        out << s[i];
+    }
+    out << '"';
+    return out.str();
+}
+
+void printJson(ostream& out, Result const& result, string const& label)
+{
+    out << "{\"benchmark\": " << quote(result.name)
+        << ", \"label\": " << quote(label)
+        << ", \"iterations\": " << result.iterations
+        << ", \"repetitions\": " << result.repetitions
+        << ", \"median_ns\": " << result.medianNs
+        << ", \"min_ns\": " << result.minNs
+        << ", \"max_ns\": " << result.maxNs
+        << ", \"items_per_second\": " << result.itemsPerSecond
+        << ", \"bytes_per_second\": " << result.bytesPerSecond
+        << "}" << endl;
+}
+
+void printCsvHeader(ostream& out)
+{
+    out << "benchmark,label,iterations,repetitions,median_ns,min_ns,max_ns,items_per_second,bytes_per_second" << endl;
+}
+
+void printCsv(ostream& out, Result const& result, string const& label)
+{
+    out << result.name << ',' << label
+        << ',' << result.iterations
+        << ',' << result.repetitions
+        << ',' << result.medianNs
+        << ',' << result.minNs
+        << ',' << result.maxNs
+        << ',' << result.itemsPerSecond
+        << ',' << result.bytesPerSecond
+        << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    string filter;
+    double minTime;
+    size_t repetitions;
+    string format;
+    string label;
+
+    po::options_description options("Options");
+    options.add_options()
+        ("help,h", "Print this help")
+        ("list", "List the benchmarks and exit")
+        ("filter", po::value<string>(&filter)->default_value(".*"),
+         "Run only the benchmarks whose names match this regular expression")
+        ("min-time", po::value<double>(&minTime)->default_value(0.2),
+         "Minimum duration in seconds of a timed run of a benchmark")
+        ("repetitions", po::value<size_t>(&repetitions)->default_value(5),
+         "Number of timed runs of each benchmark")
+        ("format", po::value<string>(&format)->default_value("json"),
+         "Format of the results, 'json' (one object per line) or 'csv'")
+        ("label", po::value<string>(&label)->default_value(""),
+         "Label of every result, such as the commit the benchmarks were built from");
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, options), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            cout << options << endl;
+            return 0;
+        }
+        if ((format != "json" && format != "csv") || repetitions == 0 || minTime < 0) {
+            cerr << options << endl;
+            return 1;
+        }
+
+        log4cxx::BasicConfigurator::configure();
+        log4cxx::Logger::getRootLogger()->setLevel(log4cxx::Level::getWarn());
+
+        // The primitives read their settings from the configuration. No catalog is connected,
+        // but initConfig() requires one to be named.
+        char catalogOption[] = "--catalog=none";
+        char* configArgv[] = { argv[0], catalogOption };
+        initConfig(2, configArgv);
+
+        TypeLibrary::registerBuiltInTypes();
+        FunctionLibrary::getInstance()->registerBuiltInFunctions();
+        registerCompressorBenchmarks();
+
+        vector<Benchmark> const& benchmarks = getBenchmarks();
+        if (vm.count("list")) {
+            for (size_t i = 0; i < benchmarks.size(); ++i) {
+                cout << benchmarks[i].name << endl;
+            }
+            return 0;
+        }
+
+        boost::regex const pattern(filter);
+        cout << setprecision(6);
+        if (format == "csv") {
+            printCsvHeader(cout);
+        }
+        for (size_t i = 0; i < benchmarks.size(); ++i) {
+            if (!boost::regex_search(benchmarks[i].name, pattern)) {
+                continue;
+            }
+            Result const result = runBenchmark(benchmarks[i],
+                                               static_cast<uint64_t>(minTime * 1e9),
+                                               repetitions);
+            if (format == "csv") {
+                printCsv(cout, result, label);
+            } else {
+                printJson(cout, result, label);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "Unhandled std::exception: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#!/bin/sh
+#
+# BEGIN_COPYRIGHT
+#
+# Copyright (C) 2008-2015 SciDB, Inc.
+# All Rights Reserved.
+#
+# SciDB is free software: you can redistribute it and/or modify
+# it under the terms of the AFFERO GNU General Public License as published by
+# the Free Software Foundation.
+#
+# SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+# INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+# NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+# the AFFERO GNU General Public License for the complete license terms.
+#
+# You should have received a copy of the AFFERO GNU General Public License
+# along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+#
+# END_COPYRIGHT
+#
+#
+#  File: Repart.sh
+#
+#   Times repart() of dense 2-D and 3-D arrays into smaller chunks with
+#  overlap, and into larger chunks, once copying runs of cells between the
+#  chunk layouts and once cell by cell (repart-disable-tile-mode). Every
+#  result is counted to check that both ways produce the same cells.
+#
+#  Usage:
+#
+#   ./Repart.sh Length_2D Chunk_Len_2D Length_3D Chunk_Len_3D Port
+#
+LEN_2=`expr $1 - 1`
+CHUNK_2=$2
+LEN_3=`expr $3 - 1`
+CHUNK_3=$4
+Port=$5
+#
+HALF_2=`expr $CHUNK_2 / 2`
+HALF_3=`expr $CHUNK_3 / 2`
+OVER_2=`expr $CHUNK_2 / 16`
+OVER_3=`expr $CHUNK_3 / 16`
+#
+iquery --port $Port -aq "remove ( Repart_2D )" > /dev/null 2>&1
+iquery --port $Port -aq "remove ( Repart_3D )" > /dev/null 2>&1
+#
+iquery --port $Port -naq "store ( apply ( build ( < a : int64 > [ I=0:$LEN_2,$CHUNK_2,0, J=0:$LEN_2,$CHUNK_2,0 ], I * $1 + J ), b, double(a) / 3 ), Repart_2D )"
+iquery --port $Port -naq "store ( apply ( build ( < a : int64 > [ I=0:$LEN_3,$CHUNK_3,0, J=0:$LEN_3,$CHUNK_3,0, K=0:$LEN_3,$CHUNK_3,0 ], (I * $3 + J) * $3 + K ), b, double(a) / 3 ), Repart_3D )"
+#
+for DISABLE in false true
+do
+  iquery --port $Port -aq "setopt ( 'repart-disable-tile-mode', '$DISABLE' )" > /dev/null
+#
+  CMD="aggregate ( repart ( Repart_2D, < a : int64, b : double > [ I=0:$LEN_2,$HALF_2,$OVER_2, J=0:$LEN_2,$HALF_2,$OVER_2 ] ), count(*), sum(a) )"
+  echo "${CMD}"
+  /usr/bin/time -f "Repart 2D split disable=$DISABLE %e" iquery --port $Port -aq "${CMD}"
+#
+  CMD="aggregate ( repart ( Repart_2D, < a : int64, b : double > [ I=0:$LEN_2,`expr $CHUNK_2 \* 2`,0, J=0:$LEN_2,`expr $CHUNK_2 \* 2`,0 ] ), count(*), sum(a) )"
+  echo "${CMD}"
+  /usr/bin/time -f "Repart 2D merge disable=$DISABLE %e" iquery --port $Port -aq "${CMD}"
+#
+  CMD="aggregate ( repart ( Repart_3D, < a : int64, b : double > [ I=0:$LEN_3,$HALF_3,$OVER_3, J=0:$LEN_3,$HALF_3,$OVER_3, K=0:$LEN_3,$HALF_3,$OVER_3 ] ), count(*), sum(a) )"
+  echo "${CMD}"
+  /usr/bin/time -f "Repart 3D split disable=$DISABLE %e" iquery --port $Port -aq "${CMD}"
+#
+  CMD="aggregate ( repart ( Repart_3D, < a : int64, b : double > [ I=0:$LEN_3,`expr $CHUNK_3 \* 2`,0, J=0:$LEN_3,`expr $CHUNK_3 \* 2`,0, K=0:$LEN_3,`expr $CHUNK_3 \* 2`,0 ] ), count(*), sum(a) )"
+  echo "${CMD}"
+  /usr/bin/time -f "Repart 3D merge disable=$DISABLE %e" iquery --port $Port -aq "${CMD}"
+done
+#
+iquery --port $Port -aq "setopt ( 'repart-disable-tile-mode', 'false' )" > /dev/null
+iquery --port $Port -aq "remove ( Repart_2D )"
+iquery --port $Port -aq "remove ( Repart_3D )"
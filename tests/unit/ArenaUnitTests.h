@@ -34,6 +34,7 @@
 #include <util/arena/UnorderedSet.h>
 #include <util/arena/UnorderedMap.h>
 #include <util/arena/ArenaMonitor.h>
+#include <thread>
 
 /****************************************************************************/
 namespace scidb { namespace arena {
@@ -67,6 +68,7 @@ struct ArenaTests : CppUnit::TestFixture
                     void      testStringConcat();
                     void      testManualAuto();
                     void      testMemoryLimit();
+                    void      testThreadCaching();
                     void      anExample();
 
                     void      arena     (Arena&);
@@ -101,6 +103,7 @@ struct ArenaTests : CppUnit::TestFixture
     CPPUNIT_TEST(testStringConcat);
     CPPUNIT_TEST(testManualAuto);
     CPPUNIT_TEST(testMemoryLimit);
+    CPPUNIT_TEST(testThreadCaching);
     CPPUNIT_TEST(anExample);
     CPPUNIT_TEST_SUITE_END();
 };
@@ -686,6 +689,76 @@ void ArenaTests::testMemoryLimit()
     CPPUNIT_ASSERT(setMemoryLimit(l));                   // Restore the limit
 }
 
+/**
+ *  Hammer a threaded Lea arena and a limited arena beneath it from a handful
+ *  of threads at once, and check that once the threads have returned all of
+ *  their allocations the statistics are exact, despite the per-thread caches
+ *  that sit in front of both of them, and that these cached blocks count for
+ *  nothing when the limit of the child is reached.
+ */
+void ArenaTests::testThreadCaching()
+{
+    ArenaPtr q(newArena(Options("caching q").lea(getArena(),1*MiB)));
+    ArenaPtr l(newArena(Options("caching l").limit(4*MiB).parent(q)));
+
+    for (ArenaPtr const& a : {q,l})
+    {
+        std::vector<std::thread> threads;
+
+        for (size_t t = 0; t != 8; ++t)
+        {
+            threads.emplace_back([a,t]
+            {
+                std::vector<void*> v;
+
+                for (size_t r = 0; r != 100; ++r)
+                {
+                    for (size_t i = 0; i != 100; ++i)
+                    {
+                        v.push_back(a->allocate(1 + (i*37 + t) % 1500));
+                    }
+                    for (void* p : v)
+                    {
+                        a->recycle(p);
+                    }
+                    v.clear();
+                }
+            });
+        }
+
+        for (std::thread& t : threads)
+        {
+            t.join();
+        }
+
+        CPPUNIT_ASSERT(a->allocated()   == 0);
+        CPPUNIT_ASSERT(a->allocations() == 0);
+    }
+
+    std::vector<void*> v;
+
+    try
+    {
+        for (;;)
+        {
+            v.push_back(l->allocate(100));
+        }
+    }
+    catch (arena::Exhausted&)
+    {
+        CPPUNIT_ASSERT(v.size() > 4*MiB / 128);          // Cache didn't count
+    }
+
+    for (void* p : v)
+    {
+        l->recycle(p);
+    }
+
+    CPPUNIT_ASSERT(l->allocated() == 0);
+    l.reset();
+    CPPUNIT_ASSERT(q->allocated() == 0);
+}
+
 /**
  *  An example of how one might use Arenas within a SciDB operator.
  */
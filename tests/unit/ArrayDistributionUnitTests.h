@@ -0,0 +1,120 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/*
+ * ArrayDistributionUnitTests.h
+ */
+
+#ifndef ARRAY_DISTRIBUTION_UNIT_TESTS_H_
+#define ARRAY_DISTRIBUTION_UNIT_TESTS_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <array/ArrayDistribution.h>
+#include <array/Metadata.h>
+
+class ArrayDistributionTests: public CppUnit::TestFixture
+{
+CPPUNIT_TEST_SUITE(ArrayDistributionTests);
+CPPUNIT_TEST(testCoPartitioned);
+CPPUNIT_TEST(testRangePartitioned);
+CPPUNIT_TEST(testOtherDimensions);
+CPPUNIT_TEST_SUITE_END();
+
+private:
+    static scidb::InstanceID place(scidb::PartitioningSchema ps, scidb::Dimensions const& dims,
+                                   scidb::Coordinate x, scidb::Coordinate y,
+                                   size_t psDimension, uint64_t psBlock)
+    {
+        scidb::Coordinates pos(2);
+        pos[0] = x;
+        pos[1] = y;
+        return scidb::getPrimaryInstanceForChunk(ps, pos, dims, 4, psDimension, psBlock);
+    }
+
+    static scidb::Dimensions dims()
+    {
+        scidb::Dimensions d;
+        d.push_back(scidb::DimensionDesc("x", -20, 19, 5, 0));
+        d.push_back(scidb::DimensionDesc("y", 0, 99, 10, 0));
+        return d;
+    }
+
+public:
+    void testCoPartitioned()
+    {
+        // one chunk per block: chunk n of x goes to instance n mod 4, counting from coordinate 0
+        const scidb::Dimensions d = dims();
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(0), place(scidb::psCoPartitioned, d, 0, 0, 0, 1));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(1), place(scidb::psCoPartitioned, d, 5, 0, 0, 1));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(3), place(scidb::psCoPartitioned, d, 15, 0, 0, 1));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(3), place(scidb::psCoPartitioned, d, -5, 0, 0, 1));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(2), place(scidb::psCoPartitioned, d, -10, 0, 0, 1));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(0), place(scidb::psCoPartitioned, d, -20, 0, 0, 1));
+    }
+
+    void testRangePartitioned()
+    {
+        // two chunks per block: chunks -2 and -1 make block -1, chunks 0 and 1 make block 0
+        const scidb::Dimensions d = dims();
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(0), place(scidb::psRangePartitioned, d, 0, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(0), place(scidb::psRangePartitioned, d, 5, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(1), place(scidb::psRangePartitioned, d, 10, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(1), place(scidb::psRangePartitioned, d, 15, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(3), place(scidb::psRangePartitioned, d, -5, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(3), place(scidb::psRangePartitioned, d, -10, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(2), place(scidb::psRangePartitioned, d, -15, 0, 0, 2));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(2), place(scidb::psRangePartitioned, d, -20, 0, 0, 2));
+
+        // the same placement for both schemas given the same block
+        for (scidb::Coordinate x = -20; x < 20; x += 5)
+        {
+            CPPUNIT_ASSERT_EQUAL(place(scidb::psCoPartitioned, d, x, 0, 0, 3),
+                                 place(scidb::psRangePartitioned, d, x, 0, 0, 3));
+        }
+    }
+
+    void testOtherDimensions()
+    {
+        // only the partitioning dimension decides where a chunk goes
+        const scidb::Dimensions d = dims();
+        for (scidb::Coordinate x = -20; x < 20; x += 5)
+        {
+            const scidb::InstanceID byX = place(scidb::psCoPartitioned, d, x, 0, 0, 1);
+            for (scidb::Coordinate y = 0; y < 100; y += 10)
+            {
+                CPPUNIT_ASSERT_EQUAL(byX, place(scidb::psCoPartitioned, d, x, y, 0, 1));
+                CPPUNIT_ASSERT_EQUAL(place(scidb::psRangePartitioned, d, 0, y, 1, 2),
+                                     place(scidb::psRangePartitioned, d, x, y, 1, 2));
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(1), place(scidb::psCoPartitioned, d, -20, 10, 1, 1));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(0), place(scidb::psRangePartitioned, d, 15, 40, 1, 5));
+        CPPUNIT_ASSERT_EQUAL(scidb::InstanceID(1), place(scidb::psRangePartitioned, d, -20, 50, 1, 5));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ArrayDistributionTests);
+
+#endif /* ARRAY_DISTRIBUTION_UNIT_TESTS_H_ */
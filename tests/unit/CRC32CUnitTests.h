@@ -0,0 +1,78 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/*
+ * CRC32CUnitTests.h
+ */
+
+#ifndef CRC32C_UNIT_TESTS_H_
+#define CRC32C_UNIT_TESTS_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <vector>
+
+#include <util/CRC32C.h>
+
+class CRC32CTests: public CppUnit::TestFixture
+{
+CPPUNIT_TEST_SUITE(CRC32CTests);
+CPPUNIT_TEST(testKnownValues);
+CPPUNIT_TEST(testPieces);
+CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testKnownValues()
+    {
+        // check values from RFC 3720 (iSCSI) and the CRC catalogue
+        const char* digits = "123456789";
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0xE3069283), scidb::calculateCRC32C(digits, strlen(digits)));
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0), scidb::calculateCRC32C(digits, 0));
+
+        std::vector<unsigned char> zeros(32, 0);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0x8A9136AA), scidb::calculateCRC32C(&zeros[0], zeros.size()));
+
+        std::vector<unsigned char> ones(32, 0xFF);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0x62A8AB43), scidb::calculateCRC32C(&ones[0], ones.size()));
+    }
+
+    void testPieces()
+    {
+        std::vector<unsigned char> data(1000);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<unsigned char>(i * 7 + 3);
+        }
+        const uint32_t whole = scidb::calculateCRC32C(&data[0], data.size());
+        for (size_t split = 0; split <= data.size(); split += 13)
+        {
+            uint32_t crc = scidb::calculateCRC32C(&data[0], split);
+            crc = scidb::calculateCRC32C(&data[split], data.size() - split, crc);
+            CPPUNIT_ASSERT_EQUAL(whole, crc);
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRC32CTests);
+
+#endif /* CRC32C_UNIT_TESTS_H_ */
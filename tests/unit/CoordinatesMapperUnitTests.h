@@ -0,0 +1,195 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/*
+ * CoordinatesMapperUnitTests.h
+ */
+
+#ifndef COORDINATES_MAPPER_UNIT_TESTS_H_
+#define COORDINATES_MAPPER_UNIT_TESTS_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <vector>
+
+#include <util/CoordinatesMapper.h>
+#include <util/FastDivisor.h>
+#include <util/PointerRange.h>
+
+class CoordinatesMapperTests: public CppUnit::TestFixture
+{
+CPPUNIT_TEST_SUITE(CoordinatesMapperTests);
+CPPUNIT_TEST(testFastDivisorEdges);
+CPPUNIT_TEST(testFastDivisorRandom);
+CPPUNIT_TEST(testRoundTrip);
+CPPUNIT_TEST(testAdvance);
+CPPUNIT_TEST_SUITE_END();
+
+    /// xorshift64, deterministic so that failures reproduce
+    static uint64_t next(uint64_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    static void checkDivisor(uint64_t divisor, uint64_t& random)
+    {
+        const scidb::FastDivisor fd(divisor);
+        CPPUNIT_ASSERT_EQUAL(divisor, fd.getDivisor());
+
+        std::vector<uint64_t> numbers;
+        const uint64_t around[] = { 0, 1, divisor - 1, divisor, divisor + 1,
+                                    2 * divisor - 1, 2 * divisor, UINT64_MAX / divisor * divisor,
+                                    UINT64_MAX - 1, UINT64_MAX };
+        numbers.assign(around, around + sizeof(around) / sizeof(around[0]));
+        for (size_t i = 0; i < 1000; ++i) {
+            const uint64_t n = next(random);
+            numbers.push_back(n);
+            numbers.push_back(n >> (n % 64));       // small numbers as well
+        }
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            const uint64_t n = numbers[i];
+            const uint64_t q = fd.divide(n);
+            CPPUNIT_ASSERT_EQUAL(n / divisor, q);
+            CPPUNIT_ASSERT_EQUAL(n % divisor, n - q * divisor);
+        }
+    }
+
+    /// the divisions CoordinatesMapper used before FastDivisor
+    static void referencePos2coord(scidb::Coordinates const& first, scidb::Coordinates const& last,
+                                   scidb::position_t pos, scidb::Coordinates& coord)
+    {
+        coord.resize(first.size());
+        for (size_t i = first.size(); i-- > 0; ) {
+            const scidb::Coordinate interval = last[i] - first[i] + 1;
+            coord[i] = first[i] + pos % interval;
+            pos /= interval;
+        }
+    }
+
+    /// chunk boxes of every rank with a fixed conversion, 1 to 4, and of the generic one, 5 and 6;
+    /// the first and last positions include an overlap of 1 or 2 where the origin allows it
+    static void makeBoxes(std::vector<scidb::Coordinates>& firsts, std::vector<scidb::Coordinates>& lasts)
+    {
+        const scidb::Coordinate intervals[] = { 7, 1, 4, 3, 5, 2 };
+        const scidb::Coordinate origins[]   = { -10, 0, 1000, -3, 1LL << 40, 5 };
+        for (size_t nDims = 1; nDims <= 6; ++nDims) {
+            for (scidb::Coordinate overlap = 0; overlap <= 2; ++overlap) {
+                scidb::Coordinates first(nDims);
+                scidb::Coordinates last(nDims);
+                for (size_t i = 0; i < nDims; ++i) {
+                    first[i] = origins[i] - overlap;
+                    last[i] = origins[i] + intervals[(i + nDims) % 6] - 1 + overlap;
+                }
+                firsts.push_back(first);
+                lasts.push_back(last);
+            }
+        }
+    }
+
+    static uint64_t logicalSize(scidb::Coordinates const& first, scidb::Coordinates const& last)
+    {
+        uint64_t size = 1;
+        for (size_t i = 0; i < first.size(); ++i) {
+            size *= last[i] - first[i] + 1;
+        }
+        return size;
+    }
+
+public:
+    void testFastDivisorEdges()
+    {
+        uint64_t random = 0x5C1DB;
+        checkDivisor(1, random);
+        for (uint32_t k = 1; k < 64; ++k) {
+            checkDivisor(uint64_t(1) << k, random);
+            checkDivisor((uint64_t(1) << k) - 1, random);
+            checkDivisor((uint64_t(1) << k) + 1, random);
+        }
+        checkDivisor(3, random);
+        checkDivisor(7, random);
+        checkDivisor(0xFFFFFFFFULL, random);        // 2^32-1
+        checkDivisor((1ULL << 63) + 1, random);     // 2^63+1
+        checkDivisor(UINT64_MAX, random);
+    }
+
+    void testFastDivisorRandom()
+    {
+        uint64_t random = 0x2545F4914F6CDD1DULL;
+        for (size_t i = 0; i < 200; ++i) {
+            const uint64_t divisor = next(random) >> (next(random) % 64);
+            if (divisor != 0) {
+                checkDivisor(divisor, random);
+            }
+        }
+    }
+
+    void testRoundTrip()
+    {
+        std::vector<scidb::Coordinates> firsts, lasts;
+        makeBoxes(firsts, lasts);
+        for (size_t b = 0; b < firsts.size(); ++b) {
+            const scidb::CoordinatesMapper mapper(scidb::pointerRange(firsts[b]), scidb::pointerRange(lasts[b]));
+            CPPUNIT_ASSERT_EQUAL(firsts[b].size(), mapper.getNumDims());
+
+            scidb::Coordinates coord, expected;
+            const uint64_t size = logicalSize(firsts[b], lasts[b]);
+            for (scidb::position_t pos = 0; static_cast<uint64_t>(pos) < size; ++pos) {
+                mapper.pos2coord(pos, coord);
+                referencePos2coord(firsts[b], lasts[b], pos, expected);
+                CPPUNIT_ASSERT(coord == expected);
+                CPPUNIT_ASSERT_EQUAL(pos, mapper.coord2pos(scidb::pointerRange(coord)));
+            }
+        }
+    }
+
+    void testAdvance()
+    {
+        std::vector<scidb::Coordinates> firsts, lasts;
+        makeBoxes(firsts, lasts);
+        for (size_t b = 0; b < firsts.size(); ++b) {
+            const scidb::CoordinatesMapper mapper(scidb::pointerRange(firsts[b]), scidb::pointerRange(lasts[b]));
+
+            scidb::Coordinates coord(firsts[b]), expected;
+            const uint64_t size = logicalSize(firsts[b], lasts[b]);
+            for (scidb::position_t pos = 0; static_cast<uint64_t>(pos) < size; ++pos) {
+                mapper.pos2coord(pos, expected);
+                CPPUNIT_ASSERT(coord == expected);
+                mapper.advance(scidb::pointerRange(coord));
+            }
+
+            // past the last cell the first coordinate steps out of the chunk
+            CPPUNIT_ASSERT_EQUAL(lasts[b][0] + 1, coord[0]);
+            for (size_t i = 1; i < coord.size(); ++i) {
+                CPPUNIT_ASSERT_EQUAL(firsts[b][i], coord[i]);
+            }
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CoordinatesMapperTests);
+
+#endif /* COORDINATES_MAPPER_UNIT_TESTS_H_ */
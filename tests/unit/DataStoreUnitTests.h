@@ -0,0 +1,345 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+/*
+ * DataStoreUnitTests.h
+ */
+
+#ifndef DATA_STORE_UNIT_TESTS_H_
+#define DATA_STORE_UNIT_TESTS_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <util/DataStore.h>
+
+class DataStoreTests: public CppUnit::TestFixture
+{
+CPPUNIT_TEST_SUITE(DataStoreTests);
+CPPUNIT_TEST(testRemoveBeforeMigration);
+CPPUNIT_TEST(testRemoveDuringMigration);
+CPPUNIT_TEST(testMapData);
+CPPUNIT_TEST(testBulkWrite);
+CPPUNIT_TEST_SUITE_END();
+
+    std::string _fast;                                   // storage root of tier 0
+    std::string _slow;                                   // storage root of tier 1
+
+    static std::string makeDir()
+    {
+        char path[] = "/tmp/datastore_unit_tests.XXXXXX";
+        CPPUNIT_ASSERT(::mkdtemp(path) != NULL);
+        return path;
+    }
+
+    static bool exists(std::string const& path)
+    {
+        struct stat st;
+        return ::stat(path.c_str(), &st) == 0;
+    }
+
+    static std::string dataFile(std::string const& root, scidb::DataStore::Guid guid)
+    {
+        std::ostringstream path;
+        path << root << "/" << guid << ".data";
+        return path.str();
+    }
+
+    /* Check that no file of the data store is left in either tier
+     */
+    void checkGone(scidb::DataStore::Guid guid)
+    {
+        std::string const roots[] = { _fast, _slow };
+        for (size_t i = 0; i < 2; ++i)
+        {
+            std::string const path = dataFile(roots[i], guid);
+            CPPUNIT_ASSERT(!exists(path));
+            CPPUNIT_ASSERT(!exists(path + ".fl"));
+            CPPUNIT_ASSERT(!exists(path + ".migrating"));
+        }
+    }
+
+    /* Write size bytes of chunks to the data store
+     */
+    static void fill(scidb::DataStore& ds, size_t size)
+    {
+        std::vector<char> chunk(64 * 1024, 'x');
+        for (size_t written = 0; written < size; written += chunk.size())
+        {
+            size_t allocated = 0;
+            off_t const off = ds.allocateSpace(chunk.size(), allocated);
+            ds.writeData(off, &chunk[0], chunk.size(), allocated);
+        }
+        ds.flush();
+    }
+
+    /* Chunk data which differs from chunk to chunk
+     */
+    static std::vector<std::vector<char> > makeChunks(std::vector<size_t> const& sizes)
+    {
+        std::vector<std::vector<char> > chunks(sizes.size());
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            chunks[i].resize(sizes[i]);
+            for (size_t j = 0; j < sizes[i]; ++j)
+            {
+                chunks[i][j] = static_cast<char>(j * 31 + i);
+            }
+        }
+        return chunks;
+    }
+
+public:
+    void setUp()
+    {
+        _fast = makeDir();
+        _slow = makeDir();
+    }
+
+    void tearDown()
+    {
+        ::rmdir(_fast.c_str());
+        ::rmdir(_slow.c_str());
+    }
+
+    void testRemoveBeforeMigration()
+    {
+        scidb::DataStores dsm;
+        dsm.initDataStores(_fast.c_str(), _slow);
+
+        std::shared_ptr<scidb::DataStore> ds = dsm.getDataStore(1);
+        fill(*ds, 1024 * 1024);
+        dsm.closeDataStore(1, true);
+
+        CPPUNIT_ASSERT(!ds->migrate(1, dataFile(_slow, 1)));
+        ds.reset();
+        checkGone(1);
+    }
+
+    /* Remove the data store at various points of a migration to the slower
+       tier: whatever the interleaving, nothing may be left on either tier
+       once the last reference is dropped.
+     */
+    void testRemoveDuringMigration()
+    {
+        scidb::DataStores dsm;
+        dsm.initDataStores(_fast.c_str(), _slow);
+
+        for (scidb::DataStore::Guid guid = 1; guid <= 16; ++guid)
+        {
+            std::shared_ptr<scidb::DataStore> ds = dsm.getDataStore(guid);
+            fill(*ds, 16 * 1024 * 1024);
+
+            std::string const target = dataFile(_slow, guid);
+            std::thread migration([&ds, &target]
+            {
+                ds->migrate(1, target);
+            });
+            ::usleep((guid - 1) * 2000);
+            dsm.closeDataStore(guid, true);
+            migration.join();
+
+            CPPUNIT_ASSERT(!exists(dataFile(_fast, guid)) || !exists(dataFile(_slow, guid)));
+            ds.reset();
+            checkGone(guid);
+        }
+    }
+
+    /* A chunk mapped from the data store holds the bytes readData() reads,
+       and the mapping stays valid and can be released after the data store
+       moved to the slower tier and was removed
+     */
+    void testMapData()
+    {
+        scidb::DataStores dsm;
+        dsm.initDataStores(_fast.c_str(), _slow);
+        std::shared_ptr<scidb::DataStore> ds = dsm.getDataStore(1);
+
+        // sizes which leave the later chunks off page boundaries
+        size_t const init[] = { 3000, 100000, 5000, 1 };
+        std::vector<size_t> const sizes(init, init + sizeof(init) / sizeof(init[0]));
+        size_t const nChunks = sizes.size();
+        std::vector<std::vector<char> > const chunks = makeChunks(sizes);
+        std::vector<off_t> offsets(nChunks);
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            size_t allocated = 0;
+            offsets[i] = ds->allocateSpace(sizes[i], allocated);
+            ds->writeData(offsets[i], &chunks[i][0], sizes[i], allocated);
+        }
+        ds->flush();
+
+        std::vector<void*> mappings(nChunks);
+        std::vector<size_t> mappedLens(nChunks);
+        std::vector<char const*> mapped(nChunks);
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            std::vector<char> read(sizes[i]);
+            ds->readData(offsets[i], &read[0], sizes[i]);
+            CPPUNIT_ASSERT(read == chunks[i]);
+
+            mapped[i] = static_cast<char const*>(
+                ds->mapData(offsets[i], sizes[i], MADV_SEQUENTIAL, mappings[i], mappedLens[i]));
+            CPPUNIT_ASSERT(mappings[i] != NULL);
+            CPPUNIT_ASSERT(mapped[i] > static_cast<char const*>(mappings[i]));
+            CPPUNIT_ASSERT(mapped[i] + sizes[i] <= static_cast<char const*>(mappings[i]) + mappedLens[i]);
+            CPPUNIT_ASSERT(memcmp(mapped[i], &read[0], sizes[i]) == 0);
+        }
+
+        // not the start of a chunk: no mapping is left behind
+        void* mapping = NULL;
+        size_t mappedLen = 0;
+        CPPUNIT_ASSERT_THROW(ds->mapData(offsets[1] + 512, 100, MADV_NORMAL, mapping, mappedLen),
+                             scidb::SystemException);
+        CPPUNIT_ASSERT(mapping == NULL);
+
+        CPPUNIT_ASSERT(ds->migrate(1, dataFile(_slow, 1)));
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            CPPUNIT_ASSERT(memcmp(mapped[i], &chunks[i][0], sizes[i]) == 0);
+        }
+
+        dsm.closeDataStore(1, true);
+        ds.reset();
+        checkGone(1);
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            CPPUNIT_ASSERT(memcmp(mapped[i], &chunks[i][0], sizes[i]) == 0);
+            CPPUNIT_ASSERT_EQUAL(0, ::munmap(mappings[i], mappedLens[i]));
+        }
+    }
+    /* The chunks of a bulk allocation are laid out back to back in the order
+       requested, a single gather write stores them all, and the blocks of a
+       batch whose write failed, once freed as rollback frees them, merge back
+       into the free extent they were carved from
+     */
+    void testBulkWrite()
+    {
+        scidb::DataStores dsm;
+        dsm.initDataStores(_fast.c_str(), _slow);
+        std::shared_ptr<scidb::DataStore> ds = dsm.getDataStore(1);
+
+        // sizes which leave alignment holes between the blocks
+        size_t const init[] = { 3000, 100000, 5000, 1, 70000 };
+        std::vector<size_t> const sizes(init, init + sizeof(init) / sizeof(init[0]));
+        size_t const nChunks = sizes.size();
+        std::vector<std::vector<char> > const chunks = makeChunks(sizes);
+        std::vector<void const*> buffers(nChunks);
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            buffers[i] = &chunks[i][0];
+        }
+
+        std::vector<off_t> offsets;
+        std::vector<size_t> allocatedSizes;
+        ds->allocateSpace(sizes, offsets, allocatedSizes);
+        CPPUNIT_ASSERT_EQUAL(nChunks, offsets.size());
+        CPPUNIT_ASSERT_EQUAL(nChunks, allocatedSizes.size());
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            size_t const allocated = allocatedSizes[i];
+            CPPUNIT_ASSERT(allocated >= sizes[i] + ds->getOverhead());
+            CPPUNIT_ASSERT_EQUAL(size_t(0), allocated & (allocated - 1));
+            CPPUNIT_ASSERT_EQUAL(off_t(0), offsets[i] % off_t(allocated));
+            if (i > 0)
+            {
+                // the next block starts at the first suitably aligned offset
+                off_t const end = offsets[i - 1] + off_t(allocatedSizes[i - 1]);
+                CPPUNIT_ASSERT(offsets[i] >= end);
+                CPPUNIT_ASSERT(offsets[i] - end < off_t(allocated));
+            }
+        }
+
+        ds->writeData(offsets, buffers, sizes, allocatedSizes);
+        ds->flush();
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            std::vector<char> read(sizes[i]);
+            ds->readData(offsets[i], &read[0], sizes[i]);
+            CPPUNIT_ASSERT(read == chunks[i]);
+        }
+
+        // a batch whose write fails part way (the third buffer is unreadable)
+        off_t fileSize = 0;
+        blkcnt_t fileBlocks = 0;
+        off_t fileFree = 0;
+        ds->getSizes(fileSize, fileBlocks, fileFree);
+
+        std::vector<off_t> failedOffsets;
+        std::vector<size_t> failedSizes;
+        ds->allocateSpace(sizes, failedOffsets, failedSizes);
+        size_t const pageSize = ::sysconf(_SC_PAGESIZE);
+        size_t const badLen = (sizes[2] + pageSize - 1) / pageSize * pageSize;
+        void* const bad = ::mmap(NULL, badLen, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        CPPUNIT_ASSERT(bad != MAP_FAILED);
+        std::vector<void const*> failedBuffers(buffers);
+        failedBuffers[2] = bad;
+        CPPUNIT_ASSERT_THROW(ds->writeData(failedOffsets, failedBuffers, sizes, failedSizes),
+                             scidb::SystemException);
+        CPPUNIT_ASSERT_EQUAL(0, ::munmap(bad, badLen));
+
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            ds->freeChunk(failedOffsets[i], failedSizes[i]);
+        }
+        ds->verifyFreelist();
+        off_t fileSizeAfter = 0;
+        off_t fileFreeAfter = 0;
+        ds->getSizes(fileSizeAfter, fileBlocks, fileFreeAfter);
+        CPPUNIT_ASSERT_EQUAL(fileSize, fileSizeAfter);
+        CPPUNIT_ASSERT_EQUAL(fileFree, fileFreeAfter);
+
+        // the same extent is handed out again, and the first batch is intact
+        std::vector<off_t> retryOffsets;
+        std::vector<size_t> retrySizes;
+        ds->allocateSpace(sizes, retryOffsets, retrySizes);
+        CPPUNIT_ASSERT(retryOffsets == failedOffsets);
+        CPPUNIT_ASSERT(retrySizes == failedSizes);
+        ds->writeData(retryOffsets, buffers, sizes, retrySizes);
+        ds->flush();
+        for (size_t i = 0; i < nChunks; ++i)
+        {
+            std::vector<char> read(sizes[i]);
+            ds->readData(offsets[i], &read[0], sizes[i]);
+            CPPUNIT_ASSERT(read == chunks[i]);
+            ds->readData(retryOffsets[i], &read[0], sizes[i]);
+            CPPUNIT_ASSERT(read == chunks[i]);
+        }
+
+        dsm.closeDataStore(1, true);
+        ds.reset();
+        checkGone(1);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DataStoreTests);
+
+#endif /* DATA_STORE_UNIT_TESTS_H_ */
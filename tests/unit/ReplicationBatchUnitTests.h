@@ -0,0 +1,204 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2015 SciDB, Inc.
+* All Rights Reserved.
+*
+* SciDB is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+
+/*
+ * ReplicationBatchUnitTests.h
+ */
+
+#ifndef REPLICATION_BATCH_UNIT_TESTS_H_
+#define REPLICATION_BATCH_UNIT_TESTS_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+
+#include <array/Array.h>
+#include <network/proto/scidb_msg.pb.h>
+#include <smgr/io/ReplicationManager.h>
+
+namespace
+{
+    const scidb::QueryID QUERY_ID = 17;
+    const scidb::ArrayID ARRAY_ID = 42;
+}
+
+class ReplicationBatchTests: public CppUnit::TestFixture
+{
+CPPUNIT_TEST_SUITE(ReplicationBatchTests);
+CPPUNIT_TEST(testFraming);
+CPPUNIT_TEST(testCompressed);
+CPPUNIT_TEST(testIncompressible);
+CPPUNIT_TEST(testTruncated);
+CPPUNIT_TEST_SUITE_END();
+
+    typedef std::vector<std::shared_ptr<scidb::MessageDesc> > Messages;
+    typedef std::vector<std::shared_ptr<scidb::CompressedBuffer> > Payloads;
+
+    /// @return replica chunk message, a tombstone if size is 0
+    static std::shared_ptr<scidb::MessageDesc> makeChunkMsg(int64_t pos, size_t size, bool random)
+    {
+        std::shared_ptr<scidb::MessageDesc> msg;
+        if (size != 0) {
+            std::shared_ptr<scidb::CompressedBuffer> data = std::make_shared<scidb::CompressedBuffer>();
+            data->allocate(size);
+            unsigned char* bytes = static_cast<unsigned char*>(data->getData());
+            for (size_t i = 0; i < size; ++i) {
+                bytes[i] = static_cast<unsigned char>(random ? rand() : (pos + i / 64));
+            }
+            msg = std::make_shared<scidb::MessageDesc>(scidb::mtChunkReplica, data);
+        } else {
+            msg = std::make_shared<scidb::MessageDesc>(scidb::mtChunkReplica);
+        }
+        msg->setQueryID(QUERY_ID);
+        std::shared_ptr<scidb_msg::Chunk> record = msg->getRecord<scidb_msg::Chunk>();
+        record->set_array_id(ARRAY_ID);
+        record->set_eof(false);
+        record->set_attribute_id(static_cast<uint32_t>(pos % 2));
+        record->add_coordinates(pos);
+        record->add_coordinates(-pos);
+        record->set_compression_method(0);
+        record->set_decompressed_size(size);
+        record->set_count(static_cast<uint32_t>(size / 8));
+        record->set_tombstone(size == 0);
+        return msg;
+    }
+
+    /// check that the batch carries exactly the records and data of the messages
+    static void checkRoundTrip(const Messages& msgs, const std::shared_ptr<scidb::MessageDesc>& batch)
+    {
+        CPPUNIT_ASSERT_EQUAL(QUERY_ID, batch->getQueryID());
+        std::shared_ptr<scidb_msg::Chunk> record = batch->getRecord<scidb_msg::Chunk>();
+        CPPUNIT_ASSERT_EQUAL(ARRAY_ID, static_cast<scidb::ArrayID>(record->array_id()));
+        CPPUNIT_ASSERT(!record->eof());
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(msgs.size()), record->replicas_size());
+
+        Payloads payloads;
+        scidb::ReplicationManager::unpackBatch(batch, payloads);
+        CPPUNIT_ASSERT_EQUAL(msgs.size(), payloads.size());
+
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            const scidb_msg::Chunk& replica = record->replicas(static_cast<int>(i));
+            std::shared_ptr<scidb_msg::Chunk> original = msgs[i]->getRecord<scidb_msg::Chunk>();
+            CPPUNIT_ASSERT_EQUAL(original->attribute_id(), replica.attribute_id());
+            CPPUNIT_ASSERT_EQUAL(original->coordinates_size(), replica.coordinates_size());
+            CPPUNIT_ASSERT_EQUAL(original->coordinates(0), replica.coordinates(0));
+            CPPUNIT_ASSERT_EQUAL(original->coordinates(1), replica.coordinates(1));
+            CPPUNIT_ASSERT_EQUAL(original->decompressed_size(), replica.decompressed_size());
+            CPPUNIT_ASSERT_EQUAL(original->count(), replica.count());
+            CPPUNIT_ASSERT_EQUAL(original->tombstone(), replica.tombstone());
+
+            std::shared_ptr<scidb::SharedBuffer> data(msgs[i]->getBinary());
+            if (!data) {
+                CPPUNIT_ASSERT(!payloads[i]);
+                CPPUNIT_ASSERT_EQUAL(uint64_t(0), replica.payload_size());
+                continue;
+            }
+            CPPUNIT_ASSERT(payloads[i]);
+            CPPUNIT_ASSERT_EQUAL(data->getSize(), payloads[i]->getSize());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(data->getSize()), replica.payload_size());
+            CPPUNIT_ASSERT(memcmp(data->getData(), payloads[i]->getData(), data->getSize()) == 0);
+        }
+    }
+
+public:
+    void testFraming()
+    {
+        // chunks of different sizes with tombstones at the ends and in the middle
+        Messages msgs;
+        msgs.push_back(makeChunkMsg(0, 0, false));
+        msgs.push_back(makeChunkMsg(1, 1, false));
+        msgs.push_back(makeChunkMsg(2, 4096, false));
+        msgs.push_back(makeChunkMsg(3, 0, false));
+        msgs.push_back(makeChunkMsg(4, 777, true));
+        msgs.push_back(makeChunkMsg(5, 0, false));
+
+        std::shared_ptr<scidb::MessageDesc> batch = scidb::ReplicationManager::makeBatch(msgs, false);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), batch->getRecord<scidb_msg::Chunk>()->batch_size());
+        CPPUNIT_ASSERT_EQUAL(size_t(1 + 4096 + 777), batch->getBinary()->getSize());
+        checkRoundTrip(msgs, batch);
+
+        // a batch of tombstones only carries no data
+        Messages tombstones;
+        tombstones.push_back(makeChunkMsg(6, 0, false));
+        tombstones.push_back(makeChunkMsg(7, 0, false));
+        batch = scidb::ReplicationManager::makeBatch(tombstones, true);
+        CPPUNIT_ASSERT(!batch->getBinary());
+        checkRoundTrip(tombstones, batch);
+    }
+
+    void testCompressed()
+    {
+        Messages msgs;
+        size_t size = 0;
+        for (int64_t pos = 0; pos < 64; ++pos) {
+            msgs.push_back(makeChunkMsg(pos, pos % 5 == 0 ? 0 : 8192, false));
+            size += msgs.back()->getBinary() ? msgs.back()->getBinary()->getSize() : 0;
+        }
+        std::shared_ptr<scidb::MessageDesc> batch = scidb::ReplicationManager::makeBatch(msgs, true);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(size), batch->getRecord<scidb_msg::Chunk>()->batch_size());
+        CPPUNIT_ASSERT(batch->getBinary()->getSize() < size / 4);
+        checkRoundTrip(msgs, batch);
+    }
+
+    void testIncompressible()
+    {
+        // random data is sent as is even if compression is requested
+        Messages msgs;
+        for (int64_t pos = 0; pos < 8; ++pos) {
+            msgs.push_back(makeChunkMsg(pos, 1000, true));
+        }
+        std::shared_ptr<scidb::MessageDesc> batch = scidb::ReplicationManager::makeBatch(msgs, true);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), batch->getRecord<scidb_msg::Chunk>()->batch_size());
+        CPPUNIT_ASSERT_EQUAL(size_t(8000), batch->getBinary()->getSize());
+        checkRoundTrip(msgs, batch);
+    }
+
+    void testTruncated()
+    {
+        Messages msgs;
+        msgs.push_back(makeChunkMsg(1, 100, true));
+        msgs.push_back(makeChunkMsg(2, 100, true));
+        std::shared_ptr<scidb::MessageDesc> batch = scidb::ReplicationManager::makeBatch(msgs, false);
+
+        // the record promises more data than the message carries
+        batch->getRecord<scidb_msg::Chunk>()->mutable_replicas(1)->set_payload_size(101);
+        Payloads payloads;
+        CPPUNIT_ASSERT_THROW(scidb::ReplicationManager::unpackBatch(batch, payloads), scidb::SystemException);
+
+        // a compressed batch which does not inflate to its declared size
+        Messages packed;
+        packed.push_back(makeChunkMsg(1, 4096, false));
+        packed.push_back(makeChunkMsg(2, 4096, false));
+        batch = scidb::ReplicationManager::makeBatch(packed, true);
+        CPPUNIT_ASSERT(batch->getRecord<scidb_msg::Chunk>()->batch_size() != 0);
+        batch->getRecord<scidb_msg::Chunk>()->set_batch_size(8193);
+        CPPUNIT_ASSERT_THROW(scidb::ReplicationManager::unpackBatch(batch, payloads), scidb::SystemException);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReplicationBatchTests);
+
+#endif /* REPLICATION_BATCH_UNIT_TESTS_H_ */
@@ -63,6 +63,11 @@
 //#include "system/ExceptionUnitTests.h"
 #include "PointerRangeUnitTests.h"
 #include "ArenaUnitTests.h"
+#include "CRC32CUnitTests.h"
+#include "DataStoreUnitTests.h"
+#include "ArrayDistributionUnitTests.h"
+#include "ReplicationBatchUnitTests.h"
+#include "CoordinatesMapperUnitTests.h"
 
 using namespace std;
 
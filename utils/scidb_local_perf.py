@@ -0,0 +1,403 @@
+#!/usr/bin/python
+#
+#
+# BEGIN_COPYRIGHT
+#
+# Copyright (C) 2008-2015 SciDB, Inc.
+# All Rights Reserved.
+#
+# SciDB is free software: you can redistribute it and/or modify
+# it under the terms of the AFFERO GNU General Public License as published by
+# the Free Software Foundation.
+#
+# SciDB is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+# INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+# NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+# the AFFERO GNU General Public License for the complete license terms.
+#
+# You should have received a copy of the AFFERO GNU General Public License
+# along with SciDB.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+#
+# END_COPYRIGHT
+#
+"""This script runs an AFL workload on a throwaway cluster of local SciDB instances
+and reports the time and the counters of every query, so that performance regressions
+can be reproduced and bisected on a single machine.
+
+The cluster lives in a working directory of its own:
+  - catalog/      a private PostgreSQL server, listening on the loopback interface only,
+                  which holds the system catalog of the cluster;
+  - instance-<i>/ the storage and logs of instance <i>, listening on 127.0.0.1:<base-port + i>.
+Nothing outside of it is touched: no config.ini, ~/.pgpass or system database is needed.
+The cluster is stopped and, unless --keep is given, the directory removed at exit.
+
+The workload is a file of AFL statements, each one ending with ';' at the end of a line.
+Lines starting with '--' are comments. The statements are run one at a time, in order,
+--repeat times. For every run of a statement one line of results is printed: its wall
+clock time as seen by iquery, and the counters of the query (bytes sent, redistributed,
+written, read...) summed over all instances, as reported by the counters statistics
+monitor (stat-monitor=3) of the instances.
+
+Assumptions:
+  - the scidb and iquery binaries to test are in --bin-dir, by default the directory of this script;
+  - the PostgreSQL server programs (initdb, pg_ctl, createdb) are in your path or in --pg-bin-dir.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import traceback
+
+_COUNTERS = [
+    'sent_bytes', 'sent_messages', 'received_bytes', 'received_messages',
+    'local_chunk_bytes', 'local_chunks', 'remote_chunk_bytes', 'remote_chunks',
+    'written_bytes', 'written_chunks', 'read_bytes', 'read_chunks',
+    'pinned_bytes', 'pinned_chunks', 'allocated_bytes', 'allocated_chunks']
+
+_COUNTERS_LINE = re.compile(r'Counters of query (\d+):(.*)$')
+
+_LOG_PROPERTIES = """\
+log4j.rootLogger=%(level)s, file
+log4j.appender.file=org.apache.log4j.FileAppender
+log4j.appender.file.File=scidb.log
+log4j.appender.file.layout=org.apache.log4j.PatternLayout
+log4j.appender.file.layout.ConversionPattern=%%d [%%t] [%%-5p]: %%m%%n
+
+log4j.logger.scidb.statistics=INFO, counters
+log4j.additivity.scidb.statistics=false
+log4j.appender.counters=org.apache.log4j.FileAppender
+log4j.appender.counters.File=counters.log
+log4j.appender.counters.layout=org.apache.log4j.PatternLayout
+log4j.appender.counters.layout.ConversionPattern=%%m%%n
+"""
+
+class AppError(Exception):
+    """An error of the set up or of the tear down of the cluster."""
+    pass
+
+def log(message):
+    """Print a progress message to stderr, leaving stdout to the results."""
+    sys.stderr.write(message + '\n')
+    sys.stderr.flush()
+
+def read_statements(path):
+    """Read the AFL statements of a workload file.
+
+    @param path the path of the file
+    @return the list of statements, without their ending ';'
+    """
+    statements = []
+    current = []
+    with open(path) as f:
+        for line in f:
+            stripped = line.strip()
+            if not stripped or stripped.startswith('--'):
+                continue
+            current.append(stripped)
+            if stripped.endswith(';'):
+                statements.append(' '.join(current)[:-1].strip())
+                current = []
+    if current:
+        statements.append(' '.join(current).strip())
+    return statements
+
+def program(directory, name):
+    """@return the path of a program in a directory, or its name alone to find it in the path."""
+    return os.path.join(directory, name) if directory else name
+
+class LocalCluster(object):
+    """A cluster of SciDB instances on the loopback interface, with a private catalog."""
+
+    def __init__(self, args, work_dir):
+        self._args = args
+        self._dir = work_dir
+        self._catalog_dir = os.path.join(work_dir, 'catalog')
+        self._log_conf = os.path.join(work_dir, 'log4cxx.properties')
+        self._instances = []
+        self._catalog_started = False
+        self._counters_offsets = [0] * args.instances
+        self._connection = ('host=127.0.0.1 port=%d dbname=scidb_catalog user=scidb password=scidb'
+                            % args.pg_port)
+
+    def _instance_dir(self, i):
+        return os.path.join(self._dir, 'instance-%d' % i)
+
+    def _run(self, cmd, cwd=None, output=None):
+        """Run a command to completion.
+
+        @exception AppError if the command fails
+        """
+        out = open(output, 'w') if output else open(os.devnull, 'w')
+        try:
+            ret = subprocess.call(cmd, cwd=cwd, stdout=out, stderr=subprocess.STDOUT)
+        finally:
+            out.close()
+        if ret != 0:
+            raise AppError('%s failed with exit code %d%s' % (
+                    ' '.join(cmd), ret, (', see ' + output) if output else ''))
+
+    def start_catalog(self):
+        """Create and start a private PostgreSQL server holding an empty catalog database."""
+        pg = self._args.pg_bin_dir
+        log('Starting the catalog on 127.0.0.1:%d' % self._args.pg_port)
+        self._run([program(pg, 'initdb'), '-D', self._catalog_dir, '-U', 'scidb', '-A', 'trust'],
+                  output=os.path.join(self._dir, 'initdb.log'))
+        self._run([program(pg, 'pg_ctl'), '-D', self._catalog_dir, '-w',
+                   '-l', os.path.join(self._catalog_dir, 'postgres.log'),
+                   '-o', '-p %d -c listen_addresses=127.0.0.1 -k %s' % (self._args.pg_port, self._catalog_dir),
+                   'start'],
+                  output=os.path.join(self._dir, 'pg_ctl.log'))
+        self._catalog_started = True
+        self._run([program(pg, 'createdb'), '-h', '127.0.0.1', '-p', str(self._args.pg_port),
+                   '-U', 'scidb', 'scidb_catalog'],
+                  output=os.path.join(self._dir, 'createdb.log'))
+
+    def _scidb_command(self, i):
+        port = self._args.base_port + i
+        cmd = [program(self._args.bin_dir, 'scidb'),
+               '-i', '127.0.0.1',
+               '-p', str(port),
+               '-s', os.path.join(self._instance_dir(i), 'storage.cfg'),
+               '-c', self._connection,
+               '-l', self._log_conf]
+        return cmd
+
+    def register_instances(self):
+        """Register the instances in the catalog, initializing it with the first one."""
+        with open(self._log_conf, 'w') as f:
+            f.write(_LOG_PROPERTIES % {'level': self._args.log_level})
+        for i in range(self._args.instances):
+            os.makedirs(self._instance_dir(i))
+            cmd = self._scidb_command(i) + ['--register']
+            if i == 0:
+                cmd.append('--initialize')
+            self._run(cmd, cwd=self._instance_dir(i),
+                      output=os.path.join(self._instance_dir(i), 'init-stdout.log'))
+
+    def start_instances(self):
+        """Start all instances and wait for the cluster to answer queries."""
+        log('Starting %d instances on 127.0.0.1:%d-%d' % (
+                self._args.instances, self._args.base_port,
+                self._args.base_port + self._args.instances - 1))
+        for i in range(self._args.instances):
+            cmd = self._scidb_command(i) + ['-k', '--no-watchdog',
+                                            '--stat-monitor=3',
+                                            '--stat-monitor-params=scidb.statistics']
+            cmd += ['--' + option for option in self._args.scidb_option]
+            out = open(os.path.join(self._instance_dir(i), 'scidb-stdout.log'), 'w')
+            try:
+                self._instances.append(subprocess.Popen(cmd, cwd=self._instance_dir(i),
+                                                        stdout=out, stderr=subprocess.STDOUT))
+            finally:
+                out.close()
+
+        deadline = time.time() + self._args.start_timeout
+        while True:
+            for i, p in enumerate(self._instances):
+                if p.poll() is not None:
+                    raise AppError('instance %d exited with code %d, see %s' % (
+                            i, p.returncode, self._instance_dir(i)))
+            if self.run_query("list('instances')", fetch=False)[0]:
+                return
+            if time.time() > deadline:
+                raise AppError('the cluster did not start within %d seconds' % self._args.start_timeout)
+            time.sleep(0.5)
+
+    def run_query(self, statement, fetch=True):
+        """Run an AFL statement on the first instance.
+
+        @return a (succeeded, seconds, error) tuple
+        """
+        cmd = [program(self._args.bin_dir, 'iquery'),
+               '-c', '127.0.0.1', '-p', str(self._args.base_port), '-a']
+        if not fetch:
+            cmd.append('-n')
+        cmd += ['-q', statement]
+        with open(os.devnull, 'w') as devnull:
+            start = time.time()
+            p = subprocess.Popen(cmd, stdout=devnull, stderr=subprocess.PIPE)
+            err = p.communicate()[1]
+            seconds = time.time() - start
+        if isinstance(err, bytes):
+            err = err.decode('utf-8', 'replace')
+        return (p.returncode == 0, seconds, err.strip())
+
+    def collect_counters(self, wait):
+        """Sum the counters the instances reported since the last call.
+
+        Instances report the counters of a query when they release it, which may happen
+        shortly after the client gets its result: the logs are read again until every
+        instance has reported some query, or until wait seconds have passed.
+
+        @return a dictionary of the counters, and the number of instances which reported none
+        """
+        totals = dict((name, 0) for name in _COUNTERS)
+        reported = [False] * len(self._instances)
+        deadline = time.time() + wait
+        while True:
+            for i in range(len(self._instances)):
+                path = os.path.join(self._instance_dir(i), 'counters.log')
+                if not os.path.exists(path):
+                    continue
+                with open(path) as f:
+                    f.seek(self._counters_offsets[i])
+                    for line in f:
+                        if not line.endswith('\n'):
+                            break  # the rest of the line is still being written
+                        self._counters_offsets[i] += len(line)
+                        match = _COUNTERS_LINE.search(line)
+                        if not match:
+                            continue
+                        reported[i] = True
+                        for pair in match.group(2).split():
+                            name, value = pair.split('=', 1)
+                            if name in totals:
+                                totals[name] += int(value)
+            if all(reported) or time.time() > deadline:
+                return totals, reported.count(False)
+            time.sleep(0.05)
+
+    def stop(self):
+        """Stop the instances, then the catalog."""
+        for p in self._instances:
+            if p.poll() is None:
+                p.send_signal(signal.SIGTERM)
+        deadline = time.time() + 30
+        for p in self._instances:
+            while p.poll() is None and time.time() < deadline:
+                time.sleep(0.1)
+            if p.poll() is None:
+                p.kill()
+                p.wait()
+        self._instances = []
+        if self._catalog_started:
+            subprocess.call([program(self._args.pg_bin_dir, 'pg_ctl'), '-D', self._catalog_dir,
+                             '-m', 'fast', '-w', 'stop'],
+                            stdout=open(os.devnull, 'w'), stderr=subprocess.STDOUT)
+            self._catalog_started = False
+
+def print_result(args, result, first):
+    """Print the result of one run of a statement, as a JSON object or a CSV row."""
+    if args.format == 'csv':
+        columns = ['label', 'run', 'statement_no', 'succeeded', 'seconds', 'unreported_instances'] + _COUNTERS
+        if first:
+            print(','.join(columns + ['statement']))
+        row = [str(result[c]) for c in columns]
+        row.append('"%s"' % result['statement'].replace('"', '""'))
+        print(','.join(row))
+    else:
+        print(json.dumps(result, sort_keys=True))
+    sys.stdout.flush()
+
+def main():
+    """Set up the cluster, run the workload, report the results and tear the cluster down."""
+    bin_dir = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(
+        description='Run an AFL workload on a throwaway cluster of local SciDB instances '
+                    'and report the time and the counters of every query.',
+        epilog='assumptions:\n' +
+               '  - the PostgreSQL server programs are in your path or in --pg-bin-dir.',
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('workload', help='The file of AFL statements to run.')
+    parser.add_argument('-n', '--instances', type=int, default=4,
+                        help='The number of instances of the cluster. Default is 4.')
+    parser.add_argument('--setup',
+                        help='A file of AFL statements to run once before the workload, without reporting them.')
+    parser.add_argument('--repeat', type=int, default=1,
+                        help='The number of times the workload is run. Default is 1.')
+    parser.add_argument('--base-port', type=int, default=11239,
+                        help='The port of the first instance, the others following it. Default is 11239.')
+    parser.add_argument('--pg-port', type=int, default=15432,
+                        help='The port of the private catalog server. Default is 15432.')
+    parser.add_argument('--bin-dir', default=bin_dir,
+                        help='The directory of the scidb and iquery binaries. Default is ' + bin_dir + '.')
+    parser.add_argument('--pg-bin-dir', default='',
+                        help='The directory of initdb, pg_ctl and createdb. Default is to find them in the path.')
+    parser.add_argument('--work-dir',
+                        help='The directory in which to create the cluster, which must not exist. '
+                             'Default is a new temporary directory.')
+    parser.add_argument('--keep', action='store_true',
+                        help='Keep the working directory, with the logs of the instances, at exit.')
+    parser.add_argument('-o', '--scidb-option', action='append', default=[],
+                        help='An option of the instances, such as merge-sort-buffer=128, may be repeated.')
+    parser.add_argument('--no-fetch', action='store_true',
+                        help='Do not fetch the results of the queries.')
+    parser.add_argument('--format', choices=['json', 'csv'], default='json',
+                        help='The format of the results: one JSON object per line (default) or CSV.')
+    parser.add_argument('--label', default='',
+                        help='The label of every result, such as the commit the binaries were built from.')
+    parser.add_argument('--log-level', default='WARN',
+                        help='The level of the logs of the instances. Default is WARN.')
+    parser.add_argument('--start-timeout', type=int, default=120,
+                        help='The number of seconds to wait for the cluster to start. Default is 120.')
+    args = parser.parse_args()
+
+    if args.instances < 1 or args.repeat < 1:
+        parser.error('--instances and --repeat must be positive')
+    workload = read_statements(args.workload)
+    setup = read_statements(args.setup) if args.setup else []
+
+    if args.work_dir:
+        work_dir = os.path.abspath(args.work_dir)
+        os.makedirs(work_dir)
+    else:
+        work_dir = tempfile.mkdtemp(prefix='scidb_local_perf.')
+    log('Working directory: ' + work_dir)
+
+    cluster = LocalCluster(args, work_dir)
+    failed = False
+    try:
+        cluster.start_catalog()
+        cluster.register_instances()
+        cluster.start_instances()
+
+        for statement in setup:
+            succeeded, seconds, error = cluster.run_query(statement, fetch=False)
+            if not succeeded:
+                raise AppError('set up statement failed: %s\n%s' % (statement, error))
+        cluster.collect_counters(wait=1)
+
+        first = True
+        for run in range(args.repeat):
+            for statement_no, statement in enumerate(workload):
+                succeeded, seconds, error = cluster.run_query(statement, fetch=not args.no_fetch)
+                counters, unreported = cluster.collect_counters(wait=5)
+                if not succeeded:
+                    failed = True
+                    log('Statement %d failed: %s' % (statement_no, error))
+                result = {'label': args.label,
+                          'run': run,
+                          'statement_no': statement_no,
+                          'statement': statement,
+                          'succeeded': succeeded,
+                          'seconds': round(seconds, 6),
+                          'unreported_instances': unreported}
+                result.update(counters)
+                print_result(args, result, first)
+                first = False
+    except AppError as e:
+        log('Error: %s' % e)
+        failed = True
+    except KeyboardInterrupt:
+        log('Interrupted')
+        failed = True
+    except Exception:
+        traceback.print_exc()
+        failed = True
+    finally:
+        cluster.stop()
+        if args.keep or failed:
+            log('The cluster was left in ' + work_dir)
+        else:
+            shutil.rmtree(work_dir, ignore_errors=True)
+    sys.exit(1 if failed else 0)
+
+if __name__ == '__main__':
+    main()